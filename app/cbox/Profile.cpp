@@ -11,69 +11,97 @@
 #include "ValueTicks.h"
 
 ticks_millis_t ProfileConfig::lastTick;
+uint32_t ProfileConfig::minutes;
 
-typedef uint16_t fixed0_16;
-typedef uint32_t fixed16_16;
+// all loaded profiles, evaluated together once per minute
+static ProfileEngine<PROFILE_MAX_LOADED> engine;
 
-uint16_t ProfileConfig::calculateSetpoint(uint8_t step, uint8_t maxStep, uint16_t current) 
+ProfileConfig::~ProfileConfig()
 {
-	uint16_t duration = stepDuration(step);
-	uint16_t setpoint = stepSetpoint(step);
-	ProfileInterpolation interpolation = this->profileInterpolation();
-	if (step==maxStep || duration==0 || interpolation==none)
-	{		
-		// setpoint is as is
+	if (cache.slot != engine.NO_SLOT)
+		engine.stop(cache.slot);
+}
+
+void ProfileConfig::load()
+{
+	eptr_t offset = eeprom_offset();
+	cache.state = eepromAccess.readByte(offset);
+	cache.currentTime = readPointer(offset+1);
+	cache.checkpointTime = cache.currentTime;
+	uint8_t count = eepromAccess.readByte(offset+3);
+	if (count > PROFILE_MAX_STEPS)
+		count = PROFILE_MAX_STEPS;
+	ProfilePoint points[PROFILE_MAX_STEPS];
+	for (uint8_t i=0; i<count; i++) {
+		points[i].duration = uint16_t(readPointer(offset+4+(i<<2)));
+		points[i].setpoint = int16_t(readPointer(offset+6+(i<<2)));
 	}
-	else
-	{
-		// todo - duration granularity is one minute
-		
-		// fixed point 0.16
-		fixed0_16 t2 = ((fixed16_16)current << 16) / duration;
+	ProfileInterpolation interpolation = profileInterpolation();
+#if !PROFILE_SMOOTHING
+	if (interpolation > INTERPOLATION_LINEAR)
+		interpolation = INTERPOLATION_LINEAR;
+#endif
+	if (cache.slot != engine.NO_SLOT) {
+		engine.stop(cache.slot);
+		cache.slot = engine.NO_SLOT;
+	}
+	if (!cache.steps.load(points, count, interpolation))
+		return;
 
-		fixed7_9 sp1 = setpoint;
-		fixed7_9 sp2 = stepSetpoint(step+1);
-#if PROFILE_SMOOTHING		
-		if (interpolation == smooth) {
-			// smoothstep (x*x*(3-2*x))
-			t2 = (fixed0_16)(((((fixed16_16)t2) * (fixed16_16)t2) >> 16) * ((3UL<<16) - ((fixed16_16) t2 << 1)) >> 16);
-		} 
-		else if (interpolation == smoother) {
-			// smootherstep (x*x*x*(x*(x*6-15)+10))
-			t2 = ((((t2 * ((fixed16_16)t2 * 6UL - (15UL<<16))) >> 16) + (10UL<<16)) * (((((fixed16_16)t2 * t2) >> 16) * t2) >> 16)) >> 16;
-		}
-#endif		
-		fixed0_16 t1 = (1UL<<16)-t2;
-		if (interpolation!=none)
-			setpoint = ((fixed23_9)sp1 * t1 + (fixed23_9)sp2 * t2) >> 16;				
+	// resume at the position stored in eeprom
+	uint8_t step = currentStep();
+	if (step >= stepCount())
+		step = stepCount()-1;
+	uint32_t elapsed = cache.steps.stepStart(step);
+	if (step+1 < stepCount())
+		elapsed += cache.currentTime;
+	cache.slot = engine.start(&cache.steps, minutes, elapsed);
+	if (cache.slot != engine.NO_SLOT && !isRunning())
+		engine.pause(cache.slot);
+}
+
+/**
+ * Writes the runtime position to eeprom, so the profile resumes there after a power loss.
+ */
+void ProfileConfig::checkpoint()
+{
+	eptr_t offset = eeprom_offset();
+	if (eepromAccess.readByte(offset)!=cache.state)
+		eepromAccess.writeByte(offset, cache.state);
+	if (cache.checkpointTime!=cache.currentTime) {
+		writePointer(offset+1, cache.currentTime);
+		cache.checkpointTime = cache.currentTime;
 	}
-	return setpoint;
 }
-	
+
 profile_value_t ProfileConfig::updateSetpoint(profile_value_t setpoint)
 {	
 	ticks_millis_t currTick = ticks.millis();
-	if (currTick-lastTick>60000) {
+	if (currTick-lastTick>60000) {		// the first profile updated in a new minute advances all of them
 		lastTick = currTick;
-		
-		uint8_t step = currentStep();
-		uint8_t maxStep = stepCount()-1;		
-		uint16_t current = currentProfileTime();
-		if (current >= stepDuration(step)) {	// end of current step
-			if (step==maxStep || stepDuration(step)==0) {		// at least step
-				setpoint = stepSetpoint(step);
-			}
-			else {
-				setCurrentProfileTime(0);
-				setCurrentStep(step+1);
-				setpoint = calculateSetpoint(step, maxStep, current);
-			}
+		engine.update(++minutes);
+	}
+	if (cache.slot == engine.NO_SLOT)
+		return setpoint;
+
+	if (isRunning()) {
+		uint8_t step = engine.currentStep(cache.slot);
+		// the last step holds its setpoint, so its time is not stored
+		uint32_t current = 0;
+		if (step+1 < stepCount())
+			current = engine.elapsed(cache.slot, minutes) - cache.steps.stepStart(step);
+		if (step != currentStep()) {
+			setCurrentStep(step);
+			setCurrentProfileTime(current);
+			checkpoint();					// step boundary
 		}
 		else {
-			setpoint = calculateSetpoint(step, maxStep, current);
+			setCurrentProfileTime(current);
+			if (uint16_t(current-cache.checkpointTime) >= PROFILE_CHECKPOINT_INTERVAL)
+				checkpoint();
 		}
 	}
-	return setpoint;
+	return engine.value(cache.slot);
 }
 
 #if 0 
@@ -11,17 +11,26 @@
 #include "ValuesEeprom.h"
 #include "ValueModels.h"
 #include "Ticks.h"
+#include "ProfileEngine.h"
 
 #ifndef PROFILE_SMOOTHING
 #define PROFILE_SMOOTHING 0
 #endif
 
-enum ProfileInterpolation {
-	none,				// each profile step is constant until the next step
-	linear,				// linear interpolation between the start and end of each step
-	smooth,				// 
-	smoother
-};
+// minutes between checkpoints of the time within the current step. After a power loss, the profile resumes from
+// the last checkpoint, so it lags at most this long. The step is checkpointed whenever it changes.
+#ifndef PROFILE_CHECKPOINT_INTERVAL
+#define PROFILE_CHECKPOINT_INTERVAL 15
+#endif
+
+#define PROFILE_MAX_STEPS 16		// the current step is stored in 4 bits
+
+// number of profiles that can be loaded at the same time. They are evaluated together once per minute.
+#ifndef PROFILE_MAX_LOADED
+#define PROFILE_MAX_LOADED 8
+#endif
+
+static_assert(PROFILE_MAX_STEPS <= SetpointProfile::MAX_STEPS, "profile steps must fit in the precomputed profile");
 
 // The profile state persisted to eeprom.
 struct ProfileState
@@ -38,25 +47,45 @@ struct ProfileState
 #define STATE_RUNNING_MASK 0x02
 #define STATE_RESERVED_MASK 0x01
 
-#define STATE_INTERPOLATION_SHIFT 0
+#define STATE_INTERPOLATION_SHIFT 2
 #define STATE_CURRENT_STEP_SHIFT 4
 
 
 typedef uint16_t profile_value_t;
 
+// RAM copy of the profile config, so ticks don't read eeprom
+struct ProfileCache
+{
+	uint8_t			state;						// state byte, see STATE_xxx_MASK
+	uint16_t		currentTime;				// minutes since the start of the current step
+	uint16_t		checkpointTime;				// current time as last written to eeprom
+	uint8_t			slot;						// slot in the profile engine, NO_SLOT when the profile has no steps
+	SetpointProfile	steps;						// steps with their interpolation precomputed, durations in minutes
+};
+
 /**
  * A profile updates a 16-bit value in tandem with passing time.  
  * Eeprom foramt:
- *  
+ *  state (1 byte), current time in step (2 bytes), step count (1 byte),
+ *  per step: duration in minutes (2 bytes), setpoint (2 bytes)
+ *
+ * The config is loaded into RAM when rehydrated or written, with the interpolation of each step precomputed, and
+ * registered in a ProfileEngine that is shared by all profiles. The engine evaluates all loaded profiles in one pass
+ * once per minute, without divisions. The current step and time are written back to eeprom
+ * at step boundaries and every PROFILE_CHECKPOINT_INTERVAL minutes.
  */
 class ProfileConfig : public EepromValue
 {
 	// I choose to make this static so that all profiles are kept on the same time, and also 
 	// so that the code-size is smaller
 	static ticks_millis_t lastTick;
+	static uint32_t minutes;		// time of the profile engine
+
+	ProfileCache cache;
+
+	void load();
+	void checkpoint();
 
-	uint16_t calculateSetpoint(uint8_t step, uint8_t maxStep, profile_value_t current);
-	
 
 	bool isRunning() {
 		return state() & STATE_RUNNING_MASK;
@@ -71,50 +100,95 @@ class ProfileConfig : public EepromValue
 	}
 	
 	void setCurrentStep(uint8_t step) {
-		eepromAccess.writeByte(eeprom_offset(), (state()& ~STATE_CURRENT_STEP_MASK) | step);
+		cache.state = (cache.state & ~STATE_CURRENT_STEP_MASK) | (step << STATE_CURRENT_STEP_SHIFT);
 	}
 	
 	uint8_t state() {
-		return eepromAccess.readByte(eeprom_offset());
+		return cache.state;
 	}
 	
 	uint8_t stepCount() {
-		return eepromAccess.readByte(eeprom_offset()+3);
+		return cache.steps.stepCount();
 	}
 	
 	uint16_t stepDuration(uint8_t step) {
-		return readPointer(eeprom_offset()+4+(step<<1));
+		return cache.steps.stepDuration(step);
 	}
 
 	profile_value_t stepSetpoint(uint8_t step) {
-		return readPointer(eeprom_offset()+6+(step<<1));
+		return cache.steps.stepSetpoint(step);
 	}
 
 	uint16_t currentProfileTime() {
-		return readPointer(eeprom_offset()+1);
+		return cache.currentTime;
 	}
 	
 	void setCurrentProfileTime(uint16_t time) {
-		writePointer(eeprom_offset()+1, time);
+		cache.currentTime = time;
 	}
 	
 	void setSetpoint(uint16_t setpoint);
 	
-	profile_value_t updateSetpoint(profile_value_t previous);
-	
 public:
+	ProfileConfig() {
+		cache.slot = ProfileEngine<PROFILE_MAX_LOADED>::NO_SLOT;
+	}
+
+	~ProfileConfig();
+
+	/**
+	 * Advances all profiles once per minute and returns the setpoint of this profile.
+	 * Returns previous when the profile has no steps.
+	 */
+	profile_value_t updateSetpoint(profile_value_t previous);
+
 	// use default read to fetch profile state
 	// default write is available but not recommended
+
+	void rehydrated(eptr_t address) {
+		EepromValue::rehydrated(address);
+		load();
+	}
+
+	void writeMaskedFrom(DataIn& in, DataIn& mask) {
+		EepromValue::writeMaskedFrom(in, mask);
+		load();
+	}
 	
 	object_t objectType() {
 		return otValueWrite|otNotLogged;
 	}
 };
 
+/**
+ * The current setpoint of a profile.
+ */
+class ProfileSetpoint : public Value
+{
+	profile_value_t value;
+
+public:
+	ProfileSetpoint() : value(0) {}
+
+	profile_value_t read() {
+		return value;
+	}
+
+	void assign(profile_value_t setpoint) {
+		value = setpoint;
+	}
+
+	void readTo(DataOut& out) {
+		writeBytes(&value, sizeof(value), out);
+	}
+
+	uint8_t streamSize() { return sizeof(value); }
+};
+
 class Profile : public Container
 {
 	ProfileConfig				config;
-	TransientValue<uint16_t>	current;
+	ProfileSetpoint				current;
 	
 public:
 	
@@ -122,6 +196,10 @@ public:
 	void rehydrated(eptr_t address) {
 		config.rehydrated(address);
 	}
+
+	void update() {
+		current.assign(config.updateSetpoint(current.read()));
+	}
 	
 	Object* item(container_id id)
 	{
@@ -27,6 +27,7 @@ INCLUDE_DIRS += $(BOOST_ROOT)
 
 CSRC += $(call target_files,../cbox,*.c)
 CPPSRC += $(call target_files,../cbox,*.cpp)
+CPPSRC += lib/src/SetpointProfile.cpp
 
 
 #CSRC += $(call target_files,app/devices,*.c)
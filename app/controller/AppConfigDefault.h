@@ -48,6 +48,33 @@
 #define BREWPI_EEPROM_HELPER_COMMANDS BREWPI_DEBUG || BREWPI_SIMULATE
 #endif
 
+/**
+ * Run the control tasks in their own thread, with a higher priority than the UI and PiLink, which read the control
+ * state from snapshots. Needs an RTOS, so it is enabled by the platform.
+ */
+#ifndef BREWPI_CONTROL_THREAD
+#define BREWPI_CONTROL_THREAD 0
+#endif
+
+/**
+ * Log the control values to a ring in flash, so the Pi can fetch the samples it missed with the 'g' command.
+ * Needs external flash, so it is enabled by the platform.
+ */
+#ifndef BREWPI_DATA_LOG
+#define BREWPI_DATA_LOG 0
+#endif
+
+// time between samples in the data log in ms, can be changed with the 'g' command. The control values change once
+// per second, so a shorter interval adds nothing
+#ifndef BREWPI_DATA_LOG_INTERVAL
+#define BREWPI_DATA_LOG_INTERVAL 1000
+#endif
+
+// a block of samples is written to flash when it is full or this old, this is the most that is lost on a reset
+#ifndef BREWPI_DATA_LOG_MAX_BLOCK_AGE
+#define BREWPI_DATA_LOG_MAX_BLOCK_AGE 300000
+#endif
+
 #ifndef OPTIMIZE_GLOBAL
 #define OPTIMIZE_GLOBAL 1
 #endif
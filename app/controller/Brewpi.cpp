@@ -39,6 +39,10 @@
 #include "Sensor.h"
 #include "SettingsManager.h"
 #include "UI.h"
+#include "TaskScheduler.h"
+#include "EepromAccess.h"
+#include "ControlLock.h"
+#include "DataLog.h"
 
 #if BREWPI_SIMULATE
 	#include "Simulator.h"
@@ -59,8 +63,114 @@ DelayImpl wait = DelayImpl(DELAY_IMPL_CONFIG);
 
 UI ui;
 
+/* The main loop is a cooperative scheduler. The control update is split into separate tasks, so the PWM task, which
+ * has the highest priority, can be serviced between them. All tasks with a 1 second period are released together and
+ * run in order of priority: sensors, PIDs, actuators, then the display.
+ *
+ * The control tasks have their own scheduler. Without a control thread, the main loop runs it before the other tasks,
+ * which have a lower priority anyway. With BREWPI_CONTROL_THREAD, it runs in a thread with a higher priority than the
+ * main loop, so a touch calibration, a slow redraw or a slow serial peer cannot delay the control update.
+ * The UI and PiLink read the control state from the snapshot that the actuators task publishes.
+ */
+TaskScheduler controlScheduler;
+TaskScheduler taskScheduler;
+bool controlThreadRunning = false;
+
+static void pwmTask(){
+    control.fastUpdate(); // update actuators as often as possible for PWM
+}
+
+static void sensorsTask(){
+    if(!ui.inStartup()){
+        control.updateSensors();
+    }
+}
+
+static void pidsTask(){
+    if(!ui.inStartup()){
+        control.updatePids();
+    }
+}
+
+static void actuatorsTask(){
+    if(!ui.inStartup()){
+        control.updateActuators();
+        tempControl.publishSnapshot();
+    }
+}
+
+static void uiTask(){
+    if(!ui.inStartup()){
+        ui.update();
+    }
+}
+
+static void piLinkTask(){
+    //listen for incoming serial connections while waiting to update
+    // commands are parsed without the control lock, the code that changes the control objects takes it
+    piLink.receive();
+    Logger::sendQueued();
+}
+
+static void telemetryTask(){
+    piLink.sendTelemetry();
+}
+
+#if BREWPI_DATA_LOG
+static void dataLogTask(){
+    // runs every second, the logger skips the samples that are not due for longer intervals
+    dataLogUpdate();
+}
+#endif
+
+static void eepromTask(){
+    // prepare free flash pages for settings writes ahead of time.
+    // Needs no control lock, the EEPROM is only used from the main loop.
+    eepromAccess.compact();
+}
+
+// The tasks are only used in this file. Their names start with task, so they don't clash with functions like link().
+//                         function        period  deadline    priority    name
+static Task taskPwm(       pwmTask,        1,      10,         200,        "pwm");
+static Task taskSensors(   sensorsTask,    1000,   200,        150,        "sensors");
+static Task taskPids(      pidsTask,       1000,   300,        140,        "pids");
+static Task taskActuators( actuatorsTask,  1000,   400,        130,        "actuators");
+static Task taskUi(        uiTask,         1000,   1000,       100,        "ui");
+static Task taskPiLink(    piLinkTask,     0,      100,        50,         "piLink");
+static Task taskTelemetry( telemetryTask,  1000,   1000,       40,         "telemetry");
+#if BREWPI_DATA_LOG
+static Task taskDataLog(   dataLogTask,    1000,   1000,       30,         "dataLog");
+#endif
+static Task taskEeprom(    eepromTask,     1000,   1000,       10,         "eeprom");
+
+#if BREWPI_CONTROL_THREAD
+#include "concurrent_hal.h"
+
+#define CONTROL_THREAD_PRIORITY (OS_THREAD_PRIORITY_DEFAULT + 1) // above the main loop
+#define CONTROL_THREAD_STACK_SIZE 3072
+
+os_thread_t controlThread;
+
+/*
+ * Runs the control tasks that are due, then sleeps until the next millisecond tick, so the main loop gets the
+ * remaining time. Sleeping until a fixed wake time keeps the period constant, however long the tasks took.
+ */
+void controlThreadRun(void *){
+    system_tick_t wake = millis();
+    while(true){
+        {
+            ControlLock lock;
+            while(controlScheduler.run() != nullptr){
+            }
+        }
+        os_thread_delay_until(&wake, 1);
+    }
+}
+#endif
+
 void setup()
 {
+    ControlLock::init(); // before settings are loaded, which takes the lock
     bool resetEeprom = platform_init();
     eepromManager.init();
     if (resetEeprom)
@@ -90,27 +200,44 @@ void setup()
     settingsManager.loadSettings();
 
     control.update();
+    tempControl.publishSnapshot();
 
     ui.showControllerPage();
+
+    controlScheduler.add(&taskPwm);
+    controlScheduler.add(&taskSensors);
+    controlScheduler.add(&taskPids);
+    controlScheduler.add(&taskActuators);
+    taskScheduler.add(&taskUi);
+    taskScheduler.add(&taskPiLink);
+    taskScheduler.add(&taskTelemetry);
+#if BREWPI_DATA_LOG
+    dataLogInit();
+    taskScheduler.add(&taskDataLog);
+#endif
+    taskScheduler.add(&taskEeprom);
+
+#if BREWPI_CONTROL_THREAD
+    // when the thread cannot be created, the main loop runs the control tasks
+    {
+        ControlLock lock; // the thread starts with taking the lock, so it is registered before it logs anything
+        controlThreadRunning = os_thread_create(&controlThread, "control", CONTROL_THREAD_PRIORITY, controlThreadRun,
+                                                nullptr, CONTROL_THREAD_STACK_SIZE) == 0;
+        if (controlThreadRunning) {
+            ControlLock::setControlThread(controlThread);
+        }
+    }
+#endif
     			
 	logDebug("init complete");
 }
 
 void brewpiLoop(void)
 {
-	static unsigned long lastUpdate = -1000; // init at -1000 to update immediately
-        ui.ticks();
-        
-    if(!ui.inStartup() && (ticks.millis() - lastUpdate >= (1000))) { //update settings every second
-		lastUpdate = ticks.millis();
-		control.update();
-        ui.update();
+    ui.ticks();
+    if (controlThreadRunning || controlScheduler.run() == nullptr) {
+        taskScheduler.run();
     }
-
-    control.fastUpdate(); // update actuators as often as possible for PWM
-
-    //listen for incoming serial connections while waiting to update
-    piLink.receive();
 }
 
 void loop() {
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ChamberControl.h"
+#include "defaultDevices.h"
+#include <stdio.h>
+
+/*
+ * Names objects of the first chamber like before there were multiple chambers, others get a chamber prefix.
+ */
+static void setChamberName(Nameable & object, uint8_t chamber, const char * name){
+    if(chamber <= 1){
+        object.setName(name);
+    }
+    else{
+        char prefixed[MAX_NAME_LENGTH + 1];
+        snprintf(prefixed, sizeof(prefixed), "c%u.%s", chamber, name);
+        object.setName(prefixed);
+    }
+}
+
+ChamberControl::ChamberControl(uint8_t chamber) :
+    chamber(chamber),
+    fridgeSensor(defaultTempSensorBasic()),
+    beerSensor(defaultTempSensorBasic()),
+    roomSensor(defaultTempSensorBasic()),
+    heaterMutex(defaultActuator(), &mutex),
+    heater(&heaterMutex, 4), // period 4s
+    coolerTimeLimited(defaultActuator(), 120, 180), // 2 min minOn time, 3 min minOff
+    coolerMutex(&coolerTimeLimited, &mutex),
+    cooler(&coolerMutex, 1200), // period 20 min
+    fridgeSetPointActuator(&fridgeSet, &fridgeSensor, &beerSet),
+    heaterInputSensor(&fridgeSensor, &beerSensor),
+    coolerInputSensor(&fridgeSensor, &beerSensor),
+    heaterPid(&heaterInputSensor, &heater, &fridgeSet),
+    coolerPid(&coolerInputSensor, &cooler, &fridgeSet),
+    beerToFridgePid(&beerSensor, &fridgeSetPointActuator, &beerSet),
+    legacyBeer(*this, 2) // named beer2 and heater2, like before
+{
+    setChamberName(fridgeSensor, chamber, "fridge");
+    setChamberName(beerSensor, chamber, "beer1");
+    setChamberName(roomSensor, chamber, "room");
+    setChamberName(beerSet, chamber, "beer1set");
+    setChamberName(fridgeSet, chamber, "fridgeset");
+    setChamberName(heaterPid, chamber, "heater1");
+    setChamberName(coolerPid, chamber, "cooler");
+    setChamberName(beerToFridgePid, chamber, "beer2fridge");
+
+    fridgeSetPointActuator.setMin(-10.0);
+    fridgeSetPointActuator.setMax(10.0);
+    coolerPid.setActuatorIsNegative(true);
+    mutex.setDeadTime(1800000); // 30 minutes
+}
+
+BeerControl::BeerControl(ChamberControl & chamber, uint8_t beer) :
+    chamber(chamber.getChamber()),
+    beer(beer),
+    sensor(defaultTempSensorBasic()),
+    heaterMutex(defaultActuator(), &chamber.mutex),
+    heater(&heaterMutex, 4), // period 4s
+    heaterPid(&sensor, &heater, &set)
+{
+    char name[MAX_NAME_LENGTH + 1];
+    snprintf(name, sizeof(name), "beer%u", beer);
+    setChamberName(sensor, this->chamber, name);
+    snprintf(name, sizeof(name), "beer%uset", beer);
+    setChamberName(set, this->chamber, name);
+    snprintf(name, sizeof(name), "heater%u", beer);
+    setChamberName(heaterPid, this->chamber, name);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Pid.h"
+#include "TempSensor.h"
+#include "TempSensorFallback.h"
+#include "ActuatorMutexDriver.h"
+#include "ActuatorPwm.h"
+#include "ActuatorTimeLimited.h"
+#include "ActuatorMutexGroup.h"
+#include "ActuatorSetPoint.h"
+#include "SetPoint.h"
+
+class ChamberControl;
+
+/*
+ * A secondary beer in a chamber, which has its own sensor, setpoint and heater.
+ * The heater shares the mutex group of the chamber.
+ * Beer 2 is part of every chamber, beers above 2 are created by Control when they are configured.
+ */
+class BeerControl {
+public:
+    BeerControl(ChamberControl & chamber, uint8_t beer);
+    ~BeerControl() = default;
+
+    BeerControl(const BeerControl &) = delete;
+    BeerControl & operator=(const BeerControl &) = delete;
+
+    uint8_t getChamber() const {
+        return chamber;
+    }
+
+    uint8_t getBeer() const {
+        return beer;
+    }
+
+private:
+    uint8_t chamber;
+    uint8_t beer;
+
+public:
+    TempSensor sensor;
+    SetPointSimple set;
+    ActuatorMutexDriver heaterMutex;
+    ActuatorPwm heater;
+    Pid heaterPid;
+};
+
+/*
+ * The control objects of one chamber: a fridge sensor and setpoint, a heater and a cooler with their PIDs
+ * and the primary beer, which drives the fridge setpoint.
+ * All objects are members, so a chamber is a single block of memory that is built and updated as a whole.
+ * Chamber numbers start at 1, like in DeviceConfig.
+ */
+class ChamberControl {
+public:
+    ChamberControl(uint8_t chamber);
+    ~ChamberControl() = default;
+
+    ChamberControl(const ChamberControl &) = delete;
+    ChamberControl & operator=(const ChamberControl &) = delete;
+
+    uint8_t getChamber() const {
+        return chamber;
+    }
+
+private:
+    uint8_t chamber;
+
+public:
+    TempSensor fridgeSensor;
+    TempSensor beerSensor;
+    TempSensor roomSensor;
+
+    SetPointSimple beerSet;
+    SetPointSimple fridgeSet;
+
+    ActuatorMutexGroup mutex;
+
+    ActuatorMutexDriver heaterMutex;
+    ActuatorPwm heater;
+
+    ActuatorTimeLimited coolerTimeLimited;
+    ActuatorMutexDriver coolerMutex;
+    ActuatorPwm cooler;
+
+    ActuatorSetPoint fridgeSetPointActuator;
+
+    TempSensorFallback heaterInputSensor;
+    TempSensorFallback coolerInputSensor;
+
+    Pid heaterPid;
+    Pid coolerPid;
+    Pid beerToFridgePid;
+
+    // beer 2, which has the beer heater from before beers were configurable
+    BeerControl legacyBeer;
+};
@@ -31,111 +31,246 @@
 #include "ActuatorSetPoint.h"
 #include "ActuatorMutexDriver.h"
 #include "ActuatorMutexGroup.h"
+#include "OneWireSwitch.h"
 #include "json_writer.h"
 
 Control::Control()
 {
-    // set up static devices for backwards compatibility with tempControl
-    beer1Sensor = new TempSensor(defaultTempSensorBasic());
-    beer1Sensor->setName("beer1");
-    beer2Sensor = new TempSensor(defaultTempSensorBasic());
-    beer2Sensor->setName("beer2");
-    fridgeSensor = new TempSensor(defaultTempSensorBasic());
-    fridgeSensor->setName("fridge");
-
-    mutex = new ActuatorMutexGroup();
-
-    heater1Mutex = new ActuatorMutexDriver(defaultActuator(), mutex);
-    heater1 = new ActuatorPwm(heater1Mutex, 4); // period 4s
-
-    heater2Mutex = new ActuatorMutexDriver(defaultActuator(), mutex);
-    heater2 = new ActuatorPwm(heater2Mutex, 4); // period 4s
-
-    coolerTimeLimited = new ActuatorTimeLimited(defaultActuator(), 120, 180); // 2 min minOn time, 3 min minOff
-    coolerMutex = new ActuatorMutexDriver(coolerTimeLimited, mutex);
-    cooler = new ActuatorPwm(coolerMutex, 1200); // period 20 min
-
-    beer1Set = new SetPointSimple();
-    beer2Set = new SetPointSimple();
-    fridgeSet = new SetPointSimple();
-
-    fridgeSetPointActuator = new ActuatorSetPoint(fridgeSet, fridgeSensor, beer1Set);
-    fridgeSetPointActuator->setMin(-10.0);
-    fridgeSetPointActuator->setMax(10.0);
+    // reserve room for the largest graph once, so rebuilding the graph does not allocate from the heap again
+    pids.reserve(CONTROL_MAX_CHAMBERS * PIDS_PER_CHAMBER + CONTROL_MAX_BEERS * OBJECTS_PER_BEER);
+    sensors.reserve(CONTROL_MAX_CHAMBERS * SENSORS_PER_CHAMBER + CONTROL_MAX_BEERS * OBJECTS_PER_BEER);
+    actuators.reserve(CONTROL_MAX_CHAMBERS * ACTUATORS_PER_CHAMBER + CONTROL_MAX_BEERS * OBJECTS_PER_BEER);
+    setpoints.reserve(CONTROL_MAX_CHAMBERS * SETPOINTS_PER_CHAMBER + CONTROL_MAX_BEERS * OBJECTS_PER_BEER);
+
+    // one chamber with one beer, the static setup from before chambers were configurable
+    const uint8_t defaultBeers[1] = {1};
+    build(1, defaultBeers);
+}
 
-    heaterInputSensor = new TempSensorFallback(fridgeSensor, beer1Sensor);
-    heater1Pid = new Pid(heaterInputSensor, heater1, fridgeSet);
-    heater1Pid->setName("heater1");
+/*
+ * Adds the objects of a chamber to an update loop. The objects of its beers in the pool follow the first beforeBeers
+ * objects, so each beer is updated together with the chamber objects of the same kind.
+ */
+template<typename T, size_t N, typename Pool, typename M>
+static void addChamberObjects(std::vector<T*> & list, T * const (&objects)[N], uint8_t beforeBeers,
+                              Pool & beers, uint8_t firstBeer, M BeerControl::* beerObject)
+{
+    list.insert(list.end(), objects, objects + beforeBeers);
+    for(uint8_t i = firstBeer; i < beers.size(); i++){
+        list.push_back(&(beers[i].*beerObject));
+    }
+    list.insert(list.end(), objects + beforeBeers, objects + N);
+}
+static_assert(Control::OBJECTS_PER_BEER == 1, "addChamberObjects adds one object of each kind for a beer");
 
-    coolerInputSensor = new TempSensorFallback(fridgeSensor, beer1Sensor);
-    coolerPid = new Pid(coolerInputSensor, cooler, fridgeSet);
-    coolerPid->setActuatorIsNegative(true);
-    coolerPid->setName("cooler");
+Control::~Control(){
+    // objects are destroyed by the pools: beers before the chambers that own their mutex group
+    beers.clear();
+    chambers.clear();
+}
 
-    heater2Pid = new Pid(beer2Sensor, heater2, beer2Set);
-    heater2Pid->setName("heater2");
+bool Control::build(uint8_t numChambers, const uint8_t * layout)
+{
+    if(numChambers == 0){
+        numChambers = 1; // TempControl needs a chamber
+    }
 
-    beerToFridgePid = new Pid(beer1Sensor, fridgeSetPointActuator, beer1Set);
-    beerToFridgePid->setName("beer2fridge");
+    // check that the layout fits before the current objects are destroyed, so a failed build keeps them
+    if(numChambers > CONTROL_MAX_CHAMBERS){
+        return false;
+    }
+    uint16_t pooledBeers = 0;
+    for(uint8_t c = 0; c < numChambers; c++){
+        if(layout[c] > 2){
+            pooledBeers += layout[c] - 2;
+        }
+    }
+    if(pooledBeers > CONTROL_MAX_BEERS){
+        return false;
+    }
 
-    pids.push_back(heater1Pid);
-    pids.push_back(heater2Pid);
-    pids.push_back(coolerPid);
-    pids.push_back(beerToFridgePid);
+    if(hasLayout(numChambers, layout)){
+        return true; // keep the objects, so pointers to them stay valid
+    }
 
-    sensors.push_back(fridgeSensor);
-    sensors.push_back(beer1Sensor);
-    sensors.push_back(beer2Sensor);
-    sensors.push_back(coolerInputSensor);
-    sensors.push_back(heaterInputSensor);
+    pids.clear();
+    sensors.clear();
+    actuators.clear();
+    setpoints.clear();
+    beers.clear();
+    chambers.clear();
+
+    for(uint8_t c = 1; c <= numChambers; c++){
+        ChamberControl * chamber = chambers.create(c);
+        if(chamber == nullptr){
+            return false;
+        }
+        // beer 2 is part of the chamber, the pool holds the beers above it
+        uint8_t firstBeer = beers.size();
+        for(uint8_t b = 3; b <= layout[c - 1]; b++){
+            if(beers.create(*chamber, b) == nullptr){
+                return false;
+            }
+        }
+
+        // add objects in the order they are stored, so the update loops walk memory linearly
+        Pid * const chamberPids[] = {
+            &chamber->heaterPid, &chamber->legacyBeer.heaterPid, &chamber->coolerPid, &chamber->beerToFridgePid
+        };
+        static_assert(sizeof(chamberPids)/sizeof(chamberPids[0]) == PIDS_PER_CHAMBER,
+                      "PIDS_PER_CHAMBER must match build()");
+        addChamberObjects(pids, chamberPids, 2, beers, firstBeer, &BeerControl::heaterPid);
+
+        TempSensorBasic * const chamberSensors[] = {
+            &chamber->fridgeSensor, &chamber->beerSensor, &chamber->roomSensor, &chamber->legacyBeer.sensor,
+            &chamber->coolerInputSensor, &chamber->heaterInputSensor
+        };
+        static_assert(sizeof(chamberSensors)/sizeof(chamberSensors[0]) == SENSORS_PER_CHAMBER,
+                      "SENSORS_PER_CHAMBER must match build()");
+        addChamberObjects(sensors, chamberSensors, 4, beers, firstBeer, &BeerControl::sensor);
+
+        Actuator * const chamberActuators[] = {
+            &chamber->cooler, &chamber->heater, &chamber->legacyBeer.heater
+        };
+        static_assert(sizeof(chamberActuators)/sizeof(chamberActuators[0]) == ACTUATORS_PER_CHAMBER,
+                      "ACTUATORS_PER_CHAMBER must match build()");
+        addChamberObjects(actuators, chamberActuators, 3, beers, firstBeer, &BeerControl::heater);
+
+        SetPoint * const chamberSetpoints[] = {
+            &chamber->beerSet, &chamber->legacyBeer.set, &chamber->fridgeSet
+        };
+        static_assert(sizeof(chamberSetpoints)/sizeof(chamberSetpoints[0]) == SETPOINTS_PER_CHAMBER,
+                      "SETPOINTS_PER_CHAMBER must match build()");
+        addChamberObjects(setpoints, chamberSetpoints, 2, beers, firstBeer, &BeerControl::set);
+    }
 
-    actuators.push_back(cooler);
-    actuators.push_back(heater1);
-    actuators.push_back(heater2);
+    ChamberControl & first = chambers[0];
+    BeerControl & second = first.legacyBeer;
+
+    fridgeSensor = &first.fridgeSensor;
+    beer1Sensor = &first.beerSensor;
+    beer2Sensor = &second.sensor;
+    roomSensor = &first.roomSensor;
+    heaterInputSensor = &first.heaterInputSensor;
+    coolerInputSensor = &first.coolerInputSensor;
+    coolerTimeLimited = &first.coolerTimeLimited;
+    coolerMutex = &first.coolerMutex;
+    cooler = &first.cooler;
+    heater1Mutex = &first.heaterMutex;
+    heater1 = &first.heater;
+    heater2Mutex = &second.heaterMutex;
+    heater2 = &second.heater;
+    fridgeSetPointActuator = &first.fridgeSetPointActuator;
+    mutex = &first.mutex;
+    heater1Pid = &first.heaterPid;
+    heater2Pid = &second.heaterPid;
+    coolerPid = &first.coolerPid;
+    beerToFridgePid = &first.beerToFridgePid;
+    beer1Set = &first.beerSet;
+    beer2Set = &second.set;
+    fridgeSet = &first.fridgeSet;
+
+    return true;
+}
 
-    beer1Set->setName("beer1set");
-    beer2Set->setName("beer2set");
-    fridgeSet->setName("fridgeset");
+bool Control::hasLayout(uint8_t numChambers, const uint8_t * layout)
+{
+    if(chambers.size() != numChambers){
+        return false;
+    }
+    for(uint8_t c = 1; c <= numChambers; c++){
+        uint8_t chamberBeers = layout[c - 1] > 2 ? layout[c - 1] : 2;
+        if(numBeers(c) != chamberBeers){
+            return false;
+        }
+    }
+    return true;
+}
 
-    setpoints.push_back(beer1Set);
-    setpoints.push_back(beer2Set);
-    setpoints.push_back(fridgeSet);
+ChamberControl * Control::getChamber(uint8_t chamber)
+{
+    if(chamber == 0 || chamber > chambers.size()){
+        return nullptr;
+    }
+    return &chambers[chamber - 1];
+}
 
-    mutex->setDeadTime(1800000); // 30 minutes
+BeerControl * Control::getBeer(uint8_t chamber, uint8_t beer)
+{
+    if(beer == 2){
+        ChamberControl * c = getChamber(chamber);
+        return c ? &c->legacyBeer : nullptr;
+    }
+    for(BeerControl & b : beers){
+        if(b.getChamber() == chamber && b.getBeer() == beer){
+            return &b;
+        }
+    }
+    return nullptr;
 }
 
-Control::~Control(){
-#if defined(ARDUINO) || defined(SPARK)
-    // global control object is static and never destroyed.
-    // omit proper destructor to save space.
-#else
-    delete heater1Mutex;
-    delete heater1;
+void * Control::deviceTarget(uint8_t chamberNr, uint8_t beerNr, DeviceFunction function)
+{
+    ChamberControl * chamber = getChamber(chamberNr ? chamberNr : 1);
+    if(chamber == nullptr){
+        return nullptr;
+    }
 
-    delete heater2Mutex;
-    delete heater2;
+    // beer 0 and 1 are the primary beer, which is part of the chamber
+    BeerControl * beer = nullptr;
+    if(beerNr > 1){
+        beer = getBeer(chamber->getChamber(), beerNr);
+        if(beer == nullptr){
+            return nullptr;
+        }
+    }
 
-    delete coolerTimeLimited;
-    delete coolerMutex;
-    delete cooler;
+    switch(function){
+        case DEVICE_CHAMBER_ROOM_TEMP :
+            return &chamber->roomSensor;
+/*
+        case DEVICE_CHAMBER_DOOR :
+            return &tempControl.door;
 
-    delete fridgeSetPointActuator;
+        case DEVICE_CHAMBER_LIGHT :
+            return &tempControl.light;
+*/
+        case DEVICE_CHAMBER_HEAT :
+            return &chamber->heater;
 
-    delete beer1Set;
-    delete beer2Set;
-    delete fridgeSet;
+        case DEVICE_BEER_HEAT :
+            // the primary beer has no heater of its own, it uses the heater of beer 2, like before
+            return beer ? &beer->heater : &chamber->legacyBeer.heater;
 
-    delete mutex;
+        case DEVICE_CHAMBER_COOL :
+            return &chamber->cooler;
 
-    delete heater1Pid;
-    delete heater2Pid;
-    delete coolerPid;
-    delete beerToFridgePid;
+        case DEVICE_CHAMBER_TEMP :
+            return &chamber->fridgeSensor;
+/*
+        case DEVICE_CHAMBER_FAN :
+            return &tempControl.fan;
+*/
+        case DEVICE_BEER_TEMP :
+            return beer ? &beer->sensor : &chamber->beerSensor;
+
+        default :
+            return nullptr;
+    }
+}
 
-    pids.clear();
-    sensors.clear();
-    actuators.clear();
-#endif
+uint8_t Control::numBeers(uint8_t chamber)
+{
+    if(getChamber(chamber) == nullptr){
+        return 0;
+    }
+    uint8_t count = 2;
+    for(BeerControl & b : beers){
+        if(b.getChamber() == chamber){
+            count++;
+        }
+    }
+    return count;
 }
 
 // This update function should be called every second
@@ -143,12 +278,13 @@ void Control::update(){
     updateSensors();
     updatePids();
     updateActuators();
-    mutex->update();
 }
 
 // This update function should be called every second
 void Control::fastUpdate(){
     fastUpdateActuators();
+    // changes to multiple PIOs of the same OneWire switch are written together
+    OneWireSwitch::flushAll();
 }
 
 void Control::updatePids(){
@@ -165,9 +301,15 @@ void Control::updateSensors(){
 }
 
 void Control::updateActuators(){
+    // OneWire switches are read at most once in each cycle, by the first actuator that uses them
+    OneWireSwitch::nextCycle();
     for ( auto &actuator : actuators ) {
         actuator->update();
     }
+    for ( auto &chamber : chambers ) {
+        chamber.mutex.update();
+    }
+    OneWireSwitch::flushAll();
 }
 
 void Control::fastUpdateActuators(){
@@ -32,6 +32,19 @@
 #include "ActuatorMutexGroup.h"
 #include "json_writer.h"
 #include "ActuatorSetPoint.h"
+#include "ChamberControl.h"
+#include "StaticPool.h"
+#include "DeviceFunction.h"
+
+// chambers that can be configured. Each chamber is controlled independently.
+#ifndef CONTROL_MAX_CHAMBERS
+#define CONTROL_MAX_CHAMBERS 4
+#endif
+
+// beers above beer 2 with their own sensor and heater, for all chambers together
+#ifndef CONTROL_MAX_BEERS
+#define CONTROL_MAX_BEERS 6
+#endif
 
 class Control
 {
@@ -40,6 +53,34 @@ public:
 
     ~Control();
 
+    /*
+     * Builds the control objects for a number of chambers from the fixed capacity pools.
+     * layout[i] is the number of beers in chamber i+1, including the primary beer. Every chamber has at least 2 beers.
+     * When the layout changes, the old objects are destroyed. Devices installed in them must be uninstalled first
+     * and other code must not keep pointers to them, but look them up with deviceTarget() again.
+     * When the layout is the same, the objects are kept.
+     * /return false when not all chambers and beers fit in the pools. The current objects are kept then.
+     */
+    bool build(uint8_t numChambers, const uint8_t * layout);
+
+    // chamber and beer numbers start at 1, like in DeviceConfig. Returns nullptr when it does not exist.
+    ChamberControl * getChamber(uint8_t chamber);
+    BeerControl * getBeer(uint8_t chamber, uint8_t beer);
+
+    uint8_t numChambers() const {
+        return chambers.size();
+    }
+
+    // number of beers in a chamber, including the primary beer and beer 2, which always exist
+    uint8_t numBeers(uint8_t chamber);
+
+    /*
+     * Returns the control object a device with this function is installed in, in the chamber and beer given.
+     * For temperature sensors it points to a TempSensor, for actuators to the ActuatorPwm that drives the device.
+     * Chamber and beer 0 are treated as the first chamber and beer. Returns nullptr when it does not exist.
+     */
+    void * deviceTarget(uint8_t chamber, uint8_t beer, DeviceFunction function);
+
     void update(); // update everything
     void fastUpdate(); // update things that need fast updating (like PWM)
 
@@ -50,16 +91,25 @@ public:
 
     void serialize(JSON::Adapter& adapter);
 
+    // objects that build() adds to the update loops for each chamber, and for each beer in the pool one of each kind
+    static const uint8_t PIDS_PER_CHAMBER = 4;
+    static const uint8_t SENSORS_PER_CHAMBER = 6;
+    static const uint8_t ACTUATORS_PER_CHAMBER = 3;
+    static const uint8_t SETPOINTS_PER_CHAMBER = 3;
+    static const uint8_t OBJECTS_PER_BEER = 1;
+
+    // objects of all chambers, chamber by chamber in the order they are stored in the pools
     std::vector<SetPoint*> setpoints;
     std::vector<TempSensorBasic*> sensors;
     std::vector<Pid*>        pids;
     std::vector<Actuator*>   actuators;
 
-    // static setup below, we should support generating this dynamically later
+    // objects of the first chamber, used by TempControl
 protected:
     TempSensor * fridgeSensor;
     TempSensor * beer1Sensor;
     TempSensor * beer2Sensor;
+    TempSensor * roomSensor;
 
     TempSensorFallback * heaterInputSensor;
     TempSensorFallback * coolerInputSensor;
@@ -87,6 +137,12 @@ protected:
     SetPointSimple * beer2Set;
     SetPointSimple * fridgeSet;
 
+private:
+    bool hasLayout(uint8_t numChambers, const uint8_t * layout);
+
+    StaticPool<ChamberControl, CONTROL_MAX_CHAMBERS> chambers;
+    StaticPool<BeerControl, CONTROL_MAX_BEERS> beers;
+
     friend class TempControl;
     friend class DeviceManager;
 };
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ControlLock.h"
+
+#if BREWPI_CONTROL_THREAD
+
+#include "concurrent_hal.h"
+
+// recursive, because code that holds the lock can call code that takes it again, like enumerating devices for the
+// device test screen
+static os_mutex_recursive_t controlMutex = nullptr;
+static os_thread_t controlThread = nullptr;
+
+void ControlLock::init()
+{
+    if (controlMutex == nullptr) {
+        os_mutex_recursive_create(&controlMutex);
+    }
+}
+
+void ControlLock::lock()
+{
+    os_mutex_recursive_lock(controlMutex);
+}
+
+void ControlLock::unlock()
+{
+    os_mutex_recursive_unlock(controlMutex);
+}
+
+void ControlLock::setControlThread(os_thread_t thread)
+{
+    controlThread = thread;
+}
+
+bool ControlLock::inControlThread()
+{
+    return controlThread != nullptr && os_thread_is_current(controlThread);
+}
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Brewpi.h"
+
+#if BREWPI_CONTROL_THREAD
+#include "concurrent_hal.h"
+#endif
+
+/**
+ * Serializes changes to the control objects and the OneWire bus with the control thread.
+ *
+ * The control thread holds the lock while it runs its tasks. UI and PiLink only read the control state through
+ * TempControl::snapshot(), which needs no lock. They take the lock for the short moments they change settings or
+ * devices, or use the bus. Without a control thread, the lock does nothing.
+ *
+ * Usage: declare a ControlLock in the scope that changes the control objects.
+ */
+class ControlLock {
+public:
+#if BREWPI_CONTROL_THREAD
+    ControlLock() {
+        lock();
+    }
+    ~ControlLock() {
+        unlock();
+    }
+
+    static void init();
+    static void lock();
+    static void unlock();
+
+    // register the thread that runs the control tasks, while holding the lock so the thread waits until it is known
+    static void setControlThread(os_thread_t thread);
+    // @return true when called from the control thread, which cannot write to PiLink itself
+    static bool inControlThread();
+#else
+    ControlLock() {}
+    ~ControlLock() {}
+
+    static void init() {}
+    static void lock() {}
+    static void unlock() {}
+    static bool inControlThread() { return false; }
+#endif
+};
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DataLog.h"
+
+#if BREWPI_DATA_LOG
+
+#include "TempControl.h"
+#include "Ticks.h"
+#include "FlashSampleStore.h"
+#include "Telemetry.h"
+
+static_assert(SampleBlockWriter::BLOCK_SIZE <= TELEMETRY_MAX_BLOCK_SIZE, "a block of the data log must fit in a frame");
+
+static FlashSampleStore flashStore;
+SampleStore & dataLogStore = flashStore;
+SampleLogger dataLog(flashStore, DATA_LOG_CHANNELS, BREWPI_DATA_LOG_INTERVAL, BREWPI_DATA_LOG_MAX_BLOCK_AGE);
+
+void dataLogInit(){
+    flashStore.init();
+    dataLog.init();
+}
+
+void dataLogUpdate(){
+    ticks_millis_t now = ticks.millis();
+    if(!dataLog.due(now)){
+        return;
+    }
+    ControlSnapshot snapshot = tempControl.snapshot();
+    int32_t values[DATA_LOG_CHANNELS] = {
+        snapshot.beerTemp.getRaw(),
+        snapshot.beerSetting.getRaw(),
+        snapshot.fridgeTemp.getRaw(),
+        snapshot.fridgeSetting.getRaw(),
+        snapshot.roomTemp.getRaw(),
+        snapshot.coolerPwm.getRaw(),
+        snapshot.heater1Pwm.getRaw(),
+        snapshot.heater2Pwm.getRaw(),
+        snapshot.mode,
+        snapshot.state,
+        snapshot.outputs
+    };
+    dataLog.add(now, values);
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Brewpi.h"
+
+#if BREWPI_DATA_LOG
+
+#include "SampleLog.h"
+
+/**
+ * The data log samples the control snapshot into blocks in flash, so the history of a brew survives a lost connection
+ * to the Pi. The channels are the values with telemetry ids TELEMETRY_BEER_TEMP to TELEMETRY_OUTPUTS, in that order.
+ * The Pi fetches the blocks it does not have yet with the 'g' command.
+ */
+#define DATA_LOG_CHANNELS 11
+
+extern SampleLogger dataLog;
+extern SampleStore & dataLogStore;
+
+void dataLogInit();
+
+// adds a sample of the newest control snapshot when one is due
+void dataLogUpdate();
+
+#endif
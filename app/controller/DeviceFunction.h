@@ -0,0 +1,43 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * Describes the logical function of each device. 
+ */
+enum DeviceFunction
+{
+	DEVICE_NONE = 0,														// used as a sentry to mark end of list
+
+	// chamber devices
+    DEVICE_CHAMBER_DOOR = 1,                                                       // switch sensor
+    DEVICE_CHAMBER_HEAT = 2, DEVICE_CHAMBER_COOL = 3, DEVICE_CHAMBER_LIGHT = 4,    // actuator
+    DEVICE_CHAMBER_TEMP = 5, DEVICE_CHAMBER_ROOM_TEMP = 6,                         // temp sensors
+    DEVICE_CHAMBER_FAN = 7,                                                        // a fan in the chamber
+    DEVICE_CHAMBER_MANUAL_ACTUATOR = 8,                                            // no function, but installed for manual action
+
+	// carboy devices
+    DEVICE_BEER_FIRST = 9, DEVICE_BEER_TEMP = DEVICE_BEER_FIRST,                   // primary beer temp sensor
+    DEVICE_BEER_TEMP2 = 10,                                                        // secondary beer temp sensor
+    DEVICE_BEER_HEAT = 11, DEVICE_BEER_COOL = 12,                                  // individual actuators
+    DEVICE_BEER_SG = 13,                                                           // SG sensor
+    DEVICE_BEER_RESERVED1 = 14, DEVICE_BEER_RESERVED2 = 15,                        // reserved
+    DEVICE_MAX = 16
+};
@@ -33,8 +33,10 @@
 #include "PiLink.h"
 #include "EepromFormat.h"
 #include "EepromManager.h"
+#include "DeviceRegistry.h"
 #include "defaultDevices.h"
 #include "OneWireAddress.h"
+#include "ControlLock.h"
 
 #define CALIBRATION_OFFSET_PRECISION (4)
 
@@ -63,17 +65,17 @@ device_slot_t findDeviceFunction(DeviceConfig & find);
  */
 void DeviceManager::setupUnconfiguredDevices()
 {
-    // right now, uninstall doesn't care about chamber/beer distinction.
-    // but this will need to match beer/function when multiferment is available
     DeviceConfig cfg;
 
-    cfg.chamber = 1;
-    cfg.beer    = 1;
+    for (cfg.chamber = 1; cfg.chamber <= control.numChambers(); cfg.chamber++){
+        uint8_t beers = control.numBeers(cfg.chamber);
+        for (cfg.beer = 1; cfg.beer <= beers; cfg.beer++){
+            for (uint8_t i = 0; i < DEVICE_MAX; i++){
+                cfg.deviceFunction = DeviceFunction(i);
 
-    for (uint8_t i = 0; i < DEVICE_MAX; i++){
-        cfg.deviceFunction = DeviceFunction(i);
-
-        uninstallDevice(cfg);
+                uninstallDevice(cfg);
+            }
+        }
     }
 }
 
@@ -124,14 +126,28 @@ void * DeviceManager::createDevice(DeviceConfig & config,
                 return new BoolActuator();
             }
 #else
-            return new ActuatorOneWire(oneWireBus(config.hw.pinNr), config.hw.address, config.hw.offset.pio, config.hw.invert);
+        {
+            // the shared DS2413 comes from a pool too, without it the actuator is useless
+            ActuatorOneWire * actuator = new ActuatorOneWire();
+            if (actuator != NULL && !actuator->init(oneWireBus(config.hw.pinNr), config.hw.address, config.hw.offset.pio, config.hw.invert)){
+                delete actuator;
+                actuator = NULL;
+            }
+            return actuator;
+        }
 #endif
 #endif
 
 #if BREWPI_DS2408
         case DEVICE_HARDWARE_ONEWIRE_2408 :
-            return new ValveController(oneWireBus(config.hw.pinNr), config.hw.address, config.hw.offset.pio);
-
+        {
+            ValveController * valve = new ValveController();
+            if (valve != NULL && !valve->init(oneWireBus(config.hw.pinNr), config.hw.address, config.hw.offset.pio)){
+                delete valve;
+                valve = NULL;
+            }
+            return valve;
+        }
 #endif
 
     }
@@ -166,71 +182,12 @@ void DeviceManager::disposeDevice(DeviceType dt,
 }
 
 /*
- * Returns the pointer to where the device pointer resides. This can be used to delete the current device and install a new one.
- * For Temperature sensors, the returned pointer points to a TempSensor*. The basic device can be fetched by calling
- * TempSensor::getSensor().
+ * Returns the control object a device is installed in, which lives in the chamber and beer of the config.
+ * See Control::deviceTarget.
  */
-void ** DeviceManager::deviceTarget(DeviceConfig & config)
+void * DeviceManager::deviceTarget(DeviceConfig & config)
 {
-    // for multichamber, will write directly to the multi-chamber managed storage.
-    // later...
-    if ((config.chamber > 1) || (config.beer > 1)){
-        return NULL;
-    }
-
-    void ** ppv;
-
-    switch (config.deviceFunction){
-        case DEVICE_CHAMBER_ROOM_TEMP :
-            ppv = (void **) &control.beer2Sensor;
-
-            break;
-/*
-        case DEVICE_CHAMBER_DOOR :
-            ppv = (void **) &tempControl.door;
-
-            break;
-
-        case DEVICE_CHAMBER_LIGHT :
-            ppv = (void **) &tempControl.light;
-
-            break;
-*/
-        case DEVICE_CHAMBER_HEAT :
-            ppv = (void **) &control.heater1;
-
-            break;
-
-        case DEVICE_BEER_HEAT :
-            ppv = (void **) &control.heater2;
-
-            break;
-
-        case DEVICE_CHAMBER_COOL :
-            ppv = (void **) &control.cooler;
-
-            break;
-
-        case DEVICE_CHAMBER_TEMP :
-            ppv = (void **) &control.fridgeSensor;
-
-            break;
-/*
-        case DEVICE_CHAMBER_FAN :
-            ppv = (void **) &tempControl.fan;
-
-            break;
-*/
-        case DEVICE_BEER_TEMP :
-            ppv = (void **) &control.beer1Sensor;
-
-            break;
-
-        default :
-            ppv = NULL;
-    }
-
-    return ppv;
+    return control.deviceTarget(config.chamber, config.beer, DeviceFunction(config.deviceFunction));
 }
 
 /*
@@ -240,7 +197,8 @@ void ** DeviceManager::deviceTarget(DeviceConfig & config)
  */
 void DeviceManager::uninstallDevice(DeviceConfig & config)
 {
-    void ** ppv = deviceTarget(config);
+    ControlLock lock; // the control thread uses the installed devices
+    void * ppv = deviceTarget(config);
 
     if (ppv == NULL){
         return;
@@ -254,7 +212,7 @@ void DeviceManager::uninstallDevice(DeviceConfig & config)
 
         case DEVICETYPE_TEMP_SENSOR :
         {
-            TempSensor * s = (TempSensor *) (*ppv);
+            TempSensor * s = (TempSensor *) ppv;
             if(s->uninstallSensor()){
                 DEBUG_ONLY(logInfoInt(INFO_UNINSTALL_TEMP_SENSOR, config.deviceFunction));
             }
@@ -264,25 +222,18 @@ void DeviceManager::uninstallDevice(DeviceConfig & config)
         case DEVICETYPE_SWITCH_ACTUATOR :
         case DEVICETYPE_PWM_ACTUATOR :
         {
-            Actuator ** target = (Actuator **) ppv;
-            /*if ((*target)->getDeviviceTarget() != 0){
-                target = (*target)->getDeviviceTarget(); // recursive call to unpack until at pin actuator
+            Actuator * target = (Actuator *) ppv;
+            /*if (target->getDeviviceTarget() != 0){
+                target = target->getDeviviceTarget(); // recursive call to unpack until at pin actuator
             }*/
-            if ((*target)->removeNonForwarder()){
+            if (target->removeNonForwarder()){
                 DEBUG_ONLY(logInfoInt(INFO_UNINSTALL_ACTUATOR, config.deviceFunction));
             }
         }
         break;
 
         case DEVICETYPE_SWITCH_SENSOR :
-            if (*ppv != defaultSensor()){
-                DEBUG_ONLY(logInfoInt(INFO_UNINSTALL_SWITCH_SENSOR, config.deviceFunction));
-
-                delete (SwitchSensor *) *ppv;
-
-                *ppv = defaultSensor();
-            }
-
+            // switch sensors (door) have no target in the control objects yet
             break;
         case DEVICETYPE_MANUAL_ACTUATOR :
             break; // not installed for now, only exists in device list
@@ -294,8 +245,9 @@ void DeviceManager::uninstallDevice(DeviceConfig & config)
  */
 void DeviceManager::installDevice(DeviceConfig & config)
 {
+    ControlLock lock; // the control thread uses the installed devices and the OneWire bus
     DeviceType dt  = deviceType(config.deviceFunction);
-    void **    ppv = deviceTarget(config);
+    void *     ppv = deviceTarget(config);
 
     if ((ppv == NULL) || config.hw.deactivate){
         return;
@@ -317,7 +269,7 @@ void DeviceManager::installDevice(DeviceConfig & config)
             }
             else{
                 s -> init();
-                ((TempSensor *) *ppv)->installSensor(s);
+                ((TempSensor *) ppv)->installSensor(s);
 
 #if BREWPI_SIMULATE
             ((ExternalTempSensor *) s) -> setConnected(true);    // now connect the sensor after init is called
@@ -330,19 +282,19 @@ void DeviceManager::installDevice(DeviceConfig & config)
         case DEVICETYPE_PWM_ACTUATOR :
         {
             DEBUG_ONLY(logInfoInt(INFO_INSTALL_DEVICE, config.deviceFunction));
-            Actuator ** target = (Actuator **) ppv;
-            /*if ((*target)->getDeviviceTarget() != 0){
-                target = (*target)->getDeviviceTarget(); // recursive call to unpack until at pin/value actuator
+            Actuator * target = (Actuator *) ppv;
+            /*if (target->getDeviviceTarget() != 0){
+                target = target->getDeviviceTarget(); // recursive call to unpack until at pin/value actuator
             }*/
 
             ActuatorDigital * newActuator = (ActuatorDigital *) createDevice(config, dt);
-            (*target)->replaceNonForwarder(newActuator);
-
-#if (BREWPI_DEBUG > 0)
-            if (*target == NULL){
+            if (newActuator == NULL){
                 logErrorInt(ERROR_OUT_OF_MEMORY_FOR_DEVICE, config.deviceFunction);
+                target->removeNonForwarder(); // the function keeps working with an inactive default actuator
+            }
+            else{
+                target->replaceNonForwarder(newActuator);
             }
-#endif
         }
         break;
         case DEVICETYPE_MANUAL_ACTUATOR :
@@ -461,7 +413,7 @@ void DeviceManager::parseDeviceDefinition(Stream & p)
     DeviceConfig original;
 
     // todo - should ideally check if the eeprom is correctly initialized.
-    eepromManager.fetchDevice(original, dev.id);
+    deviceManager.allDevices(original, dev.id);
     memcpy(&target, &original, sizeof(target));
     assignIfSet(dev.chamber, &target.chamber);
     assignIfSet(dev.beer, &target.beer);
@@ -549,7 +501,7 @@ bool DeviceManager::isDeviceValid(DeviceConfig & config,
      *  More refined checks that may cause confusing results are not yet implemented. See todo below.
      */
 
-    /* chamber and beer within range. */
+    /* chamber and beer within range. Only chambers with settings in eeprom can be used. */
     if (!inRangeUInt8(config.chamber, 0, EepromFormat::MAX_CHAMBERS)){
         logErrorInt(ERROR_INVALID_CHAMBER, config.chamber);
 
@@ -711,7 +663,7 @@ void DeviceManager::printDevice(device_slot_t  slot,
 bool DeviceManager::allDevices(DeviceConfig & config,
                                uint8_t        deviceIndex)
 {
-    return eepromManager.fetchDevice(config, deviceIndex);
+    return deviceRegistry.fetch(config, deviceIndex);
 }
 
 void DeviceManager::OutputEnumeratedDevices(DeviceConfig * config,
@@ -745,23 +697,6 @@ void handleHardwareSpec(const char * key,
     }
 }
 
-inline bool matchAddress(uint8_t * detected,
-                         uint8_t * configured,
-                         uint8_t   count)
-{
-    if (!configured[0]){
-        return true;
-    }
-
-    while (count-- > 0){
-        if (detected[count] != configured[count]){
-            return false;
-        }
-    }
-
-    return true;
-}
-
 /*
  * Find a device based on it's location.
  * A device's location is:
@@ -771,42 +706,7 @@ inline bool matchAddress(uint8_t * detected,
  */
 device_slot_t findHardwareDevice(DeviceConfig & find)
 {
-    DeviceConfig config;
-
-    for (device_slot_t slot = 0; deviceManager.allDevices(config, slot); slot++){
-        if (find.deviceHardware == config.deviceHardware){
-            bool match = true;
-
-            switch (find.deviceHardware){
-#if BREWPI_DS2413
-                case DEVICE_HARDWARE_ONEWIRE_2413 :
-                case DEVICE_HARDWARE_ONEWIRE_2408 :
-                    match &= find.hw.offset.pio == config.hw.offset.pio;
-
-                    // fall through
-#endif
-
-                case DEVICE_HARDWARE_ONEWIRE_TEMP :
-                    match &= matchAddress(find.hw.address, config.hw.address, 8);
-
-                // fall through
-                case DEVICE_HARDWARE_PIN :
-                    match &= find.hw.pinNr == config.hw.pinNr;
-                    break;
-                case DEVICE_HARDWARE_NONE:
-                    match = false; // don't return a match for no type
-                    break;
-                default :    // this should not happen - if it does the device will be returned as matching.
-                    break;
-            }
-
-            if (match){
-                return slot;
-            }
-        }
-    }
-
-    return INVALID_SLOT;
+    return deviceRegistry.findHardware(find);
 }
 
 /*
@@ -814,17 +714,7 @@ device_slot_t findHardwareDevice(DeviceConfig & find)
  */
 device_slot_t findDeviceFunction(DeviceConfig & find)
 {
-    DeviceConfig config;
-
-    for (device_slot_t slot = 0; deviceManager.allDevices(config, slot); slot++){
-        if (find.deviceFunction == config.deviceFunction){
-            bool match = true;
-            if (match){
-                return slot;
-            }
-        }
-    }
-    return INVALID_SLOT;
+    return deviceRegistry.findFunction(find.deviceFunction);
 }
 
 inline void DeviceManager::readTempSensorValue(DeviceConfig::Hardware hw,
@@ -922,6 +812,7 @@ void DeviceManager::handleEnumeratedDevice(DeviceConfig & config,
 
     if (h.values){
         // logDebug("Fetching device value");
+        ControlLock lock; // reads from the OneWire bus that the control thread uses
         switch (config.deviceHardware){
             case DEVICE_HARDWARE_ONEWIRE_TEMP :
                 readTempSensorValue(config.hw, info -> value);
@@ -1016,7 +907,15 @@ void DeviceManager::enumerateOneWireDevices(EnumerateHardware & h,
         if (wire != NULL){
             wire -> reset_search();
 
-            while (wire -> search(config.hw.address)){
+            // the lock is only held for each bus transaction, the search continues after the control thread used the bus
+            while (true){
+                {
+                    ControlLock lock;
+                    if (!wire -> search(config.hw.address)){
+                        break;
+                    }
+                }
+
                 // hardware device type from OneWire family ID
                 switch (config.hw.address[0]){
 #if BREWPI_DS2413
@@ -1060,9 +959,14 @@ void DeviceManager::enumerateOneWireDevices(EnumerateHardware & h,
 #if !ONEWIRE_PARASITE_SUPPORT
                     {    // check that device is not parasite powered
                         DallasTemperature sensor(wire);
+                        bool parasite;
+                        {
+                            ControlLock lock;
+                            parasite = sensor.isParasitePowered(config.hw.address);
+                        }
 
                         // initialize sensor without reset detection (faster)
-                        if (!sensor.isParasitePowered(config.hw.address)){
+                        if (!parasite){
                             handleEnumeratedDevice(config, h, callback, info);
                         }
                     }
@@ -1145,7 +1049,7 @@ void DeviceManager::UpdateDeviceState(DeviceDisplay & dd,
         return;
     }
 
-    void ** ppv = deviceTarget(dc);
+    void * ppv = deviceTarget(dc);
 
     if (ppv == NULL && dt != DEVICETYPE_MANUAL_ACTUATOR){ // make an exception for valves, which only exist in the device list
         return;
@@ -1165,26 +1069,26 @@ void DeviceManager::UpdateDeviceState(DeviceDisplay & dd,
         }
         if (dt == DEVICETYPE_SWITCH_ACTUATOR){
             DEBUG_ONLY(logInfoInt(INFO_SETTING_ACTIVATOR_STATE, dd.write != 0));
-            ((ActuatorDigital *) *ppv) -> setActive(dd.write != 0);
+            ((ActuatorDigital *) ppv) -> setActive(dd.write != 0);
         } else if (dt == DEVICETYPE_PWM_ACTUATOR){
             DEBUG_ONLY(logInfoInt(INFO_SETTING_ACTIVATOR_STATE, dd.write));
             temp_t value = temp_t::base_type(dd.write);
-            ((ActuatorPwm *) *ppv) -> setValue(value);
+            ((ActuatorPwm *) ppv) -> setValue(value);
         }
     } else if (dd.value == 1){    // read values
         if (dt == DEVICETYPE_SWITCH_SENSOR){
             sprintf_P(val, STR_FMT_U,
-                      (unsigned int) ((SwitchSensor *) *ppv) -> sense()
+                      (unsigned int) ((SwitchSensor *) ppv) -> sense()
                       != 0);      // cheaper than itoa, because it overlaps with vsnprintf
         } else if (dt == DEVICETYPE_TEMP_SENSOR){
-            TempSensorBasic * s = (TempSensorBasic*) *ppv;
-            s->update();
+            // the control updates its sensors every second, reading the cached value saves a conversion on the bus
+            TempSensor * s = (TempSensor*) ppv;
             temp_t temp = s->read();
             temp.toTempString(val, 3, 9, tempControl.cc.tempFormat, true);
         } else if (dt == DEVICETYPE_SWITCH_ACTUATOR){
-            sprintf_P(val, STR_FMT_U, (unsigned int) ((ActuatorDigital *) *ppv) -> isActive() != 0);
+            sprintf_P(val, STR_FMT_U, (unsigned int) ((ActuatorDigital *) ppv) -> isActive() != 0);
         } else if (dt == DEVICETYPE_PWM_ACTUATOR){
-            ((ActuatorPwm *) *ppv) -> getValue().toString(val,1,6);
+            ((ActuatorPwm *) ppv) -> getValue().toString(val,1,6);
         } else if (dt == DEVICETYPE_MANUAL_ACTUATOR){
             if(dc.deviceHardware == DEVICE_HARDWARE_ONEWIRE_2408){
                 readValve(dc.hw, val);
@@ -1218,7 +1122,10 @@ void DeviceManager::listDevices(Stream & p)
 
             val[0] = 0;
 
-            UpdateDeviceState(dd, dc, val);
+            {
+                ControlLock lock; // changes the control's actuators and reads from the OneWire bus
+                UpdateDeviceState(dd, dc, val);
+            }
             deviceManager.printDevice(idx, dc, val, p);
         }
     }
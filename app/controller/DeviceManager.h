@@ -30,6 +30,7 @@
 #include "Board.h"
 #include "OneWire.h"
 #include "OneWireAddress.h"
+#include "DeviceFunction.h"
 
 /*
  * A user has freedom to connect various devices to the controller, either via extending the oneWire bus,
@@ -54,29 +55,6 @@ inline bool isDefinedSlot(device_slot_t s)
 const device_slot_t MAX_DEVICE_SLOT = 32;		// exclusive
 const device_slot_t INVALID_SLOT = -1;
 
-/*
- * Describes the logical function of each device. 
- */
-enum DeviceFunction
-{
-	DEVICE_NONE = 0,														// used as a sentry to mark end of list
-
-	// chamber devices
-    DEVICE_CHAMBER_DOOR = 1,                                                       // switch sensor
-    DEVICE_CHAMBER_HEAT = 2, DEVICE_CHAMBER_COOL = 3, DEVICE_CHAMBER_LIGHT = 4,    // actuator
-    DEVICE_CHAMBER_TEMP = 5, DEVICE_CHAMBER_ROOM_TEMP = 6,                         // temp sensors
-    DEVICE_CHAMBER_FAN = 7,                                                        // a fan in the chamber
-    DEVICE_CHAMBER_MANUAL_ACTUATOR = 8,                                            // no function, but installed for manual action
-
-	// carboy devices
-    DEVICE_BEER_FIRST = 9, DEVICE_BEER_TEMP = DEVICE_BEER_FIRST,                   // primary beer temp sensor
-    DEVICE_BEER_TEMP2 = 10,                                                        // secondary beer temp sensor
-    DEVICE_BEER_HEAT = 11, DEVICE_BEER_COOL = 12,                                  // individual actuators
-    DEVICE_BEER_SG = 13,                                                           // SG sensor
-    DEVICE_BEER_RESERVED1 = 14, DEVICE_BEER_RESERVED2 = 15,                        // reserved
-    DEVICE_MAX = 16
-};
-
 /*
  * Describes where the device is most closely associated.
  */
@@ -311,7 +289,7 @@ class DeviceManager
         static void disposeDevice(DeviceType dt,
                                   void *     device);
 
-        static void ** deviceTarget(DeviceConfig & config);
+        static void * deviceTarget(DeviceConfig & config);
 
         static void UpdateDeviceState(DeviceDisplay & dd, DeviceConfig & dc, char * val);
 
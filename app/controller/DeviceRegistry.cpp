@@ -0,0 +1,198 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Brewpi.h"
+#include "DeviceRegistry.h"
+#include "EepromManager.h"
+#include <string.h>
+
+DeviceRegistry deviceRegistry;
+
+static_assert(MAX_DEVICE_SLOT <= 8 * sizeof(device_slot_mask_t), "device_slot_mask_t needs a bit for each slot");
+
+static bool isOneWireHardware(DeviceHardware hw)
+{
+    return hw == DEVICE_HARDWARE_ONEWIRE_TEMP
+#if BREWPI_DS2413
+           || hw == DEVICE_HARDWARE_ONEWIRE_2413 || hw == DEVICE_HARDWARE_ONEWIRE_2408
+#endif
+    ;
+}
+
+static int compareAddress(const uint8_t * a, const uint8_t * b)
+{
+    return memcmp(a, b, sizeof(DeviceAddress));
+}
+
+/*
+ * Inserts slot into a list sorted by key. Slots are added in ascending order, so slots with equal keys stay sorted
+ * by slot.
+ */
+template<typename Less>
+static void insertSorted(device_slot_t * list, uint8_t & size, device_slot_t slot, Less less)
+{
+    uint8_t i = size++;
+    for (; i > 0 && less(slot, list[i - 1]); i--){
+        list[i] = list[i - 1];
+    }
+    list[i] = slot;
+}
+
+void DeviceRegistry::load()
+{
+    count = 0;
+    pinCount = 0;
+    addressCount = 0;
+    anyAddress = 0;
+    for (uint8_t f = 0; f < DEVICE_MAX; f++){
+        functionSlots[f] = INVALID_SLOT;
+    }
+
+    while (count < MAX_DEVICE_SLOT && eepromManager.fetchDevice(devices[count], count)){
+        count++;
+    }
+
+    for (device_slot_t slot = 0; slot < count; slot++){
+        const DeviceConfig & config = devices[slot];
+        if (config.deviceFunction < DEVICE_MAX && !isDefinedSlot(functionSlots[config.deviceFunction])){
+            functionSlots[config.deviceFunction] = slot;
+        }
+        if (config.deviceHardware == DEVICE_HARDWARE_NONE){
+            continue;
+        }
+        insertSorted(byPin, pinCount, slot, [this](device_slot_t a, device_slot_t b){
+            return devices[a].hw.pinNr < devices[b].hw.pinNr;
+        });
+        if (isOneWireHardware(config.deviceHardware)){
+            if (config.hw.address[0]){
+                insertSorted(byAddress, addressCount, slot, [this](device_slot_t a, device_slot_t b){
+                    return compareAddress(devices[a].hw.address, devices[b].hw.address) < 0;
+                });
+            }
+            else {
+                anyAddress |= device_slot_mask_t(1) << slot;
+            }
+        }
+    }
+    loaded = true;
+}
+
+bool DeviceRegistry::fetch(DeviceConfig & config, device_slot_t slot)
+{
+    ensureLoaded();
+    if (slot < 0 || slot >= count){
+        return false;
+    }
+    memcpy(&config, &devices[slot], sizeof(DeviceConfig));
+    return true;
+}
+
+device_slot_mask_t DeviceRegistry::slotsWithPin(uint8_t pinNr) const
+{
+    // binary search for the first slot with the pin
+    uint8_t low = 0;
+    uint8_t high = pinCount;
+    while (low < high){
+        uint8_t mid = (low + high) / 2;
+        if (devices[byPin[mid]].hw.pinNr < pinNr){
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    device_slot_mask_t slots = 0;
+    for (; low < pinCount && devices[byPin[low]].hw.pinNr == pinNr; low++){
+        slots |= device_slot_mask_t(1) << byPin[low];
+    }
+    return slots;
+}
+
+device_slot_mask_t DeviceRegistry::slotsWithAddress(const uint8_t * address) const
+{
+    uint8_t low = 0;
+    uint8_t high = addressCount;
+    while (low < high){
+        uint8_t mid = (low + high) / 2;
+        if (compareAddress(devices[byAddress[mid]].hw.address, address) < 0){
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    device_slot_mask_t slots = 0;
+    for (; low < addressCount && compareAddress(devices[byAddress[low]].hw.address, address) == 0; low++){
+        slots |= device_slot_mask_t(1) << byAddress[low];
+    }
+    return slots;
+}
+
+/*
+ * The candidates from the pin and address indexes are checked for the remaining fields.
+ */
+bool DeviceRegistry::matchesLocation(const DeviceConfig & find, device_slot_t slot) const
+{
+    const DeviceConfig & config = devices[slot];
+    if (config.deviceHardware != find.deviceHardware){
+        return false;
+    }
+#if BREWPI_DS2413
+    if (find.deviceHardware == DEVICE_HARDWARE_ONEWIRE_2413 || find.deviceHardware == DEVICE_HARDWARE_ONEWIRE_2408){
+        return find.hw.offset.pio == config.hw.offset.pio;
+    }
+#endif
+    return true;
+}
+
+device_slot_t DeviceRegistry::findHardware(const DeviceConfig & find)
+{
+    ensureLoaded();
+
+    device_slot_mask_t candidates;
+    if (find.deviceHardware == DEVICE_HARDWARE_NONE){
+        return INVALID_SLOT; // don't return a match for no type
+    }
+    else if (find.deviceHardware == DEVICE_HARDWARE_PIN){
+        candidates = slotsWithPin(find.hw.pinNr);
+    }
+    else if (isOneWireHardware(find.deviceHardware)){
+        candidates = (slotsWithAddress(find.hw.address) | anyAddress) & slotsWithPin(find.hw.pinNr);
+    }
+    else {
+        // unknown hardware type, matched on the type only
+        candidates = 0;
+        for (device_slot_t slot = 0; slot < count; slot++){
+            candidates |= device_slot_mask_t(1) << slot;
+        }
+    }
+
+    for (device_slot_t slot = 0; candidates; slot++, candidates >>= 1){
+        if ((candidates & 1) && matchesLocation(find, slot)){
+            return slot;
+        }
+    }
+    return INVALID_SLOT;
+}
+
+device_slot_t DeviceRegistry::findFunction(DeviceFunction function)
+{
+    ensureLoaded();
+    return function < DEVICE_MAX ? functionSlots[function] : INVALID_SLOT;
+}
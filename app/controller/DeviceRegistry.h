@@ -0,0 +1,86 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "DeviceManager.h"
+
+typedef uint32_t device_slot_mask_t;    // one bit per slot
+
+/*
+ * RAM copy of the device definitions in eeprom, so device queries do not read eeprom for each slot.
+ * The copy is loaded on first use and invalidated when device definitions in eeprom are written.
+ * Slots are indexed by function, by pin and by OneWire address. The lookups give the same slot as a linear scan:
+ * the lowest slot that matches.
+ */
+class DeviceRegistry
+{
+    public:
+        DeviceRegistry() : count(0), loaded(false) {}
+
+        /*
+         * Copies the definition in a slot to config.
+         * @return false when the slot is out of range or eeprom has no settings
+         */
+        bool fetch(DeviceConfig & config, device_slot_t slot);
+
+        /*
+         * Find a device based on its location: pin, OneWire address and pio.
+         * A OneWire device configured without address matches any address.
+         */
+        device_slot_t findHardware(const DeviceConfig & find);
+
+        /*
+         * Find a device based on its function.
+         */
+        device_slot_t findFunction(DeviceFunction function);
+
+        /*
+         * Discards the RAM copy, call this after writing device definitions to eeprom.
+         */
+        void invalidate()
+        {
+            loaded = false;
+        }
+
+    private:
+        void load();
+        void ensureLoaded()
+        {
+            if (!loaded){
+                load();
+            }
+        }
+
+        device_slot_mask_t slotsWithPin(uint8_t pinNr) const;
+        device_slot_mask_t slotsWithAddress(const uint8_t * address) const;
+        bool matchesLocation(const DeviceConfig & find, device_slot_t slot) const;
+
+        DeviceConfig devices[MAX_DEVICE_SLOT];
+        device_slot_t functionSlots[DEVICE_MAX];    // first slot with each function
+        device_slot_t byPin[MAX_DEVICE_SLOT];       // slots with hardware, sorted by pin
+        uint8_t pinCount;
+        device_slot_t byAddress[MAX_DEVICE_SLOT];   // OneWire slots with an address, sorted by address
+        uint8_t addressCount;
+        device_slot_mask_t anyAddress;              // OneWire slots without an address
+        device_slot_t count;                        // number of slots in eeprom, 0 when eeprom has no settings
+        bool loaded;
+};
+
+extern DeviceRegistry deviceRegistry;
@@ -61,7 +61,7 @@ void LcdDisplay::init(void){
 void LcdDisplay::printAllTemperatures(void){
 	// alternate between beer and room temp
 	if (flags & LCD_FLAG_ALTERNATE_ROOM) {
-		bool displayRoom = ((ticks.seconds()&0x08)==0) && !tempControl.getRoomTemp().isDisabledOrInvalid();
+		bool displayRoom = ((ticks.seconds()&0x08)==0) && !tempControl.snapshot().roomTemp.isDisabledOrInvalid();
 		if (displayRoom ^ ((flags & LCD_FLAG_DISPLAY_ROOM)!=0)) {	// transition
 			flags = displayRoom ? flags | LCD_FLAG_DISPLAY_ROOM : flags & ~LCD_FLAG_DISPLAY_ROOM;
 			printStationaryText();
@@ -83,22 +83,22 @@ void LcdDisplay::setDisplayFlags(uint8_t newFlags) {
 
 
 void LcdDisplay::printBeerTemp(void){
-	printTemperatureAt(6, 1, tempControl.getBeerTemp());
+	printTemperatureAt(6, 1, tempControl.snapshot().beerTemp);
 }
 
 void LcdDisplay::printBeerSet(void){
-	temp_t beerSet = tempControl.getBeerSetting();
+	temp_t beerSet = tempControl.snapshot().beerSetting;
 	printTemperatureAt(12, 1, beerSet);	
 }
 
 void LcdDisplay::printFridgeTemp(void){	
 	printTemperatureAt(6,2, flags & LCD_FLAG_DISPLAY_ROOM ?
-		tempControl.getRoomTemp() :
-		tempControl.getFridgeTemp());
+		tempControl.snapshot().roomTemp :
+		tempControl.snapshot().fridgeTemp);
 }
 
 void LcdDisplay::printFridgeSet(void){	
-	temp_t fridgeSet = tempControl.getFridgeSetting();
+	temp_t fridgeSet = tempControl.snapshot().fridgeSetting;
 	if(flags & LCD_FLAG_DISPLAY_ROOM) // beer setting is not active
 		fridgeSet = temp_t::disabled();
 	printTemperatureAt(12, 2, fridgeSet);	
@@ -180,7 +180,7 @@ void LcdDisplay::printMode(void){
 // print the current state on the last line of the lcd
 void LcdDisplay::printState(void){
 	uint16_t time = UINT16_MAX; // init to max
-	uint8_t state = tempControl.getState();
+	uint8_t state = tempControl.snapshot().state;
 	if(state != stateOnDisplay){ //only print static text when state has changed
 		stateOnDisplay = state;
 		// Reprint state and clear rest of the line
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "Brewpi.h"
+#include <stddef.h>
 #include "DeviceManager.h"
 #include "TempControl.h"
 
@@ -28,10 +29,14 @@
 
 struct ChamberSettings
 {
-	ControlConstants cc;
-	uint8_t reserved[1];	// was 3, but added pidMax
+	ControlConstants cc;	// the reserved byte and the padding after it now hold the power budget and actuator loads
 };
 
+// The power budget and actuator loads are in the space of the reserved byte and the padding of rev 8, which were
+// cleared when the eeprom was initialized. They read as 0 from older rev 8 images: no budget and no loads.
+static_assert(sizeof(ChamberSettings) == (offsetof(ControlConstants, powerBudget) + 1 + alignof(ControlConstants) - 1)
+		/ alignof(ControlConstants) * alignof(ControlConstants), "chamber settings must keep the size of rev 8");
+
 struct BeerBlock {
 	ControlSettings cs;
 	uint8_t reserved[2];
@@ -93,4 +98,7 @@ void eepromSizeCheck() {
  * rev 4: added padding at start and reduced device count to 16. We can always increase later.
  * rev 5: PWM actuators alpha/temporary release. Changes in control constants, control variables. Removed peak detection and added PWM settings.
  * rev 6: Entirely new control structure, new temp format, new actuator classes, etc (2-11-2015)
+ * rev 7: not recorded
+ * rev 8: not recorded. Later the power budget and actuator loads were added to the control constants, in the reserved
+ *        byte and padding after them. Existing images read as no budget, so the version was kept.
  */
@@ -25,12 +25,19 @@
 #include "TempControl.h"
 #include "EepromFormat.h"
 #include "PiLink.h"
+#include "DeviceRegistry.h"
+#include "Profiling.h"
+#include "ControlLock.h"
 
 EepromManager eepromManager;
 EepromAccess eepromAccess;
 
 #define pointerOffset(x) offsetof(EepromFormat, x)
 
+uint8_t EepromManager::batchDepth = 0;
+bool EepromManager::constantsDirty = false;
+bool EepromManager::settingsDirty = false;
+
 EepromManager::EepromManager()
 {
     eepromSizeCheck();
@@ -49,8 +56,12 @@ bool EepromManager::hasSettings()
 
 void EepromManager::zapEeprom()
 {
-	for (uint16_t offset=0; offset<EepromFormat::MAX_EEPROM_SIZE; offset++)
-		eepromAccess.writeByte(offset, 0);
+	// write in blocks, so each stored object is updated once per block instead of once per byte
+	uint8_t zeros[32];
+	clear(zeros, sizeof(zeros));
+	for (uint16_t offset=0; offset<EepromFormat::MAX_EEPROM_SIZE; offset+=sizeof(zeros))
+		eepromAccess.writeBlock(offset, zeros, sizeof(zeros));
+	deviceRegistry.invalidate();
 }
 
 
@@ -79,6 +90,7 @@ void EepromManager::initializeEeprom()
 
     // set the version flag - so that storeDevice will work
     eepromAccess.writeByte(0, EEPROM_FORMAT_VERSION);
+    deviceRegistry.invalidate();
 
     saveDefaultDevices();
 }
@@ -98,7 +110,34 @@ bool EepromManager::applySettings()
 		
 	logDebug("Applying settings");
 
-	// load the one chamber and one beer for now
+	// build a chamber for each chamber that has devices, with as many beers as its devices use.
+	// Settings, TempControl and PiLink only exist for the chambers in eeprom, so devices of other chambers are skipped.
+	static_assert(EepromFormat::MAX_CHAMBERS <= CONTROL_MAX_CHAMBERS, "chambers in eeprom must fit in Control");
+	uint8_t numChambers = 1;
+	uint8_t numBeers[CONTROL_MAX_CHAMBERS];
+	clear(numBeers, sizeof(numBeers));
+	DeviceConfig deviceConfig;
+	for (uint8_t index = 0; fetchDevice(deviceConfig, index); index++)
+	{
+		uint8_t chamber = deviceConfig.chamber;
+		if (chamber == 0 || chamber > EepromFormat::MAX_CHAMBERS || deviceConfig.deviceFunction == DEVICE_NONE)
+			continue;
+		if (chamber > numChambers)
+			numChambers = chamber;
+		// chamber devices, like the room sensor, are not installed in a beer, see Control::deviceTarget
+		uint8_t beer = deviceConfig.beer;
+		if (deviceOwner(DeviceFunction(deviceConfig.deviceFunction)) == DEVICE_OWNER_BEER && beer > numBeers[chamber-1])
+			numBeers[chamber-1] = beer;
+	}
+	bool built;
+	{
+		ControlLock lock; // the control thread walks the objects that are rebuilt
+		built = control.build(numChambers, numBeers);
+	}
+	if (!built)
+		logErrorInt(ERROR_INVALID_CHAMBER, control.numChambers() + 1);
+
+	// settings are stored for one chamber and one beer for now
 	eptr_t pv = pointerOffset(chambers);
 	tempControl.loadConstants(pv+offsetof(ChamberBlock, chamberSettings.cc));	
 	tempControl.loadSettings(pv+offsetof(ChamberBlock, beer[0].cs));
@@ -106,7 +145,6 @@ bool EepromManager::applySettings()
 	logDebug("Applied settings");
 	
 	
-	DeviceConfig deviceConfig;
 	for (uint8_t index = 0; fetchDevice(deviceConfig, index); index++)
 	{	
 		if (deviceManager.isDeviceValid(deviceConfig, deviceConfig, index))
@@ -121,21 +159,71 @@ bool EepromManager::applySettings()
 
 void EepromManager::storeTempConstantsAndSettings()
 {
-	uint8_t chamber = 0;
-	eptr_t pv = pointerOffset(chambers);
-	pv += sizeof(ChamberBlock)*chamber;
-	tempControl.storeConstants(pv+offsetof(ChamberBlock, chamberSettings.cc));
-		
+	constantsDirty = true;
 	storeTempSettings();
 }
 
 void EepromManager::storeTempSettings()
+{
+	settingsDirty = true;
+	if (!batchDepth)
+		commit();
+}
+
+void EepromManager::beginBatch()
+{
+	batchDepth++;
+}
+
+void EepromManager::endBatch()
+{
+	if (batchDepth && --batchDepth==0)
+		commit();
+}
+
+void EepromManager::commit()
 {
 	uint8_t chamber = 0;
 	eptr_t pv = pointerOffset(chambers);
 	pv += sizeof(ChamberBlock)*chamber;
+	if (constantsDirty)
+		tempControl.storeConstants(pv+offsetof(ChamberBlock, chamberSettings.cc));
 	// for now assume just one beer. 
-	tempControl.storeSettings(pv+offsetof(ChamberBlock, beer[0].cs));	
+	if (settingsDirty)
+		tempControl.storeSettings(pv+offsetof(ChamberBlock, beer[0].cs));
+	constantsDirty = false;
+	settingsDirty = false;
+}
+
+PROFILE_SECTION(eepromWrites, "eeprom")
+
+void EepromManager::writeChanged(eptr_t target, const void* source, uint16_t size)
+{
+	PROFILE_SCOPE(eepromWrites)
+	const uint8_t* data = (const uint8_t*) source;
+	uint8_t stored[16];
+	uint16_t runStart = 0;
+	bool inRun = false;
+	for (uint16_t chunkStart=0; chunkStart<size; chunkStart+=sizeof(stored)) {
+		uint16_t chunkSize = size-chunkStart;
+		if (chunkSize > sizeof(stored))
+			chunkSize = sizeof(stored);
+		eepromAccess.readBlock(stored, target+chunkStart, chunkSize);
+		for (uint16_t i=0; i<chunkSize; i++) {
+			uint16_t index = chunkStart+i;
+			bool changed = stored[i]!=data[index];
+			if (changed && !inRun) {
+				runStart = index;
+				inRun = true;
+			}
+			else if (!changed && inRun) {
+				eepromAccess.writeBlock(target+runStart, data+runStart, index-runStart);
+				inRun = false;
+			}
+		}
+	}
+	if (inRun)
+		eepromAccess.writeBlock(target+runStart, data+runStart, size-runStart);
 }
 
 bool EepromManager::fetchDevice(DeviceConfig& config, uint8_t deviceIndex)
@@ -149,8 +237,10 @@ bool EepromManager::fetchDevice(DeviceConfig& config, uint8_t deviceIndex)
 bool EepromManager::storeDevice(const DeviceConfig& config, uint8_t deviceIndex)
 {
 	bool ok = (hasSettings() && deviceIndex<EepromFormat::MAX_DEVICES);
-	if (ok)
-		eepromAccess.writeBlock(pointerOffset(devices)+sizeof(DeviceConfig)*deviceIndex, &config, sizeof(DeviceConfig));	
+	if (ok) {
+		writeChanged(pointerOffset(devices)+sizeof(DeviceConfig)*deviceIndex, &config, sizeof(DeviceConfig));
+		deviceRegistry.invalidate();
+	}
 	return ok;
 }
 
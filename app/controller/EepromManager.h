@@ -32,7 +32,11 @@ void clear(uint8_t* p, uint8_t size);
 class DeviceConfig;
 
 
-// todo - the Eeprom manager should avoid too frequent saves to the eeprom since it supports 100,000 writes. 
+/*
+ * The Eeprom manager avoids unnecessary writes, because the eeprom (or the flash emulating it) wears out.
+ * Only bytes that differ from the stored image are written, and stores requested within a batch are deferred and
+ * committed once when the batch ends.
+ */
 class EepromManager {
 public:		
 		
@@ -76,10 +80,37 @@ public:
 	 */
 	static void storeTempSettings();
 
+	/**
+	 * Start deferring stores of the constants and settings. Batches can be nested, the changes are committed when
+	 * the outermost batch ends.
+	 */
+	static void beginBatch();
+
+	/**
+	 * End a batch started with beginBatch() and commit the deferred stores.
+	 */
+	static void endBatch();
+
+	/**
+	 * Write the constants and settings that have changed since the last commit to eeprom.
+	 */
+	static void commit();
+
+	/**
+	 * Write a block to eeprom, but only the bytes that differ from what is already stored.
+	 * Each run of changed bytes is written as a single block.
+	 */
+	static void writeChanged(eptr_t target, const void* source, uint16_t size);
+
 	static bool fetchDevice(DeviceConfig& config, uint8_t deviceIndex);
 	static bool storeDevice(const DeviceConfig& config, uint8_t deviceIndex);
 	
 	static uint8_t saveDefaultDevices();
+
+private:
+	static uint8_t batchDepth;
+	static bool constantsDirty;
+	static bool settingsDirty;
 };
 
 class EepromStream 
@@ -26,45 +26,49 @@
 #endif
 
 // settings
-static const char JSONKEY_mode[] PROGMEM = "mode";
-static const char JSONKEY_beerSetting[] PROGMEM = "beerSet";
-static const char JSONKEY_fridgeSetting[] PROGMEM = "fridgeSet";
+static constexpr char JSONKEY_mode[] PROGMEM = "mode";
+static constexpr char JSONKEY_beerSetting[] PROGMEM = "beerSet";
+static constexpr char JSONKEY_fridgeSetting[] PROGMEM = "fridgeSet";
 
 // constant;
-static const char JSONKEY_tempFormat[] PROGMEM = "tempFormat";
+static constexpr char JSONKEY_tempFormat[] PROGMEM = "tempFormat";
 
-static const char JSONKEY_heater1_kp[] PROGMEM = "heater1_kp";
-static const char JSONKEY_heater1_ti[] PROGMEM = "heater1_ti";
-static const char JSONKEY_heater1_td[] PROGMEM = "heater1_td";
-static const char JSONKEY_heater1_infilt[] PROGMEM = "heater1_infilt";
-static const char JSONKEY_heater1_dfilt[] PROGMEM = "heater1_dfilt";
+static constexpr char JSONKEY_heater1_kp[] PROGMEM = "heater1_kp";
+static constexpr char JSONKEY_heater1_ti[] PROGMEM = "heater1_ti";
+static constexpr char JSONKEY_heater1_td[] PROGMEM = "heater1_td";
+static constexpr char JSONKEY_heater1_infilt[] PROGMEM = "heater1_infilt";
+static constexpr char JSONKEY_heater1_dfilt[] PROGMEM = "heater1_dfilt";
 
-static const char JSONKEY_heater2_kp[] PROGMEM = "heater2_kp";
-static const char JSONKEY_heater2_ti[] PROGMEM = "heater2_ti";
-static const char JSONKEY_heater2_td[] PROGMEM = "heater2_td";
-static const char JSONKEY_heater2_infilt[] PROGMEM = "heater2_infilt";
-static const char JSONKEY_heater2_dfilt[] PROGMEM = "heater2_dfilt";
+static constexpr char JSONKEY_heater2_kp[] PROGMEM = "heater2_kp";
+static constexpr char JSONKEY_heater2_ti[] PROGMEM = "heater2_ti";
+static constexpr char JSONKEY_heater2_td[] PROGMEM = "heater2_td";
+static constexpr char JSONKEY_heater2_infilt[] PROGMEM = "heater2_infilt";
+static constexpr char JSONKEY_heater2_dfilt[] PROGMEM = "heater2_dfilt";
 
-static const char JSONKEY_cooler_kp[] PROGMEM = "cooler_kp";
-static const char JSONKEY_cooler_ti[] PROGMEM = "cooler_ti";
-static const char JSONKEY_cooler_td[] PROGMEM = "cooler_td";
-static const char JSONKEY_cooler_infilt[] PROGMEM = "cooler_infilt";
-static const char JSONKEY_cooler_dfilt[] PROGMEM = "cooler_dfilt";
+static constexpr char JSONKEY_cooler_kp[] PROGMEM = "cooler_kp";
+static constexpr char JSONKEY_cooler_ti[] PROGMEM = "cooler_ti";
+static constexpr char JSONKEY_cooler_td[] PROGMEM = "cooler_td";
+static constexpr char JSONKEY_cooler_infilt[] PROGMEM = "cooler_infilt";
+static constexpr char JSONKEY_cooler_dfilt[] PROGMEM = "cooler_dfilt";
 
-static const char JSONKEY_beer2fridge_kp[] PROGMEM = "beer2fridge_kp";
-static const char JSONKEY_beer2fridge_ti[] PROGMEM = "beer2fridge_ti";
-static const char JSONKEY_beer2fridge_td[] PROGMEM = "beer2fridge_td";
-static const char JSONKEY_beer2fridge_infilt[] PROGMEM = "beer2fridge_infilt";
-static const char JSONKEY_beer2fridge_dfilt[] PROGMEM = "beer2fridge_dfilt";
-static const char JSONKEY_beer2fridge_pidMax[] PROGMEM = "beer2fridge_pidMax";
+static constexpr char JSONKEY_beer2fridge_kp[] PROGMEM = "beer2fridge_kp";
+static constexpr char JSONKEY_beer2fridge_ti[] PROGMEM = "beer2fridge_ti";
+static constexpr char JSONKEY_beer2fridge_td[] PROGMEM = "beer2fridge_td";
+static constexpr char JSONKEY_beer2fridge_infilt[] PROGMEM = "beer2fridge_infilt";
+static constexpr char JSONKEY_beer2fridge_dfilt[] PROGMEM = "beer2fridge_dfilt";
+static constexpr char JSONKEY_beer2fridge_pidMax[] PROGMEM = "beer2fridge_pidMax";
 
-static const char JSONKEY_minCoolTime[] PROGMEM = "minCoolTime";
-static const char JSONKEY_minCoolIdleTime[] PROGMEM = "minCoolIdleTime";
-static const char JSONKEY_heater1PwmPeriod[] PROGMEM = "heater1PwmPeriod";
-static const char JSONKEY_heater2PwmPeriod[] PROGMEM = "heater2PwmPeriod";
-static const char JSONKEY_coolerPwmPeriod[] PROGMEM = "coolerPwmPeriod";
+static constexpr char JSONKEY_minCoolTime[] PROGMEM = "minCoolTime";
+static constexpr char JSONKEY_minCoolIdleTime[] PROGMEM = "minCoolIdleTime";
+static constexpr char JSONKEY_heater1PwmPeriod[] PROGMEM = "heater1PwmPeriod";
+static constexpr char JSONKEY_heater2PwmPeriod[] PROGMEM = "heater2PwmPeriod";
+static constexpr char JSONKEY_coolerPwmPeriod[] PROGMEM = "coolerPwmPeriod";
 
-static const char JSONKEY_mutexDeadTime[] PROGMEM = "deadTime";
+static constexpr char JSONKEY_mutexDeadTime[] PROGMEM = "deadTime";
+static constexpr char JSONKEY_powerBudget[] PROGMEM = "powerBudget";
+static constexpr char JSONKEY_heater1Load[] PROGMEM = "heater1Load";
+static constexpr char JSONKEY_heater2Load[] PROGMEM = "heater2Load";
+static constexpr char JSONKEY_coolerLoad[] PROGMEM = "coolerLoad";
 
-static const char JSONKEY_logType[] PROGMEM = "logType";
-static const char JSONKEY_logID[] PROGMEM = "logID";
+static constexpr char JSONKEY_logType[] PROGMEM = "logType";
+static constexpr char JSONKEY_logID[] PROGMEM = "logID";
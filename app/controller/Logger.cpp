@@ -24,37 +24,127 @@
 #include "Logger.h"
 #include "PiLink.h"
 #include "JsonKeys.h"
+#include "ControlLock.h"
 
 static const char PROGMEM LOG_STRING_FORMAT[] = "\"%s\"";
 
-void Logger::logMessageVaArg(char type, LOG_ID_TYPE errorID, const char * varTypes, ...){
+#define LOG_VALUES_SIZE 64
+#define LOG_QUEUE_SIZE 4
+
+struct QueuedLogMessage {
+	char type;
+	LOG_ID_TYPE errorID;
+	char values[LOG_VALUES_SIZE];
+};
+
+// messages logged from the control thread, sent by the main loop so they are not written in the middle of other output
+static QueuedLogMessage logQueue[LOG_QUEUE_SIZE];
+static uint8_t logQueueFirst = 0;
+static uint8_t logQueueCount = 0;
+static uint16_t logQueueDropped = 0;
+
+// appends a value to the comma separated list, a value that does not fit is left out
+static uint8_t appendValue(char * values, uint8_t pos, const char * fmt, ...){
 	va_list args;
+	char * dest = values + pos;
+	uint8_t size = LOG_VALUES_SIZE - pos;
+	if(pos > 0){
+		if(size < 2){
+			return pos;
+		}
+		*dest++ = ',';
+		size--;
+	}
+	va_start (args, fmt);
+	int len = vsnprintf_P(dest, size, fmt, args);
+	va_end (args);
+	if(len < 0 || len >= size){
+		values[pos] = 0;
+		return pos;
+	}
+	return (dest - values) + len;
+}
+
+void Logger::sendMessage(char type, LOG_ID_TYPE errorID, const char * values){
 	piLink.printResponse('D');
 	piLink.sendJsonPair(JSONKEY_logType, type);
 	piLink.sendJsonPair(JSONKEY_logID, errorID);
 	piLink.print_P(PSTR(",\"V\":["));
+	piLink.print_P(PSTR("%s"), values);
+	piLink.print(']');
+	piLink.sendJsonClose();
+}
+
+void Logger::logMessageVaArg(char type, LOG_ID_TYPE errorID, const char * varTypes, ...){
+	va_list args;
 	va_start (args, varTypes);
 	uint8_t index = 0;
+	uint8_t pos = 0;
+	char values[LOG_VALUES_SIZE];
 	char buf[9];
+	values[0] = 0;
 	while(varTypes[index]){
 		switch(varTypes[index]){	
 			case 'd': // integer, signed or unsigned
-				piLink.print_P(STR_FMT_D, va_arg(args, int));
+				pos = appendValue(values, pos, STR_FMT_D, va_arg(args, int));
 				break;
 			case 's': // string
-				piLink.print_P(LOG_STRING_FORMAT, va_arg(args, char*));
+				pos = appendValue(values, pos, LOG_STRING_FORMAT, va_arg(args, char*));
 				break;
 			case 't': // temperature in fixed point format
-				piLink.print_P(LOG_STRING_FORMAT, (*(temp_t *) va_arg(args,void*)).toString(buf, 3, 12));
+				pos = appendValue(values, pos, LOG_STRING_FORMAT, (*(temp_t *) va_arg(args,void*)).toString(buf, 3, 12));
 			break;			
 		}
-		if(varTypes[++index]){
-			piLink.print(',');
-		}
+		index++;
 	}
 	va_end (args);
-	piLink.print(']');
-	piLink.sendJsonClose();
+	if(ControlLock::inControlThread()){
+		queueMessage(type, errorID, values);
+		return;
+	}
+	sendMessage(type, errorID, values);
+}
+
+void Logger::queueMessage(char type, LOG_ID_TYPE errorID, const char * values){
+	ControlLock lock;
+	if(logQueueCount == LOG_QUEUE_SIZE){
+		logQueueDropped++;
+		return;
+	}
+	QueuedLogMessage & message = logQueue[(logQueueFirst + logQueueCount) % LOG_QUEUE_SIZE];
+	message.type = type;
+	message.errorID = errorID;
+	strncpy(message.values, values, LOG_VALUES_SIZE - 1);
+	message.values[LOG_VALUES_SIZE - 1] = 0;
+	logQueueCount++;
+}
+
+void Logger::sendQueued(){
+	QueuedLogMessage message;
+	uint16_t dropped = 0;
+	while(true){
+		{
+			// only copying the message needs the lock, sending it can take long
+			ControlLock lock;
+			if(logQueueCount == 0){
+				dropped = logQueueDropped;
+				logQueueDropped = 0;
+				break;
+			}
+			message = logQueue[logQueueFirst];
+			logQueueFirst = (logQueueFirst + 1) % LOG_QUEUE_SIZE;
+			logQueueCount--;
+		}
+		if(message.type){
+			sendMessage(message.type, message.errorID, message.values);
+		}
+		else{
+			piLink.debugMessage(PSTR("%s"), message.values);
+		}
+	}
+	if(dropped){
+		piLink.debugMessage(PSTR("%u log messages from the control thread dropped"), dropped);
+	}
 }
 
 Logger logger;
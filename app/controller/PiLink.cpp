@@ -20,6 +20,7 @@
 
 #include "Brewpi.h"
 #include <stdarg.h>
+#include <stdlib.h>
 
 #include "stddef.h"
 #include "PiLink.h"
@@ -40,11 +41,21 @@
 #include "ActuatorMocks.h"
 #include "Control.h"
 #include "json_writer.h"
+#include "json_stream_writer.h"
+#include "PerfectHash.h"
+#include "BlockPool.h"
+#include "TaskScheduler.h"
+#include "ActuatorPwm.h"
+#include "DataLog.h"
+#include "ControlLock.h"
 
 #if BREWPI_SIMULATE
 #include "Simulator.h"
 #endif
 
+extern TaskScheduler controlScheduler; // runs the control tasks, defined in Brewpi.cpp
+extern TaskScheduler taskScheduler; // runs the main loop, defined in Brewpi.cpp
+
 // Rename Serial to piStream, to abstract it for later platform independence
 
 #if BREWPI_EMULATE
@@ -78,8 +89,41 @@
 #endif        
 #endif
 
+// writes telemetry frames to the serial port
+class PiStreamTelemetrySink final : public TelemetrySink {
+public:
+	PiStreamTelemetrySink() = default;
+	~PiStreamTelemetrySink() = default;
+
+	void write(const uint8_t * data, uint16_t length) override final {
+		piStream.write(data, length);
+	}
+};
+
+static PiStreamTelemetrySink telemetrySink;
+
+#if BREWPI_DATA_LOG
+// a data log request that is parsed or sent across multiple calls to receive()
+struct DataLogTransfer {
+	uint32_t start;		// sequence number requested with "s", the next block to send once sending
+	uint16_t interval;	// interval requested with "i", 0 to keep it
+	uint8_t sent;
+	bool sending;
+};
+
+static DataLogTransfer dataLogTransfer;
+#endif
+
 bool PiLink::firstPair;
 char PiLink::printfBuff[PRINTF_BUFFER_SIZE];
+JsonTokenizer PiLink::jsonTokenizer;
+ticks_millis_t PiLink::jsonLastInput;
+void (*PiLink::jsonComplete)(void);
+bool PiLink::binaryTelemetry = false;
+TelemetryWriter PiLink::telemetry(telemetrySink);
+
+// time without input after which a JSON object is considered complete
+#define JSON_INPUT_TIMEOUT 1000
                 
 void PiLink::init(void){
 	piStream.begin(57600);	
@@ -119,7 +163,21 @@ void printNibble(uint8_t n)
 }
 
 void PiLink::receive(void){
-	while (piStream.available() > 0) {
+	while (piStream.available() > 0 || jsonTokenizer.busy() || dataLogBusy()) {
+#if BREWPI_DATA_LOG
+		if(dataLogTransfer.sending){
+			if(!continueDataLog()){
+				return; // send the next blocks on the next call, later commands wait so the responses stay in order
+			}
+			continue;
+		}
+#endif
+		if(jsonTokenizer.busy()){
+			if(!continueReceiveJson()){
+				return; // wait for more input on the next call from the main loop
+			}
+			continue;
+		}
 		char inByte = piStream.read();              
 		switch(inByte){
 		case ' ':
@@ -145,6 +203,17 @@ void PiLink::receive(void){
 		case 't': // temperatures requested
 			printTemperatures();      
 			break;		
+		case 'B': // enable binary telemetry, sending it again requests a keyframe, for example after a lost frame
+			setBinaryTelemetry(true);
+			break;
+		case 'b': // disable binary telemetry
+			setBinaryTelemetry(false);
+			break;
+#if BREWPI_DATA_LOG
+		case 'g': // blocks of the data log requested
+			receiveDataLogRequest();
+			break;
+#endif
 		case 'C': // Set default constants
 			tempControl.loadDefaultConstants();
 			display.printStationaryText(); // reprint stationary text to update to right degree unit
@@ -245,6 +314,26 @@ void PiLink::receive(void){
 			closeListResponse();
 			break;
 
+		case 'm': // memory usage of the heap and the device pools
+			sendMemoryStatistics();
+			break;
+
+#if BREWPI_PROFILING
+		case 'p': // profile of the main loop
+			sendProfile();
+			break;
+
+		case 'P': // reset profile
+			{
+				ControlLock lock; // the control thread updates these statistics
+				controlScheduler.resetStatistics();
+				ProfileSection::resetAll();
+				ActuatorPwm::resetMissedEdges();
+			}
+			taskScheduler.resetStatistics();
+			break;
+#endif
+
 #if (BREWPI_DEBUG > 0)			
 		case 'Z': // zap eeprom
 			eepromManager.zapEeprom();
@@ -307,35 +396,37 @@ void PiLink::receive(void){
 void PiLink::printTemperaturesJSON(char * beerAnnotation, char * fridgeAnnotation){
 	printResponse('T');	
 
+	// read the state published by the control task, it can update while this is printed
+	ControlSnapshot snapshot = tempControl.snapshot();
 	temp_t t;
-	t = tempControl.getBeerTemp();
+	t = snapshot.beerTemp;
 	if (changed(beerTemp, t))
 		sendJsonTemp(PSTR(JSON_BEER_TEMP), t);
 	
-	t = tempControl.getBeerSetting();
+	t = snapshot.beerSetting;
 	if (changed(beerSet,t))
 		sendJsonTemp(PSTR(JSON_BEER_SET), t);
 		
 	if (changed(beerAnn, beerAnnotation))
 		sendJsonAnnotation(PSTR(JSON_BEER_ANN), beerAnnotation);
 
-	t = tempControl.getFridgeTemp();
+	t = snapshot.fridgeTemp;
 	if (changed(fridgeTemp, t))
 		sendJsonTemp(PSTR(JSON_FRIDGE_TEMP), t);
 
-	t = tempControl.getFridgeSetting();
+	t = snapshot.fridgeSetting;
 	if (changed(fridgeSet, t))
 		sendJsonTemp(PSTR(JSON_FRIDGE_SET), t);
 	
 	if (changed(fridgeAnn, fridgeAnnotation))
 		sendJsonAnnotation(PSTR(JSON_FRIDGE_ANN), fridgeAnnotation);
 		
-	t = tempControl.getRoomTemp();
+	t = snapshot.roomTemp;
 	if (changed(roomTemp, t))
-		sendJsonTemp(PSTR(JSON_ROOM_TEMP), tempControl.getRoomTemp());
+		sendJsonTemp(PSTR(JSON_ROOM_TEMP), snapshot.roomTemp);
 		
-	if (changed(state, tempControl.getState()))
-		sendJsonPair(PSTR(JSON_STATE), (uint8_t)tempControl.getState());		
+	if (changed(state, snapshot.state))
+		sendJsonPair(PSTR(JSON_STATE), snapshot.state);		
 
 #if BREWPI_SIMULATE	
 	printJsonName(PSTR(JSON_TIME));
@@ -344,6 +435,127 @@ void PiLink::printTemperaturesJSON(char * beerAnnotation, char * fridgeAnnotatio
 	sendJsonClose();	
 }
 
+/*
+ * Binary telemetry is an alternative to the temperatures sent as JSON for clients that ask for it with 'B'.
+ * Each second, the values that changed are sent as raw fixed point values in a COBS framed record, see Telemetry.h.
+ * Text responses are still sent as before, between the frames.
+ */
+void PiLink::setBinaryTelemetry(bool enabled){
+	binaryTelemetry = enabled;
+	if(enabled){
+		telemetry.requestKeyframe();
+	}
+	print_P(PSTR("B:{\"v\":%d}"), enabled ? TELEMETRY_VERSION : 0);
+	printNewLine();
+}
+
+void PiLink::sendTelemetry(void){
+	if(!binaryTelemetry){
+		return;
+	}
+	ControlSnapshot snapshot = tempControl.snapshot();
+	telemetry.begin(ticks.millis());
+	telemetry.add(TELEMETRY_BEER_TEMP, snapshot.beerTemp.getRaw());
+	telemetry.add(TELEMETRY_BEER_SET, snapshot.beerSetting.getRaw());
+	telemetry.add(TELEMETRY_FRIDGE_TEMP, snapshot.fridgeTemp.getRaw());
+	telemetry.add(TELEMETRY_FRIDGE_SET, snapshot.fridgeSetting.getRaw());
+	telemetry.add(TELEMETRY_ROOM_TEMP, snapshot.roomTemp.getRaw());
+	telemetry.add(TELEMETRY_COOLER_PWM, snapshot.coolerPwm.getRaw());
+	telemetry.add(TELEMETRY_HEATER1_PWM, snapshot.heater1Pwm.getRaw());
+	telemetry.add(TELEMETRY_HEATER2_PWM, snapshot.heater2Pwm.getRaw());
+	telemetry.add(TELEMETRY_MODE, snapshot.mode);
+	telemetry.add(TELEMETRY_STATE, snapshot.state);
+	telemetry.add(TELEMETRY_OUTPUTS, snapshot.outputs);
+	for(uint8_t i = 0; i < 4; i++){
+		uint8_t id = TELEMETRY_BEER_TO_FRIDGE_PID + 4 * i;
+		const PidSnapshot & pid = snapshot.pids[i];
+		telemetry.add(id, pid.inputError.getRaw());
+		telemetry.add(id + 1, pid.p.getRaw());
+		telemetry.add(id + 2, pid.i.getRaw());
+		telemetry.add(id + 3, pid.d.getRaw());
+	}
+	telemetry.end();
+}
+
+#if BREWPI_DATA_LOG
+// blocks sent for one 'g' command. The Pi asks again for the next blocks.
+#define DATA_LOG_BLOCKS_PER_REQUEST 16
+// blocks sent per call to receive(), to not hold up the main loop for long
+#define DATA_LOG_BLOCKS_PER_CALL 2
+
+static void parseDataLogRequest(const char * key, const char * val, void* pv){
+	DataLogTransfer * request = (DataLogTransfer *) pv;
+	if(key[0] == 's' && key[1] == 0){
+		request->start = strtoul(val, NULL, 10);
+	}
+	else if(key[0] == 'i' && key[1] == 0){
+		stringToUint16(&request->interval, val);
+	}
+}
+
+/*
+ * The data log keeps samples of the control values in flash, so the Pi can fill the gaps after it lost the connection.
+ * g{"s":<sequence>} sends the blocks from that sequence number on as frames like binary telemetry, see Telemetry.h,
+ * followed by G:{"n":<blocks sent>,"l":<newest sequence number>,"i":<interval>}. When the Pi has all stored blocks,
+ * the block that is being filled is stored first, so it also receives the latest samples.
+ * g{"i":<ms>} changes the time between samples.
+ *
+ * The request is parsed like settings received with 'j', without waiting for input. The blocks are sent a few per
+ * call to receive(), so a request does not hold up the main loop.
+ */
+void PiLink::receiveDataLogRequest(void){
+	dataLogTransfer.start = SampleStore::NO_SEQUENCE;
+	dataLogTransfer.interval = 0;
+	beginReceiveJson(&parseDataLogRequest, &dataLogTransfer, &startDataLog);
+}
+
+void PiLink::startDataLog(void){
+	if(dataLogTransfer.interval){
+		dataLog.setInterval(dataLogTransfer.interval);
+	}
+	if(dataLogTransfer.start != SampleStore::NO_SEQUENCE
+			&& uint32_t(dataLog.lastSequence() + 1) <= dataLogTransfer.start){
+		dataLog.flush();
+	}
+	dataLogTransfer.sent = 0;
+	dataLogTransfer.sending = true; // receive() sends the blocks
+}
+
+bool PiLink::dataLogBusy(void){
+	return dataLogTransfer.sending;
+}
+
+bool PiLink::continueDataLog(void){
+	int16_t length = -1;
+	// seek on each call, the store can drop its oldest blocks or add new ones in between
+	if(dataLogTransfer.start != SampleStore::NO_SEQUENCE && dataLogStore.seek(dataLogTransfer.start)){
+		uint8_t block[TELEMETRY_MAX_BLOCK_SIZE];
+		uint32_t sequence;
+		for(uint8_t i = 0; i < DATA_LOG_BLOCKS_PER_CALL && dataLogTransfer.sent < DATA_LOG_BLOCKS_PER_REQUEST; i++){
+			length = dataLogStore.read(sequence, block, sizeof(block));
+			if(length < 0){
+				break;
+			}
+			telemetrySendBlock(telemetrySink, sequence, block, length);
+			dataLogTransfer.start = sequence + 1;
+			dataLogTransfer.sent++;
+		}
+	}
+	if(length >= 0 && dataLogTransfer.sent < DATA_LOG_BLOCKS_PER_REQUEST){
+		return false;
+	}
+	dataLogTransfer.sending = false;
+	print_P(PSTR("G:{\"n\":%u,\"l\":%lu,\"i\":%u}"), dataLogTransfer.sent, (unsigned long) dataLog.lastSequence(),
+			dataLog.interval());
+	printNewLine();
+	return true;
+}
+#else
+bool PiLink::dataLogBusy(void){
+	return false;
+}
+#endif
+
 void PiLink::sendJsonAnnotation(const char* name, const char* annotation)
 {
 	printJsonName(name);
@@ -403,6 +615,16 @@ void PiLink::closeListResponse() {
 
 void PiLink::debugMessage(const char * message, ...){
 	va_list args;
+
+	if(ControlLock::inControlThread()){
+		// the main loop sends it, so it does not end up in the middle of other output
+		char text[64];
+		va_start (args, message );
+		vsnprintf_P(text, sizeof(text), message, args);
+		va_end (args);
+		Logger::queueMessage(0, 0, text);
+		return;
+	}
 		
 	//print 'D:' as prefix
 	printResponse('D');
@@ -525,7 +747,11 @@ const PiLink::JsonOutput PiLink::jsonOutputCCMap[] PROGMEM = {
 	JSON_OUTPUT_CC_MAP(heater1PwmPeriod, JOCC_UINT16),
 	JSON_OUTPUT_CC_MAP(heater2PwmPeriod, JOCC_UINT16),
 	JSON_OUTPUT_CC_MAP(coolerPwmPeriod, JOCC_UINT16),
-	JSON_OUTPUT_CC_MAP(mutexDeadTime, JOCC_UINT16)
+	JSON_OUTPUT_CC_MAP(mutexDeadTime, JOCC_UINT16),
+	JSON_OUTPUT_CC_MAP(powerBudget, JOCC_UINT8),
+	JSON_OUTPUT_CC_MAP(heater1Load, JOCC_UINT8),
+	JSON_OUTPUT_CC_MAP(heater2Load, JOCC_UINT8),
+	JSON_OUTPUT_CC_MAP(coolerLoad, JOCC_UINT8)
 };
 
 void PiLink::sendJsonValues(char responseType, const JsonOutput* /*PROGMEM*/ jsonOutputMap, uint8_t mapCount) {
@@ -544,14 +770,87 @@ void PiLink::sendControlConstants(void){
 	sendJsonValues('C', jsonOutputCCMap, sizeof(jsonOutputCCMap)/sizeof(jsonOutputCCMap[0]));	
 }
 
-// This function now sends the entire Control object as json using ESJ
+// This function now sends the entire Control object as json, streamed through a small buffer without heap allocation
+// It is sent without the control lock, so values can be from different control updates. The objects themselves
+// are only rebuilt by the main loop, which is sending this.
 void PiLink::sendControlVariables(void){
     piStream.print('V');
     piStream.print(':');
-    JSON::serial_producer<Control>::convert(control, piStream);
+    JSON::stream_producer<Control>::convert(control, piStream);
     piStream.println();
 }
 
+/*
+ * Sends heap usage and the statistics of each pool as
+ * M:{"heap":{"u":used,"h":highWater},"pools":[{"n":name,"c":capacity,"u":used,"h":highWater,"f":failures},...]}
+ */
+void PiLink::sendMemoryStatistics(void){
+    HeapStatistics heap = heapStatistics();
+    print_P(PSTR("M:{\"heap\":{\"u\":%lu,\"h\":%lu},\"pools\":["), (unsigned long) heap.used, (unsigned long) heap.highWater);
+    for(PoolStatistics * pool = PoolStatistics::first(); pool != nullptr; pool = pool->getNext()){
+        print_P(PSTR("{\"n\":\"%s\",\"c\":%u,\"u\":%u,\"h\":%u,\"f\":%u}"),
+            pool->getName(), pool->getCapacity(), pool->getUsed(), pool->getHighWater(), pool->getFailures());
+        if(pool->getNext() != nullptr){
+            piStream.print(',');
+        }
+    }
+    piStream.print(']');
+    piStream.print('}');
+    printNewLine();
+}
+
+#if BREWPI_PROFILING
+
+// run times in microseconds as "r":runs,"mn":min,"av":mean,"mx":max,"rx":max of the recent runs
+void PiLink::printRunTimes(const RunTimeStatistics & stats){
+    print_P(PSTR("\"r\":%lu,\"mn\":%lu,\"av\":%lu,\"mx\":%lu,\"rx\":%lu"),
+        (unsigned long) stats.runs,
+        (unsigned long) (stats.runs ? stats.minRunTime : 0),
+        (unsigned long) stats.meanRunTime(),
+        (unsigned long) stats.maxRunTime,
+        (unsigned long) stats.recentMaxRunTime());
+}
+
+/*
+ * Sends the profile of the main loop as
+ * P:{"t":[{"n":task,<run times>,"l":maxLateness,"d":missedDeadlines,"j":[lateness histogram]},...],
+ *    "s":[{"n":section,<run times>},...],"e":missedPwmEdges}
+ */
+void PiLink::sendProfile(void){
+    print_P(PSTR("P:{\"t\":["));
+    TaskScheduler * schedulers[2] = {&controlScheduler, &taskScheduler};
+    bool first = true;
+    for(TaskScheduler * scheduler : schedulers){
+        for(uint8_t i = 0; i < scheduler->taskCount(); i++){
+            const Task * task = scheduler->task(i);
+            const TaskStatistics & stats = task->statistics();
+            if(!first){
+                piStream.print(',');
+            }
+            first = false;
+            print_P(PSTR("{\"n\":\"%s\","), task->getName() ? task->getName() : "");
+            printRunTimes(stats);
+            print_P(PSTR(",\"l\":%lu,\"d\":%lu,\"j\":["), (unsigned long) stats.maxLateness, (unsigned long) stats.missedDeadlines);
+            for(uint8_t b = 0; b < PROFILING_LATENESS_BINS; b++){
+                print_P(b ? PSTR(",%u") : PSTR("%u"), stats.lateness.bins[b]);
+            }
+            print_P(PSTR("]}"));
+        }
+    }
+    print_P(PSTR("],\"s\":["));
+    for(ProfileSection * section = ProfileSection::first(); section != nullptr; section = section->getNext()){
+        print_P(PSTR("{\"n\":\"%s\","), section->getName());
+        printRunTimes(section->statistics());
+        piStream.print('}');
+        if(section->getNext() != nullptr){
+            piStream.print(',');
+        }
+    }
+    print_P(PSTR("],\"e\":%lu}"), (unsigned long) ActuatorPwm::missedEdges());
+    printNewLine();
+}
+#endif
+
 void PiLink::printJsonName(const char * name)
 {
 	printJsonSeparator();
@@ -599,63 +898,68 @@ int readNext()
 	}
 	return piStream.read();
 }
-/**
- * Parses a token from the piStream.
- * \return true if a token was parsed
- */
-bool parseJsonToken(char* val) {
-	uint8_t index = 0;
-	val[0] = 0;
-	bool result = true;
-	for(;;) // get value
-	{
-		int character = readNext();
-		if (index==29 || character == '}' || character==-1) {
-			result = false;
-			break;
-		}
-		if(character == ',' || character==':')  // end of value
-			break;		
-		if(character == ' ' || character == '"'){
-			; // skip spaces and apostrophes
-		}		
-		else
-			val[index++] = character;
-	}
-	val[index]=0; // null terminate string
-	return result;	
-}
 
 void PiLink::parseJson(ParseJsonCallback fn, void* data) 
 {
-	char key[30];
-	char val[30];
-	*key = 0;
-	*val = 0;
-	bool next = true;
-	// read first open brace	
-	int c = readNext();		
-	if (c!='{')
-	{
+	JsonTokenizer tokenizer;
+	tokenizer.begin(fn, data);
+	int c = 0;
+	while (tokenizer.busy()) {
+		c = readNext();
+		if (c < 0) {
+			tokenizer.finish();
+			break;
+		}
+		tokenizer.feed(c);
+	}
+	if (tokenizer.getStatus() == JsonTokenizer::ERROR_NO_OBJECT) {
 		logErrorInt(ERROR_EXPECTED_BRACKET, c);
-		return;
 	}
-	do {
-		next = parseJsonToken(key) && parseJsonToken(val);
-		if (val[0] && key[0])
-			fn(key, val, data);
-	} while (next);
 }
 
 void PiLink::receiveJson(void){
+	// commit all settings in the message to eeprom at once, instead of once per key
+	eepromManager.beginBatch();
+	beginReceiveJson(&processJsonPair, NULL, &finishReceiveJson);
+}
+
+void PiLink::beginReceiveJson(ParseJsonCallback fn, void* data, void (*complete)(void)){
+	jsonTokenizer.begin(fn, data);
+	jsonComplete = complete;
+	jsonLastInput = ticks.millis();
+	// the object is parsed from the input that is already buffered, receive() continues when more arrives
+	continueReceiveJson();
+}
+
+bool PiLink::continueReceiveJson(void){
+	while (piStream.available() > 0) {
+		int c = piStream.read();
+		jsonLastInput = ticks.millis();
+		if (jsonTokenizer.feed(c) == JsonTokenizer::ERROR_NO_OBJECT) {
+			logErrorInt(ERROR_EXPECTED_BRACKET, c);
+		}
+		if (!jsonTokenizer.busy()) {
+			jsonComplete();
+			return true;
+		}
+	}
+	if (ticks.timeSinceMillis(jsonLastInput) >= JSON_INPUT_TIMEOUT) {
+		if (jsonTokenizer.finish() == JsonTokenizer::ERROR_NO_OBJECT) {
+			logErrorInt(ERROR_EXPECTED_BRACKET, -1);
+		}
+		jsonComplete();
+		return true;
+	}
+	return false;
+}
+
+void PiLink::finishReceiveJson(void){
+	eepromManager.endBatch();
 
-	parseJson(&processJsonPair, NULL);	
-				
 #if !BREWPI_SIMULATE	// this is quite an overhead and not needed for the simulator
 	sendControlSettings();	// update script with new settings
 	sendControlConstants();
 #endif
-	return;
 }
 
 
@@ -753,6 +1057,13 @@ void setUint16(const char* value, uint16_t* target) {
         eepromManager.storeTempConstantsAndSettings(); // value parsed correctly
     }
 }
+void setUint8(const char* value, uint8_t* target) {
+    uint16_t received;
+    if(stringToUint16(&received, value) && received <= UINT8_MAX){
+        *target = received;
+        eepromManager.storeTempConstantsAndSettings(); // value parsed correctly
+    }
+}
 void setBool(const char* value, uint8_t* target) {
     bool result;
     if(stringToBool(&result, value)){
@@ -762,58 +1073,74 @@ void setBool(const char* value, uint8_t* target) {
 }
 
 
-#define JSON_CONVERT(jsonKey, target, fn) { jsonKey, target, (JsonParserHandlerFn)&fn }
+// All JSON settings keys, with their target and handler. Used to build both the handler table and the key index.
+#define JSON_PARSER_CONVERTERS(CONVERT) \
+	CONVERT(JSONKEY_mode, NULL, setMode) \
+	CONVERT(JSONKEY_beerSetting, NULL, setBeerSetting) \
+	CONVERT(JSONKEY_fridgeSetting, NULL, setFridgeSetting) \
+	\
+	CONVERT(JSONKEY_tempFormat, NULL, setTempFormat) \
+	\
+	CONVERT(JSONKEY_heater1_kp, &tempControl.cc.heater1_kp, setStringToFixedLong) \
+	CONVERT(JSONKEY_heater1_ti, &tempControl.cc.heater1_ti, setUint16) \
+	CONVERT(JSONKEY_heater1_td, &tempControl.cc.heater1_td,setUint16) \
+	CONVERT(JSONKEY_heater1_infilt, &tempControl.cc.heater1_infilt, setFilter) \
+	CONVERT(JSONKEY_heater1_dfilt, &tempControl.cc.heater1_dfilt, setFilter) \
+	CONVERT(JSONKEY_heater2_kp, &tempControl.cc.heater2_kp, setStringToFixedLong) \
+	CONVERT(JSONKEY_heater2_ti, &tempControl.cc.heater2_ti, setUint16) \
+	CONVERT(JSONKEY_heater2_td, &tempControl.cc.heater2_td, setUint16) \
+	CONVERT(JSONKEY_heater2_infilt, &tempControl.cc.heater2_infilt, setFilter) \
+	CONVERT(JSONKEY_heater2_dfilt, &tempControl.cc.heater2_dfilt, setFilter) \
+	CONVERT(JSONKEY_cooler_kp, &tempControl.cc.cooler_kp, setStringToFixedLong) \
+	CONVERT(JSONKEY_cooler_ti, &tempControl.cc.cooler_ti, setUint16) \
+	CONVERT(JSONKEY_cooler_td, &tempControl.cc.cooler_td, setUint16) \
+	CONVERT(JSONKEY_cooler_infilt, &tempControl.cc.cooler_infilt, setFilter) \
+	CONVERT(JSONKEY_cooler_dfilt, &tempControl.cc.cooler_dfilt, setFilter) \
+	CONVERT(JSONKEY_beer2fridge_kp, &tempControl.cc.beer2fridge_kp, setStringToFixedLong) \
+	CONVERT(JSONKEY_beer2fridge_ti, &tempControl.cc.beer2fridge_ti, setUint16) \
+	CONVERT(JSONKEY_beer2fridge_td, &tempControl.cc.beer2fridge_td, setUint16) \
+	CONVERT(JSONKEY_beer2fridge_infilt, &tempControl.cc.beer2fridge_infilt, setFilter) \
+	CONVERT(JSONKEY_beer2fridge_dfilt, &tempControl.cc.beer2fridge_dfilt, setFilter) \
+	CONVERT(JSONKEY_beer2fridge_pidMax, &tempControl.cc.beer2fridge_pidMax, setStringToFixedLong) \
+	\
+	CONVERT(JSONKEY_minCoolTime, &tempControl.cc.minCoolTime, setUint16) \
+	CONVERT(JSONKEY_minCoolIdleTime, &tempControl.cc.minCoolIdleTime, setUint16) \
+	CONVERT(JSONKEY_heater1PwmPeriod, &tempControl.cc.heater1PwmPeriod, setUint16) \
+	CONVERT(JSONKEY_heater2PwmPeriod, &tempControl.cc.heater2PwmPeriod, setUint16) \
+	CONVERT(JSONKEY_coolerPwmPeriod, &tempControl.cc.coolerPwmPeriod, setUint16) \
+	CONVERT(JSONKEY_mutexDeadTime, &tempControl.cc.mutexDeadTime, setUint16) \
+	CONVERT(JSONKEY_powerBudget, &tempControl.cc.powerBudget, setUint8) \
+	CONVERT(JSONKEY_heater1Load, &tempControl.cc.heater1Load, setUint8) \
+	CONVERT(JSONKEY_heater2Load, &tempControl.cc.heater2Load, setUint8) \
+	CONVERT(JSONKEY_coolerLoad, &tempControl.cc.coolerLoad, setUint8)
+
+#define JSON_CONVERT(jsonKey, target, fn) { jsonKey, target, (JsonParserHandlerFn)&fn },
+#define JSON_CONVERT_KEY(jsonKey, target, fn) jsonKey,
 
 const PiLink::JsonParserConvert PiLink::jsonParserConverters[] PROGMEM = {
-	JSON_CONVERT(JSONKEY_mode, NULL, setMode),
-	JSON_CONVERT(JSONKEY_beerSetting, NULL, setBeerSetting),
-	JSON_CONVERT(JSONKEY_fridgeSetting, NULL, setFridgeSetting),
-	
-	JSON_CONVERT(JSONKEY_tempFormat, NULL, setTempFormat),
-	
-	JSON_CONVERT(JSONKEY_heater1_kp, &tempControl.cc.heater1_kp, setStringToFixedLong),
-	JSON_CONVERT(JSONKEY_heater1_ti, &tempControl.cc.heater1_ti, setUint16),
-	JSON_CONVERT(JSONKEY_heater1_td, &tempControl.cc.heater1_td,setUint16),
-	JSON_CONVERT(JSONKEY_heater1_infilt, &tempControl.cc.heater1_infilt, setFilter),
-	JSON_CONVERT(JSONKEY_heater1_dfilt, &tempControl.cc.heater1_dfilt, setFilter),
-	JSON_CONVERT(JSONKEY_heater2_kp, &tempControl.cc.heater2_kp, setStringToFixedLong),
-	JSON_CONVERT(JSONKEY_heater2_ti, &tempControl.cc.heater2_ti, setUint16),
-	JSON_CONVERT(JSONKEY_heater2_td, &tempControl.cc.heater2_td, setUint16),
-	JSON_CONVERT(JSONKEY_heater2_infilt, &tempControl.cc.heater2_infilt, setFilter),
-	JSON_CONVERT(JSONKEY_heater2_dfilt, &tempControl.cc.heater2_dfilt, setFilter),
-	JSON_CONVERT(JSONKEY_cooler_kp, &tempControl.cc.cooler_kp, setStringToFixedLong),
-	JSON_CONVERT(JSONKEY_cooler_ti, &tempControl.cc.cooler_ti, setUint16),
-	JSON_CONVERT(JSONKEY_cooler_td, &tempControl.cc.cooler_td, setUint16),
-	JSON_CONVERT(JSONKEY_cooler_infilt, &tempControl.cc.cooler_infilt, setFilter),
-	JSON_CONVERT(JSONKEY_cooler_dfilt, &tempControl.cc.cooler_dfilt, setFilter),
-	JSON_CONVERT(JSONKEY_beer2fridge_kp, &tempControl.cc.beer2fridge_kp, setStringToFixedLong),
-	JSON_CONVERT(JSONKEY_beer2fridge_ti, &tempControl.cc.beer2fridge_ti, setUint16),
-	JSON_CONVERT(JSONKEY_beer2fridge_td, &tempControl.cc.beer2fridge_td, setUint16),
-	JSON_CONVERT(JSONKEY_beer2fridge_infilt, &tempControl.cc.beer2fridge_infilt, setFilter),
-	JSON_CONVERT(JSONKEY_beer2fridge_dfilt, &tempControl.cc.beer2fridge_dfilt, setFilter),
-	JSON_CONVERT(JSONKEY_beer2fridge_pidMax, &tempControl.cc.beer2fridge_pidMax, setStringToFixedLong),
-
-	JSON_CONVERT(JSONKEY_minCoolTime, &tempControl.cc.minCoolTime, setUint16),
-	JSON_CONVERT(JSONKEY_minCoolIdleTime, &tempControl.cc.minCoolIdleTime, setUint16),
-	JSON_CONVERT(JSONKEY_heater1PwmPeriod, &tempControl.cc.heater1PwmPeriod, setUint16),
-	JSON_CONVERT(JSONKEY_heater2PwmPeriod, &tempControl.cc.heater2PwmPeriod, setUint16),
-	JSON_CONVERT(JSONKEY_coolerPwmPeriod, &tempControl.cc.coolerPwmPeriod, setUint16),
-	JSON_CONVERT(JSONKEY_mutexDeadTime, &tempControl.cc.mutexDeadTime, setUint16)
+	JSON_PARSER_CONVERTERS(JSON_CONVERT)
+};
+
+static constexpr const char * jsonParserKeys[] = {
+	JSON_PARSER_CONVERTERS(JSON_CONVERT_KEY)
 };
 
+// perfect hash of the keys, computed at compile time. Maps each key to its entry in jsonParserConverters
+static constexpr PerfectHash::Index<sizeof(jsonParserKeys)/sizeof(jsonParserKeys[0]), 7> jsonParserIndex(jsonParserKeys);
+static_assert(jsonParserIndex.isValid(), "No collision free hash found for JSON keys, increase the number of index bits");
+
 void PiLink::processJsonPair(const char * key, const char * val, void* pv){
 	logInfoStringString(INFO_RECEIVED_SETTING, key, val);
-	
-	for (uint8_t i=0; i<sizeof(jsonParserConverters)/sizeof(jsonParserConverters[0]); i++) {
+
+	int16_t i = jsonParserIndex.candidate(key);
+	if (i >= 0) {
 		JsonParserConvert converter;
-		memcpy_P(&converter, &jsonParserConverters[i], sizeof(converter));		
-		//logDeveloper("Handling converter %d %s "PRINTF_PROGMEM" %d %d"), i, key, converter.key, converter.fn, converter.target);
-		if (strcmp_P(key,converter.key) == 0) {
-			//logDeveloper("Handling json key %s"), key);
+		memcpy_P(&converter, &jsonParserConverters[i], sizeof(converter));
+		if (strcmp_P(key,converter.key) == 0) { // the hash only tells which key it could be
 			converter.fn(val, converter.target);
 			return;
 		}
-	}					
+	}
 	logWarning(WARNING_COULD_NOT_PROCESS_SETTING);
 }
 
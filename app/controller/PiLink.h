@@ -24,9 +24,37 @@
 #include "temperatureFormats.h"
 #include "DeviceManager.h"
 #include "Logger.h"
+#include "JsonTokenizer.h"
+#include "Ticks.h"
+#include "Profiling.h"
+#include "Telemetry.h"
 
 #define PRINTF_BUFFER_SIZE 128
 
+// version of the binary telemetry, reported when it is enabled with 'B'
+#define TELEMETRY_VERSION 1
+
+/* Object ids of the values in binary telemetry frames. Temperatures, PWM values and PID terms are raw fixed point
+ * values with 8 fraction bits, temperatures are in Celsius. Each PID has 4 consecutive ids: input error, p, i and d.
+ */
+enum TelemetryId {
+	TELEMETRY_BEER_TEMP = 0,
+	TELEMETRY_BEER_SET = 1,
+	TELEMETRY_FRIDGE_TEMP = 2,
+	TELEMETRY_FRIDGE_SET = 3,
+	TELEMETRY_ROOM_TEMP = 4,
+	TELEMETRY_COOLER_PWM = 5,
+	TELEMETRY_HEATER1_PWM = 6,
+	TELEMETRY_HEATER2_PWM = 7,
+	TELEMETRY_MODE = 8,
+	TELEMETRY_STATE = 9,
+	TELEMETRY_OUTPUTS = 10, // bit 0: cooler active, bit 1: heater 1 active, bit 2: heater 2 active
+	TELEMETRY_BEER_TO_FRIDGE_PID = 16,
+	TELEMETRY_HEATER1_PID = 20,
+	TELEMETRY_HEATER2_PID = 24,
+	TELEMETRY_COOLER_PID = 28,
+};
+
 class DeviceConfig;
 
 
@@ -43,6 +71,9 @@ class PiLink{
 	static void debugMessage(const char * message, ...);
 
 	static void printTemperatures(void);
+
+	// sends the control state as a binary telemetry frame, when the client enabled binary telemetry
+	static void sendTelemetry(void);
 	
 	typedef void (*ParseJsonCallback)(const char* key, const char* val, void* data);
 
@@ -54,8 +85,17 @@ class PiLink{
 	static void receiveControlConstants(void);
 	static void sendControlConstants(void);
 	static void sendControlVariables(void);
+	static void sendMemoryStatistics(void);
+#if BREWPI_PROFILING
+	static void sendProfile(void);
+	static void printRunTimes(const RunTimeStatistics & stats);
+#endif
 	
 	static void receiveJson(void); // receive settings as JSON key:value pairs
+	// starts parsing a JSON object from the input, complete is called when the object has been parsed
+	static void beginReceiveJson(ParseJsonCallback fn, void* data, void (*complete)(void));
+	static bool continueReceiveJson(void); // process buffered JSON input, returns true when the object is complete
+	static void finishReceiveJson(void);
 	
 	static void print(char *fmt, ...); // use when format string is stored in RAM
 	static void print(char c)       // inline for arduino
@@ -71,6 +111,13 @@ class PiLink{
 	
 	private:
 	static void soundAlarm(bool enabled);
+	static void setBinaryTelemetry(bool enabled);
+#if BREWPI_DATA_LOG
+	static void receiveDataLogRequest(void);
+	static void startDataLog(void);
+	static bool continueDataLog(void); // sends the next blocks of the data log, returns true when all have been sent
+#endif
+	static bool dataLogBusy(void);
 	static void printResponse(char responseChar);
 	static void printChamberInfo();
 	
@@ -140,6 +187,11 @@ class PiLink{
 
 	private:
 	static bool firstPair;
+	static JsonTokenizer jsonTokenizer; // parses JSON received with 'j' or 'g' across multiple calls to receive()
+	static ticks_millis_t jsonLastInput;
+	static void (*jsonComplete)(void);
+	static bool binaryTelemetry; // the client asked for binary telemetry frames
+	static TelemetryWriter telemetry;
 	friend class DeviceManager;
 	friend class PiLinkTest;
 	friend class Logger;
@@ -32,6 +32,7 @@
 #include "EepromManager.h"
 #include "fixstl.h"
 #include "defaultDevices.h"
+#include "ControlLock.h"
 
 #define DISABLED_TEMP temp_t::disabled()
 
@@ -68,6 +69,10 @@ ControlConstants const ccDefaults PROGMEM =
     4, // heater2PwmPeriod
     1200, // coolerPwmPeriod
     1800, // mutexDeadTime
+    0, // powerBudget
+    0, // heater1Load
+    0, // heater2Load
+    0, // coolerLoad
 };
 
 TempControl::TempControl()
@@ -92,6 +97,32 @@ tcduration_t TempControl::timeSinceIdle(void)
     return ticks.timeSinceSeconds(lastIdleTime);
 }
 
+void TempControl::publishSnapshot()
+{
+    ControlSnapshot s;
+    s.beerTemp = getBeerTemp();
+    s.beerSetting = getBeerSetting();
+    s.fridgeTemp = getFridgeTemp();
+    s.fridgeSetting = getFridgeSetting();
+    s.roomTemp = getRoomTemp();
+    s.coolerPwm = control.cooler->getValue();
+    s.heater1Pwm = control.heater1->getValue();
+    s.heater2Pwm = control.heater2->getValue();
+    const Pid * pids[4] = {control.beerToFridgePid, control.heater1Pid, control.heater2Pid, control.coolerPid};
+    for(uint8_t i = 0; i < 4; i++){
+        s.pids[i].inputError = pids[i]->inputError;
+        s.pids[i].p = pids[i]->p;
+        s.pids[i].i = pids[i]->i;
+        s.pids[i].d = pids[i]->d;
+    }
+    s.mode = cs.mode;
+    s.state = getState();
+    s.outputs = (control.coolerMutex->isActive() ? 0x01 : 0)
+            | (control.heater1Mutex->isActive() ? 0x02 : 0)
+            | (control.heater2Mutex->isActive() ? 0x04 : 0);
+    snapshots.publish(s);
+}
+
 void TempControl::loadDefaultSettings()
 {
 #if BREWPI_EMULATE
@@ -106,7 +137,7 @@ void TempControl::loadDefaultSettings()
 
 void TempControl::storeConstants(eptr_t offset)
 {
-    eepromAccess.writeBlock(offset, (void *) &cc, sizeof(ControlConstants));
+    eepromManager.writeChanged(offset, (void *) &cc, sizeof(ControlConstants));
     updateConstants();
 }
 
@@ -120,7 +151,7 @@ void TempControl::loadConstants(eptr_t offset)
 // The update functions only write to EEPROM if the value has changed
 void TempControl::storeSettings(eptr_t offset)
 {
-    eepromAccess.writeBlock(offset, (void *) &cs, sizeof(ControlSettings));
+    eepromManager.writeChanged(offset, (void *) &cs, sizeof(ControlSettings));
 
     storedBeerSetting = cs.beerSetting;
 }
@@ -154,20 +185,29 @@ void TempControl::setMode(char newMode,
     {
         setBeerTemp(DISABLED_TEMP, true);
         setFridgeTemp(DISABLED_TEMP, true);
-        control.heater1Pid->disable(true);
-        control.coolerPid->disable(true);
-        control.beerToFridgePid->disable(false);
-    }
-    else if (newMode == MODE_BEER_CONSTANT || newMode == MODE_BEER_PROFILE){
-        control.heater1Pid->enable();
-        control.coolerPid->enable();
-        control.beerToFridgePid->enable();
     }
     else if (newMode == MODE_FRIDGE_CONSTANT){
         setBeerTemp(DISABLED_TEMP, true);
-        control.heater1Pid->enable();
-        control.coolerPid->enable();
-        control.beerToFridgePid->disable(false);
+    }
+
+    {
+        ControlLock lock; // the PIDs are updated by the control thread
+        if (newMode == MODE_OFF)
+        {
+            control.heater1Pid->disable(true);
+            control.coolerPid->disable(true);
+            control.beerToFridgePid->disable(false);
+        }
+        else if (newMode == MODE_BEER_CONSTANT || newMode == MODE_BEER_PROFILE){
+            control.heater1Pid->enable();
+            control.coolerPid->enable();
+            control.beerToFridgePid->enable();
+        }
+        else if (newMode == MODE_FRIDGE_CONSTANT){
+            control.heater1Pid->enable();
+            control.coolerPid->enable();
+            control.beerToFridgePid->disable(false);
+        }
     }
     cs.mode = newMode;
     if(store){
@@ -176,7 +216,10 @@ void TempControl::setMode(char newMode,
 }
 
 void TempControl::setBeerTemp(temp_t newTemp, bool store) {
-    control.beer1Set->write(newTemp);
+    {
+        ControlLock lock;
+        control.beer1Set->write(newTemp);
+    }
     cs.beerSetting = newTemp;
 
     if (store && ((cs.mode != MODE_BEER_PROFILE) ||
@@ -192,7 +235,10 @@ void TempControl::setBeerTemp(temp_t newTemp, bool store) {
 }
 
 void TempControl::setFridgeTemp(temp_t newTemp, bool store) {
-    control.fridgeSet->write(newTemp);
+    {
+        ControlLock lock;
+        control.fridgeSet->write(newTemp);
+    }
     cs.fridgeSetting = newTemp;
     if(store){
         eepromManager.storeTempSettings();
@@ -213,47 +259,68 @@ control_mode_t ModeControl_SetMode(control_mode_t mode)
     return prev;
 }
 
+void TempControl::updateBeerConstants(BeerControl & beer, const ControlConstants & cc)
+{
+    beer.heaterPid.Kp = cc.heater2_kp;
+    beer.heaterPid.Ti = cc.heater2_ti;
+    beer.heaterPid.Td = cc.heater2_td;
+    beer.heater.setPeriod(cc.heater2PwmPeriod);
+    beer.heaterPid.setInputFilter(cc.heater2_infilt);
+    beer.heaterPid.setDerivativeFilter(cc.heater2_dfilt);
+    beer.heaterMutex.setLoad(cc.heater2Load * 100);
+}
+
 // loads settings in tempControl to control, overwriting all existing settings
 // This is temporary fix, until settings are stored elsewhere
 // Overwriting with the same value should not have any side effects
 // updating all settings when only one has changed is a temporary fix. TODO
 void TempControl::updateConstants()
 {
-    //settings for heater 1
-    control.heater1Pid->Kp = cc.heater1_kp;
-    control.heater1Pid->Ti = cc.heater1_ti;
-    control.heater1Pid->Td = cc.heater1_td;
-
-    //settings for heater 2
-    control.heater2Pid->Kp = cc.heater2_kp;
-    control.heater2Pid->Ti = cc.heater2_ti;
-    control.heater2Pid->Td = cc.heater2_td;
-
-    //settings for cooler
-    control.coolerPid->Kp = cc.cooler_kp;
-    control.coolerPid->Ti = cc.cooler_ti;
-    control.coolerPid->Td = cc.cooler_td;
-
-    //settings for beer2fridge PID
-    control.beerToFridgePid->Kp = cc.beer2fridge_kp;
-    control.beerToFridgePid->Ti = cc.beer2fridge_ti;
-    control.beerToFridgePid->Td = cc.beer2fridge_td;
-
-    control.cooler->setPeriod(cc.coolerPwmPeriod);
-    control.heater1->setPeriod(cc.heater1PwmPeriod);
-    control.heater2->setPeriod(cc.heater2PwmPeriod);
-
-    control.coolerTimeLimited->setTimes(cc.minCoolTime, cc.minCoolIdleTime);
-
-    control.heater1Pid->setInputFilter(cc.heater1_infilt);
-    control.heater1Pid->setDerivativeFilter(cc.heater1_dfilt);
-    control.heater2Pid->setInputFilter(cc.heater2_infilt);
-    control.heater2Pid->setDerivativeFilter(cc.heater2_dfilt);
-    control.coolerPid->setInputFilter(cc.cooler_infilt);
-    control.coolerPid->setDerivativeFilter(cc.cooler_dfilt);
-    control.beerToFridgePid->setInputFilter(cc.beer2fridge_infilt);
-    control.beerToFridgePid->setDerivativeFilter(cc.beer2fridge_dfilt);
-    control.fridgeSetPointActuator->setMin(-cc.beer2fridge_pidMax);
-    control.fridgeSetPointActuator->setMax(cc.beer2fridge_pidMax);
-    control.mutex->setDeadTime(cc.mutexDeadTime * 1000);
+    ControlLock lock; // the control thread uses the objects that are changed
+    // only the first chamber has settings in eeprom, the other chambers use the same constants
+    for (ChamberControl & chamber : control.chambers)
+    {
+        //settings for heater 1
+        chamber.heaterPid.Kp = cc.heater1_kp;
+        chamber.heaterPid.Ti = cc.heater1_ti;
+        chamber.heaterPid.Td = cc.heater1_td;
+
+        //settings for cooler
+        chamber.coolerPid.Kp = cc.cooler_kp;
+        chamber.coolerPid.Ti = cc.cooler_ti;
+        chamber.coolerPid.Td = cc.cooler_td;
+
+        //settings for beer2fridge PID
+        chamber.beerToFridgePid.Kp = cc.beer2fridge_kp;
+        chamber.beerToFridgePid.Ti = cc.beer2fridge_ti;
+        chamber.beerToFridgePid.Td = cc.beer2fridge_td;
+
+        chamber.cooler.setPeriod(cc.coolerPwmPeriod);
+        chamber.heater.setPeriod(cc.heater1PwmPeriod);
+
+        chamber.coolerTimeLimited.setTimes(cc.minCoolTime, cc.minCoolIdleTime);
+
+        chamber.heaterPid.setInputFilter(cc.heater1_infilt);
+        chamber.heaterPid.setDerivativeFilter(cc.heater1_dfilt);
+        chamber.coolerPid.setInputFilter(cc.cooler_infilt);
+        chamber.coolerPid.setDerivativeFilter(cc.cooler_dfilt);
+        chamber.beerToFridgePid.setInputFilter(cc.beer2fridge_infilt);
+        chamber.beerToFridgePid.setDerivativeFilter(cc.beer2fridge_dfilt);
+        chamber.fridgeSetPointActuator.setMin(-cc.beer2fridge_pidMax);
+        chamber.fridgeSetPointActuator.setMax(cc.beer2fridge_pidMax);
+        chamber.mutex.setDeadTime(cc.mutexDeadTime * 1000);
+        chamber.mutex.setPowerBudget(cc.powerBudget * 100);
+        chamber.heaterMutex.setLoad(cc.heater1Load * 100);
+        chamber.coolerMutex.setLoad(cc.coolerLoad * 100);
+    }
+
+    //settings for heater 2, used by all secondary beers
+    for (ChamberControl & chamber : control.chambers)
+    {
+        updateBeerConstants(chamber.legacyBeer, cc);
+    }
+    for (BeerControl & beer : control.beers)
+    {
+        updateBeerConstants(beer, cc);
+    }
 }
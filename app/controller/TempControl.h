@@ -26,6 +26,7 @@
 #include "ModeControl.h"
 #include "Ticks.h"
 #include "Control.h"
+#include "SnapshotBuffer.h"
 
 // These two structs are stored in and loaded from EEPROM
 struct ControlSettings {
@@ -72,6 +73,13 @@ struct ControlConstants {
     uint16_t heater2PwmPeriod;
     uint16_t coolerPwmPeriod;
     uint16_t mutexDeadTime;
+
+    // total power the actuators of a chamber can use together and the power of each, in units of 100 W.
+    // A budget of 0 allows only one active actuator, with the dead time in between.
+    uint8_t powerBudget;
+    uint8_t heater1Load;
+    uint8_t heater2Load;
+    uint8_t coolerLoad;
 };
 
 #define EEPROM_TC_SETTINGS_BASE_ADDRESS 0
@@ -87,6 +95,30 @@ enum states {
     NUM_STATES                  // 5
 };
 
+// Terms of a PID as published by the control task
+struct PidSnapshot {
+    temp_t inputError;
+    temp_long_t p;
+    temp_long_t i;
+    temp_long_t d;
+};
+
+// Control state as published by the control task, for the UI and PiLink
+struct ControlSnapshot {
+    temp_t beerTemp;
+    temp_t beerSetting;
+    temp_t fridgeTemp;
+    temp_t fridgeSetting;
+    temp_t roomTemp;
+    temp_t coolerPwm; // PWM values of the actuators of the first chamber
+    temp_t heater1Pwm;
+    temp_t heater2Pwm;
+    PidSnapshot pids[4]; // beer to fridge, heater 1, heater 2 and cooler PID
+    control_mode_t mode;
+    uint8_t state; // see states
+    uint8_t outputs; // bit 0: cooler active, bit 1: heater 1 active, bit 2: heater 2 active
+};
+
 class TempControl {
 public:
 
@@ -150,7 +182,15 @@ public:
     void setFridgeTemp(temp_t newTemp, bool store);
 
     temp_t getRoomTemp(void) {
-        return control.beer2Sensor->read();
+        return control.roomSensor->read();
+    }
+
+    // Publishes the current state for other threads. Called by the control task after the actuators are updated.
+    void publishSnapshot();
+
+    // Newest published state. Safe to call from any thread, unlike the getters above, which the control task uses.
+    ControlSnapshot snapshot() const {
+        return snapshots.read();
     }
 
 
@@ -160,12 +200,16 @@ public:
     ControlSettings cs;
 
 private:
+    static void updateBeerConstants(BeerControl & beer, const ControlConstants & cc);
+
     // keep track of beer setting stored in EEPROM
     // Timers
     tcduration_t lastIdleTime;
     tcduration_t lastHeatTime;
     tcduration_t lastCoolTime;
     temp_t storedBeerSetting;
+
+    SnapshotBuffer<ControlSnapshot> snapshots;
 };
 
 extern TempControl tempControl;
@@ -0,0 +1,357 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "json_adapter.h"
+#include "temperatureFormats.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifndef JSON_STREAM_WRITER_BUFFER_SIZE
+#define JSON_STREAM_WRITER_BUFFER_SIZE (64)
+#endif
+
+namespace JSON
+{
+
+/**
+ * JSON writer that formats directly into a fixed size character buffer, without heap allocation.
+ * Produces the same output as JSON::Writer, so both writers can be used for the same serialize() functions.
+ *
+ * Without a flush function, the output is kept in the buffer and is truncated when the buffer is full.
+ * With a flush function, the buffer is handed to the flush function each time it is full, which allows streaming
+ * output of any length through a small buffer.
+ */
+class StreamWriter : public Adapter
+{
+public:
+    typedef void (*FlushFunction)(void * context, const char * data, uint16_t length);
+
+    /**
+     * @param buffer target buffer
+     * @param size size of the buffer, including the terminating \0
+     * @param flushFunction called with the buffer contents when the buffer is full and on flush()
+     * @param flushContext passed to flushFunction
+     */
+    StreamWriter(char * buffer, uint16_t size, FlushFunction flushFunction = nullptr, void * flushContext = nullptr) :
+        buf(buffer),
+        capacity(size - 1),
+        pos(0),
+        flushFn(flushFunction),
+        context(flushContext),
+        truncated(false) {
+        buf[0] = '\0';
+    }
+    virtual ~StreamWriter(){}
+
+    /**
+     * Hands the buffered output to the flush function and empties the buffer.
+     * Does nothing when there is no flush function.
+     */
+    void flush(){
+        if(flushFn != nullptr && pos > 0){
+            flushFn(context, buf, pos);
+            pos = 0;
+        }
+    }
+
+    /**
+     * @return buffer contents as a \0 terminated string. Only the unflushed part when a flush function is used.
+     */
+    const char * c_str(){
+        buf[pos] = '\0';
+        return buf;
+    }
+
+    uint16_t length() const {
+        return pos;
+    }
+
+    /**
+     * @return true when output was discarded, because the buffer was full and there is no flush function
+     */
+    bool overflow() const {
+        return truncated;
+    }
+
+    virtual bool storing() override final { return true; }
+
+    // key/value pairs
+    virtual void serialize(const char* key,std::string& value,bool more) override final
+    {
+        putKey(key); putQuoted(value.c_str()); putMore(more);
+    }
+
+    virtual void serialize(const char* key,std::wstring& value,bool more) override final
+    {
+        putKey(key); serialize(value); putMore(more);
+    }
+
+    virtual void serialize(const char* key,const char* value,bool more) override final
+    {
+        putKey(key); putQuoted(value); putMore(more);
+    }
+
+    virtual void serialize(const char* key,int8_t& value,bool more) override final
+    {
+        putKey(key); putSigned(value); putMore(more);
+    }
+
+    virtual void serialize(const char* key,int16_t& value,bool more) override final
+    {
+        putKey(key); putSigned(value); putMore(more);
+    }
+
+    virtual void serialize(const char* key,int32_t& value,bool more) override final
+    {
+        putKey(key); putSigned(value); putMore(more);
+    }
+
+    virtual void serialize(const char* key,uint8_t& value,bool more) override final
+    {
+        putKey(key); putUnsigned(value); putMore(more);
+    }
+
+    virtual void serialize(const char* key,uint16_t& value,bool more) override final
+    {
+        putKey(key); putUnsigned(value); putMore(more);
+    }
+
+    virtual void serialize(const char* key,uint32_t& value,bool more) override final
+    {
+        putKey(key); putUnsigned(value); putMore(more);
+    }
+
+#ifndef ESJ_DISABLE_DOUBLE
+    virtual void serialize(const char* key,double& value,bool more) override final
+    {
+        putKey(key); serialize(value); putMore(more);
+    }
+#endif
+
+    virtual void serialize(const char* key,bool& value,bool more) override final
+    {
+        putKey(key); put(value ? "true" : "false"); putMore(more);
+    }
+
+    virtual void serialize(const char* key,temp_t& value,bool more) override final
+    {
+        putKey(key); serialize(value); putMore(more);
+    }
+
+    virtual void serialize(const char* key,temp_precise_t& value,bool more) override final
+    {
+        putKey(key); serialize(value); putMore(more);
+    }
+
+    virtual void serialize(const char* key,temp_long_t& value,bool more) override final
+    {
+        putKey(key); serialize(value); putMore(more);
+    }
+
+    // literal, not escaped
+    virtual void serialize(const char* value) override final
+    {
+        put('"'); put(value); put('"');
+    }
+
+    virtual void serialize(TokenType type) override final
+    {
+        switch (type)
+        {
+        case T_OBJ_BEGIN:   put('{'); break;
+        case T_OBJ_END:     put('}'); break;
+        case T_ARRAY_BEGIN: put('['); break;
+        case T_ARRAY_END:   put(']'); break;
+        case T_COMMA:       put(','); break;
+        case T_COLON:       put(':'); break;
+        case T_NULL:        put("null"); break;
+        default: break;
+        }
+    }
+
+    // values
+    virtual void serialize(std::string& value) override final
+    {
+        putQuoted(value.c_str());
+    }
+
+    // wide strings are not used in the firmware, convert through the ESJ helpers
+    virtual void serialize(std::wstring& value) override final
+    {
+        put('"'); put(Chordia::escape(Chordia::w2n(value)).c_str()); put('"');
+    }
+
+    virtual void serialize(int8_t& value) override final { putSigned(value); }
+    virtual void serialize(int16_t& value) override final { putSigned(value); }
+    virtual void serialize(int32_t& value) override final { putSigned(value); }
+    virtual void serialize(uint8_t& value) override final { putUnsigned(value); }
+    virtual void serialize(uint16_t& value) override final { putUnsigned(value); }
+    virtual void serialize(uint32_t& value) override final { putUnsigned(value); }
+
+#ifndef ESJ_DISABLE_DOUBLE
+    virtual void serialize(double& value) override final
+    {
+        put(Chordia::DoubleConverter<>::Convert(value).c_str());
+    }
+#endif
+
+    virtual void serialize(bool& value) override final
+    {
+        put(value ? "true" : "false");
+    }
+
+    // fixed point values are formatted on the stack, with the same precision as toCstring()
+    virtual void serialize(temp_t& value) override final
+    {
+        char temporary[10];
+        put(value.toString(temporary, 4, sizeof(temporary)));
+    }
+
+    virtual void serialize(temp_precise_t& value) override final
+    {
+        char temporary[15];
+        put(value.toString(temporary, 8, sizeof(temporary)));
+    }
+
+    virtual void serialize(temp_long_t& value) override final
+    {
+        char temporary[15];
+        put(value.toString(temporary, 4, sizeof(temporary)));
+    }
+
+private:
+    void put(char c){
+        if(pos >= capacity){
+            if(flushFn == nullptr){
+                truncated = true;
+                return;
+            }
+            flush();
+        }
+        buf[pos++] = c;
+    }
+
+    void put(const char * s){
+        uint16_t len = strlen(s);
+        while(len > 0){
+            if(pos >= capacity){
+                if(flushFn == nullptr){
+                    truncated = true;
+                    return;
+                }
+                flush();
+            }
+            uint16_t chunk = capacity - pos;
+            if(chunk > len){
+                chunk = len;
+            }
+            memcpy(&buf[pos], s, chunk);
+            pos += chunk;
+            s += chunk;
+            len -= chunk;
+        }
+    }
+
+    // same escaping as Chordia::escape
+    void putQuoted(const char * s){
+        put('"');
+        for(; *s != '\0'; s++){
+            char c = *s;
+            switch(c){
+            case '"':
+            case '\\':
+            case '/':  put('\\'); put(c); break;
+            case '\b': put("\\b"); break;
+            case '\f': put("\\f"); break;
+            case '\n': put("\\n"); break;
+            case '\r': put("\\r"); break;
+            case '\t': put("\\t"); break;
+            default:   put(c); break;
+            }
+        }
+        put('"');
+    }
+
+    void putKey(const char * key){
+        put('"'); put(key); put('"'); put(':');
+    }
+
+    void putMore(bool more){
+        if(more){
+            put(',');
+        }
+    }
+
+    void putUnsigned(uint32_t value){
+        char digits[11];
+        char * p = &digits[sizeof(digits) - 1];
+        *p = '\0';
+        do {
+            *--p = '0' + (value % 10);
+            value /= 10;
+        } while(value);
+        put(p);
+    }
+
+    void putSigned(int32_t value){
+        if(value < 0){
+            put('-');
+            putUnsigned(uint32_t(0) - uint32_t(value));
+        }
+        else{
+            putUnsigned(value);
+        }
+    }
+
+    char * buf;
+    uint16_t capacity; // buffer size, excluding the terminating \0
+    uint16_t pos;
+    FlushFunction flushFn;
+    void * context;
+    bool truncated;
+};
+
+#if defined(SPARK) || defined(ARDUINO)
+    //-----------------------------------------------------------------------------
+    // streams the JSON through a small stack buffer. usage is:
+    // JSON::stream_producer<JSONExample>::convert(source, stream);
+    template <typename serializable_type>
+    class stream_producer
+    {
+        static void flushToStream(void * context, const char * data, uint16_t length){
+            static_cast<Stream *>(context)->write(reinterpret_cast<const uint8_t *>(data), length);
+        }
+
+        public:
+        static void convert(serializable_type * source, Stream & sink)
+        {
+            char buffer[JSON_STREAM_WRITER_BUFFER_SIZE];
+            JSON::StreamWriter writer(buffer, sizeof(buffer), flushToStream, &sink);
+            source->serialize(writer);
+            writer.flush();
+        }
+        static inline void convert(serializable_type & source, Stream & sink){
+            convert(&source, sink);
+        }
+    };
+#endif
+
+}
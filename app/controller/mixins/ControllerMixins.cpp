@@ -59,7 +59,7 @@ void PidMixin::serialize(JSON::Adapter & adapter)
     Pid * obj = static_cast<Pid *>(this);
 
     JSON::Class root(adapter, "Pid");
-    std::string name(getName());    // get name as std string for json_writer
+    const char * name = getName();
     JSON_E(adapter, name);
     JSON_OE(adapter, enabled);
     JSON_OE(adapter, setPoint);
@@ -80,7 +80,7 @@ void TempSensorMixin::serialize(JSON::Adapter & adapter)
     TempSensor * obj = static_cast<TempSensor *>(this);
 
     JSON::Class root(adapter, "TempSensor");
-    std::string name(getName());    // get name as std string for json_writer
+    const char * name = getName();
     JSON_E(adapter, name);
     JSON_OT(adapter, sensor);
 }
@@ -111,7 +111,7 @@ void OneWireTempSensorMixin::serialize(JSON::Adapter & adapter)
     char addressBuf[17];
 
     printBytes(obj -> sensorAddress, 8, addressBuf);    // print to hex string
-    std::string address(addressBuf);    // convert to std string
+    const char * address = addressBuf;
     JSON_E(adapter, address);
     JSON_OT(adapter, calibrationOffset);
 }
@@ -299,7 +299,7 @@ void SetPointSimpleMixin::serialize(JSON::Adapter & adapter)
     SetPointSimple * obj = static_cast<SetPointSimple *>(this);
 
     JSON::Class root(adapter, "SetPointSimple");
-    std::string name(getName());    // get name as std string for json_writer
+    const char * name = getName();
     JSON_E(adapter, name);
     JSON_OT(adapter, value);
 }
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Counts the heap allocations made while it is in scope, so a test can check that the code under test does not
+ * allocate. Counters can be nested, only the innermost counter sees an allocation.
+ */
+class AllocationCounter {
+public:
+    AllocationCounter() : allocations(0), outer(active) {
+        active = this;
+    }
+    ~AllocationCounter() {
+        active = outer;
+    }
+
+    AllocationCounter(const AllocationCounter &) = delete;
+    AllocationCounter & operator=(const AllocationCounter &) = delete;
+
+    uint32_t count() const {
+        return allocations;
+    }
+
+    // called by operator new
+    static void record() {
+        if(active){
+            active->allocations++;
+        }
+    }
+
+private:
+    uint32_t allocations;
+    AllocationCounter * outer;
+
+    static AllocationCounter * active;
+};
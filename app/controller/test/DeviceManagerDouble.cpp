@@ -0,0 +1,37 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DeviceManager.h"
+
+/*
+ * DeviceManager needs the pins and OneWire buses of a board. The tests of the eeprom and the device registry only need
+ * the device definitions, so the devices are accepted without installing them.
+ */
+
+DeviceManager deviceManager;
+
+void DeviceManager::setupUnconfiguredDevices(){
+}
+
+bool DeviceManager::isDeviceValid(DeviceConfig & config, DeviceConfig & original, uint8_t deviceIndex){
+    return true;
+}
+
+void DeviceManager::installDevice(DeviceConfig & config){
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "Control.h"
+#include "TempSensorMock.h"
+#include "ActuatorMocks.h"
+#include <string.h>
+
+BOOST_AUTO_TEST_SUITE(ControlTest)
+
+BOOST_AUTO_TEST_CASE(default_control_has_one_chamber_with_the_legacy_objects) {
+    Control * c = new Control();
+    BOOST_CHECK_EQUAL(c->numChambers(), 1);
+    BOOST_CHECK_EQUAL(c->numBeers(1), 2);
+    BOOST_CHECK_EQUAL(c->pids.size(), 4);
+    BOOST_CHECK_EQUAL(c->sensors.size(), 6);
+    BOOST_CHECK_EQUAL(c->actuators.size(), 3);
+    BOOST_CHECK_EQUAL(c->setpoints.size(), 3);
+    BOOST_CHECK(c->getChamber(2) == nullptr);
+    BOOST_CHECK(c->getBeer(1, 2) == &c->getChamber(1)->legacyBeer);
+    BOOST_CHECK(c->getBeer(1, 3) == nullptr);
+    BOOST_CHECK(c->getBeer(2, 2) == nullptr);
+    BOOST_CHECK_EQUAL(c->getBeer(1, 2)->heaterPid.getName(), "heater2");
+    delete c;
+}
+
+BOOST_AUTO_TEST_CASE(chambers_and_beers_are_built_from_layout) {
+    Control * c = new Control();
+    const uint8_t beers[3] = {3, 1, 4};
+    BOOST_CHECK(c->build(3, beers));
+
+    BOOST_CHECK_EQUAL(c->numChambers(), 3);
+    BOOST_CHECK_EQUAL(c->numBeers(1), 3);
+    BOOST_CHECK_EQUAL(c->numBeers(2), 2);
+    BOOST_CHECK_EQUAL(c->numBeers(3), 4);
+    BOOST_CHECK_EQUAL(c->pids.size(), 3 * 4 + 3);
+    BOOST_CHECK_EQUAL(c->actuators.size(), 3 * 3 + 3);
+
+    // objects of other chambers are prefixed with the chamber number
+    BOOST_CHECK_EQUAL(c->getChamber(1)->heaterPid.getName(), "heater1");
+    BOOST_CHECK_EQUAL(c->getChamber(2)->fridgeSensor.getName(), "c2.fridge");
+    BOOST_CHECK_EQUAL(c->getBeer(3, 4)->heaterPid.getName(), "c3.heater4");
+
+    // beer 2 is the beer of the chamber, there is one object for each name
+    BOOST_CHECK(c->getBeer(1, 2) == &c->getChamber(1)->legacyBeer);
+    BOOST_CHECK_EQUAL(c->getBeer(1, 3)->sensor.getName(), "beer3");
+    for(uint8_t i = 0; i < c->pids.size(); i++){
+        for(uint8_t j = i + 1; j < c->pids.size(); j++){
+            BOOST_CHECK(strcmp(c->pids[i]->getName(), c->pids[j]->getName()) != 0);
+        }
+    }
+
+    // update loops visit the chambers in order
+    BOOST_CHECK(c->pids[0] == &c->getChamber(1)->heaterPid);
+    BOOST_CHECK(c->pids[1] == &c->getBeer(1, 2)->heaterPid);
+    BOOST_CHECK(c->pids[2] == &c->getBeer(1, 3)->heaterPid);
+    BOOST_CHECK(c->pids[5] == &c->getChamber(2)->heaterPid);
+    BOOST_CHECK(c->pids[9] == &c->getChamber(3)->heaterPid);
+    BOOST_CHECK(c->pids[11] == &c->getBeer(3, 3)->heaterPid);
+
+    // beer heaters use the mutex group of their chamber
+    BOOST_CHECK(c->getBeer(3, 3)->heaterMutex.getMutex() == &c->getChamber(3)->mutex);
+
+    c->update();
+    c->fastUpdate();
+    delete c;
+}
+
+BOOST_AUTO_TEST_CASE(layout_that_does_not_fit_keeps_the_current_objects) {
+    Control * c = new Control();
+    ChamberControl * first = c->getChamber(1);
+    uint8_t beers[CONTROL_MAX_CHAMBERS + 1];
+    memset(beers, 1, sizeof(beers));
+    BOOST_CHECK(!c->build(CONTROL_MAX_CHAMBERS + 1, beers));
+    BOOST_CHECK_EQUAL(c->numChambers(), 1);
+    BOOST_CHECK(c->getChamber(1) == first);
+
+    beers[0] = CONTROL_MAX_BEERS + 3; // one beer above beer 2 too many
+    BOOST_CHECK(!c->build(1, beers));
+    BOOST_CHECK_EQUAL(c->numBeers(1), 2);
+    BOOST_CHECK_EQUAL(c->pids.size(), 4);
+    c->update();
+    delete c;
+}
+
+BOOST_AUTO_TEST_CASE(largest_layout_fits_in_the_reserved_room) {
+    Control * c = new Control();
+    Pid * const * pids = c->pids.data();
+    TempSensorBasic * const * sensors = c->sensors.data();
+    Actuator * const * actuators = c->actuators.data();
+    SetPoint * const * setpoints = c->setpoints.data();
+
+    // all pooled beers in the last chamber
+    uint8_t beers[CONTROL_MAX_CHAMBERS];
+    memset(beers, 2, sizeof(beers));
+    beers[CONTROL_MAX_CHAMBERS - 1] = CONTROL_MAX_BEERS + 2;
+    BOOST_REQUIRE(c->build(CONTROL_MAX_CHAMBERS, beers));
+
+    BOOST_CHECK_EQUAL(c->pids.size(), CONTROL_MAX_CHAMBERS * 4 + CONTROL_MAX_BEERS);
+    BOOST_CHECK_EQUAL(c->sensors.size(), CONTROL_MAX_CHAMBERS * 6 + CONTROL_MAX_BEERS);
+    BOOST_CHECK_EQUAL(c->actuators.size(), CONTROL_MAX_CHAMBERS * 3 + CONTROL_MAX_BEERS);
+    BOOST_CHECK_EQUAL(c->setpoints.size(), CONTROL_MAX_CHAMBERS * 3 + CONTROL_MAX_BEERS);
+    BOOST_CHECK(c->pids.data() == pids);
+    BOOST_CHECK(c->sensors.data() == sensors);
+    BOOST_CHECK(c->actuators.data() == actuators);
+    BOOST_CHECK(c->setpoints.data() == setpoints);
+    delete c;
+}
+
+BOOST_AUTO_TEST_CASE(building_the_same_layout_keeps_the_objects) {
+    Control * c = new Control();
+    const uint8_t beers[2] = {4, 1};
+    BOOST_CHECK(c->build(2, beers));
+    BeerControl * beer = c->getBeer(1, 4);
+    BOOST_CHECK(beer != nullptr);
+    beer->sensor.installSensor(new TempSensorMock(20.0));
+
+    BOOST_CHECK(c->build(2, beers));
+    BOOST_CHECK(c->getBeer(1, 4) == beer);
+    BOOST_CHECK(beer->sensor.getSensor() != defaultTempSensorBasic());
+    delete c;
+}
+
+BOOST_AUTO_TEST_CASE(room_sensor_is_separate_from_the_beers) {
+    Control * c = new Control();
+    const uint8_t beers[1] = {3};
+    BOOST_CHECK(c->build(1, beers));
+
+    TempSensor * room = (TempSensor *) c->deviceTarget(1, 1, DEVICE_CHAMBER_ROOM_TEMP);
+    TempSensor * beer1 = (TempSensor *) c->deviceTarget(1, 1, DEVICE_BEER_TEMP);
+    TempSensor * beer2 = (TempSensor *) c->deviceTarget(1, 2, DEVICE_BEER_TEMP);
+    TempSensor * beer3 = (TempSensor *) c->deviceTarget(1, 3, DEVICE_BEER_TEMP);
+    BOOST_REQUIRE(room != nullptr && beer1 != nullptr && beer2 != nullptr && beer3 != nullptr);
+    BOOST_CHECK(room != beer2 && room != beer3 && room != beer1);
+    BOOST_CHECK(beer2 == &c->getBeer(1, 2)->sensor);
+    // the room sensor belongs to the chamber, whatever beer it is configured for
+    BOOST_CHECK(c->deviceTarget(1, 2, DEVICE_CHAMBER_ROOM_TEMP) == room);
+
+    room->installSensor(new TempSensorMock(15.0));
+    beer2->installSensor(new TempSensorMock(20.0));
+    c->update();
+    BOOST_CHECK_EQUAL(room->read(), temp_t(15.0));
+    BOOST_CHECK_EQUAL(beer2->read(), temp_t(20.0));
+
+    ActuatorPwm * beerHeater = (ActuatorPwm *) c->deviceTarget(1, 1, DEVICE_BEER_HEAT);
+    ActuatorPwm * beer2Heater = (ActuatorPwm *) c->deviceTarget(1, 2, DEVICE_BEER_HEAT);
+    ActuatorPwm * beer3Heater = (ActuatorPwm *) c->deviceTarget(1, 3, DEVICE_BEER_HEAT);
+    BOOST_REQUIRE(beerHeater != nullptr && beer2Heater != nullptr && beer3Heater != nullptr);
+    // the primary beer has no heater of its own, its beer heater is the heater of beer 2 like before
+    BOOST_CHECK(beerHeater == &c->getChamber(1)->legacyBeer.heater);
+    BOOST_CHECK(beer2Heater == beerHeater);
+    BOOST_CHECK(beer3Heater == &c->getBeer(1, 3)->heater);
+
+    BOOST_CHECK(c->deviceTarget(1, 4, DEVICE_BEER_TEMP) == nullptr);
+    BOOST_CHECK(c->deviceTarget(2, 1, DEVICE_CHAMBER_TEMP) == nullptr);
+    delete c;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "DeviceRegistry.h"
+#include "EepromManager.h"
+#include <string.h>
+
+static DeviceConfig pinDevice(DeviceFunction function, uint8_t pinNr){
+    DeviceConfig config;
+    clear((uint8_t*)&config, sizeof(config));
+    config.chamber = 1;
+    config.deviceFunction = function;
+    config.deviceHardware = DEVICE_HARDWARE_PIN;
+    config.hw.pinNr = pinNr;
+    return config;
+}
+
+// address 0 configures the device without address, it matches any device on the pin
+static DeviceConfig oneWireDevice(DeviceFunction function, DeviceHardware hardware, uint8_t pinNr, uint8_t address, uint8_t pio = 0){
+    DeviceConfig config = pinDevice(function, pinNr);
+    config.deviceHardware = hardware;
+    if(address){
+        config.hw.address[0] = 0x28;
+        config.hw.address[7] = address;
+    }
+    if(hardware != DEVICE_HARDWARE_ONEWIRE_TEMP){
+        config.hw.offset.pio = pio;
+    }
+    return config;
+}
+
+// eeprom with settings and empty device slots
+struct DeviceRegistryFixture {
+    DeviceRegistryFixture(){
+        eepromAccess.erase();
+        eepromManager.initializeEeprom();
+    }
+
+    void store(device_slot_t slot, const DeviceConfig & config){
+        BOOST_REQUIRE(eepromManager.storeDevice(config, slot));
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(DeviceRegistryTest, DeviceRegistryFixture)
+
+BOOST_AUTO_TEST_CASE(eeprom_without_settings_has_no_devices){
+    eepromAccess.erase();
+    deviceRegistry.invalidate();
+
+    DeviceConfig config;
+    BOOST_CHECK(!deviceRegistry.fetch(config, 0));
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_NONE), INVALID_SLOT);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_CHAMBER_HEAT, 0)), INVALID_SLOT);
+}
+
+BOOST_AUTO_TEST_CASE(fetch_returns_the_definition_in_eeprom){
+    store(3, oneWireDevice(DEVICE_BEER_TEMP, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x11));
+
+    DeviceConfig config;
+    BOOST_REQUIRE(deviceRegistry.fetch(config, 3));
+    BOOST_CHECK_EQUAL(config.deviceFunction, DEVICE_BEER_TEMP);
+    BOOST_CHECK_EQUAL(config.hw.address[7], 0x11);
+    BOOST_CHECK(deviceRegistry.fetch(config, MAX_DEVICE_SLOT - 1));
+    BOOST_CHECK(!deviceRegistry.fetch(config, MAX_DEVICE_SLOT));
+    BOOST_CHECK(!deviceRegistry.fetch(config, INVALID_SLOT));
+}
+
+BOOST_AUTO_TEST_CASE(function_slots_hold_the_first_slot_with_each_function){
+    store(4, pinDevice(DEVICE_CHAMBER_COOL, 2));
+    store(2, pinDevice(DEVICE_CHAMBER_HEAT, 1));
+    store(6, pinDevice(DEVICE_CHAMBER_HEAT, 3));
+
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_CHAMBER_HEAT), 2);
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_CHAMBER_COOL), 4);
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_CHAMBER_FAN), INVALID_SLOT);
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_NONE), 0); // empty slots have no function
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_MAX), INVALID_SLOT);
+}
+
+BOOST_AUTO_TEST_CASE(pin_lookup_returns_the_lowest_slot_with_the_pin){
+    // stored out of pin order, so the index has to be sorted
+    store(0, pinDevice(DEVICE_CHAMBER_HEAT, 7));
+    store(1, pinDevice(DEVICE_CHAMBER_COOL, 3));
+    store(2, pinDevice(DEVICE_CHAMBER_LIGHT, 5));
+    store(3, pinDevice(DEVICE_CHAMBER_FAN, 3));
+    store(4, pinDevice(DEVICE_CHAMBER_DOOR, 0));
+
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 0)), 4);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 3)), 1);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 5)), 2);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 7)), 0);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 4)), INVALID_SLOT);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 8)), INVALID_SLOT);
+}
+
+BOOST_AUTO_TEST_CASE(address_lookup_returns_the_slot_with_the_address){
+    store(0, oneWireDevice(DEVICE_BEER_TEMP, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x30));
+    store(1, oneWireDevice(DEVICE_CHAMBER_TEMP, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x10));
+    store(2, oneWireDevice(DEVICE_CHAMBER_ROOM_TEMP, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x20));
+    store(3, oneWireDevice(DEVICE_BEER_TEMP2, DEVICE_HARDWARE_ONEWIRE_TEMP, 1, 0x40));
+
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x10)), 1);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x20)), 2);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x30)), 0);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 1, 0x40)), 3);
+    // the address has to be on the same pin
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 1, 0x10)), INVALID_SLOT);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x50)), INVALID_SLOT);
+    // and the same hardware type
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_2413, 0, 0x10)), INVALID_SLOT);
+}
+
+BOOST_AUTO_TEST_CASE(device_without_address_matches_any_address_on_its_pin){
+    store(1, oneWireDevice(DEVICE_BEER_TEMP, DEVICE_HARDWARE_ONEWIRE_TEMP, 1, 0));
+    store(2, oneWireDevice(DEVICE_CHAMBER_TEMP, DEVICE_HARDWARE_ONEWIRE_TEMP, 1, 0x10));
+    store(3, oneWireDevice(DEVICE_CHAMBER_ROOM_TEMP, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x20));
+
+    // the lowest slot wins, like a scan of all slots
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 1, 0x10)), 1);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 1, 0x50)), 1);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x20)), 3);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x50)), INVALID_SLOT);
+}
+
+BOOST_AUTO_TEST_CASE(switch_lookup_matches_the_pio){
+    store(2, oneWireDevice(DEVICE_CHAMBER_HEAT, DEVICE_HARDWARE_ONEWIRE_2413, 0, 0x10, 0));
+    store(5, oneWireDevice(DEVICE_CHAMBER_COOL, DEVICE_HARDWARE_ONEWIRE_2413, 0, 0x10, 1));
+
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_2413, 0, 0x10, 0)), 2);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_2413, 0, 0x10, 1)), 5);
+}
+
+BOOST_AUTO_TEST_CASE(no_hardware_is_never_found){
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 0)), INVALID_SLOT);
+
+    DeviceConfig none = pinDevice(DEVICE_NONE, 0);
+    none.deviceHardware = DEVICE_HARDWARE_NONE;
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(none), INVALID_SLOT);
+}
+
+BOOST_AUTO_TEST_CASE(lookups_do_not_read_eeprom_once_loaded){
+    store(1, pinDevice(DEVICE_CHAMBER_HEAT, 3));
+    deviceRegistry.findFunction(DEVICE_CHAMBER_HEAT);
+
+    eepromAccess.resetReads();
+    DeviceConfig config;
+    BOOST_CHECK(deviceRegistry.fetch(config, 1));
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_CHAMBER_HEAT), 1);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 3)), 1);
+    BOOST_CHECK_EQUAL(eepromAccess.getReads(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(store_device_invalidates_the_registry){
+    store(1, pinDevice(DEVICE_CHAMBER_HEAT, 3));
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 3)), 1);
+
+    store(1, pinDevice(DEVICE_CHAMBER_COOL, 4));
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 3)), INVALID_SLOT);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 4)), 1);
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_CHAMBER_HEAT), INVALID_SLOT);
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_CHAMBER_COOL), 1);
+}
+
+BOOST_AUTO_TEST_CASE(zap_eeprom_invalidates_the_registry){
+    store(1, pinDevice(DEVICE_CHAMBER_HEAT, 3));
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_CHAMBER_HEAT), 1);
+
+    eepromManager.zapEeprom();
+    DeviceConfig config;
+    BOOST_CHECK(!deviceRegistry.fetch(config, 1));
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_CHAMBER_HEAT), INVALID_SLOT);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(pinDevice(DEVICE_NONE, 3)), INVALID_SLOT);
+}
+
+BOOST_AUTO_TEST_CASE(initialize_eeprom_invalidates_the_registry){
+    store(1, oneWireDevice(DEVICE_BEER_TEMP, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x10));
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_BEER_TEMP), 1);
+
+    eepromManager.initializeEeprom();
+    DeviceConfig config;
+    BOOST_REQUIRE(deviceRegistry.fetch(config, 1));
+    BOOST_CHECK_EQUAL(config.deviceFunction, DEVICE_NONE);
+    BOOST_CHECK_EQUAL(deviceRegistry.findFunction(DEVICE_BEER_TEMP), INVALID_SLOT);
+    BOOST_CHECK_EQUAL(deviceRegistry.findHardware(oneWireDevice(DEVICE_NONE, DEVICE_HARDWARE_ONEWIRE_TEMP, 0, 0x10)), INVALID_SLOT);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include <string>
+#include <chrono>
+
+#include "ActuatorMocks.h"
+#include "ActuatorPwm.h"
+#include "SetPoint.h"
+#include "TempSensorMock.h"
+#include "Pid.h"
+#include "Control.h"
+#include "json_writer.h"
+#include "json_stream_writer.h"
+#include "AllocationCounter.h"
+
+static void appendTo(void * context, const char * data, uint16_t length){
+    static_cast<std::string *>(context)->append(data, length);
+}
+
+BOOST_AUTO_TEST_SUITE(JsonStreamWriterTest)
+
+BOOST_AUTO_TEST_CASE(output_is_identical_to_esj_writer) {
+    Control * control = new Control();
+    std::string esj = JSON::producer<Control>::convert(control);
+
+    char buffer[4096];
+    JSON::StreamWriter writer(buffer, sizeof(buffer));
+    control->serialize(writer);
+
+    BOOST_CHECK(!writer.overflow());
+    BOOST_CHECK_EQUAL(esj, writer.c_str());
+    delete control;
+}
+
+BOOST_AUTO_TEST_CASE(strings_are_escaped_like_esj) {
+    SetPointSimple sp(20.0);
+    sp.setName("a\"b/c\\");
+
+    std::string esj = JSON::producer<SetPointSimple>::convert(sp);
+    char buffer[128];
+    JSON::StreamWriter writer(buffer, sizeof(buffer));
+    sp.serialize(writer);
+
+    BOOST_CHECK_EQUAL(esj, writer.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(full_buffer_truncates_without_flush_function) {
+    SetPointSimple sp(20.0);
+    char buffer[11];
+    JSON::StreamWriter writer(buffer, sizeof(buffer));
+    sp.serialize(writer);
+
+    BOOST_CHECK(writer.overflow());
+    BOOST_CHECK_EQUAL(writer.length(), 10);
+    BOOST_CHECK_EQUAL(writer.c_str(), "{\"kind\":\"S");
+}
+
+BOOST_AUTO_TEST_CASE(small_buffer_is_flushed_when_full) {
+    Control * control = new Control();
+    std::string esj = JSON::producer<Control>::convert(control);
+
+    std::string streamed;
+    char buffer[8];
+    JSON::StreamWriter writer(buffer, sizeof(buffer), appendTo, &streamed);
+    control->serialize(writer);
+    writer.flush();
+
+    BOOST_CHECK(!writer.overflow());
+    BOOST_CHECK_EQUAL(esj, streamed);
+    delete control;
+}
+
+BOOST_AUTO_TEST_CASE(serializing_control_does_not_allocate) {
+    Control * control = new Control();
+    char buffer[4096];
+
+    {
+        AllocationCounter allocations;
+        JSON::StreamWriter writer(buffer, sizeof(buffer));
+        control->serialize(writer);
+        BOOST_CHECK_EQUAL(allocations.count(), 0u);
+    }
+    {
+        AllocationCounter allocations;
+        JSON::producer<Control>::convert(control);
+        BOOST_TEST_MESSAGE("ESJ writer allocations for Control: " << allocations.count());
+    }
+    delete control;
+}
+
+// not part of the default run, run it with --run_test=JsonStreamWriterTest/benchmark_stream_writer_against_esj
+BOOST_AUTO_TEST_CASE(benchmark_stream_writer_against_esj, * boost::unit_test::disabled()) {
+    Control * control = new Control();
+    const int iterations = 2000;
+    char buffer[4096];
+    uint32_t checksum = 0; // prevent the serialization from being optimized away
+
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < iterations; i++){
+        std::string json = JSON::producer<Control>::convert(control);
+        checksum += json.size();
+    }
+    auto esjTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < iterations; i++){
+        JSON::StreamWriter writer(buffer, sizeof(buffer));
+        control->serialize(writer);
+        checksum -= writer.length();
+    }
+    auto streamTime = std::chrono::steady_clock::now() - start;
+
+    BOOST_CHECK_EQUAL(checksum, 0u);
+    BOOST_TEST_MESSAGE("Control::serialize x" << iterations
+            << ": ESJ writer " << std::chrono::duration_cast<std::chrono::microseconds>(esjTime).count() << " us"
+            << ", stream writer " << std::chrono::duration_cast<std::chrono::microseconds>(streamTime).count() << " us");
+    delete control;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -22,6 +22,7 @@ CPPSRC += $(call target_files,lib/src,*.cpp)
 CPPSRC += $(call target_files,lib/src,*.cpp)
 
 CPPSRC += $(call target_files,platform/spark/modules/Adafruit_ILI9341,*.cpp)
+CPPSRC += platform/spark/modules/ParticleSpiSink.cpp
 CPPSRC += $(call target_files,platform/spark/modules/Adafruit_mfGFX,*.cpp)
 CPPSRC += $(call target_files,platform/spark/modules/OneWire,*.cpp)
 CPPSRC += $(call target_files,platform/spark/modules/ScrollBox,*.cpp)
@@ -20,6 +20,12 @@ result=$?
 popd
 status $result
 
+pushd lib/sim
+make
+result=$?
+popd
+status $result
+
 pushd platform/spark 
 ./build-all.sh
 result=$?
@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include "temperatureFormats.h"
 #include "ControllerMixins.h"
+#include "ChangeNotifier.h"
 
 enum {
     ACTUATOR_RANGE,
@@ -63,6 +64,25 @@ public:
     virtual void setActive(bool active) = 0;
     virtual bool isActive() const = 0;
 
+    /*
+     * Listeners are notified of changes of isActive(), implementations publish at the end of setActive()
+     */
+    void subscribe(ChangeListener<bool> & listener){
+        changes.subscribe(listener);
+    }
+
+    void unsubscribe(ChangeListener<bool> & listener){
+        changes.unsubscribe(listener);
+    }
+
+protected:
+    void publishChange(){
+        changes.publish(isActive());
+    }
+
+private:
+    ChangeNotifier<bool> changes;
+
     friend class ActuatorDigitalMixin;
 };
 
@@ -81,6 +101,25 @@ public:
     virtual temp_t readValue() const = 0; // read actual achieved value
     virtual temp_t min() const = 0;
     virtual temp_t max() const = 0;
+
+    /*
+     * Listeners are notified of changes of readValue(), implementations publish at the end of update()
+     */
+    void subscribe(ChangeListener<temp_t> & listener){
+        changes.subscribe(listener);
+    }
+
+    void unsubscribe(ChangeListener<temp_t> & listener){
+        changes.unsubscribe(listener);
+    }
+
+protected:
+    void publishChange(){
+        changes.publish(readValue());
+    }
+
+private:
+    ChangeNotifier<temp_t> changes;
 };
 
 /*
@@ -56,7 +56,12 @@ public:
     temp_t getValue() const override final {
         return value;
     }
-    void update() override final {}
+    temp_t readValue() const override final {
+        return value; // the mock reaches the set value immediately
+    }
+    void update() override final {
+        publishChange();
+    }
     void fastUpdate() override final {}
 
     temp_t min() const override final {
@@ -85,7 +90,10 @@ public:
     ActuatorBool(bool initial) : state(initial) {}
     ~ActuatorBool() = default;
 
-    void setActive(bool active) override final { state = active; }
+    void setActive(bool active) override final {
+        state = active;
+        publishChange();
+    }
     bool isActive() const override final { return state; }
 
     void update() override final {}
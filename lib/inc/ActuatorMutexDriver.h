@@ -32,8 +32,8 @@
 
 class ActuatorMutexDriver final : public ActuatorForwarder, public ActuatorDigital, public ActuatorMutexDriverMixin{
 public:
-    ActuatorMutexDriver(ActuatorDigital * target) : ActuatorForwarder(target), mutexGroup(nullptr){}
-    ActuatorMutexDriver(ActuatorDigital * target, ActuatorMutexGroup * m) : ActuatorForwarder(target), mutexGroup(m){}
+    ActuatorMutexDriver(ActuatorDigital * target) : ActuatorForwarder(target), mutexGroup(nullptr), load(0){}
+    ActuatorMutexDriver(ActuatorDigital * target, ActuatorMutexGroup * m) : ActuatorForwarder(target), mutexGroup(m), load(0){}
 
     ~ActuatorMutexDriver(){
         setMutex(nullptr);
@@ -54,11 +54,30 @@ public:
             mutexGroup->unRegisterActuator(this);
         }
         mutexGroup = mutex;
+        if(mutexGroup != nullptr && load != 0){
+            mutexGroup->setLoad(this, load);
+        }
     }
     ActuatorMutexGroup * getMutex(){
         return mutexGroup;
     }
 
+    // power used by the target when active in W, used by a mutex group with a power budget
+    void setLoad(uint16_t watts){
+        load = watts;
+        if(mutexGroup != nullptr){
+            mutexGroup->setLoad(this, load);
+        }
+    }
+    uint16_t getLoad() const {
+        return load;
+    }
+
+    // whether a PWM actuator driving this actuator should start its period now, to stagger the actuators in the group
+    bool inPhase(ticks_millis_t period){
+        return mutexGroup ? mutexGroup->inPhase(this, period) : true;
+    }
+
     // To activate actuator, permission is asked from mutexGroup, false is always allowed
     void setActive(bool active, int8_t priority) {
         if(mutexGroup){
@@ -73,6 +92,7 @@ public:
         else{
             target->setActive(active); // if mutex group is not set, just pass on the call
         }
+        publishChange();
     }
 
     void setActive(bool active) override final{
@@ -85,6 +105,7 @@ public:
 
 private:
     ActuatorMutexGroup * mutexGroup;
+    uint16_t load;
 
 friend class ActuatorMutexDriverMixin;
 };
@@ -26,21 +26,44 @@
 
 struct ActuatorPriority{
     ActuatorDigital * actuator;
-    int8_t priority; // valid priorities are 0-127, at -128 the actuator is removed from the group
+    int8_t priority; // valid priorities are 0-127, at -1 the actuator has no open request
+    uint8_t heapIndex; // position in the request heap, NOT_QUEUED when the actuator has no open request
+    uint16_t load; // power used when active, in W
+    bool granted; // the group allowed the actuator to go active and it has not gone inactive since
 };
 
+/**
+ * Decides which actuators in a group may be active at the same time.
+ *
+ * Without a power budget (the default), at most one actuator is active: the mutex that keeps a heater and a cooler
+ * from running together. After an actuator was active, others have to wait for the dead time.
+ *
+ * With a power budget, actuators are active together as long as their total load fits in the budget, for example
+ * several heating elements on one circuit. A request is refused when it would use power reserved for waiting
+ * requests with a higher priority, so a large load is not starved by smaller ones. The dead time is not used.
+ * PWM actuators in the group are staggered: each one starts its period in its own slot of the period, so their
+ * on-times interleave instead of all starting together.
+ *
+ * Open requests are kept in a binary heap ordered by priority, so a request only visits the requests with a
+ * higher priority. The group keeps track of the load of the actuators it allowed to go active.
+ */
 class ActuatorMutexGroup final : public ActuatorMutexGroupMixin
 {
 public:
+    static const uint8_t NOT_QUEUED = 0xFF;
+
     ActuatorMutexGroup(){
         deadTime = 0;
         lastActiveTime = 0;
         lastActiveActuator = nullptr;
+        powerBudget = 0;
+        grantedLoad = 0;
+        phaseOrigin = ticks.millis();
     }
 
     ~ActuatorMutexGroup() = default;
 
-    ActuatorPriority * registerActuator(ActuatorDigital * act, int8_t prio);
+    ActuatorPriority * registerActuator(ActuatorDigital * act, int8_t prio, uint16_t load = 0);
     void unRegisterActuator(size_t index); // remove by index
     void unRegisterActuator(ActuatorDigital * act); // remove by pointer
 
@@ -63,13 +86,58 @@ public:
 
     ticks_millis_t getWaitTime();
 
+    /**
+     * Sets the total power that active actuators can use, in W. 0 allows only one active actuator.
+     */
+    void setPowerBudget(uint16_t watts){
+        powerBudget = watts;
+    }
+
+    uint16_t getPowerBudget() const {
+        return powerBudget;
+    }
+
+    // sets the power an actuator uses when active, registers the actuator when it is not in the group yet
+    void setLoad(ActuatorDigital * act, uint16_t watts);
+
+    // total load of the actuators that are allowed to be active
+    uint16_t getActiveLoad() const {
+        return grantedLoad;
+    }
+
+    /**
+     * Whether a PWM actuator with the given period is in its slot to start a period. The period is divided in a slot
+     * for each actuator in the group. Always true without a power budget.
+     */
+    bool inPhase(ActuatorDigital * act, ticks_millis_t period);
+
     void update();
 
 private:
+    void setPriority(size_t index, int8_t priority);
+    void grant(ActuatorPriority & entry);
+    void revoke(ActuatorPriority & entry);
+
+    // heap of the indexes of the actuators with an open request, highest priority first
+    void heapSwap(uint8_t a, uint8_t b);
+    void siftUp(uint8_t pos);
+    void siftDown(uint8_t pos);
+    void heapRemove(uint8_t pos);
+
+    /*
+     * Sum of the loads of the waiting requests with a higher priority than prio, except for skip.
+     * Only visits the part of the heap with a higher priority. Without a power budget, each request counts as 1.
+     */
+    uint32_t reservedAbove(int8_t prio, const ActuatorPriority * skip, uint8_t pos = 0) const;
+
     ticks_millis_t deadTime; // minimum time between switching from one actuator to the other
     ticks_millis_t lastActiveTime;
     ActuatorDigital * lastActiveActuator;
     std::vector<ActuatorPriority> actuatorPriorities;
+    std::vector<uint8_t> requestHeap;
+    ticks_millis_t phaseOrigin; // start of the first period of the slots for staggered PWM
+    uint16_t powerBudget;
+    uint16_t grantedLoad;
 
 friend class ActuatorMutexGroupMixin;
 };
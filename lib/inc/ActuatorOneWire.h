@@ -26,10 +26,12 @@
 #include "ActuatorInterfaces.h"
 #include "DS2413.h"
 #include "ControllerMixins.h"
+#include "BlockPool.h"
 
 /*
  * An actuator or sensor that operates by communicating with a DS2413 device.
- *
+ * Actuators on PIO A and PIO B of the same chip share the DS2413, so it is read once per control cycle and
+ * changes to both latches are written together when the switches are flushed.
  */
 class ActuatorOneWire final:
     public ActuatorDigital, public ActuatorOneWireMixin
@@ -41,16 +43,26 @@ class ActuatorOneWire final:
 
 {
     public:
+        ActuatorOneWire() : device(nullptr), pio(0), invert(true)
+        {
+        }
         ActuatorOneWire(OneWire *     bus,
                         DeviceAddress address,
                         pio_t         pio,
-                        bool          invert = true)
+                        bool          invert = true) : device(nullptr)
         {
             init(bus, address, pio, invert);
         }
-        ~ActuatorOneWire() = default;
+        ~ActuatorOneWire()
+        {
+            OneWireSwitch::release(device);
+        }
 
-        void init(OneWire *     bus,
+        /*
+         * Acquires the shared DS2413.
+         * /return false when the pool of switches is full. The actuator then stays inactive and ignores writes.
+         */
+        bool init(OneWire *     bus,
                   DeviceAddress address,
                   pio_t         pio,
                   bool          invert = true)
@@ -58,42 +70,61 @@ class ActuatorOneWire final:
             this -> invert = invert;
             this -> pio    = pio;
 
-            device.init(bus, address);
-            device.update();
+            OneWireSwitch::release(device);
+            device = OneWireSwitch::acquire<DS2413>(bus, address);
+            if (device == nullptr){
+                return false;
+            }
+            device -> refresh();
+            return true;
         }
 
         void setActive(bool active) override final
         {
-            // todo: alarm when write fails
-            device.latchWrite(pio, active ^ invert, true);
+            if (device == nullptr){
+                return;
+            }
+            // written on the next flush. todo: alarm when write fails
+            device -> latchWriteDeferred(pio, active ^ invert);
+            publishChange();
         }
 
         bool isActive() const override final
         {
-            return device.latchReadCached(pio, false) ^ invert;
+            return device != nullptr && (device -> latchReadCached(pio, false) ^ invert);
         }
 
 #if DS2413_SUPPORT_SENSE
         bool sense()
         {
-            device.latchWrite(pio, 0, false);
+            if (device == nullptr){
+                return invert;
+            }
+            device -> latchWrite(pio, 0, false);
 
-            return device.sense(pio, invert);    // on device failure, default is high for invert, low for regular.
+            return device -> sense(pio, invert);    // on device failure, default is high for invert, low for regular.
         }
 #endif
         void write(uint8_t val) {
             setActive(val != 0);
+            if (device != nullptr){
+                device -> flush();
+            }
         };
 
         void update() override final{
-            device.update();
+            if (device != nullptr){
+                device -> refresh();
+                device -> flush();
+            }
         }
 
         void fastUpdate() override final {} // no actions needed
 
+        POOL_ALLOCATED
 
     private:
-        DS2413 device;
+        DS2413 * device; // shared with the actuator on the other PIO
         pio_t  pio;
         bool   invert;
 
@@ -28,6 +28,12 @@
 
 #include "ActuatorForwarder.h"
 #include "ControllerMixins.h"
+#include "Profiling.h"
+
+// an edge that is made this many ms later than planned is counted as missed
+#ifndef PWM_EDGE_TOLERANCE
+#define PWM_EDGE_TOLERANCE (10)
+#endif
 
 #undef min
 #undef max
@@ -111,6 +117,7 @@ public:
     void update() override final {
         target->update();
         fastUpdate();
+        publishChange();
     };
 
     /** returns the PWM period
@@ -128,6 +135,20 @@ public:
         period_ms = int32_t(sec) * 1000;
     }
 
+#if BREWPI_PROFILING
+    /** Returns the number of edges of all PWM actuators that were made later than PWM_EDGE_TOLERANCE.
+     * Late edges are compensated in the next cycle, but many late edges show that the main loop does not update
+     * the actuators often enough and that the achieved duty cycle drifts.
+     */
+    static uint32_t missedEdges(){
+        return missedEdgeCount;
+    }
+
+    static void resetMissedEdges(){
+        missedEdgeCount = 0;
+    }
+#endif
+
 
 
 private:
@@ -138,11 +159,28 @@ private:
      */
     int8_t priority();
 
+    /** Checks with the mutex group whether a new period can start now. Staggers the periods of the PWM actuators in
+     * a group with a power budget, so their high times interleave. Waiting for the slot makes the period longer,
+     * which is compensated like any other late period.
+     * @return true when the period can start
+     */
+    bool inPhase();
+
     /** Calculates duty time based on expected period
      * @param expectedPeriod estimate of the duration of the period in ms
      * @return duration of the high period in ms
      */
     int32_t calculateDutyTime(int32_t expectedPeriod);
 
+#if BREWPI_PROFILING
+    static void checkEdge(int32_t late){
+        if(late > PWM_EDGE_TOLERANCE){
+            missedEdgeCount++;
+        }
+    }
+
+    static uint32_t missedEdgeCount;
+#endif
+
     friend class ActuatorPwmMixin;
 };
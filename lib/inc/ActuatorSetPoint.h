@@ -86,7 +86,9 @@ public:
         maximum = max;
     }
 
-    void update() override final {}; //no actions required
+    void update() override final {
+        publishChange();
+    };
     void fastUpdate() override final {}; //no actions required
 
 private:
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+/*
+ * Usage statistics of a pool. All pools are kept in a list, so they can be reported together.
+ */
+class PoolStatistics {
+public:
+    PoolStatistics(const char * name, uint8_t capacity);
+    ~PoolStatistics();
+
+    PoolStatistics(const PoolStatistics &) = delete;
+    PoolStatistics & operator=(const PoolStatistics &) = delete;
+
+    const char * getName() const {
+        return name;
+    }
+
+    uint8_t getCapacity() const {
+        return capacity;
+    }
+
+    uint8_t getUsed() const {
+        return used;
+    }
+
+    // maximum number of blocks in use at the same time since startup
+    uint8_t getHighWater() const {
+        return highWater;
+    }
+
+    // number of allocations that failed because the pool was full
+    uint16_t getFailures() const {
+        return failures;
+    }
+
+    PoolStatistics * getNext() const {
+        return next;
+    }
+
+    static PoolStatistics * first() {
+        return list;
+    }
+
+    void allocated() {
+        used++;
+        if (used > highWater) {
+            highWater = used;
+        }
+    }
+
+    void released() {
+        used--;
+    }
+
+    void failed() {
+        failures++;
+    }
+
+private:
+    const char * name;
+    uint8_t capacity;
+    uint8_t used;
+    uint8_t highWater;
+    uint16_t failures;
+    PoolStatistics * next;
+
+    static PoolStatistics * list;
+};
+
+/*
+ * Heap usage in bytes, as reported by the C library. Both are 0 when the C library does not report them.
+ */
+struct HeapStatistics {
+    uint32_t used; // bytes allocated now
+    uint32_t highWater; // size of the heap arena, which only grows
+};
+
+HeapStatistics heapStatistics();
+
+/*
+ * Fixed capacity pool of N blocks of Size bytes.
+ * Allocate and release take constant time. Released blocks are kept in a free list that is linked through the
+ * blocks themselves. Blocks that were never handed out are taken in order, so construction does not touch the blocks.
+ * Because all blocks have the same size, allocating and releasing in any order cannot fragment the pool.
+ */
+template<size_t Size, size_t Align, uint8_t N>
+class BlockPool {
+public:
+    BlockPool(const char * name) : freeList(nullptr), unused(0), stats(name, N) {}
+    ~BlockPool() = default;
+
+    BlockPool(const BlockPool &) = delete;
+    BlockPool & operator=(const BlockPool &) = delete;
+
+    /*
+     * /return a block of Size bytes or nullptr when all blocks are in use
+     */
+    void * allocate() {
+        Block * block = freeList;
+        if (block != nullptr) {
+            freeList = block->next;
+        }
+        else if (unused < N) {
+            block = &blocks[unused++];
+        }
+        else {
+            stats.failed();
+            return nullptr;
+        }
+        stats.allocated();
+        return block;
+    }
+
+    void release(void * p) {
+        if (p == nullptr) {
+            return;
+        }
+        Block * block = static_cast<Block *>(p);
+        block->next = freeList;
+        freeList = block;
+        stats.released();
+    }
+
+    const PoolStatistics & statistics() const {
+        return stats;
+    }
+
+private:
+    union Block {
+        Block * next;
+        typename std::aligned_storage<Size, Align>::type storage;
+    };
+
+    Block blocks[N];
+    Block * freeList;
+    uint8_t unused; // blocks at the end of the array that have never been allocated
+    PoolStatistics stats;
+};
+
+/*
+ * Declares a class specific operator new and delete that allocate objects of the class from a pool.
+ * Put it in the class body. Existing new and delete expressions for the class then use the pool, and new
+ * returns nullptr when the pool is full.
+ * The pool is defined with POOL_ALLOCATION in the source file of the class.
+ */
+#define POOL_ALLOCATED \
+    public: \
+        static void * operator new(size_t size) noexcept; \
+        static void operator delete(void * p) noexcept;
+
+/*
+ * Defines the pool with N objects and the operators declared by POOL_ALLOCATED for class T.
+ * The pool is a static object, objects of the class should not be created before main.
+ */
+#define POOL_ALLOCATION(T, N) \
+    static BlockPool<sizeof(T), alignof(T), N> T##Pool(#T); \
+    void * T::operator new(size_t size) noexcept { \
+        return T##Pool.allocate(); \
+    } \
+    void T::operator delete(void * p) noexcept { \
+        T##Pool.release(p); \
+    }
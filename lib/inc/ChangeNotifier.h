@@ -0,0 +1,194 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "temperatureFormats.h"
+
+/*
+ * Change notification for values that are refreshed periodically, like sensor readings and actuator states.
+ *
+ * The object that owns the value publishes it each time it is refreshed. A listener is only notified when the value
+ * moved more than its deadband away from the value it was last notified of, or when the value becomes valid or
+ * invalid. A consumer that subscribes does not have to read the value every second to find out whether it changed.
+ *
+ * Listeners are called by the object that publishes, for the control objects that is the control thread while it
+ * holds the ControlLock. Subscribe and unsubscribe under that lock and keep changed() short, ChangeFlag only stores
+ * the value for a consumer in another thread.
+ */
+
+// @return true when value differs enough from the last notified value to notify a listener
+inline bool exceedsDeadband(bool value, bool last, bool /*deadband*/){
+    return value != last;
+}
+
+inline bool exceedsDeadband(temp_t const & value, temp_t const & last, temp_t const & deadband){
+    if(value.isDisabledOrInvalid() || last.isDisabledOrInvalid()){
+        return value.getRaw() != last.getRaw();
+    }
+    int32_t diff = int32_t(value.getRaw()) - int32_t(last.getRaw());
+    if(diff < 0){
+        diff = -diff;
+    }
+    return diff > int32_t(deadband.getRaw());
+}
+
+template<typename T> class ChangeNotifier;
+
+template<typename T>
+class ChangeListener {
+public:
+    explicit ChangeListener(T const & deadband) :
+        deadband(deadband),
+        source(nullptr),
+        next(nullptr),
+        notified(false)
+    {
+    }
+
+    virtual ~ChangeListener(){
+        unsubscribe();
+    }
+
+    ChangeListener(const ChangeListener &) = delete;
+    ChangeListener & operator=(const ChangeListener &) = delete;
+
+    virtual void changed(T const & value) = 0;
+
+    void setDeadband(T const & newDeadband){
+        deadband = newDeadband;
+    }
+
+    bool isSubscribed() const {
+        return source != nullptr;
+    }
+
+    // unsubscribes from the notifier it is subscribed to. Safe after that notifier was destroyed.
+    void unsubscribe(){
+        if(source){
+            source->unsubscribe(*this);
+        }
+    }
+
+private:
+    T last;
+    T deadband;
+    ChangeNotifier<T> * source;
+    ChangeListener<T> * next;
+    bool notified; // last is only valid after the first notification
+
+    friend class ChangeNotifier<T>;
+};
+
+/*
+ * Keeps a list of listeners in the listeners themselves, so an object without listeners only pays for one pointer.
+ */
+template<typename T>
+class ChangeNotifier {
+public:
+    ChangeNotifier() : listeners(nullptr) {}
+
+    // a copy of the owner does not take over the listeners
+    ChangeNotifier(const ChangeNotifier &) : listeners(nullptr) {}
+
+    ChangeNotifier & operator=(const ChangeNotifier &){
+        return *this;
+    }
+
+    ~ChangeNotifier(){
+        while(listeners){
+            unsubscribe(*listeners);
+        }
+    }
+
+    // the listener is notified of the next published value, even when it is within the deadband
+    void subscribe(ChangeListener<T> & listener){
+        if(listener.source == this){
+            return;
+        }
+        if(listener.source){
+            listener.source->unsubscribe(listener);
+        }
+        listener.notified = false;
+        listener.source = this;
+        listener.next = listeners;
+        listeners = &listener;
+    }
+
+    void unsubscribe(ChangeListener<T> & listener){
+        for(ChangeListener<T> ** p = &listeners; *p; p = &(*p)->next){
+            if(*p == &listener){
+                *p = listener.next;
+                listener.next = nullptr;
+                listener.source = nullptr;
+                return;
+            }
+        }
+    }
+
+    void publish(T const & value){
+        ChangeListener<T> * listener = listeners;
+        while(listener){
+            ChangeListener<T> * next = listener->next; // the listener can unsubscribe itself
+            if(!listener->notified || exceedsDeadband(value, listener->last, listener->deadband)){
+                listener->last = value;
+                listener->notified = true;
+                listener->changed(value);
+            }
+            listener = next;
+        }
+    }
+
+    bool hasListeners() const {
+        return listeners != nullptr;
+    }
+
+private:
+    ChangeListener<T> * listeners;
+};
+
+/*
+ * A listener that keeps the newest value until the consumer takes it, for consumers that run at their own pace.
+ * Take the value under the lock that the publisher holds.
+ */
+template<typename T>
+class ChangeFlag final : public ChangeListener<T> {
+public:
+    explicit ChangeFlag(T const & deadband) : ChangeListener<T>(deadband), pending(false) {}
+    ~ChangeFlag() = default;
+
+    void changed(T const & newValue) override final {
+        value = newValue;
+        pending = true;
+    }
+
+    // @return true once after each change, value is set to the newest value
+    bool take(T & newValue){
+        if(!pending){
+            return false;
+        }
+        pending = false;
+        newValue = value;
+        return true;
+    }
+
+private:
+    T value;
+    bool pending;
+};
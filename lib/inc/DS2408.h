@@ -22,6 +22,7 @@
 
 #include <inttypes.h>
 #include "OneWireSwitch.h"
+#include "BlockPool.h"
 
 typedef uint8_t pio_t;
 
@@ -38,7 +39,7 @@ typedef uint8_t pio_t;
 class DS2408 : public OneWireSwitch {
 public:
 
-    DS2408() {
+    DS2408() : latches(0xFF), latchesKnown(false) {
     }
 
     ~DS2408() {
@@ -110,6 +111,34 @@ public:
         return accessWrite(values);
     }
 
+    /*
+     * Reads the pin state from the device and saves it to the cache.
+     */
+    void update();
+
+    /*
+     * Reads the pin state from the device, unless it was already read in this control cycle.
+     */
+    void refresh() {
+        if (!isRefreshed()) {
+            update();
+        }
+    }
+
+    /*
+     * Sets the latches in mask to values. Changes to multiple PIOs are combined in a single write by flush().
+     * /param values 1 to switch the pin off, 0 to switch on.
+     */
+    void latchWriteDeferred(uint8_t mask, uint8_t values) {
+        writeLatchesDeferred(mask, values);
+    }
+
+    bool flush() override final;
+
+    POOL_ALLOCATED
+
 private:
+    uint8_t latches; // last value written to the output latches
+    bool latchesKnown;
 
 };
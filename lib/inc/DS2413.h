@@ -24,6 +24,7 @@
 
 #include "OneWireSwitch.h"
 #include "Logger.h"
+#include "BlockPool.h"
 
 typedef uint8_t pio_t;
 
@@ -45,7 +46,7 @@ class DS2413:
     public OneWireSwitch
 {
 public:
-    DS2413() : cachedState(0), connected(false)
+    DS2413() : connected(false)
     {
     }
 
@@ -67,6 +68,20 @@ public:
                     bool  set,
                     bool  useCached);
 
+    /**
+     * Sets the latch for a given PIO without writing it to the device.
+     * Changes to both PIOs are combined in a single write by flush().
+     * @param pio           channel/pin to write
+     * @param set           1 to switch the open drain ON (pin low), 0 to switch it off.
+     */
+    void latchWriteDeferred(pio_t pio,
+                            bool  set)
+    {
+        writeLatchesDeferred(latchWriteMask(pio), set ? 0 : latchWriteMask(pio));
+    }
+
+    bool flush() override final;
+
     /**
      * Read the latch state of an output. True means latch is active
      * @param pio               pin number to read
@@ -86,9 +101,20 @@ public:
      */
     void update();
 
+    /**
+     * Reads the state from the device, unless it was already read in this control cycle.
+     */
+    void refresh()
+    {
+        if (!isRefreshed() || !cacheIsValid())
+        {
+            update();
+        }
+    }
+
+    POOL_ALLOCATED
 
 private:
-    uint8_t cachedState; /** last value of read */
     bool connected; /** stores whether last read was succesful */
 
     // assumes pio is either 0 or 1, which translates to masks 0x8 and 0x2
@@ -106,9 +132,9 @@ private:
     /*
      * Writes all a bit field of all channel latch states
      */
-    inline bool channelWriteAll(uint8_t values)
+    inline bool channelWriteAll(uint8_t values, uint8_t * status = nullptr)
     {
-        return accessWrite(values);
+        return accessWrite(values, 3, status);
     }
 
     /**
@@ -117,6 +143,11 @@ private:
      */
     uint8_t writeByteFromCache();
 
+    /**
+     * Writes the pending latch changes, assuming the cache is valid.
+     */
+    bool writePending();
+
 #if DS2413_SUPPORT_SENSE
 
 public:
@@ -64,6 +64,7 @@
 
 #include <inttypes.h>
 #include "OneWire.h"
+#include "BlockPool.h"
 
 // Model IDs
 #if REQUIRESDS18S20MODEL
@@ -220,6 +221,10 @@ class DallasTemperature
   int16_t getTemp(const uint8_t* address) { return getTempRaw(address); }
   
   int16_t getTempRaw(const uint8_t* deviceAddress);  // changed return type from uint32 to int16 (Elco, BrewPi)
+
+  // returns the raw temperature from a scratchpad that was read by the caller, for example in a queued transaction.
+  // Returns DEVICE_DISCONNECTED_RAW when the crc does not match or a reset has been detected.
+  int16_t getTempRaw(const uint8_t* deviceAddress, uint8_t* scratchPad);
   
 #if REQUIRESTEMPCONVERSION
   // returns temperature in degrees C
@@ -318,7 +323,12 @@ class DallasTemperature
 
   // delete memory reference
   void operator delete(void*);
-  
+
+  #else
+
+  // objects are allocated from a fixed pool
+  POOL_ALLOCATED
+
   #endif
 
   private:
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "BlockPool.h"
+
+/*
+ * Capacity of the pools for devices that are created when devices are installed.
+ * Together the pools hold more devices than there are device slots, so a slot can be reconfigured to another type
+ * while the other slots are in use. Each pool can be resized by defining its macro in the build.
+ */
+
+#ifndef ONEWIRE_TEMP_SENSOR_POOL_SIZE
+#define ONEWIRE_TEMP_SENSOR_POOL_SIZE (12)
+#endif
+
+// each OneWire temp sensor has its own DallasTemperature driver
+#ifndef DALLAS_TEMPERATURE_POOL_SIZE
+#define DALLAS_TEMPERATURE_POOL_SIZE ONEWIRE_TEMP_SENSOR_POOL_SIZE
+#endif
+
+#ifndef ACTUATOR_ONEWIRE_POOL_SIZE
+#define ACTUATOR_ONEWIRE_POOL_SIZE (12)
+#endif
+
+// an actuator uses at most one DS2413, so acquiring the switch cannot fail for an actuator that was created
+#ifndef DS2413_POOL_SIZE
+#define DS2413_POOL_SIZE ACTUATOR_ONEWIRE_POOL_SIZE
+#endif
+
+#ifndef VALVE_CONTROLLER_POOL_SIZE
+#define VALVE_CONTROLLER_POOL_SIZE (8)
+#endif
+
+// a valve uses at most one DS2408
+#ifndef DS2408_POOL_SIZE
+#define DS2408_POOL_SIZE VALVE_CONTROLLER_POOL_SIZE
+#endif
+
+// pin actuators that exist for the lifetime of the application: the buzzer and the 4 actuators of the device test screen
+#ifndef ACTUATOR_PIN_FIXED_USERS
+#define ACTUATOR_PIN_FIXED_USERS (1 + 4)
+#endif
+
+// the fixed users, plus each installed pin device twice, so a slot can be reconfigured while it is in use
+#ifndef ACTUATOR_PIN_POOL_SIZE
+#define ACTUATOR_PIN_POOL_SIZE (ACTUATOR_PIN_FIXED_USERS + 8)
+#endif
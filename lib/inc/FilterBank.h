@@ -0,0 +1,194 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "temperatureFormats.h"
+#include <stdint.h>
+
+// number of second order sections in a cascaded filter
+#ifndef NUM_SECTIONS
+#define NUM_SECTIONS 3
+#endif
+
+// number of channels that are filtered with one vector instruction
+#ifndef FILTER_BANK_SIMD_WIDTH
+#if (defined(__SSE2__) || defined(__ARM_NEON)) && !defined(FILTER_BANK_NO_SIMD)
+#define FILTER_BANK_SIMD_WIDTH (4)
+#else
+#define FILTER_BANK_SIMD_WIDTH (1)
+#endif
+#endif
+
+/*
+ * Filter state of a bank is stored as a structure of arrays: for each section there are 3 input taps and 3 output
+ * taps, and each tap is an array with one raw temp_precise_t value per channel. The taps are used as a ring buffer, so
+ * adding a sample does not move the older samples.
+ *
+ * Row of tap t (0-2) of section s, for the inputs (y = 0) or outputs (y = 1):
+ *     state[((s * 2 + y) * 3 + t) * stride + channel]
+ * The newest sample is in tap head, the previous one in tap (head + 1) % 3 and the oldest in tap (head + 2) % 3.
+ *
+ * The update functions advance all channels by one sample. The new input of each channel must be stored in input tap
+ * (head + 2) % 3 of section 0, which holds the oldest input that is not needed anymore.
+ * filterBankUpdate uses vector instructions when stride is a multiple of FILTER_BANK_SIMD_WIDTH.
+ * Filtering of channel i is set by b[i], see FixedFilter. b must be 13 or lower, so all shifts are less than 32 bits.
+ * The result is bit exact with cascading FixedFilter objects, including saturation.
+ *
+ * @return the new head
+ */
+uint8_t filterBankUpdate(int32_t * state, const int32_t * b, uint8_t head, uint8_t stride);
+
+// portable implementation without vector instructions, for reference and for targets without SIMD support
+uint8_t filterBankUpdateScalar(int32_t * state, const int32_t * b, uint8_t head, uint8_t stride);
+
+/**
+ * Bank of cascaded filters, which advances all channels in a single pass.
+ * Each channel has the same behavior as a FilterCascaded object and the same accessors, with a channel index.
+ * FilterCascaded itself is a bank with a single channel.
+ *
+ * Usage: set the input of each channel with setInput(), then call update() once to filter all channels.
+ */
+template <uint8_t CHANNELS>
+class FilterBank
+{
+public:
+    // channels are padded to a multiple of the SIMD width, padding channels are filtered but never read.
+    // A single channel is not padded, it is filtered faster without vector instructions.
+    static const uint8_t stride = (CHANNELS == 1) ? 1 :
+            ((CHANNELS + FILTER_BANK_SIMD_WIDTH - 1) / FILTER_BANK_SIMD_WIDTH) * FILTER_BANK_SIMD_WIDTH;
+
+    FilterBank() : head(0) {
+        for (uint8_t ch = 0; ch < stride; ch++)
+        {
+            b[ch] = 2; // default to a b value of 2
+            initChannel(ch, 0);
+        }
+    }
+    ~FilterBank() = default;
+
+    void setFiltering(uint8_t ch, uint8_t bValue)
+    {
+        b[ch] = bValue;
+    }
+
+    uint8_t getFiltering(uint8_t ch) const
+    {
+        return b[ch];
+    }
+
+    // sets all taps of all sections of a channel to val
+    void init(uint8_t ch, temp_precise_t val = temp_precise_t(0.0))
+    {
+        initChannel(ch, val.getRaw());
+    }
+
+    // sets the input for the next update(), without changing the value returned by readInput()
+    void setInput(uint8_t ch, temp_precise_t val)
+    {
+        tap(0, 0, 2)[ch] = val.getRaw();
+    }
+
+    // filters the inputs of all channels
+    void update()
+    {
+        head = filterBankUpdate(state, b, head, stride);
+    }
+
+    // returns the most recent input of the first section
+    temp_precise_t readInput(uint8_t ch) const
+    {
+        return raw(tap(0, 0, 0)[ch]);
+    }
+
+    // returns the most recent output of the last section, which is most filtered
+    temp_precise_t readOutput(uint8_t ch) const
+    {
+        return raw(tap(NUM_SECTIONS - 1, 1, 0)[ch]);
+    }
+
+    temp_precise_t readPrevOutput(uint8_t ch) const
+    {
+        return raw(tap(NUM_SECTIONS - 1, 1, 1)[ch]);
+    }
+
+    // returns true if peak detected in the last section and puts peak in result
+    bool detectPosPeak(uint8_t ch, temp_precise_t * peak) const
+    {
+        if(output(ch, 0) < output(ch, 1) && output(ch, 1) >= output(ch, 2)){
+            *peak = raw(output(ch, 1));
+            return true;
+        }
+        return false;
+    }
+
+    bool detectNegPeak(uint8_t ch, temp_precise_t * peak) const
+    {
+        if(output(ch, 0) > output(ch, 1) && output(ch, 1) <= output(ch, 2)){
+            *peak = raw(output(ch, 1));
+            return true;
+        }
+        return false;
+    }
+
+    bool isRising(uint8_t ch) const
+    {
+        return (output(ch, 0) > output(ch, 1)) && (output(ch, 1) > output(ch, 2));
+    }
+
+    bool isFalling(uint8_t ch) const
+    {
+        return (output(ch, 0) < output(ch, 1)) && (output(ch, 1) < output(ch, 2));
+    }
+
+private:
+    int32_t * tap(uint8_t section, uint8_t isOutput, uint8_t age)
+    {
+        return &state[((section * 2 + isOutput) * 3 + (head + age) % 3) * stride];
+    }
+
+    const int32_t * tap(uint8_t section, uint8_t isOutput, uint8_t age) const
+    {
+        return &state[((section * 2 + isOutput) * 3 + (head + age) % 3) * stride];
+    }
+
+    int32_t output(uint8_t ch, uint8_t age) const
+    {
+        return tap(NUM_SECTIONS - 1, 1, age)[ch];
+    }
+
+    static temp_precise_t raw(int32_t value)
+    {
+        temp_precise_t result;
+        result.setRaw(value);
+        return result;
+    }
+
+    void initChannel(uint8_t ch, int32_t value)
+    {
+        for (uint8_t row = 0; row < NUM_SECTIONS * 6; row++)
+        {
+            state[row * stride + ch] = value;
+        }
+    }
+
+    int32_t state[NUM_SECTIONS * 6 * stride];
+    int32_t b[stride];
+    uint8_t head;
+};
@@ -25,6 +25,7 @@
 
 #include "temperatureFormats.h"
 #include "FilterFixed.h"
+#include "FilterBank.h"
 
 // Use 3 filter sections. This gives excellent filtering, without adding too much delay.
 // For 3 sections the stop band attenuation is 3x the single section attenuation in dB.
@@ -40,13 +41,15 @@
  *       a=14,   b=5,    delay time = 360
  *       a=16,   b=6,    delay time = 723
  */
-#define NUM_SECTIONS 3
+// NUM_SECTIONS is defined in FilterBank.h
 class FilterCascaded
 {
-    public:
+    private:
 
         // CascadedFilter implements a filter that consists of multiple second order secions.
-        FixedFilter sections[NUM_SECTIONS];
+        // The sections are computed by a single channel filter bank, which gives the same result as cascading
+        // NUM_SECTIONS FixedFilter objects.
+        FilterBank<1> bank;
 
     public:
         FilterCascaded();
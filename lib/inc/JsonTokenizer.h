@@ -0,0 +1,91 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// maximum length of a key or value, including the terminating \0
+#ifndef JSON_TOKENIZER_MAX_TOKEN_LENGTH
+#define JSON_TOKENIZER_MAX_TOKEN_LENGTH (64)
+#endif
+
+/**
+ * Incremental parser for the flat {key:value,key:value} JSON objects received from the Pi.
+ * Characters are fed one at a time, so parsing can be suspended when no more input is buffered and resumed on the
+ * next call from the main loop. Each complete key/value pair is passed to a callback.
+ *
+ * Like the previous parser, quotes and spaces are skipped and nested objects are not supported.
+ */
+class JsonTokenizer {
+public:
+    typedef void (*PairCallback)(const char * key, const char * val, void * data);
+
+    enum Status : uint8_t {
+        IDLE,           // not parsing
+        BUSY,           // waiting for more input
+        DONE,           // closing brace received
+        ERROR_NO_OBJECT,// first character was not an opening brace
+        ERROR_TOO_LONG  // key or value does not fit the token buffer
+    };
+
+    JsonTokenizer() : callback(nullptr), data(nullptr), status(IDLE), started(false), inValue(false), length(0) {
+        key[0] = '\0';
+        val[0] = '\0';
+    }
+    ~JsonTokenizer() = default;
+
+    /**
+     * Starts parsing a new object. The first character fed should be the opening brace.
+     */
+    void begin(PairCallback fn, void * _data);
+
+    /**
+     * Processes one character.
+     * @return BUSY while the object is not complete, otherwise the final status
+     */
+    Status feed(char c);
+
+    /**
+     * Ends parsing when no more input will arrive, for example after a timeout.
+     * A pending complete key/value pair is still passed to the callback, like a closing brace would.
+     */
+    Status finish();
+
+    Status getStatus() const {
+        return status;
+    }
+
+    bool busy() const {
+        return status == BUSY;
+    }
+
+private:
+    void endToken();
+    Status close(Status result);
+
+    PairCallback callback;
+    void * data;
+    Status status;
+    bool started;
+    bool inValue;
+    uint8_t length;
+    char key[JSON_TOKENIZER_MAX_TOKEN_LENGTH];
+    char val[JSON_TOKENIZER_MAX_TOKEN_LENGTH];
+};
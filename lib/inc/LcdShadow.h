@@ -0,0 +1,97 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Shadow copy of the content of a 20x4 HD44780 compatible character display.
+ *
+ * Drivers store each character they are given in the shadow copy and only transmit the characters that differ
+ * from what the display already shows. The shadow copy also tracks the DDRAM address of the display's cursor,
+ * which increments after each character. A cursor move is only transmitted when the next changed character is not
+ * at that address, so moving the cursor over unchanged text costs nothing and a run of changed characters needs a
+ * single cursor move.
+ */
+class LcdShadow {
+public:
+    static const uint8_t COLS = 20;
+    static const uint8_t ROWS = 4;
+
+    // returned by write() when the display already shows the character
+    static const uint8_t UNCHANGED = 0xFF;
+    // returned by write() when the cursor of the display is already at the position of the character
+    static const uint8_t AT_CURSOR = 0xFE;
+
+    LcdShadow() {
+        clear();
+    }
+    ~LcdShadow() = default;
+
+    // the display was cleared, which fills it with spaces and moves the cursor home
+    void clear();
+
+    // the cursor of the display was moved home
+    void home() {
+        cursor = 0;
+    }
+
+    // the display's address counter no longer points to DDRAM, for example after writing CGRAM
+    void invalidateCursor() {
+        cursor = UNCHANGED;
+    }
+
+    /*
+     * Stores a character that will be transmitted by the driver.
+     * /return UNCHANGED when it does not have to be transmitted, AT_CURSOR when it can be transmitted right away,
+     *         or the DDRAM address to move the cursor to before transmitting it
+     */
+    uint8_t write(uint8_t row, uint8_t col, uint8_t c);
+
+    /*
+     * Stores a character without transmitting it. The display no longer matches the shadow copy until the content
+     * is transmitted again with refresh().
+     */
+    void store(uint8_t row, uint8_t col, uint8_t c);
+
+    // Records that the driver moved the cursor to a position, for example to write a full line
+    void moveCursor(uint8_t row, uint8_t col) {
+        cursor = address(row, col);
+    }
+
+    // Records that the driver transmitted a character at the cursor
+    void advanceCursor() {
+        cursor++;
+    }
+
+    // null terminated content of a row, with the character codes of the display
+    const char * line(uint8_t row) const {
+        return content[row];
+    }
+
+    // copies a row to buffer and replaces the degree sign of the display by the one of the character set of the Pi
+    void getLine(uint8_t row, char * buffer) const;
+
+    static uint8_t address(uint8_t row, uint8_t col);
+
+private:
+    char content[ROWS][COLS + 1];
+    uint8_t cursor; // DDRAM address of the display's cursor, UNCHANGED when unknown
+};
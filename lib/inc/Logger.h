@@ -63,6 +63,14 @@ class Logger{
 	~Logger() = default;
 	
 	static void logMessageVaArg(const char type, LOG_ID_TYPE errorID, const char * varTypes, ...);
+
+	// keeps a message that is logged while the output cannot be written, type 0 is a debug message
+	static void queueMessage(const char type, LOG_ID_TYPE errorID, const char * values);
+	// sends the queued messages, call from the thread that writes the output
+	static void sendQueued();
+
+	private:
+	static void sendMessage(const char type, LOG_ID_TYPE errorID, const char * values);
 };
 extern Logger logger;
 
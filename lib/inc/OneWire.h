@@ -48,6 +48,12 @@
 
 #include <inttypes.h>
 #include "OneWireImpl.h"
+#include "OneWireTransaction.h"
+
+// Drivers that can run a OneWireTransaction in the background define this to 1
+#ifndef ONEWIRE_QUEUED
+#define ONEWIRE_QUEUED 0
+#endif
 
 class OneWire {
 public:
@@ -106,6 +112,13 @@ public:
 
     void read_bytes(uint8_t *buf, uint16_t count);
 
+    // Adds a transaction to the queue of the driver. Drivers without a queue run it right away.
+    // Returns false when the transaction is already pending.
+    bool submit(OneWireTransaction & transaction);
+
+    // Continues the queued transactions without waiting for the bus. Returns true while transactions are pending.
+    bool poll();
+
 #if ONEWIRE_SEARCH
     // Clear the search state so that if will start from the beginning again.
     void reset_search();
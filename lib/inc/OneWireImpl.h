@@ -14,12 +14,20 @@ typedef OneWirePin OneWireDriver;
 
 typedef DS248x OneWireDriver;
 
+#define ONEWIRE_QUEUED 1 // the DS248x runs transactions in the background
+
 #elif defined(ONEWIRE_PIN)
 
 #include "OneWirePin.h"
 
 typedef OneWirePin OneWireDriver;
 
+#elif defined(ONEWIRE_EMULATED)
+
+#include "OneWireEmulated.h"
+
+typedef OneWireEmulated OneWireDriver;
+
 #elif defined(ONEWIRE_NULL)
 
 #include "OneWireNull.h"
@@ -24,22 +24,136 @@
 #include <string.h>
 
 
+/*
+ * Base class for OneWire switches (DS2413, DS2408).
+ *
+ * Actuators that use different PIOs of the same chip share one instance, acquired by bus and ROM address.
+ * The shared instance has a single cached state that is read from the device at most once per control cycle,
+ * and latch changes of all PIOs are combined in a single Channel Access Write by flush().
+ */
 class OneWireSwitch {
 public:
-    OneWireSwitch(){
-        oneWire = nullptr;
+    OneWireSwitch() :
+        oneWire(nullptr),
+        cachedState(0),
+        pendingMask(0),
+        pendingBits(0),
+        refreshedCycle(cycle - 1),
+        users(0),
+        next(nullptr){
     }
 protected:
-    ~OneWireSwitch() = default;
+    virtual ~OneWireSwitch() = default;
 public:
 
     void init(OneWire* oneWire, DeviceAddress address);
     DeviceAddress& getDeviceAddress();
     bool validAddress(OneWire* oneWire, DeviceAddress deviceAddress);
 
+    /*
+     * Returns the shared switch for a bus and address, creating it when it is not used yet.
+     * Each acquire must be matched by a release.
+     * /return the switch or nullptr when the pool of T is full
+     */
+    template<class T>
+    static T * acquire(OneWire * bus, DeviceAddress address){
+        for(OneWireSwitch * s = first; s != nullptr; s = s->next){
+            if(s->oneWire == bus && memcmp(s->address, address, sizeof(DeviceAddress)) == 0){
+                s->users++;
+                return static_cast<T *>(s);
+            }
+        }
+        T * s = new T();
+        if(s == nullptr){
+            return nullptr; // pool is full
+        }
+        s->init(bus, address);
+        s->users = 1;
+        s->next = first;
+        first = s;
+        return s;
+    }
+
+    /*
+     * Releases a shared switch. Pending writes are flushed and the switch is deleted when it has no users left.
+     */
+    template<class T>
+    static void release(T * s){
+        if(s != nullptr && unlink(s)){
+            delete s;
+        }
+    }
+
+    /*
+     * Starts a new control cycle: the next refresh of each switch reads its state from the device again.
+     */
+    static void nextCycle(){
+        cycle++;
+    }
+
+    /*
+     * Writes the pending latch changes of all shared switches.
+     * /return true when all writes succeeded
+     */
+    static bool flushAll();
+
+    /*
+     * Writes the pending latch changes in one Channel Access Write.
+     * /return true on success or when nothing had to be written
+     */
+    virtual bool flush() = 0;
+
+    bool hasPendingWrite() const {
+        return pendingMask != 0;
+    }
+
+    // last state read from the device or received after a write
+    uint8_t getCachedState() const {
+        return cachedState;
+    }
+
 protected:
     OneWire* oneWire;
     DeviceAddress address;
+    uint8_t cachedState;
+    uint8_t pendingMask; // latch bits that have a pending write
+    uint8_t pendingBits; // values of the pending latch bits
+
+    /*
+     * Sets the latch bits in mask to values. The write is deferred until the next flush.
+     */
+    void writeLatchesDeferred(uint8_t mask, uint8_t values){
+        pendingMask |= mask;
+        pendingBits = (pendingBits & ~mask) | (values & mask);
+    }
+
+    uint8_t applyPending(uint8_t latches) const {
+        return (latches & ~pendingMask) | pendingBits;
+    }
+
+    void clearPending(){
+        pendingMask = 0;
+        pendingBits = 0;
+    }
+
+    bool isRefreshed() const {
+        return refreshedCycle == cycle;
+    }
+
+    void setRefreshed(){
+        refreshedCycle = cycle;
+    }
+
+private:
+    // removes one user, returns true when the switch should be deleted
+    static bool unlink(OneWireSwitch * s);
+
+    uint8_t refreshedCycle;
+    uint8_t users;
+    OneWireSwitch * next;
+
+    static OneWireSwitch * first;
+    static uint8_t cycle;
 
 public:    
     /*
@@ -52,9 +166,8 @@ public:
      * Writes the state of all PIOs in one operation.
      * /param b pio data - PIOA is bit 0 (lsb), PIOB is bit 1 for DS2413. All bits are used for DS2408
      * /param maxTries the maximum number of attempts before giving up.
+     * /param status when not null, receives the PIO status byte the device sends after the acknowledgement
      * /return true on success
      */
-    bool accessWrite(uint8_t b, uint8_t maxTries = 3);
+    bool accessWrite(uint8_t b, uint8_t maxTries = 3, uint8_t * status = nullptr);
 };
-
-
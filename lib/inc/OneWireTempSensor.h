@@ -22,8 +22,11 @@
 
 #include "TempSensorBasic.h"
 #include "OneWireAddress.h"
+#include "OneWireTransaction.h"
 #include "DallasTemperature.h"
+#include "OneWireTempSensorScheduler.h"
 #include "Ticks.h"
+#include "BlockPool.h"
 
 class DallasTemperature;
 class OneWire;
@@ -40,11 +43,15 @@ public:
 	 * /param calibration	A temperature value that is added to all readings. This can be used to calibrate the sensor.	 
 	 */
 	OneWireTempSensor(OneWire* bus, DeviceAddress address, temp_t calibrationOffset)
-	: oneWire(bus), sensor(NULL) {		
+	: oneWire(bus), sensor(NULL), nextOnBus(NULL) {		
 		connected = true;  // assume connected. Transition from connected to disconnected prints a message.
 		memcpy(sensorAddress, address, sizeof(DeviceAddress));
 		this->calibrationOffset = calibrationOffset;
 		cachedValue = TEMP_SENSOR_DISCONNECTED;
+		scheduler = OneWireTempSensorScheduler::forBus(bus);
+		if(scheduler){
+			scheduler->add(this);
+		}
 	};
 	
 	~OneWireTempSensor();
@@ -56,11 +63,32 @@ public:
 	bool init() override final ;
 	temp_t read() const override final ; // return cached value
 	void update() override final ; // read from hardware sensor
+
+	POOL_ALLOCATED
 	
 	private:
 
 	void setConnected(bool connected);
 	void requestConversion();
+
+	/**
+	 * Reads the result of the last conversion from the scratchpad into the cached value.
+	 * Tries to re-initialize the sensor once when the read fails.
+	 */
+	void updateFromScratchPad();
+
+	/**
+	 * Queues a read of the scratchpad on the bus, used by the scheduler to read all sensors on the bus in a batch.
+	 */
+	void submitScratchPadRead();
+
+	/**
+	 * Updates the cached value from the scratchpad read by the queued transaction, like updateFromScratchPad().
+	 */
+	void updateFromQueuedRead();
+
+	// sets the cached value from a raw reading, tries to re-initialize the sensor once when the reading is invalid
+	void updateTemp(int16_t tempRaw);
 	void waitForConversion()
 	{
 		wait.millis(750);
@@ -71,9 +99,15 @@ public:
 	 * updates lastRequestTime. On successful, leaves lastRequestTime alone and returns DEVICE_DISCONNECTED.
 	 */
 	temp_t readAndConstrainTemp();
+	temp_t constrainTemp(int16_t tempRaw);
+	temp_t rawToTemp(int16_t tempRaw) const;
 	
 	OneWire * oneWire;
 	DallasTemperature * sensor;
+	OneWireTempSensorScheduler * scheduler; // batches conversions for all sensors on the bus, can be NULL
+	OneWireTempSensor * nextOnBus; // next sensor in the scheduler's list
+	OneWireTransaction scratchPadRead;
+	uint8_t scratchPad[9];
 	DeviceAddress sensorAddress;
 
 	temp_t calibrationOffset;
@@ -81,4 +115,5 @@ public:
 	bool connected;
 	
 	friend class OneWireTempSensorMixin;
+	friend class OneWireTempSensorScheduler;
 };
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "Ticks.h"
+
+class OneWire;
+class OneWireTempSensor;
+
+// maximum number of OneWire buses that can have a scheduler. Sensors on additional buses fall back to addressing
+// each sensor individually.
+#ifndef ONEWIRE_TEMP_SENSOR_SCHEDULER_MAX_BUSES
+#define ONEWIRE_TEMP_SENSOR_SCHEDULER_MAX_BUSES (4)
+#endif
+
+// conversion time of a DS18B20 at 12 bit resolution
+#define ONEWIRE_TEMP_SENSOR_CONVERSION_TIME (750)
+
+/**
+ * Schedules temperature conversions for all OneWireTempSensors on a single OneWire bus.
+ *
+ * Instead of every sensor starting its own conversion with Match ROM, a single Skip ROM Convert T starts a conversion
+ * on all sensors on the bus at once. The conversion time is tracked with ticks, so the caller never blocks.
+ * The first sensor that is updated after the conversion has completed queues the scratchpad reads of all sensors on
+ * the bus as OneWire transactions. A bus master with a queue (DS248x) reads them in the background and the following
+ * updates poll it, other drivers read them right away. When all scratchpads are read, the sensors are updated in one
+ * batch and the next conversion is started. Updates of the other sensors in the same cycle just return.
+ */
+class OneWireTempSensorScheduler
+{
+public:
+    OneWireTempSensorScheduler() :
+        bus(nullptr),
+        first(nullptr),
+        conversionStart(0),
+        converting(false),
+        reading(false) {
+    }
+
+    ~OneWireTempSensorScheduler() = default;
+
+    /**
+     * Returns the scheduler for a bus, creating it if it doesn't exist yet.
+     * Returns nullptr when all scheduler slots are in use.
+     */
+    static OneWireTempSensorScheduler * forBus(OneWire * bus);
+
+    void add(OneWireTempSensor * sensor);
+    void remove(OneWireTempSensor * sensor);
+
+    /**
+     * When the pending conversion is complete, reads all sensors on the bus and starts a new conversion.
+     * Does nothing while a conversion is in progress and only polls the bus while the scratchpads are read.
+     */
+    void update();
+
+    /**
+     * Starts a conversion on all sensors on the bus with a single Skip ROM Convert T command.
+     * Does nothing while a conversion is in progress, the sensors are read when it completes.
+     */
+    void requestConversion();
+
+    bool conversionComplete() const;
+
+    OneWire * getBus() const {
+        return bus;
+    }
+
+    uint8_t sensorCount() const;
+
+private:
+    OneWire * bus;
+    OneWireTempSensor * first; // sensors on this bus are kept in an intrusive linked list
+    ticks_millis_t conversionStart;
+    bool converting;
+    bool reading; // scratchpad reads of the completed conversion are queued
+
+    void startConversion();
+
+    static OneWireTempSensorScheduler schedulers[ONEWIRE_TEMP_SENSOR_SCHEDULER_MAX_BUSES];
+};
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// channel of a transaction that does not select a channel (all bus masters except the DS2482-800)
+#define ONEWIRE_NO_CHANNEL 0xff
+
+/**
+ * A queued OneWire transaction: reset, select a device (or skip ROM), write writeLength bytes and read readLength
+ * bytes. Submit it with OneWire::submit() and call OneWire::poll() until it is no longer pending.
+ *
+ * Drivers with a queue (DS248x) run the transaction in the background, the other drivers run it when it is submitted.
+ * The caller owns the transaction and its buffers and keeps them alive until it is no longer pending.
+ */
+class OneWireTransaction {
+public:
+    enum class Status : uint8_t {
+        IDLE, // not submitted yet
+        QUEUED,
+        BUSY,
+        DONE,
+        NO_PRESENCE, // no device responded to the reset
+        CHANNEL_ERROR, // the channel could not be selected
+        TIMEOUT // the bus master stayed busy
+    };
+
+    OneWireTransaction() :
+        channel(ONEWIRE_NO_CHANNEL),
+        writeData(nullptr),
+        writeLength(0),
+        readData(nullptr),
+        readLength(0),
+        status(Status::IDLE),
+        skipRom(true),
+        step(0),
+        index(0),
+        next(nullptr) {
+    }
+
+    // Selects the device with Match ROM. Without a selected device, Skip ROM is used.
+    void select(const uint8_t rom[8]) {
+        memcpy(this->rom, rom, 8);
+        skipRom = false;
+    }
+
+    void skip() {
+        skipRom = true;
+    }
+
+    bool isPending() const {
+        return status == Status::QUEUED || status == Status::BUSY;
+    }
+
+    Status getStatus() const {
+        return status;
+    }
+
+    uint8_t channel; // DS2482-800 channel
+    const uint8_t * writeData;
+    uint8_t writeLength;
+    uint8_t * readData;
+    uint8_t readLength;
+
+private:
+    Status status;
+    bool skipRom;
+    uint8_t rom[8];
+    uint8_t step; // progress of a queued transaction, used by the driver
+    uint8_t index;
+    OneWireTransaction * next;
+
+    friend class OneWire;
+    friend class DS248x;
+};
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// number of seeds that are tried at compile time to find a hash without collisions
+#ifndef PERFECT_HASH_MAX_SEED
+#define PERFECT_HASH_MAX_SEED (200)
+#endif
+
+/*
+ * Compile time perfect hashing of a fixed set of string keys.
+ * All functions are C++11 constexpr, so the seed and the slot table are computed by the compiler and end up in flash.
+ */
+namespace PerfectHash {
+
+    constexpr uint32_t noSeed = UINT32_MAX;
+
+    // FNV-1a
+    constexpr uint32_t fnv1a(const char * s, uint32_t h){
+        return *s ? fnv1a(s + 1, (h ^ uint8_t(*s)) * 16777619UL) : h;
+    }
+
+    constexpr uint32_t fold(uint32_t h, uint8_t bits){
+        return (h ^ (h >> 16)) & ((uint32_t(1) << bits) - 1);
+    }
+
+    constexpr uint8_t slot(const char * s, uint32_t seed, uint8_t bits){
+        return fold(fnv1a(s, 2166136261UL ^ (seed * 0x9E3779B9UL)), bits);
+    }
+
+    // true when one of keys[0..i-1] hashes to slot s
+    template <size_t N>
+    constexpr bool slotTaken(const char * const (&keys)[N], size_t i, uint8_t s, uint32_t seed, uint8_t bits){
+        return i > 0 && (slot(keys[i - 1], seed, bits) == s || slotTaken(keys, i - 1, s, seed, bits));
+    }
+
+    template <size_t N>
+    constexpr bool isPerfect(const char * const (&keys)[N], uint32_t seed, uint8_t bits, size_t i = 0){
+        return i >= N || (!slotTaken(keys, i, slot(keys[i], seed, bits), seed, bits) && isPerfect(keys, seed, bits, i + 1));
+    }
+
+    template <size_t N>
+    constexpr uint32_t findSeed(const char * const (&keys)[N], uint8_t bits, uint32_t seed = 0){
+        return seed >= PERFECT_HASH_MAX_SEED ? noSeed :
+                isPerfect(keys, seed, bits) ? seed : findSeed(keys, bits, seed + 1);
+    }
+
+    // index + 1 of the key that hashes to slot s, 0 for an empty slot
+    template <size_t N>
+    constexpr uint8_t keyForSlot(const char * const (&keys)[N], uint32_t seed, uint8_t bits, uint8_t s, size_t i = 0){
+        return i >= N ? 0 : slot(keys[i], seed, bits) == s ? uint8_t(i + 1) : keyForSlot(keys, seed, bits, s, i + 1);
+    }
+
+    template <size_t... I> struct IndexList {};
+    template <size_t N, size_t... I> struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+    template <size_t... I> struct MakeIndexList<0, I...> { typedef IndexList<I...> type; };
+
+    /**
+     * Maps each of N keys to a unique slot in a table of 2^BITS entries.
+     * Looking up a string takes one hash and returns the only key index that can match, so the caller needs a single
+     * string compare to confirm the match. Compilation fails through isValid() when no seed without collisions is
+     * found, in that case increase BITS.
+     */
+    template <size_t N, uint8_t BITS>
+    class Index {
+        static_assert(N < 255, "too many keys for a perfect hash index");
+
+    public:
+        constexpr Index(const char * const (&keys)[N]) :
+            Index(keys, findSeed(keys, BITS), typename MakeIndexList<(size_t(1) << BITS)>::type()) {}
+
+        constexpr bool isValid() const {
+            return seed != noSeed;
+        }
+
+        /**
+         * @return index of the key that could be equal to s, or -1 if s is not one of the keys
+         */
+        int16_t candidate(const char * s) const {
+            return int16_t(slots[slot(s, seed, BITS)]) - 1;
+        }
+
+        constexpr uint32_t getSeed() const {
+            return seed;
+        }
+
+    private:
+        template <size_t... I>
+        constexpr Index(const char * const (&keys)[N], uint32_t _seed, IndexList<I...>) :
+            seed(_seed),
+            slots{ keyForSlot(keys, _seed, BITS, uint8_t(I))... } {}
+
+        uint32_t seed;
+        uint8_t slots[size_t(1) << BITS];
+    };
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "SetpointProfile.h"
+
+/**
+ * Evaluates up to PROFILES running profiles in a single pass per tick.
+ *
+ * Each slot keeps the time at which its profile started and the step it is in. Time only moves forward between
+ * updates, so the step is found by advancing from the previous step. seek() jumps to an arbitrary offset with a binary
+ * search, for example to resume at the position stored before a reboot.
+ *
+ * Usage: start() or seek() profiles in slots, call update() once per tick and read value() of each slot.
+ */
+template <uint8_t PROFILES>
+class ProfileEngine
+{
+public:
+    static const uint8_t NO_SLOT = 0xFF;
+
+    ProfileEngine() : running(0) {
+        for (uint8_t i = 0; i < PROFILES; i++) {
+            profiles[i] = nullptr;
+            values[i] = 0;
+        }
+    }
+    ~ProfileEngine() = default;
+
+    /*
+     * Starts a profile in a free slot, elapsed time units after its start.
+     * @return slot of the profile, or NO_SLOT when all slots are in use
+     */
+    uint8_t start(const SetpointProfile * profile, uint32_t now, uint32_t elapsed = 0) {
+        for (uint8_t slot = 0; slot < PROFILES; slot++) {
+            if (profiles[slot] == nullptr) {
+                profiles[slot] = profile;
+                seek(slot, now, elapsed);
+                return slot;
+            }
+        }
+        return NO_SLOT;
+    }
+
+    // moves the profile in a slot to elapsed time units after its start and updates its value
+    void seek(uint8_t slot, uint32_t now, uint32_t elapsed) {
+        origin[slot] = now - elapsed;
+        step[slot] = profiles[slot]->stepAt(elapsed);
+        running |= uint32_t(1) << slot;
+        evaluate(slot, elapsed);
+    }
+
+    // stops updating a slot, its value is kept
+    void pause(uint8_t slot) {
+        running &= ~(uint32_t(1) << slot);
+    }
+
+    // frees a slot
+    void stop(uint8_t slot) {
+        pause(slot);
+        profiles[slot] = nullptr;
+    }
+
+    // updates the values of all running profiles
+    void update(uint32_t now) {
+        uint32_t pending = running;
+        for (uint8_t slot = 0; pending; slot++, pending >>= 1) {
+            if (!(pending & 1)) {
+                continue;
+            }
+            const SetpointProfile * p = profiles[slot];
+            uint32_t elapsed = now - origin[slot];
+            uint8_t s = step[slot];
+            if (elapsed < p->stepStart(s)) {
+                s = p->stepAt(elapsed); // time went back
+            }
+            else {
+                while (s + 1 < p->stepCount() && elapsed >= p->stepStart(s + 1)) {
+                    s++;
+                }
+            }
+            step[slot] = s;
+            evaluate(slot, elapsed);
+        }
+    }
+
+    int16_t value(uint8_t slot) const {
+        return values[slot];
+    }
+
+    uint8_t currentStep(uint8_t slot) const {
+        return step[slot];
+    }
+
+    // time since the start of the profile in a slot, to store its position
+    uint32_t elapsed(uint8_t slot, uint32_t now) const {
+        return now - origin[slot];
+    }
+
+    bool isRunning(uint8_t slot) const {
+        return running & (uint32_t(1) << slot);
+    }
+
+private:
+    void evaluate(uint8_t slot, uint32_t elapsed) {
+        const SetpointProfile * p = profiles[slot];
+        uint8_t s = step[slot];
+        values[slot] = p->valueInStep(s, elapsed - p->stepStart(s));
+    }
+
+    static_assert(PROFILES <= 32, "running profiles are a 32 bit mask");
+
+    const SetpointProfile * profiles[PROFILES];
+    uint32_t origin[PROFILES];  // time at which each profile started
+    int16_t values[PROFILES];
+    uint8_t step[PROFILES];
+    uint32_t running;           // bit mask of the slots that are updated
+};
+
+template <uint8_t PROFILES>
+const uint8_t ProfileEngine<PROFILES>::NO_SLOT;
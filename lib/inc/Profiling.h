@@ -0,0 +1,150 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "Ticks.h"
+
+/*
+ * Profiling of the main loop: run times of the tasks and of other sections of code, lateness of the tasks and
+ * late PWM edges. Define BREWPI_PROFILING as 0 to compile out all measurements and statistics.
+ */
+#ifndef BREWPI_PROFILING
+#define BREWPI_PROFILING 1
+#endif
+
+#if BREWPI_PROFILING
+    #define PROFILING_ONLY(x) x
+#else
+    #define PROFILING_ONLY(x)
+#endif
+
+// number of recent run times that are kept for each task or section
+#ifndef PROFILING_RECENT_RUNS
+#define PROFILING_RECENT_RUNS (8)
+#endif
+
+#define PROFILING_LATENESS_BINS (8)
+
+#if BREWPI_PROFILING
+
+/*
+ * Run time statistics of a piece of code, in microseconds.
+ * The last run times are kept in a ring buffer. The recent maximum shows a regression while the overall maximum
+ * still holds an old outlier, like the first run after startup.
+ */
+struct RunTimeStatistics {
+    uint32_t runs;
+    uint32_t totalRunTime;
+    uint32_t minRunTime;
+    uint32_t maxRunTime;
+    uint32_t recentRunTimes[PROFILING_RECENT_RUNS];
+    uint8_t recentIndex; // next entry of recentRunTimes to overwrite
+
+    void reset();
+    void add(uint32_t runTime);
+
+    uint32_t meanRunTime() const {
+        return runs ? totalRunTime / runs : 0;
+    }
+
+    uint32_t recentMaxRunTime() const;
+};
+
+/*
+ * Histogram of the lateness of a periodic job in milliseconds, which is the jitter of its period.
+ * Bin 0 counts runs that started on time, bin i counts runs that were 2^(i-1) to 2^i - 1 ms late and the last bin
+ * also counts all later runs.
+ */
+struct LatenessHistogram {
+    uint16_t bins[PROFILING_LATENESS_BINS];
+
+    void reset();
+    void add(uint32_t lateness);
+};
+
+/*
+ * A section of code that is not a task, like writing settings to EEPROM.
+ * Sections are kept in a list, so they can be reported together.
+ */
+class ProfileSection {
+public:
+    ProfileSection(const char * name);
+    ~ProfileSection();
+
+    ProfileSection(const ProfileSection &) = delete;
+    ProfileSection & operator=(const ProfileSection &) = delete;
+
+    const char * getName() const {
+        return name;
+    }
+
+    const RunTimeStatistics & statistics() const {
+        return stats;
+    }
+
+    void add(uint32_t runTime) {
+        stats.add(runTime);
+    }
+
+    ProfileSection * getNext() const {
+        return next;
+    }
+
+    static ProfileSection * first() {
+        return list;
+    }
+
+    static void resetAll();
+
+private:
+    const char * name;
+    RunTimeStatistics stats;
+    ProfileSection * next;
+
+    static ProfileSection * list;
+};
+
+/*
+ * Measures the time until it goes out of scope and adds it to a section.
+ */
+class ProfileScope {
+public:
+    ProfileScope(ProfileSection & _section) : section(_section), start(ticks.micros()) {}
+    ~ProfileScope() {
+        section.add(ticks.micros() - start);
+    }
+
+private:
+    ProfileSection & section;
+    ticks_micros_t start;
+};
+
+// defines a section at file scope
+#define PROFILE_SECTION(section, name) static ProfileSection section(name);
+// measures the rest of the enclosing block
+#define PROFILE_SCOPE(section) ProfileScope profileScope(section);
+
+#else
+
+#define PROFILE_SECTION(section, name)
+#define PROFILE_SCOPE(section)
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Compressed blocks of periodic samples, for the data log on the controller.
+ *
+ * Each block can be decoded without the blocks before it:
+ *     version (1 byte)
+ *     channels (1 byte)    number of values in each sample
+ *     interval (2 bytes)   nominal time between samples in ms, little endian
+ *     time (4 bytes)       time of the first sample in ms, little endian
+ *     samples
+ *
+ * A sample starts with an unsigned varint (7 bits per byte, least significant first, high bit set when more follow):
+ *     odd, 2n + 1          the previous sample is repeated n times at the nominal interval
+ *     even, 2z             z is the zigzag encoded deviation from the nominal interval, followed by a varint with a bit
+ *                          for each channel that changed and a zigzag varint difference for each changed channel
+ * The first sample of a block is at the time in the header and its differences are relative to zero.
+ *
+ * Temperatures that are stable, outputs and settings cost a few bits per sample, a second of unchanged values
+ * costs nothing until the run ends.
+ */
+
+class SampleBlockWriter {
+public:
+    static const uint8_t VERSION = 1;
+    static const uint8_t HEADER_SIZE = 8;
+    static const uint8_t MAX_CHANNELS = 32;
+    static const uint16_t BLOCK_SIZE = 240; // fits in one telemetry frame without a COBS split
+
+    SampleBlockWriter();
+    ~SampleBlockWriter() = default;
+
+    // starts an empty block
+    void begin(uint8_t channels, uint16_t interval);
+
+    /*
+     * Adds a sample with a value for each channel.
+     * @return false when the block is full or the time is too far from the previous sample, start a new block then
+     */
+    bool add(uint32_t time, const int32_t * values);
+
+    // completes the block, the data is valid until the next call to begin()
+    const uint8_t * finish();
+
+    uint16_t size() const {
+        return length;
+    }
+
+    uint16_t samples() const {
+        return count;
+    }
+
+    uint32_t firstTime() const {
+        return startTime;
+    }
+
+private:
+    void flushRun();
+
+    uint8_t block[BLOCK_SIZE];
+    int32_t previous[MAX_CHANNELS];
+    uint32_t startTime;
+    uint32_t lastTime;
+    uint32_t run; // repeats of the previous sample that are not written yet
+    uint16_t length;
+    uint16_t count;
+    uint16_t sampleInterval;
+    uint8_t numChannels;
+};
+
+class SampleBlockReader {
+public:
+    SampleBlockReader();
+    ~SampleBlockReader() = default;
+
+    // @return false when the block has an unknown version or is too short
+    bool begin(const uint8_t * block, uint16_t length);
+
+    /*
+     * Decodes the next sample.
+     * @param values receives a value for each channel
+     * @return false at the end of the block or when the block is corrupt
+     */
+    bool next(uint32_t & time, int32_t * values);
+
+    uint8_t channels() const {
+        return numChannels;
+    }
+
+    uint16_t interval() const {
+        return sampleInterval;
+    }
+
+private:
+    bool readVarint(uint32_t & value);
+
+    const uint8_t * data;
+    uint16_t length;
+    uint16_t pos;
+    int32_t current[SampleBlockWriter::MAX_CHANNELS];
+    uint32_t currentTime;
+    uint32_t run;
+    uint16_t sampleInterval;
+    uint8_t numChannels;
+    bool first;
+};
+
+/*
+ * Keeps the blocks of the data log by sequence number, for example in a ring in flash that drops the oldest blocks.
+ * There is one reader position, for sending blocks to the Pi.
+ */
+class SampleStore {
+public:
+    static const uint32_t NO_SEQUENCE = 0xFFFFFFFF;
+
+    virtual ~SampleStore() = default;
+
+    virtual bool append(uint32_t sequence, const uint8_t * block, uint16_t length) = 0;
+
+    // @return the sequence number of the newest block, NO_SEQUENCE when the store is empty
+    virtual uint32_t lastSequence() = 0;
+
+    // moves the reader to the oldest block with a sequence number of at least sequence, false when the store is empty
+    virtual bool seek(uint32_t sequence) = 0;
+
+    // @return the length of the next block, -1 when there are no more blocks
+    virtual int16_t read(uint32_t & sequence, uint8_t * block, uint16_t maxLength) = 0;
+};
+
+/**
+ * Samples values at a fixed interval into blocks and stores each block when it is full or older than maxBlockAge.
+ *
+ * Sample times are on a grid with the interval as spacing, so a late sample does not break a run of repeats. When a
+ * sample is missed, the next one has a larger deviation. Block sequence numbers continue after the newest block in
+ * the store, so the Pi can ask for the blocks it does not have after a reset or a lost connection.
+ */
+class SampleLogger {
+public:
+    SampleLogger(SampleStore & target, uint8_t channels, uint16_t interval, uint32_t maxBlockAge);
+    ~SampleLogger() = default;
+
+    // continues the sequence numbers of the store, call before adding samples
+    void init();
+
+    bool due(uint32_t now) const {
+        return !started || uint32_t(now - lastTime) >= sampleInterval;
+    }
+
+    void add(uint32_t now, const int32_t * values);
+
+    // stores the current block when it has samples
+    void flush();
+
+    // stores the current block, so each block has one interval
+    void setInterval(uint16_t interval);
+
+    uint16_t interval() const {
+        return sampleInterval;
+    }
+
+    // @return the sequence number of the newest stored block, SampleStore::NO_SEQUENCE when none was stored
+    uint32_t lastSequence() const {
+        return nextSequence - 1;
+    }
+
+private:
+    SampleStore & store;
+    SampleBlockWriter writer;
+    uint32_t nextSequence;
+    uint32_t lastTime;
+    uint32_t maxAge;
+    uint16_t sampleInterval;
+    uint8_t numChannels;
+    bool started;
+};
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum ProfileInterpolation {
+    INTERPOLATION_NONE,     // each profile step is constant until the next step
+    INTERPOLATION_LINEAR,   // linear interpolation between the start and end of each step
+    INTERPOLATION_SMOOTH,   // smoothstep: 3u^2 - 2u^3, no change in slope at the start and end of a step
+    INTERPOLATION_SMOOTHER  // smootherstep: 6u^5 - 15u^4 + 10u^3, no change in slope or curvature at the start and end of a step
+};
+
+// A step of a profile as it is configured: the setpoint at the start of the step and how long it lasts.
+struct ProfilePoint {
+    uint32_t duration;
+    int16_t setpoint;
+};
+
+/*
+ * A step with its interpolation precomputed.
+ * With u the fraction of the step that has passed in 0.24 fixed point, the value is
+ *     value + u * (c[0] + u * (c[1] + u * (c[2] + u * (c[3] + u * c[4]))))
+ * The coefficients are the change in value during the step multiplied by the polynomial of the interpolation.
+ */
+struct ProfileSegment {
+    uint32_t start;             // time since the start of the profile at which the step starts
+    uint32_t inverseDuration;   // 0xFFFFFFFF / duration, 0 when the value is constant
+    int32_t c[5];
+    int16_t value;              // value at the start of the step
+};
+
+/*
+ * A profile with its steps precomputed when it is loaded, so evaluating it needs no divisions and no access to the
+ * configuration. Step i runs from the setpoint of step i to the setpoint of step i + 1. The last step holds its
+ * setpoint. Time is in any unit, as long as the durations and the times passed to the evaluation functions match.
+ */
+class SetpointProfile {
+public:
+    static const uint8_t MAX_STEPS = 16;
+
+    SetpointProfile() : count(0) {}
+    ~SetpointProfile() = default;
+
+    /*
+     * Precomputes the steps. Steps beyond MAX_STEPS are ignored.
+     * @return false when there are no steps
+     */
+    bool load(const ProfilePoint * points, uint8_t numSteps, ProfileInterpolation interpolation);
+
+    uint8_t stepCount() const {
+        return count;
+    }
+
+    uint32_t stepStart(uint8_t step) const {
+        return segments[step].start;
+    }
+
+    uint32_t stepDuration(uint8_t step) const {
+        return (step + 1 < count) ? segments[step + 1].start - segments[step].start : 0;
+    }
+
+    int16_t stepSetpoint(uint8_t step) const {
+        return segments[step].value;
+    }
+
+    // total duration of all steps, after which the profile holds the setpoint of the last step
+    uint32_t duration() const {
+        return count ? segments[count - 1].start : 0;
+    }
+
+    // step that is active at a time since the start of the profile, found with a binary search
+    uint8_t stepAt(uint32_t time) const;
+
+    // value at an offset within a step, the offset must be less than the duration of the step, except for the last step
+    int16_t valueInStep(uint8_t step, uint32_t offset) const;
+
+    // value at any time since the start of the profile, for example to resume a profile after a reboot
+    int16_t valueAt(uint32_t time) const {
+        uint8_t step = stepAt(time);
+        return valueInStep(step, time - segments[step].start);
+    }
+
+private:
+    ProfileSegment segments[MAX_STEPS];
+    uint8_t count;
+};
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Hands copies of a value from one writer to any number of readers without locks.
+ *
+ * The writer publishes into the half of a double buffer that holds the older snapshot, so a reader copying the
+ * newest snapshot is only disturbed when the writer publishes twice while it is copying. The reader detects that
+ * from the sequence numbers and copies again. The writer never waits for readers, so a high priority task can
+ * publish without being delayed by slow readers.
+ *
+ * Only one thread can call publish(). T is copied byte for byte, it should not contain pointers to data that
+ * changes.
+ */
+template <typename T>
+class SnapshotBuffer {
+public:
+    SnapshotBuffer() : published(0), writing(0) {
+        slots[0] = T();
+        slots[1] = T();
+    }
+    ~SnapshotBuffer() = default;
+
+    void publish(const T & value) {
+        uint32_t next = published.load(std::memory_order_relaxed) + 1;
+        // announce which slot is overwritten before writing it
+        writing.store(next, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slots[next & 1] = value;
+        published.store(next, std::memory_order_release);
+    }
+
+    /*
+     * Copies the newest snapshot.
+     * @return false when the writer overwrote the slot during the copy, out is then inconsistent
+     */
+    bool tryRead(T & out) const {
+        uint32_t sequence = published.load(std::memory_order_acquire);
+        out = slots[sequence & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t overwriting = writing.load(std::memory_order_relaxed);
+        return uint32_t(overwriting - sequence) <= 1;
+    }
+
+    // copies the newest snapshot, retries until the copy is consistent
+    T read() const {
+        T out;
+        while (!tryRead(out)) {
+        }
+        return out;
+    }
+
+    // number of snapshots published, to check whether there is a new snapshot without copying it
+    uint32_t version() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+private:
+    T slots[2];
+    std::atomic<uint32_t> published; // number of the newest complete snapshot, stored in slots[published & 1]
+    std::atomic<uint32_t> writing; // number of the snapshot that is being written
+};
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * The SPI bus and the chip select and data/command lines of a display.
+ * Implemented by the platform with the SPI peripheral and by tests with SpiSinkMock.
+ */
+class SpiSink {
+public:
+    virtual ~SpiSink() = default;
+
+    // assert (true) or release (false) chip select
+    virtual void select(bool selected) = 0;
+
+    // set the data/command line: true for data bytes, false for a command byte
+    virtual void dataMode(bool data) = 0;
+
+    /*
+     * Starts transmitting length bytes, after the previous write has been transmitted. The transfer can still be
+     * running when write() returns, for example with DMA, so the bytes must remain unchanged until the next call to
+     * write() or wait() returns.
+     */
+    virtual void write(const uint8_t * data, uint16_t length) = 0;
+
+    // blocks until the last write() has been transmitted
+    virtual void wait() = 0;
+};
+
+/*
+ * Streams commands and RGB565 pixels to an SPI display in bursts.
+ *
+ * Bytes are collected in one half of a double buffer. A full half is handed to the sink as a single write, while the
+ * other half is being filled, so a DMA transfer runs while the next pixels are prepared. Chip select is asserted
+ * at the first byte and stays asserted until end(), instead of toggling it around every byte.
+ *
+ * The display must use MIPI DCS column, page and memory write commands for setWindow(), like the ILI9341.
+ */
+class SpiDisplayStream {
+public:
+    // size of each half of the double buffer, an even number to keep pixels in one write
+    static const uint16_t BUFFER_SIZE = 64;
+
+    SpiDisplayStream(SpiSink & target) : sink(target), commandByte(0), pending(0), active(0), selected(false) {}
+    ~SpiDisplayStream() = default;
+
+    // transmits a command byte, after all bytes before it
+    void command(uint8_t cmd);
+
+    // adds a parameter or pixel byte
+    void data(uint8_t d) {
+        if(pending == BUFFER_SIZE){
+            flush();
+        }
+        buffer[active][pending++] = d;
+    }
+
+    // sets the window that following pixels fill, left to right and top to bottom, coordinates are inclusive
+    void setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+
+    // adds count pixels of the same color
+    void pushColor(uint16_t color, uint32_t count = 1);
+
+    // adds count pixels from a buffer
+    void pushColors(const uint16_t * colors, uint16_t count);
+
+    // hands the collected bytes to the sink, chip select stays asserted
+    void flush();
+
+    // transmits the collected bytes, waits until they are sent and releases chip select, so the bus can be shared
+    void end();
+
+    bool isSelected() const {
+        return selected;
+    }
+
+    static const uint8_t CASET = 0x2A; // column address set
+    static const uint8_t PASET = 0x2B; // page address set
+    static const uint8_t RAMWR = 0x2C; // memory write
+
+private:
+    void begin() {
+        if(!selected){
+            sink.select(true);
+            selected = true;
+        }
+    }
+
+    SpiSink & sink;
+    uint8_t buffer[2][BUFFER_SIZE];
+    uint8_t commandByte; // command byte being transmitted, must remain valid during the write
+    uint16_t pending; // number of bytes collected in the active half
+    uint8_t active; // half of the buffer that is being filled
+    bool selected;
+};
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SpiDisplayStream.h"
+#include <stdint.h>
+#include <vector>
+
+/*
+ * An SPI sink that records what would be sent to the display and counts the bus operations.
+ * Used to test display drivers on the host and to compare the cost of redraws.
+ */
+class SpiSinkMock final : public SpiSink {
+public:
+    SpiSinkMock() : recording(true) {
+        reset();
+    }
+    ~SpiSinkMock() = default;
+
+    void select(bool sel) override final {
+        if(sel && !selected){
+            selections++;
+        }
+        selected = sel;
+    }
+
+    void dataMode(bool data) override final {
+        dataLine = data;
+    }
+
+    void write(const uint8_t * data, uint16_t length) override final {
+        writes++;
+        if(dataLine){
+            dataBytes += length;
+        }
+        else{
+            commands += length;
+        }
+        if(!selected){
+            unselectedBytes += length;
+        }
+        if(recording){
+            for(uint16_t i = 0; i < length; i++){
+                bytes.push_back(data[i]);
+                commandFlags.push_back(!dataLine);
+            }
+        }
+    }
+
+    void wait() override final {}
+
+    void reset(){
+        selected = false;
+        dataLine = true;
+        selections = 0;
+        writes = 0;
+        commands = 0;
+        dataBytes = 0;
+        unselectedBytes = 0;
+        bytes.clear();
+        commandFlags.clear();
+    }
+
+    // total number of bytes clocked out
+    uint32_t totalBytes() const {
+        return commands + dataBytes;
+    }
+
+    /*
+     * Estimated time in microseconds to transmit everything at clockHz, with overheadMicros for each write and each
+     * chip select, the time it takes the CPU to start a transfer or toggle a pin.
+     */
+    uint32_t estimatedMicros(uint32_t clockHz, uint32_t overheadMicros) const {
+        uint64_t bits = uint64_t(totalBytes()) * 8;
+        return uint32_t(bits * 1000000 / clockHz) + (writes + selections) * overheadMicros;
+    }
+
+    bool recording; // store every byte in bytes, disable for large benchmarks
+    bool selected;
+    bool dataLine;
+    uint32_t selections; // number of times chip select was asserted
+    uint32_t writes;
+    uint32_t commands; // number of command bytes
+    uint32_t dataBytes;
+    uint32_t unselectedBytes; // bytes written without chip select asserted, should be zero
+    std::vector<uint8_t> bytes;
+    std::vector<bool> commandFlags; // true for each byte in bytes that was sent as a command
+};
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Fixed capacity storage for objects of one type.
+ * Objects are constructed in place in a statically sized array, in the order they are created, so iterating
+ * the pool walks memory linearly. Objects are destroyed all at once by clear(), in reverse order of creation.
+ */
+template<class T, uint8_t N>
+class StaticPool {
+public:
+    StaticPool() : count(0) {}
+
+    ~StaticPool() {
+        clear();
+    }
+
+    StaticPool(const StaticPool &) = delete;
+    StaticPool & operator=(const StaticPool &) = delete;
+
+    /*
+     * Constructs a new object in the pool.
+     * /return the new object or nullptr when the pool is full
+     */
+    template<class... Args>
+    T * create(Args&&... args) {
+        if (count >= N) {
+            return nullptr;
+        }
+        T * object = new (&storage[count]) T(std::forward<Args>(args)...);
+        count++;
+        return object;
+    }
+
+    void clear() {
+        while (count > 0) {
+            count--;
+            (*this)[count].~T();
+        }
+    }
+
+    T & operator[](uint8_t i) {
+        return *reinterpret_cast<T *>(&storage[i]);
+    }
+
+    const T & operator[](uint8_t i) const {
+        return *reinterpret_cast<const T *>(&storage[i]);
+    }
+
+    T * begin() {
+        return &(*this)[0];
+    }
+
+    T * end() {
+        return begin() + count;
+    }
+
+    uint8_t size() const {
+        return count;
+    }
+
+    static constexpr uint8_t capacity() {
+        return N;
+    }
+
+private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[N];
+    uint8_t count;
+};
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "Ticks.h"
+#include "Profiling.h"
+
+#ifndef TASK_SCHEDULER_MAX_TASKS
+#define TASK_SCHEDULER_MAX_TASKS (8)
+#endif
+
+typedef void (*TaskFunction)(void);
+
+#if BREWPI_PROFILING
+struct TaskStatistics : public RunTimeStatistics {
+    ticks_millis_t maxLateness; // time between release and start of a run
+    uint32_t missedDeadlines; // runs that finished later than release time + deadline
+    LatenessHistogram lateness;
+
+    void reset();
+};
+#endif
+
+/**
+ * A periodic task for the cooperative TaskScheduler.
+ * A task is released every period. The deadline is relative to the release time.
+ * When multiple tasks are due, the task with the highest priority runs first. Tasks with the same priority run
+ * earliest deadline first.
+ */
+class Task {
+public:
+    Task(TaskFunction _function, ticks_millis_t _period, ticks_millis_t _deadline, uint8_t _priority,
+         const char * _name = nullptr) :
+        function(_function),
+        name(_name),
+        period(_period),
+        deadline(_deadline),
+        nextRelease(0),
+        priority(_priority),
+        enabled(true) {
+        resetStatistics();
+    }
+    ~Task() = default;
+
+#if BREWPI_PROFILING
+    const TaskStatistics & statistics() const {
+        return stats;
+    }
+#endif
+
+    void resetStatistics(){
+        PROFILING_ONLY(stats.reset());
+    }
+
+    const char * getName() const {
+        return name;
+    }
+
+    ticks_millis_t getPeriod() const {
+        return period;
+    }
+
+    void setPeriod(ticks_millis_t _period){
+        period = _period;
+    }
+
+    uint8_t getPriority() const {
+        return priority;
+    }
+
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    void setEnabled(bool _enabled){
+        enabled = _enabled;
+    }
+
+    bool isDue(ticks_millis_t now) const {
+        return enabled && int32_t(now - nextRelease) >= 0;
+    }
+
+private:
+    void run(ticks_millis_t now);
+
+    ticks_millis_t absoluteDeadline() const {
+        return nextRelease + deadline;
+    }
+
+    TaskFunction function;
+    const char * name;
+    ticks_millis_t period;
+    ticks_millis_t deadline;
+    ticks_millis_t nextRelease;
+    uint8_t priority; // higher value is more important
+    bool enabled;
+#if BREWPI_PROFILING
+    TaskStatistics stats;
+#endif
+
+    friend class TaskScheduler;
+};
+
+/**
+ * Cooperative scheduler for the main loop.
+ * Each call to run() executes the most urgent task that is due. Long jobs should be split into multiple tasks, so
+ * short high priority tasks (like PWM) can be serviced in between.
+ */
+class TaskScheduler {
+public:
+    TaskScheduler() : count(0) {}
+    ~TaskScheduler() = default;
+
+    /**
+     * Adds a task. The first run of the task is released immediately.
+     * @return false when the scheduler is full
+     */
+    bool add(Task * task);
+    void remove(Task * task);
+
+    /**
+     * Runs the most urgent task that is due.
+     * @return the task that was run, or nullptr when no task was due
+     */
+    Task * run();
+
+    uint8_t taskCount() const {
+        return count;
+    }
+
+    Task * task(uint8_t index) const {
+        return index < count ? tasks[index] : nullptr;
+    }
+
+    void resetStatistics();
+
+private:
+    Task * tasks[TASK_SCHEDULER_MAX_TASKS];
+    uint8_t count;
+};
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Binary telemetry frames, an alternative to formatting values as JSON text.
+ *
+ * A frame before encoding is:
+ *     flags (1 byte)       TELEMETRY_KEYFRAME when the frame holds all values, TELEMETRY_MORE when the batch continues
+ *                          in the next frame
+ *     sequence (1 byte)    incremented for each frame, a gap means a frame was lost
+ *     time (4 bytes)       milliseconds, little endian
+ *     records              a header byte with the object id in the low 6 bits and the number of value bytes minus 1 in
+ *                          the high 2 bits, followed by the raw fixed point value, signed little endian
+ *     crc (2 bytes)        CRC-16/CCITT of everything before it, little endian
+ *
+ * The frame is COBS encoded, so it contains no zero bytes, and sent between two zero bytes. Text lines never contain
+ * a zero byte, so a client can receive frames and text responses on the same stream.
+ *
+ * Blocks of the data log are sent in frames with the TELEMETRY_LOG_BLOCK flag, followed by the sequence number of the
+ * block (4 bytes, little endian), the block and the crc.
+ */
+
+static const uint8_t TELEMETRY_KEYFRAME = 0x01;
+static const uint8_t TELEMETRY_MORE = 0x02;
+static const uint8_t TELEMETRY_LOG_BLOCK = 0x80;
+static const uint16_t TELEMETRY_MAX_BLOCK_SIZE = 240;
+
+// CRC-16/CCITT with polynomial 0x1021 and initial value 0xFFFF
+uint16_t telemetryCrc(const uint8_t * data, uint16_t length, uint16_t crc = 0xFFFF);
+
+/*
+ * Encodes length bytes with consistent overhead byte stuffing, out must hold length + length / 254 + 1 bytes.
+ * @return number of bytes written to out
+ */
+uint16_t cobsEncode(const uint8_t * in, uint16_t length, uint8_t * out);
+
+/*
+ * Decodes a COBS encoded block without its delimiters, out must hold length bytes. in and out can be the same.
+ * @return number of decoded bytes, 0 when the input is not valid COBS
+ */
+uint16_t cobsDecode(const uint8_t * in, uint16_t length, uint8_t * out);
+
+// Receives encoded frames, including their delimiters
+class TelemetrySink {
+public:
+    virtual ~TelemetrySink() = default;
+    virtual void write(const uint8_t * data, uint16_t length) = 0;
+};
+
+/**
+ * Sends values as telemetry frames, only the values that changed since they were last sent.
+ *
+ * All values of one update are a batch: begin() starts it, add() each value and end() sends it. A batch that does not
+ * fit in one frame is split. Every keyframeInterval batches, and after requestKeyframe(), all values are sent, so a
+ * client that connects or misses a frame is complete again.
+ */
+class TelemetryWriter {
+public:
+    static const uint8_t MAX_IDS = 64;
+    static const uint8_t PAYLOAD_SIZE = 120; // maximum size of the records in one frame
+    static const uint8_t HEADER_SIZE = 6;
+    static const uint8_t FRAME_SIZE = HEADER_SIZE + PAYLOAD_SIZE + 2;
+    static const uint8_t ENCODED_SIZE = FRAME_SIZE + FRAME_SIZE / 254 + 1 + 2; // with COBS overhead and delimiters
+
+    TelemetryWriter(TelemetrySink & target, uint8_t keyframeInterval = 60);
+    ~TelemetryWriter() = default;
+
+    void begin(uint32_t time);
+
+    // adds a value to the batch, when it changed since it was last sent or when the batch is a keyframe
+    void add(uint8_t id, int32_t value);
+
+    // sends the remaining values, a batch without changes is still sent so the client sees the time advance
+    void end();
+
+    void requestKeyframe() {
+        keyframeCountdown = 0;
+    }
+
+    uint8_t sequence() const {
+        return nextSequence;
+    }
+
+private:
+    void flush(bool more);
+
+    TelemetrySink & sink;
+    int32_t lastSent[MAX_IDS];
+    uint64_t sentIds; // bit mask of the ids in lastSent
+    uint8_t frame[FRAME_SIZE];
+    uint8_t length; // bytes in frame
+    uint32_t batchTime;
+    uint8_t nextSequence;
+    uint8_t interval;
+    uint8_t keyframeCountdown; // batches until the next keyframe
+    bool keyframe; // the current batch is a keyframe
+};
+
+struct TelemetryRecord {
+    uint8_t id;
+    int32_t value;
+};
+
+struct TelemetryFrame {
+    uint8_t flags;
+    uint8_t sequence;
+    uint32_t time;
+    uint8_t count;
+    TelemetryRecord records[TelemetryWriter::PAYLOAD_SIZE / 2];
+};
+
+/*
+ * Decodes a frame as received between two zero bytes.
+ * @return false when the frame is not valid COBS, is truncated or has the wrong CRC
+ */
+bool telemetryDecode(const uint8_t * encoded, uint16_t length, TelemetryFrame & frame);
+
+// sends a block of the data log as a frame, the block can be up to TELEMETRY_MAX_BLOCK_SIZE bytes
+void telemetrySendBlock(TelemetrySink & sink, uint32_t sequence, const uint8_t * block, uint16_t length);
+
+/*
+ * Decodes a frame with a block of the data log, block must hold TELEMETRY_MAX_BLOCK_SIZE bytes.
+ * @return false when the frame is not a valid block frame
+ */
+bool telemetryDecodeBlock(const uint8_t * encoded, uint16_t length, uint32_t & sequence, uint8_t * block,
+                          uint16_t & blockLength);
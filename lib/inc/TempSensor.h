@@ -73,6 +73,7 @@ public:
      */
     void update() override final {
         sensor->update();
+        publishChange();
     }
 
     /*
@@ -22,6 +22,7 @@
 
 #include "temperatureFormats.h"
 #include "ControllerMixins.h"
+#include "ChangeNotifier.h"
 
 #define TEMP_SENSOR_DISCONNECTED temp_t::invalid()
 
@@ -48,6 +49,24 @@ public:
 	 */
 	virtual temp_t read() const = 0;
 
+    /*
+     * Listeners are notified of changes of read(), implementations publish at the end of update()
+     */
+    void subscribe(ChangeListener<temp_t> & listener){
+        changes.subscribe(listener);
+    }
+
+    void unsubscribe(ChangeListener<temp_t> & listener){
+        changes.unsubscribe(listener);
+    }
+
+protected:
+    void publishChange(){
+        changes.publish(read());
+    }
+
+private:
+    ChangeNotifier<temp_t> changes;
 };
 
 
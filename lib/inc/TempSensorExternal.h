@@ -47,7 +47,7 @@ class TempSensorExternal final : public TempSensorBasic, public TempSensorExtern
 	}
 	
     void update() override final {
-        // nop for this mock sensor
+        publishChange(); // nothing to read for this mock sensor
     }
 
 	temp_t read() const override final {
@@ -44,7 +44,7 @@ public:
 	}
 
 	void update() override final {
-	    // nop for this mock sensor
+	    publishChange(); // nothing to read for this mock sensor
 	}
 
 	temp_t read() const override final
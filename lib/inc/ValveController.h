@@ -21,19 +21,36 @@
 #include "DS2408.h"
 #include "ActuatorInterfaces.h"
 #include "ControllerMixins.h"
+#include "BlockPool.h"
 
 class ValveController final : public ActuatorDigital, public ValveControllerMixin {
 public:
-    ValveController(OneWire *     bus,
-                    DeviceAddress address,
-                    pio_t         pio_) :
+    ValveController() :
                     switchState(0xff), // Set outputs and inputs to OFF state
                     sense(0b11), // Set sense to OFF state (in between)
                     act(0b11),   // set output to OFF (not open/closed, no action)
-                    pio(pio_){  //
-        device.init(bus, address);
+                    pio(0),
+                    device(nullptr){
+    }
+    ValveController(OneWire *     bus,
+                    DeviceAddress address,
+                    pio_t         pio_) : ValveController(){
+        init(bus, address, pio_);
+    }
+    ~ValveController(){
+        OneWireSwitch::release(device);
+    }
+
+    /*
+     * Acquires the shared DS2408.
+     * /return false when the pool of switches is full. The valve then stays inactive and ignores writes.
+     */
+    bool init(OneWire * bus, DeviceAddress address, pio_t pio_){
+        pio = pio_;
+        OneWireSwitch::release(device);
+        device = OneWireSwitch::acquire<DS2408>(bus, address);
+        return device != nullptr;
     }
-    ~ValveController() = default;
 
     enum class ValveActions : uint8_t {
         OFF_LOW = 0b00,
@@ -55,11 +72,12 @@ public:
         else{
             close();
         }
+        publishChange();
     }
 
     bool isActive() const override final {
         // return active when not closed, so a half open valve also returns active
-        return sense != uint8_t(ValveActions::CLOSE);
+        return device != nullptr && sense != uint8_t(ValveActions::CLOSE);
     }
 
     uint8_t read(bool doUpdate = true);
@@ -76,12 +94,17 @@ public:
         write(ValveActions::OFF);
     }
 
+    POOL_ALLOCATED
+
 protected:
     uint8_t switchState; // state bits of the entire switch
     uint8_t sense; // sensed value (feedback)
     uint8_t act; // written value (actuator)
     pio_t pio; // 0=A or 1=B
-    DS2408 device;
+    DS2408 * device; // shared with the other valve on the same DS2408
+
+    // sets act and sense from the switch state
+    void parseState();
 
     friend class ValveControllerMixin;
 };
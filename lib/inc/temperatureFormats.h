@@ -136,6 +136,10 @@ public:
         value_= val;
     }
 
+    TEMP_TYPE getRaw() const {
+        return value_;
+    }
+
     bool isDisabledOrInvalid() const {
         return (value_ < min_val);
     }
@@ -253,6 +257,10 @@ public:
         value_= val;
     }
 
+    TEMP_PRECISE_TYPE getRaw() const {
+        return value_;
+    }
+
     char * toString(char buf[], uint8_t numDecimals, uint8_t len) const {
         return toStringImpl(value_, fractional_bit_count, buf, numDecimals, len, 'C', false);
     }
@@ -352,6 +360,10 @@ public:
         value_= val;
     }
 
+    TEMP_LONG_TYPE getRaw() const {
+        return value_;
+    }
+
     char * toString(char buf[], uint8_t numDecimals, uint8_t len) const {
         return toStringImpl(value_, fractional_bit_count, buf, numDecimals, len, 'C', false);
     }
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Time and logging for the simulation sweep tool, like platform/test/src/runner.cpp and Logger.cpp provide them for
+ * the tests. Each worker process has its own copy of these globals.
+ */
+
+#include "Platform.h"
+#include "Ticks.h"
+#include "Logger.h"
+
+ExternalTicks ticks;
+NoOpDelay wait;
+
+// delay ms milliseconds and return current time afterwards
+ticks_millis_t delay(int ms) {
+    ticks.incMillis(ms);
+    return ticks.millis();
+}
+
+// log messages of hundreds of runs in parallel processes are not useful, the results are in the metrics
+void Logger::logMessageVaArg(char type, LOG_ID_TYPE errorID, const char * varTypes, ...){
+}
+
+Logger logger;
@@ -0,0 +1,312 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SimulationRun.h"
+#include "Simulation.h"
+
+#include "Pid.h"
+#include "SetPoint.h"
+#include "TempSensorMock.h"
+#include "ActuatorMocks.h"
+#include "ActuatorPwm.h"
+#include "ActuatorTimeLimited.h"
+#include "ActuatorSetPoint.h"
+#include "ActuatorMutexDriver.h"
+#include "ActuatorMutexGroup.h"
+#include "Ticks.h"
+#include "TicksImpl.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+ticks_millis_t delay(int ms);
+
+static const char * const modeNames[SIM_NUM_MODES] = {
+    "beer-heater",
+    "fridge-heater",
+    "beer-cooler",
+    "fridge-cooler",
+    "fridge-heater-cooler",
+    "beer-heater-cooler",
+    "cascaded-heater-cooler"
+};
+
+const char * simModeName(SimMode mode){
+    return mode < SIM_NUM_MODES ? modeNames[mode] : "unknown";
+}
+
+SimMode simModeFromName(const char * name){
+    for(uint8_t i = 0; i < SIM_NUM_MODES; i++){
+        if(strcmp(name, modeNames[i]) == 0){
+            return SimMode(i);
+        }
+    }
+    return SIM_NUM_MODES;
+}
+
+SimParams simDefaultParams(SimMode mode){
+    SimParams p;
+    p.mode = mode;
+    p.inputFilter = 1;
+    p.derivativeFilter = 4;
+    p.heaterPeriod = 20;
+    p.coolerPeriod = 1200;
+    p.envTemp = 20.0;
+    p.startTemp = 20.0;
+    p.stepTime = 1000;
+    p.settlingBand = 0.2;
+
+    switch(mode){
+    case SIM_BEER_HEATER:
+        p.kp = 60.0; p.ti = 7200; p.td = 500;
+        p.envTemp = 16.0; p.targetTemp = 22.0; p.duration = 40000;
+        break;
+    case SIM_FRIDGE_HEATER:
+        p.kp = 10.0; p.ti = 600; p.td = 60;
+        p.envTemp = 16.0; p.targetTemp = 24.0; p.duration = 20000;
+        break;
+    case SIM_BEER_COOLER:
+        p.kp = 40.0; p.ti = 7200; p.td = 1200;
+        p.inputFilter = 2; p.derivativeFilter = 5;
+        p.envTemp = 24.0; p.targetTemp = 18.0; p.duration = 30000;
+        break;
+    case SIM_FRIDGE_COOLER:
+        p.kp = 10.0; p.ti = 1800; p.td = 200;
+        p.derivativeFilter = 5;
+        p.envTemp = 24.0; p.targetTemp = 16.0; p.duration = 20000;
+        break;
+    case SIM_FRIDGE_HEATER_COOLER:
+        p.kp = 10.0; p.ti = 1800; p.td = 200;
+        p.targetTemp = 17.0; p.duration = 30000;
+        break;
+    case SIM_BEER_HEATER_COOLER:
+        p.kp = 40.0; p.ti = 7200; p.td = 1200;
+        p.targetTemp = 18.0; p.duration = 40000;
+        break;
+    case SIM_CASCADED_HEATER_COOLER:
+    default:
+        p.kp = 2.0; p.ti = 7200; p.td = 1200;
+        p.targetTemp = 18.0; p.duration = 60000;
+        break;
+    }
+    return p;
+}
+
+/*
+ * Same actuator chain as StaticSetup in SimulationTest.cpp, with the objects as members instead of on the heap.
+ */
+struct SimSetup {
+    SimSetup(const SimParams & params) :
+        beerSensor(params.startTemp),
+        fridgeSensor(params.startTemp),
+        heaterMutex(&heaterPin),
+        heater(&heaterMutex, params.heaterPeriod),
+        coolerTimeLimited(&coolerPin, 120, 180), // 2 min minOn time, 3 min minOff
+        coolerMutex(&coolerTimeLimited),
+        cooler(&coolerMutex, params.coolerPeriod),
+        beerSet(params.startTemp),
+        fridgeSet(params.startTemp),
+        fridgeSetPointActuator(&fridgeSet, &fridgeSensor, &beerSet) {
+        heaterPid.setOutputActuator(&heater);
+        coolerPid.setOutputActuator(&cooler);
+        coolerPid.setActuatorIsNegative(true);
+        beerToFridgePid.setOutputActuator(&fridgeSetPointActuator);
+    }
+
+    TempSensorMock beerSensor;
+    TempSensorMock fridgeSensor;
+
+    ActuatorBool heaterPin;
+    ActuatorMutexDriver heaterMutex;
+    ActuatorPwm heater;
+
+    ActuatorBool coolerPin;
+    ActuatorTimeLimited coolerTimeLimited;
+    ActuatorMutexDriver coolerMutex;
+    ActuatorPwm cooler;
+
+    ActuatorMutexGroup mutex;
+
+    SetPointSimple beerSet;
+    SetPointSimple fridgeSet;
+    ActuatorSetPoint fridgeSetPointActuator;
+
+    Pid heaterPid;
+    Pid coolerPid;
+    Pid beerToFridgePid;
+};
+
+static void configurePid(Pid & pid, TempSensorBasic * sensor, SetPoint * setPoint,
+        double kp, double ti, double td, uint8_t inputFilter, uint8_t derivativeFilter){
+    pid.setInputSensor(sensor);
+    pid.setSetPoint(setPoint);
+    pid.setInputFilter(inputFilter);
+    pid.setDerivativeFilter(derivativeFilter);
+    pid.setConstants(kp, ti, td);
+}
+
+SimResult simRun(const SimParams & params, std::ostream * trace, uint16_t traceInterval){
+    // make runs reproducible, independent of which runs were simulated before in the same worker
+    ticks.reset(); // actuators store time stamps on construction
+    srand(1); // TempSensorMock adds noise with rand()
+    SimSetup s(params);
+    Simulation sim;
+    sim.beerTemp = sim.airTemp = sim.wallTemp = sim.heaterTemp = params.startTemp;
+    sim.envTemp = params.envTemp;
+
+    bool beerControlled = false;
+    bool useHeater = false;
+    bool useCooler = false;
+    bool cascaded = false;
+    switch(params.mode){
+    case SIM_BEER_HEATER:            beerControlled = true; useHeater = true; break;
+    case SIM_FRIDGE_HEATER:          useHeater = true; break;
+    case SIM_BEER_COOLER:            beerControlled = true; useCooler = true; break;
+    case SIM_FRIDGE_COOLER:          useCooler = true; break;
+    case SIM_FRIDGE_HEATER_COOLER:   useHeater = true; useCooler = true; break;
+    case SIM_BEER_HEATER_COOLER:     beerControlled = true; useHeater = true; useCooler = true; break;
+    case SIM_CASCADED_HEATER_COOLER:
+    default:                         beerControlled = true; useHeater = true; useCooler = true; cascaded = true; break;
+    }
+
+    TempSensorBasic * controlledSensor = beerControlled ? &s.beerSensor : &s.fridgeSensor;
+    SetPoint & controlledSet = beerControlled ? static_cast<SetPoint &>(s.beerSet) : static_cast<SetPoint &>(s.fridgeSet);
+
+    if(cascaded){
+        // inner loops use the constants of SimCascadedHeaterCooler, the sweep tunes the outer loop
+        configurePid(s.coolerPid, &s.fridgeSensor, &s.fridgeSet, 10.0, 1800, 200, 1, 4);
+        configurePid(s.heaterPid, &s.fridgeSensor, &s.fridgeSet, 10.0, 600, 60, 1, 4);
+        configurePid(s.beerToFridgePid, &s.beerSensor, &s.beerSet,
+                params.kp, params.ti, params.td, params.inputFilter, params.derivativeFilter);
+        s.fridgeSetPointActuator.setMin(-10.0);
+        s.fridgeSetPointActuator.setMax(10.0);
+    }
+    else {
+        if(useHeater){
+            configurePid(s.heaterPid, controlledSensor, &controlledSet,
+                    params.kp, params.ti, params.td, params.inputFilter, params.derivativeFilter);
+        }
+        if(useCooler){
+            configurePid(s.coolerPid, controlledSensor, &controlledSet,
+                    params.kp, params.ti, params.td, params.inputFilter, params.derivativeFilter);
+        }
+    }
+    if(useHeater && useCooler){
+        s.coolerMutex.setMutex(&s.mutex);
+        s.heaterMutex.setMutex(&s.mutex);
+        s.mutex.setDeadTime(3600000); // 60 minutes
+    }
+
+    if(trace != nullptr){
+        trace->precision(5);
+        *trace << "1#set point, 1#beer sensor, 1#fridge air sensor, 1#fridge wall temp, 2#error, "
+                "3#heater pwm, 3#cooler pwm, 4a#heater pin, 4a#cooler pin\n";
+    }
+
+    SimResult result = {0};
+    const double direction = params.targetTemp >= params.startTemp ? 1.0 : -1.0;
+    const uint32_t steadyStateStart = params.duration - params.duration / 10;
+    uint32_t lastOutsideBand = params.stepTime;
+    bool settled = true;
+    double steadyStateErrorSum = 0;
+    uint32_t heaterOnTime = 0;
+    uint32_t coolerOnTime = 0;
+    bool heaterWasActive = false;
+    bool coolerWasActive = false;
+
+    for(uint32_t t = 0; t < params.duration; t++){
+        controlledSet.write(t < params.stepTime ? params.startTemp : params.targetTemp);
+
+        s.beerSensor.setTemp(sim.beerTemp);
+        s.fridgeSensor.setTemp(sim.airTemp);
+        if(useHeater){
+            s.heaterPid.update();
+        }
+        if(useCooler){
+            s.coolerPid.update();
+        }
+        if(cascaded){
+            s.beerToFridgePid.update();
+        }
+        if(useCooler){
+            s.cooler.update();
+        }
+        if(useHeater){
+            s.heater.update();
+        }
+        if(cascaded){
+            s.fridgeSetPointActuator.update();
+        }
+        if(useHeater && useCooler){
+            s.mutex.update();
+        }
+
+        bool heaterActive = s.heaterPin.isActive();
+        bool coolerActive = s.coolerPin.isActive();
+        sim.update(heaterActive, coolerActive);
+        delay(1000); // simulate actual time passing for pin state of cooler, which is time limited
+
+        result.heaterCycles += (heaterActive && !heaterWasActive) ? 1 : 0;
+        result.coolerCycles += (coolerActive && !coolerWasActive) ? 1 : 0;
+        heaterOnTime += heaterActive ? 1 : 0;
+        coolerOnTime += coolerActive ? 1 : 0;
+        heaterWasActive = heaterActive;
+        coolerWasActive = coolerActive;
+
+        // TempSensorMock adds noise on each read, so always read both sensors once, also when not tracing
+        double beerTemp = s.beerSensor.read();
+        double fridgeTemp = s.fridgeSensor.read();
+        double setPoint = controlledSet.read();
+        double error = (beerControlled ? beerTemp : fridgeTemp) - setPoint;
+        if(t >= params.stepTime){
+            if(error * direction > result.overshoot){
+                result.overshoot = error * direction;
+            }
+            if(fabs(error) > params.settlingBand){
+                lastOutsideBand = t + 1;
+                settled = false;
+            }
+            else {
+                settled = true;
+            }
+        }
+        if(t >= steadyStateStart){
+            steadyStateErrorSum += fabs(error);
+        }
+
+        if(trace != nullptr && (t % traceInterval) == 0){
+            *trace  << setPoint << ","
+                    << beerTemp << ","
+                    << fridgeTemp << ","
+                    << sim.wallTemp << ","
+                    << error << ","
+                    << s.heater.getValue() << ","
+                    << s.cooler.getValue() << ","
+                    << heaterActive << ","
+                    << coolerActive << "\n";
+        }
+    }
+
+    result.settlingTime = settled ? double(lastOutsideBand - params.stepTime) : -1.0;
+    result.steadyStateError = steadyStateErrorSum / (params.duration - steadyStateStart);
+    result.heaterDuty = double(heaterOnTime) / params.duration;
+    result.coolerDuty = double(coolerOnTime) / params.duration;
+    result.completed = true;
+    return result;
+}
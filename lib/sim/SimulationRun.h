@@ -0,0 +1,94 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <ostream>
+
+/**
+ * Control set ups that can be simulated. They match the static set ups in SimulationTest.cpp.
+ */
+enum SimMode : uint8_t {
+    SIM_BEER_HEATER,
+    SIM_FRIDGE_HEATER,
+    SIM_BEER_COOLER,
+    SIM_FRIDGE_COOLER,
+    SIM_FRIDGE_HEATER_COOLER,
+    SIM_BEER_HEATER_COOLER,
+    SIM_CASCADED_HEATER_COOLER,
+    SIM_NUM_MODES
+};
+
+/**
+ * Parameters of a single simulation run.
+ * The PID constants and filters are applied to the PID that controls the simulated process value: both the heater and
+ * cooler PID for the non-cascaded set ups and the beer to fridge PID for the cascaded set up.
+ */
+struct SimParams {
+    SimMode mode;
+    double kp;
+    double ti;
+    double td;
+    uint8_t inputFilter;
+    uint8_t derivativeFilter;
+    uint16_t heaterPeriod;  // seconds
+    uint16_t coolerPeriod;  // seconds
+    double envTemp;
+    double startTemp;       // initial temperature of the simulation and the set point before the step
+    double targetTemp;      // set point after the step
+    uint32_t stepTime;      // seconds
+    uint32_t duration;      // seconds
+    double settlingBand;    // process value is settled when it stays within this distance from the set point
+};
+
+/**
+ * Performance of a simulation run, measured from the set point step.
+ */
+struct SimResult {
+    double settlingTime;    // seconds after the step until the process value stays within the band, -1 if never
+    double overshoot;       // largest excursion past the new set point, in the direction of the step
+    double steadyStateError;// mean absolute error over the last 10% of the run
+    uint32_t heaterCycles;  // number of times the heater pin was switched on
+    uint32_t coolerCycles;
+    double heaterDuty;      // fraction of the run the heater pin was active
+    double coolerDuty;
+    bool completed;
+};
+
+const char * simModeName(SimMode mode);
+
+/**
+ * @return the mode with the given name, or SIM_NUM_MODES when the name is unknown
+ */
+SimMode simModeFromName(const char * name);
+
+/**
+ * @return parameters for mode with the same constants and set point profile as the matching test in SimulationTest.cpp
+ */
+SimParams simDefaultParams(SimMode mode);
+
+/**
+ * Runs one simulation against the real Pid, ActuatorPwm, ActuatorTimeLimited and ActuatorMutexGroup classes.
+ * Time is advanced with delay(), so runs in the same process cannot be executed concurrently.
+ *
+ * @param trace when not null, receives a CSV trace in the format read by test_results/plot_all.py
+ * @param traceInterval one row is written to the trace per traceInterval seconds
+ */
+SimResult simRun(const SimParams & params, std::ostream * trace, uint16_t traceInterval);
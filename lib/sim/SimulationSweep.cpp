@@ -0,0 +1,326 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Batch simulation of control set ups, for tuning PID constants, filters and PWM periods.
+ *
+ * Each combination of the swept parameters is simulated with the thermal model from Simulation.h. The runs are
+ * distributed over worker processes: the library reads time from the global ticks object, so runs cannot share a
+ * process concurrently. The results are collected in shared memory and written as one CSV row per run, in the format
+ * read by test_results/plot_all.py.
+ *
+ * Example:
+ *   obj/simulator -m beer-heater,beer-cooler --kp 20,40,60 --td 0,600,1200 -o ../../test_results --trace
+ */
+
+#include "SimulationRun.h"
+
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void usage(const char * name){
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -m, --mode LIST              set ups to simulate (default: all)\n"
+        "      --kp LIST                proportional gain\n"
+        "      --ti LIST                integral time (s)\n"
+        "      --td LIST                derivative time (s)\n"
+        "      --input-filter LIST      PID input filter index\n"
+        "      --derivative-filter LIST PID derivative filter index\n"
+        "      --heater-period LIST     heater PWM period (s)\n"
+        "      --cooler-period LIST     cooler PWM period (s)\n"
+        "      --duration SECONDS       simulated time per run (default: per set up)\n"
+        "      --band DEGREES           settling band around the set point (default: 0.2)\n"
+        "  -j, --jobs N                 number of worker processes (default: number of cores)\n"
+        "  -o, --output DIR             directory for summary.csv and traces (default: .)\n"
+        "  -t, --trace                  write a CSV trace per run\n"
+        "      --trace-interval SECONDS time between trace rows (default: 60)\n"
+        "LIST is a comma separated list of values. Parameters that are not swept use the defaults of the set up.\n"
+        "Set ups: ", name);
+    for(uint8_t m = 0; m < SIM_NUM_MODES; m++){
+        fprintf(stderr, "%s%s", m ? ", " : "", simModeName(SimMode(m)));
+    }
+    fprintf(stderr, "\n");
+}
+
+static bool parseList(const char * arg, std::vector<double> & values){
+    std::string s(arg);
+    size_t start = 0;
+    while(start <= s.size()){
+        size_t end = s.find(',', start);
+        if(end == std::string::npos){
+            end = s.size();
+        }
+        std::string item = s.substr(start, end - start);
+        char * parsedEnd;
+        double value = strtod(item.c_str(), &parsedEnd);
+        if(item.empty() || *parsedEnd != '\0'){
+            return false;
+        }
+        values.push_back(value);
+        start = end + 1;
+    }
+    return true;
+}
+
+static bool parseModes(const char * arg, std::vector<SimMode> & modes){
+    std::string s(arg);
+    size_t start = 0;
+    while(start <= s.size()){
+        size_t end = s.find(',', start);
+        if(end == std::string::npos){
+            end = s.size();
+        }
+        SimMode mode = simModeFromName(s.substr(start, end - start).c_str());
+        if(mode == SIM_NUM_MODES){
+            return false;
+        }
+        modes.push_back(mode);
+        start = end + 1;
+    }
+    return true;
+}
+
+// a swept parameter, or the default of the set up when nothing is swept
+struct Sweep {
+    std::vector<double> values;
+
+    size_t size() const {
+        return values.empty() ? 1 : values.size();
+    }
+    double get(size_t i, double defaultValue) const {
+        return values.empty() ? defaultValue : values[i];
+    }
+};
+
+enum SweepParam {
+    SWEEP_KP, SWEEP_TI, SWEEP_TD, SWEEP_INPUT_FILTER, SWEEP_DERIVATIVE_FILTER, SWEEP_HEATER_PERIOD, SWEEP_COOLER_PERIOD,
+    SWEEP_NUM_PARAMS
+};
+
+static std::vector<SimParams> expand(const std::vector<SimMode> & modes, const Sweep (&sweeps)[SWEEP_NUM_PARAMS],
+        double duration, double band){
+    std::vector<SimParams> runs;
+    for(SimMode mode : modes){
+        size_t combinations = 1;
+        for(const Sweep & sweep : sweeps){
+            combinations *= sweep.size();
+        }
+        for(size_t c = 0; c < combinations; c++){
+            size_t idx[SWEEP_NUM_PARAMS];
+            size_t rest = c;
+            for(int i = SWEEP_NUM_PARAMS - 1; i >= 0; i--){
+                idx[i] = rest % sweeps[i].size();
+                rest /= sweeps[i].size();
+            }
+            SimParams p = simDefaultParams(mode);
+            p.kp = sweeps[SWEEP_KP].get(idx[SWEEP_KP], p.kp);
+            p.ti = sweeps[SWEEP_TI].get(idx[SWEEP_TI], p.ti);
+            p.td = sweeps[SWEEP_TD].get(idx[SWEEP_TD], p.td);
+            p.inputFilter = sweeps[SWEEP_INPUT_FILTER].get(idx[SWEEP_INPUT_FILTER], p.inputFilter);
+            p.derivativeFilter = sweeps[SWEEP_DERIVATIVE_FILTER].get(idx[SWEEP_DERIVATIVE_FILTER], p.derivativeFilter);
+            p.heaterPeriod = sweeps[SWEEP_HEATER_PERIOD].get(idx[SWEEP_HEATER_PERIOD], p.heaterPeriod);
+            p.coolerPeriod = sweeps[SWEEP_COOLER_PERIOD].get(idx[SWEEP_COOLER_PERIOD], p.coolerPeriod);
+            if(duration > 0){
+                p.duration = duration;
+            }
+            if(band > 0){
+                p.settlingBand = band;
+            }
+            runs.push_back(p);
+        }
+    }
+    return runs;
+}
+
+static std::string traceFileName(const std::string & dir, size_t index, const SimParams & p){
+    char name[128];
+    snprintf(name, sizeof(name), "/sim-%04u-%s.csv", unsigned(index), simModeName(p.mode));
+    return dir + name;
+}
+
+// runs every jobs'th simulation, starting at first
+static void worker(const std::vector<SimParams> & runs, SimResult * results, size_t first, size_t jobs,
+        const std::string & dir, bool writeTraces, uint16_t traceInterval){
+    for(size_t i = first; i < runs.size(); i += jobs){
+        if(writeTraces){
+            std::ofstream csv(traceFileName(dir, i, runs[i]).c_str());
+            results[i] = simRun(runs[i], &csv, traceInterval);
+        }
+        else {
+            results[i] = simRun(runs[i], nullptr, traceInterval);
+        }
+    }
+}
+
+int main(int argc, char ** argv){
+    enum {
+        OPT_KP = 256, OPT_TI, OPT_TD, OPT_INPUT_FILTER, OPT_DERIVATIVE_FILTER, OPT_HEATER_PERIOD, OPT_COOLER_PERIOD,
+        OPT_DURATION, OPT_BAND, OPT_TRACE_INTERVAL
+    };
+    static const struct option options[] = {
+        { "mode",              required_argument, nullptr, 'm' },
+        { "kp",                required_argument, nullptr, OPT_KP },
+        { "ti",                required_argument, nullptr, OPT_TI },
+        { "td",                required_argument, nullptr, OPT_TD },
+        { "input-filter",      required_argument, nullptr, OPT_INPUT_FILTER },
+        { "derivative-filter", required_argument, nullptr, OPT_DERIVATIVE_FILTER },
+        { "heater-period",     required_argument, nullptr, OPT_HEATER_PERIOD },
+        { "cooler-period",     required_argument, nullptr, OPT_COOLER_PERIOD },
+        { "duration",          required_argument, nullptr, OPT_DURATION },
+        { "band",              required_argument, nullptr, OPT_BAND },
+        { "jobs",              required_argument, nullptr, 'j' },
+        { "output",            required_argument, nullptr, 'o' },
+        { "trace",             no_argument,       nullptr, 't' },
+        { "trace-interval",    required_argument, nullptr, OPT_TRACE_INTERVAL },
+        { "help",              no_argument,       nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    std::vector<SimMode> modes;
+    Sweep sweeps[SWEEP_NUM_PARAMS];
+    double duration = 0;
+    double band = 0;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    std::string dir = ".";
+    bool writeTraces = false;
+    long traceInterval = 60;
+
+    int opt;
+    bool valid = true;
+    while(valid && (opt = getopt_long(argc, argv, "m:j:o:th", options, nullptr)) != -1){
+        switch(opt){
+        case 'm':                   valid = parseModes(optarg, modes); break;
+        case OPT_KP:                valid = parseList(optarg, sweeps[SWEEP_KP].values); break;
+        case OPT_TI:                valid = parseList(optarg, sweeps[SWEEP_TI].values); break;
+        case OPT_TD:                valid = parseList(optarg, sweeps[SWEEP_TD].values); break;
+        case OPT_INPUT_FILTER:      valid = parseList(optarg, sweeps[SWEEP_INPUT_FILTER].values); break;
+        case OPT_DERIVATIVE_FILTER: valid = parseList(optarg, sweeps[SWEEP_DERIVATIVE_FILTER].values); break;
+        case OPT_HEATER_PERIOD:     valid = parseList(optarg, sweeps[SWEEP_HEATER_PERIOD].values); break;
+        case OPT_COOLER_PERIOD:     valid = parseList(optarg, sweeps[SWEEP_COOLER_PERIOD].values); break;
+        case OPT_DURATION:          duration = atof(optarg); valid = duration >= 10; break;
+        case OPT_BAND:              band = atof(optarg); valid = band > 0; break;
+        case 'j':                   jobs = atol(optarg); valid = jobs > 0; break;
+        case 'o':                   dir = optarg; break;
+        case 't':                   writeTraces = true; break;
+        case OPT_TRACE_INTERVAL:    traceInterval = atol(optarg); valid = traceInterval > 0 && traceInterval < 65536; break;
+        default:                    valid = false; break;
+        }
+    }
+    if(!valid || optind != argc){
+        usage(argv[0]);
+        return 1;
+    }
+    if(modes.empty()){
+        for(uint8_t m = 0; m < SIM_NUM_MODES; m++){
+            modes.push_back(SimMode(m));
+        }
+    }
+
+    std::vector<SimParams> runs = expand(modes, sweeps, duration, band);
+    for(const SimParams & p : runs){
+        if(p.duration <= p.stepTime){
+            fprintf(stderr, "duration must be longer than the set point step at %u s\n", unsigned(p.stepTime));
+            return 1;
+        }
+    }
+    if(size_t(jobs) > runs.size()){
+        jobs = runs.size();
+    }
+
+    // results are written by the workers into memory shared with this process
+    size_t resultsSize = runs.size() * sizeof(SimResult);
+    SimResult * results = static_cast<SimResult *>(mmap(nullptr, resultsSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+    if(results == MAP_FAILED){
+        perror("mmap");
+        return 1;
+    }
+    memset(results, 0, resultsSize);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<pid_t> workers;
+    for(long w = 0; w < jobs; w++){
+        pid_t pid = fork();
+        if(pid == 0){
+            worker(runs, results, w, jobs, dir, writeTraces, traceInterval);
+            _exit(0);
+        }
+        if(pid < 0){
+            perror("fork");
+            break;
+        }
+        workers.push_back(pid);
+    }
+    bool failed = workers.size() != size_t(jobs);
+    for(pid_t pid : workers){
+        int status;
+        if(waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+            failed = true;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream summary((dir + "/summary.csv").c_str());
+    summary << "1#mode, 2#kp, 3#ti, 3#td, 4#input filter, 4#derivative filter, 5#heater period, 5#cooler period, "
+            "6#settling time, 7#overshoot, 7#steady state error, 8#heater cycles, 8#cooler cycles, "
+            "9a#heater duty, 9a#cooler duty\n";
+    printf("%5s %-24s %7s %7s %7s %3s %3s %5s %5s | %9s %9s %9s %6s %6s %6s %6s\n",
+            "run", "set up", "kp", "ti", "td", "if", "df", "hp", "cp",
+            "settling", "overshoot", "ss error", "h cyc", "c cyc", "h duty", "c duty");
+
+    double simulatedSeconds = 0;
+    for(size_t i = 0; i < runs.size(); i++){
+        const SimParams & p = runs[i];
+        const SimResult & r = results[i];
+        if(!r.completed){
+            failed = true;
+            printf("%5u %-24s did not complete\n", unsigned(i), simModeName(p.mode));
+            continue;
+        }
+        simulatedSeconds += p.duration;
+        summary << int(p.mode) << "," << p.kp << "," << p.ti << "," << p.td << ","
+                << int(p.inputFilter) << "," << int(p.derivativeFilter) << ","
+                << p.heaterPeriod << "," << p.coolerPeriod << ","
+                << r.settlingTime << "," << r.overshoot << "," << r.steadyStateError << ","
+                << r.heaterCycles << "," << r.coolerCycles << ","
+                << r.heaterDuty << "," << r.coolerDuty << "\n";
+        printf("%5u %-24s %7.2f %7.0f %7.0f %3u %3u %5u %5u | %9.0f %9.3f %9.3f %6u %6u %6.3f %6.3f\n",
+                unsigned(i), simModeName(p.mode), p.kp, p.ti, p.td, p.inputFilter, p.derivativeFilter,
+                p.heaterPeriod, p.coolerPeriod,
+                r.settlingTime, r.overshoot, r.steadyStateError, r.heaterCycles, r.coolerCycles,
+                r.heaterDuty, r.coolerDuty);
+    }
+    summary.close();
+    munmap(results, resultsSize);
+
+    printf("%u runs on %ld workers in %.2f s, %.0f simulated seconds per second\n",
+            unsigned(runs.size()), jobs, elapsed, elapsed > 0 ? simulatedSeconds / elapsed : 0.0);
+    return failed ? 1 : 0;
+}
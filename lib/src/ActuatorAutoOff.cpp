@@ -26,6 +26,7 @@ void AutoOffActuator::setActive(bool active)
     target->setActive(active);
     if (active)
             lastActiveTime = ticks.seconds();
+    publishChange();
 }
 
 void AutoOffActuator::update() {
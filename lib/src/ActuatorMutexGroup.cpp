@@ -22,9 +22,13 @@
 #include "ActuatorInterfaces.h"
 #include <vector>
 
-ActuatorPriority * ActuatorMutexGroup::registerActuator(ActuatorDigital * act, int8_t prio){
-    ActuatorPriority ap = {act, prio};
+ActuatorPriority * ActuatorMutexGroup::registerActuator(ActuatorDigital * act, int8_t prio, uint16_t load){
+    ActuatorPriority ap = {act, -1, NOT_QUEUED, load, false};
     actuatorPriorities.push_back(ap);
+    setPriority(actuatorPriorities.size() - 1, prio);
+    if(act->isActive()){
+        grant(actuatorPriorities.back()); // was already active before it joined the group
+    }
     return &actuatorPriorities.back();
 }
 
@@ -38,7 +42,20 @@ size_t ActuatorMutexGroup::find(ActuatorDigital * act){
 }
 
 void ActuatorMutexGroup::unRegisterActuator(size_t index){
+    ActuatorPriority & entry = actuatorPriorities[index];
+    if(entry.granted){
+        grantedLoad -= entry.load;
+    }
     actuatorPriorities.erase(actuatorPriorities.begin() + index);
+
+    // indexes in the heap have changed, rebuild it
+    requestHeap.clear();
+    for (size_t i=0; i<actuatorPriorities.size(); ++i){
+        int8_t prio = actuatorPriorities[i].priority;
+        actuatorPriorities[i].priority = -1;
+        actuatorPriorities[i].heapIndex = NOT_QUEUED;
+        setPriority(i, prio);
+    }
 }
 
 void ActuatorMutexGroup::unRegisterActuator(ActuatorDigital * act){
@@ -48,54 +65,97 @@ void ActuatorMutexGroup::unRegisterActuator(ActuatorDigital * act){
     }
 }
 
+void ActuatorMutexGroup::setLoad(ActuatorDigital * act, uint16_t watts){
+    size_t index = find(act);
+    if(index == size_t(-1)){
+        registerActuator(act, -1, watts);
+        return;
+    }
+    ActuatorPriority & entry = actuatorPriorities[index];
+    if(entry.granted){
+        grantedLoad = grantedLoad - entry.load + watts;
+    }
+    entry.load = watts;
+}
+
 bool ActuatorMutexGroup::request(ActuatorDigital * requester, bool active, int8_t newPriority){
-    // loop over all actuators to see if my request has highest priority
-    // and if no other actuators are active
+    size_t index = find(requester);
+    if(index == size_t(-1)){ // I was not in the list
+        registerActuator(requester, -1);
+        index = actuatorPriorities.size() - 1;
+    }
 
-    bool otherActuatorActive = false;
-    bool highestPriority = true;
-    bool requestHonored = true;
-    ActuatorPriority * me = nullptr;
+    // the dead time counts from the last moment an actuator was seen active, including the requester itself
+    bool otherActive = false;
+    for (size_t i=0; i<actuatorPriorities.size(); ++i){
+        if(actuatorPriorities[i].actuator->isActive()){
+            lastActiveTime = ticks.millis();
+            lastActiveActuator = actuatorPriorities[i].actuator;
+            if(i != index){
+                otherActive = true;
+            }
+        }
+    }
 
     if(!active){
-        newPriority = -1; // set requester priority to -1, because its not waiting to go active anymore
+        // not waiting to go active anymore. The actuator stays granted until it is seen inactive,
+        // because it could stay active for a while, for example due to a minimum on time.
+        setPriority(index, -1);
+        return true; // always allow false
     }
 
+    // revoke grants of actuators that have gone inactive since they withdrew their request
     for (size_t i=0; i<actuatorPriorities.size(); ++i){
-        ActuatorPriority * other = &actuatorPriorities[i];
-
-        if(other->actuator == requester){
-            other->priority = newPriority; // update my own priority
-            me = &actuatorPriorities[i];
-        }
-        else{
-            if(other->priority > newPriority){
-                highestPriority = false;
-            }
-        }
-        if(other->actuator->isActive()){
-            otherActuatorActive = true;
-            lastActiveTime = ticks.millis();
-            lastActiveActuator = other->actuator;
-        }
-        // always allow false, otherwise allow when no one else is active and me has highest priority
-        requestHonored = active ? !otherActuatorActive && highestPriority : true;
-        if(me && !requestHonored){
-            break;
+        ActuatorPriority & other = actuatorPriorities[i];
+        if(other.granted && other.priority < 0 && !other.actuator->isActive()){
+            revoke(other);
         }
     }
-    if(!me){ // I was not in the list
-        me = registerActuator(requester, newPriority);
+
+    setPriority(index, newPriority);
+
+    ActuatorPriority & me = actuatorPriorities[index];
+    if(me.granted){
+        return true;
     }
-    if(active && getWaitTime() > 0 && lastActiveActuator != requester){
-        requestHonored = false; // dead time has not passed
+
+    bool requestHonored;
+    uint32_t reserved = reservedAbove(newPriority, &me);
+    if(powerBudget == 0){
+        // allow when no one else is active and no one else is waiting with a higher priority.
+        // Only actual activity blocks: a request that was granted, but held off by its actuator, does not.
+        requestHonored = !otherActive && reserved == 0;
+        if(getWaitTime() > 0 && lastActiveActuator != requester){
+            requestHonored = false; // dead time has not passed
+        }
+    }
+    else{
+        // allow when my load fits, without using power reserved for waiting requests with a higher priority
+        requestHonored = uint32_t(grantedLoad) + reserved + me.load <= powerBudget;
     }
 
+    if(requestHonored){
+        grant(me);
+    }
     return requestHonored;
 }
 
 void ActuatorMutexGroup::cancelRequest(ActuatorDigital * requester){
     request(requester, false, -1);
+    size_t index = find(requester);
+    if(index != size_t(-1) && actuatorPriorities[index].granted && !requester->isActive()){
+        revoke(actuatorPriorities[index]);
+    }
+}
+
+void ActuatorMutexGroup::grant(ActuatorPriority & entry){
+    entry.granted = true;
+    grantedLoad += entry.load;
+}
+
+void ActuatorMutexGroup::revoke(ActuatorPriority & entry){
+    entry.granted = false;
+    grantedLoad -= entry.load;
 }
 
 void ActuatorMutexGroup::setDeadTime(ticks_millis_t time){
@@ -116,15 +176,130 @@ ticks_millis_t ActuatorMutexGroup::getWaitTime(){
     }
 }
 
+bool ActuatorMutexGroup::inPhase(ActuatorDigital * act, ticks_millis_t period){
+    size_t index = find(act);
+    if(powerBudget == 0 || index == size_t(-1) || period < 4 * actuatorPriorities.size()){
+        return true;
+    }
+    ticks_millis_t slot = period / actuatorPriorities.size();
+    ticks_millis_t slotStart = phaseOrigin + index * slot;
+    int32_t sinceSlot = int32_t(ticks.millis() - slotStart) % int32_t(period);
+    if(sinceSlot < 0){
+        sinceSlot += period;
+    }
+    // start in the first quarter of the slot, when the loop was too late for the slot itself
+    return sinceSlot <= int32_t(slot / 4);
+}
+
 // update decreases all priorities by 1, so that old requests lose their priority automatically
 void ActuatorMutexGroup::update(){
     for (size_t i=0; i<actuatorPriorities.size(); ++i){
-        if(actuatorPriorities[i].priority > -1){
-            actuatorPriorities[i].priority--;
+        ActuatorPriority & entry = actuatorPriorities[i];
+        if(entry.priority > 0){
+            entry.priority--; // decreasing all priorities together keeps the heap order
         }
-        if(actuatorPriorities[i].actuator->isActive()){
+        else if(entry.priority == 0){
+            setPriority(i, -1);
+        }
+        if(entry.actuator->isActive()){
             lastActiveTime = ticks.millis();
-            lastActiveActuator = actuatorPriorities[i].actuator;
+            lastActiveActuator = entry.actuator;
+            if(!entry.granted){
+                grant(entry); // switched on without asking the group
+            }
+        }
+        else if(entry.granted && entry.priority < 0){
+            revoke(entry);
+        }
+    }
+}
+
+void ActuatorMutexGroup::setPriority(size_t index, int8_t priority){
+    ActuatorPriority & entry = actuatorPriorities[index];
+    int8_t old = entry.priority;
+    entry.priority = priority;
+    if(priority < 0){
+        if(entry.heapIndex != NOT_QUEUED){
+            heapRemove(entry.heapIndex);
         }
     }
+    else if(entry.heapIndex == NOT_QUEUED){
+        requestHeap.push_back(uint8_t(index));
+        entry.heapIndex = requestHeap.size() - 1;
+        siftUp(entry.heapIndex);
+    }
+    else if(priority > old){
+        siftUp(entry.heapIndex);
+    }
+    else if(priority < old){
+        siftDown(entry.heapIndex);
+    }
+}
+
+void ActuatorMutexGroup::heapSwap(uint8_t a, uint8_t b){
+    uint8_t tmp = requestHeap[a];
+    requestHeap[a] = requestHeap[b];
+    requestHeap[b] = tmp;
+    actuatorPriorities[requestHeap[a]].heapIndex = a;
+    actuatorPriorities[requestHeap[b]].heapIndex = b;
+}
+
+void ActuatorMutexGroup::siftUp(uint8_t pos){
+    while(pos > 0){
+        uint8_t parent = (pos - 1) / 2;
+        if(actuatorPriorities[requestHeap[parent]].priority >= actuatorPriorities[requestHeap[pos]].priority){
+            break;
+        }
+        heapSwap(pos, parent);
+        pos = parent;
+    }
+}
+
+void ActuatorMutexGroup::siftDown(uint8_t pos){
+    uint8_t size = requestHeap.size();
+    while(true){
+        uint8_t largest = pos;
+        uint8_t left = 2 * pos + 1;
+        uint8_t right = left + 1;
+        if(left < size && actuatorPriorities[requestHeap[left]].priority > actuatorPriorities[requestHeap[largest]].priority){
+            largest = left;
+        }
+        if(right < size && actuatorPriorities[requestHeap[right]].priority > actuatorPriorities[requestHeap[largest]].priority){
+            largest = right;
+        }
+        if(largest == pos){
+            break;
+        }
+        heapSwap(pos, largest);
+        pos = largest;
+    }
+}
+
+void ActuatorMutexGroup::heapRemove(uint8_t pos){
+    uint8_t last = requestHeap.size() - 1;
+    actuatorPriorities[requestHeap[pos]].heapIndex = NOT_QUEUED;
+    if(pos != last){
+        requestHeap[pos] = requestHeap[last];
+        actuatorPriorities[requestHeap[pos]].heapIndex = pos;
+    }
+    requestHeap.pop_back();
+    if(pos < requestHeap.size()){
+        siftUp(pos);
+        siftDown(actuatorPriorities[requestHeap[pos]].heapIndex);
+    }
+}
+
+uint32_t ActuatorMutexGroup::reservedAbove(int8_t prio, const ActuatorPriority * skip, uint8_t pos) const {
+    if(pos >= requestHeap.size()){
+        return 0;
+    }
+    const ActuatorPriority & entry = actuatorPriorities[requestHeap[pos]];
+    if(entry.priority <= prio){
+        return 0; // the rest of this subtree has a lower priority too
+    }
+    uint32_t reserved = 0;
+    if(&entry != skip && !entry.granted){
+        reserved = powerBudget ? entry.load : 1;
+    }
+    return reserved + reservedAbove(prio, skip, 2 * pos + 1) + reservedAbove(prio, skip, 2 * pos + 2);
 }
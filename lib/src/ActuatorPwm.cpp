@@ -4,6 +4,10 @@
 #include "Ticks.h"
 #include "ActuatorMutexDriver.h"
 
+#if BREWPI_PROFILING
+uint32_t ActuatorPwm::missedEdgeCount = 0;
+#endif
+
 ActuatorPwm::ActuatorPwm(ActuatorDigital* _target, uint16_t _period) :
                          ActuatorForwarder(_target) {
     periodStartTime = ticks.millis();
@@ -114,6 +118,7 @@ void ActuatorPwm::fastUpdate() {
                     return; // try next time
                 }
                 int32_t thisDutyLate = elapsedTime - dutyTime;
+                PROFILING_ONLY(checkEdge(elapsedTime - adjDutyTime));
                 dutyLate += thisDutyLate;
                 if(highToLowTime != 0){
                     cycleTime = ticks.timeSinceMillis(highToLowTime);
@@ -145,7 +150,7 @@ void ActuatorPwm::fastUpdate() {
                 dutyLate = dutyLate - dutyTime;
                 newPeriod = true;
             } else {
-                if(dutyTime > 0){
+                if(dutyTime > 0 && inPhase()){
                     goHigh = true;
                 }
             }
@@ -166,6 +171,7 @@ void ActuatorPwm::fastUpdate() {
                     cycleTime = ticks.timeSinceMillis(lowToHighTime);
                 }
                 lowToHighTime = currentTime;
+                PROFILING_ONLY(checkEdge(elapsedTime - period_ms));
             }
         }
         if(newPeriod){
@@ -192,6 +198,13 @@ void ActuatorPwm::fastUpdate() {
     }
 }
 
+bool ActuatorPwm::inPhase(){
+    if(target->type() != ACTUATOR_TOGGLE_MUTEX){
+        return true;
+    }
+    return static_cast<ActuatorMutexDriver*>(target)->inPhase(period_ms);
+}
+
 int8_t ActuatorPwm::priority(){
     int32_t adjDutyTime = dutyTime - dutyLate;
     int32_t priority = (adjDutyTime*100)/period_ms;
@@ -47,6 +47,7 @@ void ActuatorTimeLimited::setActive(bool newState)
             toggleTime = ticks.seconds();
         }
     }
+    publishChange();
 }
 
 void ActuatorTimeLimited::update()
@@ -56,6 +57,7 @@ void ActuatorTimeLimited::update()
     if (state && (timeSinceToggle() >= maxOnTime)){
         setActive(false);
     }
+    publishChange(); // the target can also change state without going through this actuator
 }
 
 ticks_seconds_t ActuatorTimeLimited::timeSinceToggle() const
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BlockPool.h"
+#include <stdlib.h>
+#if defined(__NEWLIB__) || defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+PoolStatistics * PoolStatistics::list = nullptr;
+
+PoolStatistics::PoolStatistics(const char * name, uint8_t capacity) :
+    name(name),
+    capacity(capacity),
+    used(0),
+    highWater(0),
+    failures(0),
+    next(list) {
+    list = this;
+}
+
+PoolStatistics::~PoolStatistics() {
+    for (PoolStatistics ** p = &list; *p != nullptr; p = &(*p)->next) {
+        if (*p == this) {
+            *p = next;
+            break;
+        }
+    }
+}
+
+HeapStatistics heapStatistics() {
+    HeapStatistics heap = {0, 0};
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 info = mallinfo2(); // mallinfo is deprecated
+    heap.used = info.uordblks;
+    heap.highWater = info.arena;
+#elif defined(__NEWLIB__) || defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+    heap.used = info.uordblks;
+    heap.highWater = info.arena;
+#endif
+    return heap;
+}
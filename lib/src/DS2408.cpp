@@ -6,3 +6,43 @@
  */
 
 #include "DS2408.h"
+#include "DevicePools.h"
+
+POOL_ALLOCATION(DS2408, DS2408_POOL_SIZE)
+
+void DS2408::update()
+{
+    cachedState = accessRead();
+    setRefreshed();
+    // a pin can only be high when its latch is off: the latches were reset by a power cycle
+    if (cachedState & ~latches){
+        latchesKnown = false;
+    }
+}
+
+bool DS2408::flush()
+{
+    if (!hasPendingWrite()){
+        return true;
+    }
+    refresh();
+
+    // pins that are pulled low externally read as 0, so the cache only gives the latch state for outputs
+    uint8_t oldVal = latchesKnown ? latches : cachedState;
+    uint8_t newVal = applyPending(oldVal);
+    if (latchesKnown && newVal == oldVal){
+        clearPending();
+        return true; // skip write if already correct value to reduce OneWire communication
+    }
+
+    uint8_t status = 0;
+    bool ok = accessWrite(newVal, 3, &status);
+    if (ok){
+        clearPending();
+        latches = newVal;
+        latchesKnown = true;
+        cachedState = status; // the device sends its new pin state after the acknowledgement
+        setRefreshed();
+    }
+    return ok;
+}
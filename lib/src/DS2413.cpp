@@ -22,6 +22,9 @@
 #include "OneWire.h"
 
 #include "DS2413.h"
+#include "DevicePools.h"
+
+POOL_ALLOCATION(DS2413, DS2413_POOL_SIZE)
 
 bool DS2413::cacheIsValid() const
 {
@@ -35,9 +38,10 @@ bool DS2413::latchWrite(pio_t pio,
                 bool  set,
                 bool  useCached)
 {
-    bool    ok      = false;
     uint8_t retries = 5;
 
+    latchWriteDeferred(pio, set);
+
     if (!useCached || !cacheIsValid())
     {
         // read a fresh value form the device
@@ -53,26 +57,49 @@ bool DS2413::latchWrite(pio_t pio,
         }
     }
 
-    uint8_t mask   = latchWriteMask(pio);
-    uint8_t oldVal = writeByteFromCache();
-    uint8_t newVal = oldVal;
+    return writePending();
+}
 
-    if (set)
+bool DS2413::flush()
+{
+    if (!hasPendingWrite())
     {
-        newVal &= ~mask; // 0 means latch transistor is active
+        return true;
     }
-    else
+
+    refresh();
+
+    if (!cacheIsValid())
     {
-        newVal |= mask; // 1 means latch transistor is inactive
+        return false;    // the write is retried on the next flush
     }
 
+    return writePending();
+}
+
+bool DS2413::writePending()
+{
+    uint8_t oldVal = writeByteFromCache();
+    uint8_t newVal = applyPending(oldVal);
+
     if (oldVal == newVal)
     {
-        ok = true;    // skip write if already correct value to reduce OneWire communication
+        clearPending();
+        return true;    // skip write if already correct value to reduce OneWire communication
     }
-    else
+
+    uint8_t status = 0;
+    bool ok = channelWriteAll(newVal, &status);
+
+    if (ok)
+    {
+        clearPending();
+        cachedState = status;    // the device sends its new state after the acknowledgement
+        setRefreshed();
+    }
+
+    if (!ok || !cacheIsValid())
     {
-        ok = channelWriteAll(newVal);
         update();
     }
 
@@ -93,6 +120,10 @@ bool DS2413::latchRead(pio_t pio,
 bool DS2413::latchReadCached(pio_t pio,
                bool defaultValue) const
 {
+    if (pendingMask & latchWriteMask(pio))
+    {
+        return (pendingBits & latchWriteMask(pio)) == 0;
+    }
     if(cacheIsValid()){
         return ((cachedState & latchReadMask(pio)) == 0);
     }
@@ -105,6 +136,7 @@ bool DS2413::latchReadCached(pio_t pio,
 void DS2413::update()
 {
     cachedState = accessRead();
+    setRefreshed();
     bool success = cacheIsValid();
     if(connected && !success){
         connected = false;
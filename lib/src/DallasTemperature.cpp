@@ -12,6 +12,7 @@
 
 #include "DallasTemperature.h"
 #include "Ticks.h"
+#include "DevicePools.h"
 
 DallasTemperature::DallasTemperature(OneWire* _oneWire)
 #if REQUIRESALARMS
@@ -564,6 +565,16 @@ int16_t DallasTemperature::getTempRaw(const uint8_t* deviceAddress) {
     return calculateTemperature(deviceAddress, scratchPad);
 }
 
+int16_t DallasTemperature::getTempRaw(const uint8_t* deviceAddress, uint8_t* scratchPad) {
+    if (_wire->crc8(scratchPad, 8) != scratchPad[SCRATCHPAD_CRC]) {
+        return DEVICE_DISCONNECTED_RAW;
+    }
+    if (detectedReset(scratchPad)) {
+        return DEVICE_DISCONNECTED_RAW;
+    }
+    return calculateTemperature(deviceAddress, scratchPad);
+}
+
 #if REQUIRESTEMPCONVERSION
 // returns temperature in degrees C or DEVICE_DISCONNECTED_C if the
 // device's scratch pad cannot be read successfully.
@@ -855,4 +866,8 @@ void DallasTemperature::operator delete(void* p) {
     free(p); // Free the memory
 }
 
+#else
+
+POOL_ALLOCATION(DallasTemperature, DALLAS_TEMPERATURE_POOL_SIZE)
+
 #endif
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FilterBank.h"
+
+#if FILTER_BANK_SIMD_WIDTH > 1
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#endif
+
+/*
+ * Each section computes the same as FixedFilter::add(), with the saturating addition and subtraction of
+ * temp_precise_t:
+ *   y0 = (y1 - y2) + y1
+ *   y0 -= y1 >> b
+ *   y0 += y2 >> b
+ *   t = (x0 >> a) + (x1 >> (a - 1)) + (x2 >> a)
+ *   t -= y2 >> (a - 2)
+ *   y0 += t
+ * with a = 2b + 4. The x and y rows are passed for the new (0) and the two previous (1, 2) samples.
+ */
+
+static inline int32_t saturatingAdd(int32_t lhs, int32_t rhs){
+    int64_t result = int64_t(lhs) + rhs;
+    if(result > INT32_MAX){
+        return INT32_MAX;
+    }
+    if(result < INT32_MIN){
+        return INT32_MIN;
+    }
+    return int32_t(result);
+}
+
+static inline int32_t saturatingSub(int32_t lhs, int32_t rhs){
+    int64_t result = int64_t(lhs) - rhs;
+    if(result > INT32_MAX){
+        return INT32_MAX;
+    }
+    if(result < INT32_MIN){
+        return INT32_MIN;
+    }
+    return int32_t(result);
+}
+
+uint8_t filterBankUpdateScalar(int32_t * state, const int32_t * b, uint8_t head, uint8_t stride){
+    const uint8_t newest = (head + 2) % 3; // oldest samples are replaced
+    const uint8_t previous = head;
+    const uint8_t oldest = (head + 1) % 3;
+
+    for(uint8_t ch = 0; ch < stride; ch++){
+        const uint8_t bb = b[ch];
+        const uint8_t a = bb * 2 + 4;
+        int32_t x0 = state[newest * stride + ch];
+        for(uint8_t s = 0; s < NUM_SECTIONS; s++){
+            int32_t * x = &state[(s * 6) * stride + ch];
+            int32_t * y = x + 3 * stride;
+            x[newest * stride] = x0;
+            const int32_t x1 = x[previous * stride];
+            const int32_t x2 = x[oldest * stride];
+            const int32_t y1 = y[previous * stride];
+            const int32_t y2 = y[oldest * stride];
+
+            int32_t y0 = saturatingAdd(saturatingSub(y1, y2), y1);
+            y0 = saturatingSub(y0, y1 >> bb);
+            y0 = saturatingAdd(y0, y2 >> bb);
+            int32_t t = saturatingAdd(saturatingAdd(x0 >> a, x1 >> (a - 1)), x2 >> a);
+            t = saturatingSub(t, y2 >> (a - 2));
+            y0 = saturatingAdd(y0, t);
+
+            y[newest * stride] = y0;
+            x0 = y0; // input of the next section
+        }
+    }
+    return newest;
+}
+
+#if FILTER_BANK_SIMD_WIDTH > 1 && defined(__SSE2__)
+
+/*
+ * SSE2 has no saturating 32 bit arithmetic. Overflow is detected from the sign bits instead: it occurs when the
+ * operands have a sign that makes overflow possible and the sign of the result differs from the left operand.
+ * The saturated value is INT32_MAX for a positive left operand and INT32_MIN for a negative one.
+ */
+static inline __m128i select(__m128i mask, __m128i ifSet, __m128i ifClear){
+    return _mm_or_si128(_mm_and_si128(mask, ifSet), _mm_andnot_si128(mask, ifClear));
+}
+
+static inline __m128i saturated(__m128i lhs){
+    return _mm_xor_si128(_mm_srai_epi32(lhs, 31), _mm_set1_epi32(INT32_MAX));
+}
+
+static inline __m128i saturatingAdd(__m128i lhs, __m128i rhs){
+    __m128i result = _mm_add_epi32(lhs, rhs);
+    __m128i overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(result, lhs), _mm_xor_si128(result, rhs)), 31);
+    return select(overflow, saturated(lhs), result);
+}
+
+static inline __m128i saturatingSub(__m128i lhs, __m128i rhs){
+    __m128i result = _mm_sub_epi32(lhs, rhs);
+    __m128i overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(lhs, rhs), _mm_xor_si128(lhs, result)), 31);
+    return select(overflow, saturated(lhs), result);
+}
+
+// arithmetic shift right of all channels by the same count
+struct UniformShift {
+    UniformShift(int32_t c) : count(_mm_cvtsi32_si128(c)) {}
+    __m128i operator()(__m128i value) const {
+        return _mm_sra_epi32(value, count);
+    }
+    __m128i count;
+};
+
+// arithmetic shift right with a different count per channel
+struct LaneShift {
+    LaneShift(__m128i c) : count(c) {}
+    __m128i operator()(__m128i value) const {
+#if defined(__AVX2__)
+        return _mm_srav_epi32(value, count);
+#else
+        // SSE2 shifts all channels by the same count, so shift by each bit of the count separately
+        for(int bit = 1; bit < 32; bit <<= 1){
+            __m128i bitMask = _mm_set1_epi32(bit);
+            __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(count, bitMask), bitMask);
+            value = select(mask, _mm_sra_epi32(value, _mm_cvtsi32_si128(bit)), value);
+        }
+        return value;
+#endif
+    }
+    __m128i count;
+};
+
+static inline __m128i load(const int32_t * p){
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+static inline void store(int32_t * p, __m128i value){
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), value);
+}
+
+static inline __m128i shiftCount(__m128i b, int32_t offset){
+    return _mm_add_epi32(_mm_add_epi32(b, b), _mm_set1_epi32(offset));
+}
+
+typedef __m128i lanes_t;
+
+#elif FILTER_BANK_SIMD_WIDTH > 1 && defined(__ARM_NEON)
+
+static inline int32x4_t saturatingAdd(int32x4_t lhs, int32x4_t rhs){
+    return vqaddq_s32(lhs, rhs);
+}
+
+static inline int32x4_t saturatingSub(int32x4_t lhs, int32x4_t rhs){
+    return vqsubq_s32(lhs, rhs);
+}
+
+// arithmetic shift right with a different count per channel, NEON shifts right for negative counts
+struct LaneShift {
+    LaneShift(int32x4_t c) : count(vnegq_s32(c)) {}
+    int32x4_t operator()(int32x4_t value) const {
+        return vshlq_s32(value, count);
+    }
+    int32x4_t count;
+};
+
+static inline int32x4_t load(const int32_t * p){
+    return vld1q_s32(p);
+}
+
+static inline void store(int32_t * p, int32x4_t value){
+    vst1q_s32(p, value);
+}
+
+static inline int32x4_t shiftCount(int32x4_t b, int32_t offset){
+    return vaddq_s32(vaddq_s32(b, b), vdupq_n_s32(offset));
+}
+
+typedef int32x4_t lanes_t;
+
+#endif
+
+#if FILTER_BANK_SIMD_WIDTH > 1
+
+/*
+ * Filters FILTER_BANK_SIMD_WIDTH channels starting at x0, which points into the input rows of section 0.
+ * Shift is the functor for arithmetic shifts right by b, a, a - 1 and a - 2.
+ */
+template<typename Shift>
+static inline void updateLanes(int32_t * x, uint8_t stride, uint8_t newest, uint8_t previous, uint8_t oldest,
+        const Shift & b, const Shift & a, const Shift & a1, const Shift & a2){
+    lanes_t x0 = load(&x[newest * stride]);
+    for(uint8_t s = 0; s < NUM_SECTIONS; s++){
+        int32_t * y = x + 3 * stride;
+        store(&x[newest * stride], x0);
+        const lanes_t x1 = load(&x[previous * stride]);
+        const lanes_t x2 = load(&x[oldest * stride]);
+        const lanes_t y1 = load(&y[previous * stride]);
+        const lanes_t y2 = load(&y[oldest * stride]);
+
+        lanes_t y0 = saturatingAdd(saturatingSub(y1, y2), y1);
+        y0 = saturatingSub(y0, b(y1));
+        y0 = saturatingAdd(y0, b(y2));
+        lanes_t t = saturatingAdd(saturatingAdd(a(x0), a1(x1)), a(x2));
+        t = saturatingSub(t, a2(y2));
+        y0 = saturatingAdd(y0, t);
+
+        store(&y[newest * stride], y0);
+        x0 = y0; // input of the next section
+        x += 6 * stride;
+    }
+}
+
+// same as filterBankUpdateScalar, for FILTER_BANK_SIMD_WIDTH channels at a time
+uint8_t filterBankUpdate(int32_t * state, const int32_t * b, uint8_t head, uint8_t stride){
+    if(stride % FILTER_BANK_SIMD_WIDTH != 0){
+        return filterBankUpdateScalar(state, b, head, stride);
+    }
+
+    const uint8_t newest = (head + 2) % 3; // oldest samples are replaced
+    const uint8_t previous = head;
+    const uint8_t oldest = (head + 1) % 3;
+
+    for(uint8_t ch = 0; ch < stride; ch += FILTER_BANK_SIMD_WIDTH){
+#if defined(__SSE2__) && !defined(__AVX2__)
+        // per channel shifts are slow on SSE2, but usually all channels use the same filtering
+        if(b[ch] == b[ch + 1] && b[ch] == b[ch + 2] && b[ch] == b[ch + 3]){
+            const int32_t bb = b[ch];
+            updateLanes(&state[ch], stride, newest, previous, oldest,
+                    UniformShift(bb), UniformShift(2 * bb + 4), UniformShift(2 * bb + 3), UniformShift(2 * bb + 2));
+            continue;
+        }
+#endif
+        const lanes_t bb = load(&b[ch]);
+        updateLanes(&state[ch], stride, newest, previous, oldest,
+                LaneShift(bb), LaneShift(shiftCount(bb, 4)), LaneShift(shiftCount(bb, 3)), LaneShift(shiftCount(bb, 2)));
+    }
+    return newest;
+}
+
+#else
+
+uint8_t filterBankUpdate(int32_t * state, const int32_t * b, uint8_t head, uint8_t stride){
+    return filterBankUpdateScalar(state, b, head, stride);
+}
+
+#endif
@@ -19,30 +19,22 @@
 
 
 #include "temperatureFormats.h"
-#include "FilterFixed.h"
 #include "FilterCascaded.h"
 #include <stdlib.h>
 
 FilterCascaded::FilterCascaded()
 {
-    for (uint8_t i = 0; i < NUM_SECTIONS; i++)
-    {
-        sections[i].setFiltering(2);    // default to a b value of 2
-    }
-    init();
+    // the bank defaults to a b value of 2 and is initialized to zero
 }
 
 void FilterCascaded::setFiltering(uint8_t bValue)
 {
-    for (uint8_t i = 0; i < NUM_SECTIONS; i++)
-    {
-        sections[i].setFiltering(bValue);
-    }
+    bank.setFiltering(0, bValue);
 }
 
 uint8_t FilterCascaded::getFiltering()
 {
-    return sections[0].getFiltering();
+    return bank.getFiltering(0);
 }
 
 temp_t FilterCascaded::add(const temp_t & val)
@@ -55,62 +47,53 @@ temp_t FilterCascaded::add(const temp_t & val)
 
 temp_precise_t FilterCascaded::add(const temp_precise_t & val)
 {
-    temp_precise_t temporary = val;
-
-    // temporary is input for next section, which is the output of the previous section
-    for (uint8_t i = 0; i < NUM_SECTIONS; i++)
-    {
-        temporary = sections[i].add(temporary);
-    }
-
-    return temporary;
+    bank.setInput(0, val);
+    bank.update();
+    return bank.readOutput(0);
 }
 
 temp_precise_t FilterCascaded::readInput(void)
 {
-    return sections[0].readInput();    // return unfiltered input of first section
+    return bank.readInput(0);    // return unfiltered input of first section
 }
 
 temp_precise_t FilterCascaded::readOutput(void)
 {
-    return sections[NUM_SECTIONS - 1].readOutput();    // return output of last section (which is most filtered)
+    return bank.readOutput(0);    // return output of last section (which is most filtered)
 }
 
 bool FilterCascaded::detectPosPeak(temp_precise_t * peak)
 {
-    return sections[NUM_SECTIONS - 1].detectPosPeak(peak);    // detect peaks in last section
+    return bank.detectPosPeak(0, peak);    // detect peaks in last section
 }
 
 bool FilterCascaded::detectNegPeak(temp_precise_t * peak)
 {
-    return sections[NUM_SECTIONS - 1].detectNegPeak(peak);    // detect peaks in last section
+    return bank.detectNegPeak(0, peak);    // detect peaks in last section
 }
 
 bool FilterCascaded::isRising()
 {
-    return sections[NUM_SECTIONS - 1].isRising(); // return true if in the last section output > previous output
+    return bank.isRising(0); // return true if in the last section output > previous output
 }
 
 bool FilterCascaded::isFalling()
 {
-    return sections[NUM_SECTIONS - 1].isFalling(); // return true if in the last section output < previous output
+    return bank.isFalling(0); // return true if in the last section output < previous output
 }
 
 temp_precise_t FilterCascaded::readPrevOutput(void)
 {
-    return sections[NUM_SECTIONS - 1].readPrevOutput();    // return previous output of last section
+    return bank.readPrevOutput(0);    // return previous output of last section
 }
 
 void FilterCascaded::init(temp_precise_t val)
 {
-    for (uint8_t i = 0; i < NUM_SECTIONS; i++)
-    {
-        sections[i].init(val);
-    }
+    bank.init(0, val);
 }
 
 uint16_t FilterCascaded::getDelay(){
-    return delayTimes[sections[0].b];
+    return delayTimes[bank.getFiltering(0)];
 }
 
 void FilterCascaded::setFilteringForDelay(uint16_t maxDelay){
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "JsonTokenizer.h"
+
+void JsonTokenizer::begin(PairCallback fn, void * _data){
+    callback = fn;
+    data = _data;
+    status = BUSY;
+    started = false;
+    inValue = false;
+    length = 0;
+    key[0] = '\0';
+    val[0] = '\0';
+}
+
+JsonTokenizer::Status JsonTokenizer::close(Status result){
+    status = result;
+    return status;
+}
+
+// ends the current key or value. A pair is complete when a value ends.
+void JsonTokenizer::endToken(){
+    if(inValue){
+        if(key[0] && val[0] && callback){
+            callback(key, val, data);
+        }
+        key[0] = '\0';
+    }
+    val[0] = '\0';
+    inValue = !inValue;
+    length = 0;
+}
+
+JsonTokenizer::Status JsonTokenizer::feed(char c){
+    if(status != BUSY){
+        return status;
+    }
+    if(!started){
+        if(c != '{'){
+            return close(ERROR_NO_OBJECT);
+        }
+        started = true;
+        return status;
+    }
+    switch(c){
+    case '}':
+        if(inValue){
+            endToken();
+        }
+        return close(DONE);
+    case ',':
+    case ':':
+        endToken();
+        break;
+    case ' ':
+    case '"':
+        break; // skip spaces and quotes
+    default:
+        if(length >= JSON_TOKENIZER_MAX_TOKEN_LENGTH - 1){
+            return close(ERROR_TOO_LONG);
+        }
+        char * token = inValue ? val : key;
+        token[length++] = c;
+        token[length] = '\0';
+        break;
+    }
+    return status;
+}
+
+JsonTokenizer::Status JsonTokenizer::finish(){
+    if(status != BUSY){
+        return status;
+    }
+    if(!started){
+        return close(ERROR_NO_OBJECT);
+    }
+    return feed('}');
+}
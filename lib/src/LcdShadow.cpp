@@ -0,0 +1,69 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LcdShadow.h"
+
+const uint8_t LcdShadow::COLS;
+const uint8_t LcdShadow::ROWS;
+const uint8_t LcdShadow::UNCHANGED;
+const uint8_t LcdShadow::AT_CURSOR;
+
+void LcdShadow::clear(){
+    for(uint8_t i = 0; i < ROWS; i++){
+        for(uint8_t j = 0; j < COLS; j++){
+            content[i][j] = ' ';
+        }
+        content[i][COLS] = '\0';
+    }
+    cursor = 0;
+}
+
+uint8_t LcdShadow::address(uint8_t row, uint8_t col){
+    static const uint8_t rowOffsets[ROWS] = { 0x00, 0x40, 0x14, 0x54 };
+    return rowOffsets[row & 0x3] + col;
+}
+
+uint8_t LcdShadow::write(uint8_t row, uint8_t col, uint8_t c){
+    uint8_t target = address(row, col);
+    if(col < COLS){
+        if(uint8_t(content[row][col]) == c){
+            return UNCHANGED;
+        }
+        content[row][col] = c;
+    }
+    // characters past the end of the line are not kept, but the display shows them on another line
+    uint8_t result = (target == cursor) ? AT_CURSOR : target;
+    cursor = target + 1;
+    return result;
+}
+
+void LcdShadow::store(uint8_t row, uint8_t col, uint8_t c){
+    if(col < COLS){
+        content[row][col] = c;
+    }
+}
+
+void LcdShadow::getLine(uint8_t row, char * buffer) const {
+    const char * src = content[row];
+    for(uint8_t i = 0; i < COLS; i++){
+        uint8_t c = src[i];
+        buffer[i] = (c == 0b11011111) ? 0xB0 : c;
+    }
+    buffer[COLS] = '\0';
+}
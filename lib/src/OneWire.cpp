@@ -148,6 +148,42 @@ void OneWire::skip() {
     driver.write(0xCC); // Skip ROM
 }
 
+//
+// Queued transactions
+//
+
+bool OneWire::submit(OneWireTransaction & transaction) {
+#if ONEWIRE_QUEUED
+    return driver.submit(transaction);
+#else
+    if (transaction.isPending()) {
+        return false;
+    }
+    // without a queue in the driver, the transaction is done when it is submitted
+    if (!reset()) {
+        transaction.status = OneWireTransaction::Status::NO_PRESENCE;
+        return true;
+    }
+    if (transaction.skipRom) {
+        skip();
+    } else {
+        select(transaction.rom);
+    }
+    write_bytes(transaction.writeData, transaction.writeLength);
+    read_bytes(transaction.readData, transaction.readLength);
+    transaction.status = OneWireTransaction::Status::DONE;
+    return true;
+#endif
+}
+
+bool OneWire::poll() {
+#if ONEWIRE_QUEUED
+    return driver.poll();
+#else
+    return false;
+#endif
+}
+
 #if ONEWIRE_SEARCH
 
 //
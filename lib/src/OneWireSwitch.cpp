@@ -7,6 +7,9 @@
 
 #include "OneWireSwitch.h"
 
+OneWireSwitch * OneWireSwitch::first = nullptr;
+uint8_t OneWireSwitch::cycle = 0;
+
 /*
  * Initializes this OneWire slave.
  * /param oneWire The oneWire bus the device is connected to
@@ -49,10 +52,12 @@ uint8_t OneWireSwitch::accessRead()    /* const */
  *    Writes the state of all PIOs in one operation.
  *    /param b pio data - PIOA is bit 0 (lsb), PIOB is bit 1
  *    /param maxTries the maximum number of attempts before giving up.
+ *    /param status receives the status byte sent after the acknowledgement
  *    /return true on success
  */
 bool OneWireSwitch::accessWrite(uint8_t b,
-                                uint8_t maxTries)
+                                uint8_t maxTries,
+                                uint8_t * status)
 {
 #define ACCESS_WRITE 0x5A
 #define ACK_SUCCESS 0xAA
@@ -74,7 +79,10 @@ bool OneWireSwitch::accessWrite(uint8_t b,
         ack = oneWire -> read();
 
         if (ack == ACK_SUCCESS){
-            oneWire -> read();    // status byte sent after ack
+            uint8_t pios = oneWire -> read();    // status byte sent after ack
+            if (status){
+                *status = pios;
+            }
         }
     } while ((ack != ACK_SUCCESS) && (maxTries-- > 0));
 
@@ -82,3 +90,30 @@ bool OneWireSwitch::accessWrite(uint8_t b,
 
     return ack == ACK_SUCCESS;
 }
+
+bool OneWireSwitch::flushAll()
+{
+    bool ok = true;
+    for (OneWireSwitch * s = first; s != nullptr; s = s -> next){
+        if (s -> hasPendingWrite()){
+            ok = s -> flush() && ok;
+        }
+    }
+    return ok;
+}
+
+bool OneWireSwitch::unlink(OneWireSwitch * s)
+{
+    if (s -> users > 1){
+        s -> users--;
+        return false;
+    }
+    for (OneWireSwitch ** p = &first; *p != nullptr; p = &(*p) -> next){
+        if (*p == s){
+            *p = s -> next;
+            break;
+        }
+    }
+    s -> flush();
+    return true;
+}
@@ -25,8 +25,14 @@
 #include "OneWire.h"
 #include "Ticks.h"
 #include "Logger.h"
+#include "DevicePools.h"
+
+POOL_ALLOCATION(OneWireTempSensor, ONEWIRE_TEMP_SENSOR_POOL_SIZE)
 
 OneWireTempSensor::~OneWireTempSensor() {
+    if (scheduler) {
+        scheduler->remove(this);
+    }
     delete sensor;
 };
 
@@ -63,7 +69,7 @@ bool OneWireTempSensor::init() {
         if(temp == DEVICE_DISCONNECTED_RAW){
             // Device was just powered on and should be initialized
             if(sensor->initConnection(sensorAddress)){
-                requestConversion();
+                sensor->requestTemperaturesByAddress(sensorAddress);
                 waitForConversion();
                 temp = sensor->getTempRaw(sensorAddress);            
             }
@@ -71,6 +77,7 @@ bool OneWireTempSensor::init() {
         DEBUG_ONLY(logInfoIntStringTemp(INFO_TEMP_SENSOR_INITIALIZED, pinNr, addressString, temp));
         success = temp != DEVICE_DISCONNECTED_RAW;
         if(success){
+            cachedValue = rawToTemp(temp);
             requestConversion(); // piggyback request for a new conversion
         }
     }
@@ -80,7 +87,11 @@ bool OneWireTempSensor::init() {
 }
 
 void OneWireTempSensor::requestConversion() {
-    sensor->requestTemperaturesByAddress(sensorAddress);
+    if (scheduler) {
+        scheduler->requestConversion();
+    } else {
+        sensor->requestTemperaturesByAddress(sensorAddress);
+    }
 }
 
 void OneWireTempSensor::setConnected(bool connected) {
@@ -106,7 +117,49 @@ temp_t OneWireTempSensor::read() const {
 }
 
 void OneWireTempSensor::update(){
-    cachedValue = readAndConstrainTemp();
+    if (scheduler) {
+        // The scheduler reads all sensors on the bus when the conversion is complete
+        scheduler->update();
+        return;
+    }
+    updateFromScratchPad();
+    requestConversion();
+}
+
+void OneWireTempSensor::updateFromScratchPad(){
+    if (sensor == NULL) {
+        return; // not initialized yet
+    }
+    updateTemp(sensor->getTempRaw(sensorAddress));
+}
+
+static const uint8_t readScratchPadCommand = READSCRATCH;
+
+void OneWireTempSensor::submitScratchPadRead(){
+    if (sensor == NULL) {
+        return; // not initialized yet
+    }
+    scratchPadRead.select(sensorAddress);
+    scratchPadRead.writeData = &readScratchPadCommand;
+    scratchPadRead.writeLength = 1;
+    scratchPadRead.readData = scratchPad;
+    scratchPadRead.readLength = sizeof(scratchPad);
+    oneWire->submit(scratchPadRead);
+}
+
+void OneWireTempSensor::updateFromQueuedRead(){
+    if (sensor == NULL) {
+        return; // not initialized yet
+    }
+    int16_t tempRaw = DEVICE_DISCONNECTED_RAW;
+    if (scratchPadRead.getStatus() == OneWireTransaction::Status::DONE) {
+        tempRaw = sensor->getTempRaw(sensorAddress, scratchPad);
+    }
+    updateTemp(tempRaw);
+}
+
+void OneWireTempSensor::updateTemp(int16_t tempRaw){
+    cachedValue = constrainTemp(tempRaw);
 
     if(cachedValue.isDisabledOrInvalid()){
         // Try to reconnect once
@@ -115,16 +168,23 @@ void OneWireTempSensor::update(){
             cachedValue = readAndConstrainTemp();
         }
     }
-    requestConversion();
+    publishChange();
 }
 
 temp_t OneWireTempSensor::readAndConstrainTemp() {
-    int16_t tempRaw = sensor->getTempRaw(sensorAddress);
+    return constrainTemp(sensor->getTempRaw(sensorAddress));
+}
+
+temp_t OneWireTempSensor::constrainTemp(int16_t tempRaw) {
     if (tempRaw == DEVICE_DISCONNECTED_RAW) {
         setConnected(false);
         return temp_t::invalid();
     }
+    setConnected(true); // a sensor that did not reset while it was disconnected does not need to be initialized
+    return rawToTemp(tempRaw);
+}
 
+temp_t OneWireTempSensor::rawToTemp(int16_t tempRaw) const {
     const uint8_t shift = temp_t::fractional_bit_count - ONEWIRE_TEMP_SENSOR_PRECISION; // difference in precision between DS18B20 format and temperature adt
     temp_t temp;
     temp.setRaw(tempRaw << shift);
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OneWireTempSensorScheduler.h"
+#include "OneWireTempSensor.h"
+#include "DallasTemperature.h"
+#include "OneWire.h"
+#include "Ticks.h"
+
+OneWireTempSensorScheduler OneWireTempSensorScheduler::schedulers[ONEWIRE_TEMP_SENSOR_SCHEDULER_MAX_BUSES];
+
+OneWireTempSensorScheduler * OneWireTempSensorScheduler::forBus(OneWire * bus){
+    if(bus == nullptr){
+        return nullptr;
+    }
+    OneWireTempSensorScheduler * unused = nullptr;
+    for(auto & s : schedulers){
+        if(s.bus == bus){
+            return &s;
+        }
+        if(s.bus == nullptr && unused == nullptr){
+            unused = &s;
+        }
+    }
+    if(unused){
+        unused->bus = bus;
+    }
+    return unused;
+}
+
+void OneWireTempSensorScheduler::add(OneWireTempSensor * sensor){
+    sensor->nextOnBus = first;
+    first = sensor;
+}
+
+void OneWireTempSensorScheduler::remove(OneWireTempSensor * sensor){
+    // the queue of the driver still points to the transaction of the sensor until it is done
+    while(sensor->scratchPadRead.isPending()){
+        bus->poll();
+    }
+    for(OneWireTempSensor ** p = &first; *p != nullptr; p = &(*p)->nextOnBus){
+        if(*p == sensor){
+            *p = sensor->nextOnBus;
+            sensor->nextOnBus = nullptr;
+            break;
+        }
+    }
+    if(first == nullptr){
+        // release the slot when the last sensor is removed
+        bus = nullptr;
+        converting = false;
+        reading = false;
+    }
+}
+
+uint8_t OneWireTempSensorScheduler::sensorCount() const {
+    uint8_t count = 0;
+    for(OneWireTempSensor * s = first; s != nullptr; s = s->nextOnBus){
+        count++;
+    }
+    return count;
+}
+
+bool OneWireTempSensorScheduler::conversionComplete() const {
+    return converting && ticks.timeSinceMillis(conversionStart) >= ONEWIRE_TEMP_SENSOR_CONVERSION_TIME;
+}
+
+void OneWireTempSensorScheduler::requestConversion(){
+    if(converting){
+        return; // restarting would delay the readings of all sensors on the bus
+    }
+    startConversion();
+}
+
+void OneWireTempSensorScheduler::startConversion(){
+    // Like DallasTemperature, keep the bus powered during the conversion when a sensor uses parasite power
+    bool parasite = false;
+    for(OneWireTempSensor * s = first; s != nullptr; s = s->nextOnBus){
+        if(s->sensor && s->sensor->isParasitePowerMode()){
+            parasite = true;
+        }
+    }
+    bus->reset();
+    bus->skip();
+    bus->write(STARTCONVO, parasite);
+    conversionStart = ticks.millis();
+    converting = true;
+}
+
+void OneWireTempSensorScheduler::update(){
+    if(!converting){
+        startConversion();
+        return;
+    }
+    if(!reading){
+        if(!conversionComplete()){
+            return;
+        }
+        for(OneWireTempSensor * s = first; s != nullptr; s = s->nextOnBus){
+            s->submitScratchPadRead();
+        }
+        reading = true;
+    }
+    if(bus->poll()){
+        return; // the driver reads the scratchpads in the background
+    }
+    reading = false;
+    // a sensor that reconnects while the batch is processed does not start a conversion, because converting is still set
+    for(OneWireTempSensor * s = first; s != nullptr; s = s->nextOnBus){
+        s->updateFromQueuedRead();
+    }
+    startConversion();
+}
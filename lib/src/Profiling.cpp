@@ -0,0 +1,97 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Profiling.h"
+
+#if BREWPI_PROFILING
+
+void RunTimeStatistics::reset(){
+    runs = 0;
+    totalRunTime = 0;
+    minRunTime = UINT32_MAX;
+    maxRunTime = 0;
+    for(auto & t : recentRunTimes){
+        t = 0;
+    }
+    recentIndex = 0;
+}
+
+void RunTimeStatistics::add(uint32_t runTime){
+    runs++;
+    totalRunTime += runTime;
+    if(runTime < minRunTime){
+        minRunTime = runTime;
+    }
+    if(runTime > maxRunTime){
+        maxRunTime = runTime;
+    }
+    recentRunTimes[recentIndex] = runTime;
+    recentIndex = (recentIndex + 1) % PROFILING_RECENT_RUNS;
+}
+
+uint32_t RunTimeStatistics::recentMaxRunTime() const {
+    uint32_t result = 0;
+    for(auto t : recentRunTimes){
+        if(t > result){
+            result = t;
+        }
+    }
+    return result;
+}
+
+void LatenessHistogram::reset(){
+    for(auto & b : bins){
+        b = 0;
+    }
+}
+
+void LatenessHistogram::add(uint32_t lateness){
+    uint8_t bin = 0;
+    while(lateness != 0 && bin < PROFILING_LATENESS_BINS - 1){
+        lateness >>= 1;
+        bin++;
+    }
+    if(bins[bin] != UINT16_MAX){
+        bins[bin]++;
+    }
+}
+
+ProfileSection * ProfileSection::list = nullptr;
+
+ProfileSection::ProfileSection(const char * _name) : name(_name), next(list){
+    stats.reset();
+    list = this;
+}
+
+ProfileSection::~ProfileSection(){
+    for(ProfileSection ** p = &list; *p != nullptr; p = &(*p)->next){
+        if(*p == this){
+            *p = next;
+            break;
+        }
+    }
+}
+
+void ProfileSection::resetAll(){
+    for(ProfileSection * s = list; s != nullptr; s = s->next){
+        s->stats.reset();
+    }
+}
+
+#endif
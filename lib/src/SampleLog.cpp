@@ -0,0 +1,301 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SampleLog.h"
+
+const uint8_t SampleBlockWriter::VERSION;
+const uint8_t SampleBlockWriter::HEADER_SIZE;
+const uint8_t SampleBlockWriter::MAX_CHANNELS;
+const uint16_t SampleBlockWriter::BLOCK_SIZE;
+const uint32_t SampleStore::NO_SEQUENCE;
+
+// largest deviation from the interval that fits in the sample head, doubled and zigzag encoded
+static const int32_t MAX_DEVIATION = 0x1FFFFFFF;
+static const uint8_t MAX_VARINT_SIZE = 5;
+
+static uint32_t zigzag(int32_t value){
+    return (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value){
+    return int32_t(value >> 1) ^ -int32_t(value & 1);
+}
+
+static uint8_t writeVarint(uint8_t * out, uint32_t value){
+    uint8_t size = 0;
+    while(value >= 0x80){
+        out[size++] = uint8_t(value) | 0x80;
+        value >>= 7;
+    }
+    out[size++] = uint8_t(value);
+    return size;
+}
+
+static uint8_t varintSize(uint32_t value){
+    uint8_t size = 1;
+    while(value >= 0x80){
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+SampleBlockWriter::SampleBlockWriter() :
+    startTime(0),
+    lastTime(0),
+    run(0),
+    length(0),
+    count(0),
+    sampleInterval(0),
+    numChannels(0)
+{
+}
+
+void SampleBlockWriter::begin(uint8_t channels, uint16_t interval){
+    numChannels = channels > MAX_CHANNELS ? MAX_CHANNELS : channels;
+    sampleInterval = interval;
+    for(uint8_t i = 0; i < MAX_CHANNELS; i++){
+        previous[i] = 0;
+    }
+    run = 0;
+    count = 0;
+    length = HEADER_SIZE;
+    block[0] = VERSION;
+    block[1] = numChannels;
+    block[2] = uint8_t(interval);
+    block[3] = uint8_t(interval >> 8);
+}
+
+bool SampleBlockWriter::add(uint32_t time, const int32_t * values){
+    if(count == 0xFFFF){
+        return false;
+    }
+    int32_t deviation = 0;
+    uint32_t changed = 0;
+    for(uint8_t i = 0; i < numChannels; i++){
+        if(values[i] != previous[i]){
+            changed |= uint32_t(1) << i;
+        }
+    }
+
+    if(count > 0){
+        deviation = int32_t(time - lastTime - sampleInterval);
+        if(deviation > MAX_DEVIATION || deviation < -MAX_DEVIATION){
+            return false;
+        }
+        if(deviation == 0 && changed == 0){
+            if(run >= uint32_t(MAX_DEVIATION)){
+                return false; // 2 * run + 1 would not fit in the varint
+            }
+            run++;
+            count++;
+            lastTime = time;
+            return true;
+        }
+    }
+
+    uint8_t sample[2 * MAX_VARINT_SIZE + MAX_CHANNELS * MAX_VARINT_SIZE];
+    uint8_t size = writeVarint(sample, zigzag(deviation) << 1);
+    size += writeVarint(sample + size, changed);
+    for(uint8_t i = 0; i < numChannels; i++){
+        if(changed & (uint32_t(1) << i)){
+            size += writeVarint(sample + size, zigzag(int32_t(uint32_t(values[i]) - uint32_t(previous[i]))));
+        }
+    }
+
+    // keep room to end a run of repeats after this sample
+    uint8_t runSize = run ? varintSize(2 * run + 1) : 0;
+    if(length + runSize + size + MAX_VARINT_SIZE > BLOCK_SIZE){
+        return false;
+    }
+    flushRun();
+    for(uint8_t i = 0; i < size; i++){
+        block[length++] = sample[i];
+    }
+    for(uint8_t i = 0; i < numChannels; i++){
+        previous[i] = values[i];
+    }
+    if(count == 0){
+        startTime = time;
+        for(uint8_t i = 0; i < 4; i++){
+            block[4 + i] = uint8_t(time >> (8 * i));
+        }
+    }
+    count++;
+    lastTime = time;
+    return true;
+}
+
+const uint8_t * SampleBlockWriter::finish(){
+    flushRun();
+    return block;
+}
+
+void SampleBlockWriter::flushRun(){
+    if(run){
+        length += writeVarint(block + length, 2 * run + 1);
+        run = 0;
+    }
+}
+
+SampleBlockReader::SampleBlockReader() :
+    data(nullptr),
+    length(0),
+    pos(0),
+    currentTime(0),
+    run(0),
+    sampleInterval(0),
+    numChannels(0),
+    first(true)
+{
+}
+
+bool SampleBlockReader::begin(const uint8_t * block, uint16_t blockLength){
+    data = block;
+    length = blockLength;
+    pos = SampleBlockWriter::HEADER_SIZE;
+    run = 0;
+    first = true;
+    if(length < SampleBlockWriter::HEADER_SIZE || block[0] != SampleBlockWriter::VERSION
+            || block[1] > SampleBlockWriter::MAX_CHANNELS){
+        length = 0;
+        return false;
+    }
+    numChannels = block[1];
+    sampleInterval = block[2] | (uint16_t(block[3]) << 8);
+    currentTime = 0;
+    for(uint8_t i = 0; i < 4; i++){
+        currentTime |= uint32_t(block[4 + i]) << (8 * i);
+    }
+    for(uint8_t i = 0; i < SampleBlockWriter::MAX_CHANNELS; i++){
+        current[i] = 0;
+    }
+    return true;
+}
+
+bool SampleBlockReader::readVarint(uint32_t & value){
+    value = 0;
+    for(uint8_t shift = 0; shift < 7 * MAX_VARINT_SIZE; shift += 7){
+        if(pos >= length){
+            return false;
+        }
+        uint8_t b = data[pos++];
+        value |= uint32_t(b & 0x7F) << shift;
+        if(!(b & 0x80)){
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SampleBlockReader::next(uint32_t & time, int32_t * values){
+    if(run == 0){
+        uint32_t head;
+        if(pos >= length || !readVarint(head)){
+            return false;
+        }
+        if(head & 1){
+            run = head >> 1;
+            if(first || run == 0){
+                return false;
+            }
+        }
+        else {
+            uint32_t changed;
+            if(!readVarint(changed)){
+                return false;
+            }
+            for(uint8_t i = 0; i < numChannels; i++){
+                if(changed & (uint32_t(1) << i)){
+                    uint32_t delta;
+                    if(!readVarint(delta)){
+                        return false;
+                    }
+                    current[i] = int32_t(uint32_t(current[i]) + uint32_t(unzigzag(delta)));
+                }
+            }
+            if(!first){
+                currentTime += sampleInterval + unzigzag(head >> 1);
+            }
+            first = false;
+        }
+    }
+    if(run){
+        run--;
+        currentTime += sampleInterval;
+    }
+    time = currentTime;
+    for(uint8_t i = 0; i < numChannels; i++){
+        values[i] = current[i];
+    }
+    return true;
+}
+
+SampleLogger::SampleLogger(SampleStore & target, uint8_t channels, uint16_t interval, uint32_t maxBlockAge) :
+    store(target),
+    nextSequence(0),
+    lastTime(0),
+    maxAge(maxBlockAge),
+    sampleInterval(interval),
+    numChannels(channels),
+    started(false)
+{
+}
+
+void SampleLogger::init(){
+    nextSequence = store.lastSequence() + 1; // NO_SEQUENCE + 1 is 0
+}
+
+void SampleLogger::add(uint32_t now, const int32_t * values){
+    uint32_t time = now;
+    if(started){
+        // the last point on the grid of sample times
+        time = lastTime + (uint32_t(now - lastTime) / sampleInterval) * sampleInterval;
+    }
+    if(writer.samples() > 0 && uint32_t(time - writer.firstTime()) >= maxAge){
+        flush();
+    }
+    if(writer.samples() == 0){
+        writer.begin(numChannels, sampleInterval);
+    }
+    if(!writer.add(time, values)){
+        flush();
+        writer.begin(numChannels, sampleInterval);
+        writer.add(time, values);
+    }
+    lastTime = time;
+    started = true;
+}
+
+void SampleLogger::flush(){
+    if(writer.samples() == 0){
+        return;
+    }
+    const uint8_t * block = writer.finish();
+    store.append(nextSequence++, block, writer.size());
+    writer.begin(numChannels, sampleInterval);
+}
+
+void SampleLogger::setInterval(uint16_t interval){
+    if(interval == 0 || interval == sampleInterval){
+        return;
+    }
+    flush();
+    sampleInterval = interval; // the next sample is one new interval after the last sample
+}
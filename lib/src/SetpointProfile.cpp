@@ -0,0 +1,97 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SetpointProfile.h"
+
+const uint8_t SetpointProfile::MAX_STEPS;
+
+bool SetpointProfile::load(const ProfilePoint * points, uint8_t numSteps, ProfileInterpolation interpolation){
+    count = (numSteps < MAX_STEPS) ? numSteps : MAX_STEPS;
+    uint32_t start = 0;
+    for(uint8_t i = 0; i < count; i++){
+        ProfileSegment & seg = segments[i];
+        seg.start = start;
+        seg.value = points[i].setpoint;
+        for(int32_t & c : seg.c){
+            c = 0;
+        }
+        uint32_t duration = points[i].duration;
+        if(i + 1 == count || duration == 0){
+            seg.inverseDuration = 0; // last step holds its setpoint
+        }
+        else {
+            seg.inverseDuration = 0xFFFFFFFF / duration;
+            int32_t delta = int32_t(points[i + 1].setpoint) - points[i].setpoint;
+            switch(interpolation){
+            case INTERPOLATION_NONE:
+                break;
+            case INTERPOLATION_LINEAR:
+                seg.c[0] = delta;
+                break;
+            case INTERPOLATION_SMOOTH:
+                seg.c[1] = 3 * delta;
+                seg.c[2] = -2 * delta;
+                break;
+            case INTERPOLATION_SMOOTHER:
+                seg.c[2] = 10 * delta;
+                seg.c[3] = -15 * delta;
+                seg.c[4] = 6 * delta;
+                break;
+            }
+        }
+        start += duration;
+    }
+    return count > 0;
+}
+
+uint8_t SetpointProfile::stepAt(uint32_t time) const {
+    if(count == 0){
+        return 0;
+    }
+    // last step that starts at or before time. Steps without duration start at the same time as the next step.
+    uint8_t low = 0;
+    uint8_t high = count - 1;
+    while(low < high){
+        uint8_t mid = (low + high + 1) / 2;
+        if(segments[mid].start <= time){
+            low = mid;
+        }
+        else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+int16_t SetpointProfile::valueInStep(uint8_t step, uint32_t offset) const {
+    const ProfileSegment & seg = segments[step];
+    if(seg.inverseDuration == 0){
+        return seg.value;
+    }
+    int64_t u = (uint64_t(offset) * seg.inverseDuration) >> 8; // 0.24 fixed point, less than 1
+    // Horner's method, the terms are in the units of the value with 16 fraction bits
+    int64_t acc = int64_t(seg.c[4]) << 16;
+    acc = (int64_t(seg.c[3]) << 16) + ((acc * u) >> 24);
+    acc = (int64_t(seg.c[2]) << 16) + ((acc * u) >> 24);
+    acc = (int64_t(seg.c[1]) << 16) + ((acc * u) >> 24);
+    acc = (int64_t(seg.c[0]) << 16) + ((acc * u) >> 24);
+    acc = ((acc * u) >> 24) + (1 << 15); // round to nearest
+    acc >>= 16;
+    return seg.value + int16_t(acc);
+}
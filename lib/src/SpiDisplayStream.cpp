@@ -0,0 +1,106 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SpiDisplayStream.h"
+
+const uint16_t SpiDisplayStream::BUFFER_SIZE;
+const uint8_t SpiDisplayStream::CASET;
+const uint8_t SpiDisplayStream::PASET;
+const uint8_t SpiDisplayStream::RAMWR;
+
+void SpiDisplayStream::command(uint8_t cmd){
+    flush();
+    begin();
+    sink.wait(); // the data/command line cannot change while data is being transmitted
+    commandByte = cmd;
+    sink.dataMode(false);
+    sink.write(&commandByte, 1);
+    sink.wait();
+    sink.dataMode(true);
+}
+
+void SpiDisplayStream::setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1){
+    command(CASET);
+    data(x0 >> 8);
+    data(x0);
+    data(x1 >> 8);
+    data(x1);
+    command(PASET);
+    data(y0 >> 8);
+    data(y0);
+    data(y1 >> 8);
+    data(y1);
+    command(RAMWR);
+}
+
+void SpiDisplayStream::pushColor(uint16_t color, uint32_t count){
+    uint8_t hi = color >> 8;
+    uint8_t lo = color;
+    while(count > 0){
+        if(pending + 2 > BUFFER_SIZE){
+            flush();
+        }
+        uint8_t * p = &buffer[active][pending];
+        uint16_t fit = (BUFFER_SIZE - pending) / 2;
+        uint16_t n = (count < fit) ? count : fit;
+        for(uint16_t i = 0; i < n; i++){
+            *p++ = hi;
+            *p++ = lo;
+        }
+        pending += 2 * n;
+        count -= n;
+    }
+}
+
+void SpiDisplayStream::pushColors(const uint16_t * colors, uint16_t count){
+    while(count > 0){
+        if(pending + 2 > BUFFER_SIZE){
+            flush();
+        }
+        uint8_t * p = &buffer[active][pending];
+        uint16_t fit = (BUFFER_SIZE - pending) / 2;
+        uint16_t n = (count < fit) ? count : fit;
+        for(uint16_t i = 0; i < n; i++){
+            uint16_t color = *colors++;
+            *p++ = color >> 8;
+            *p++ = color;
+        }
+        pending += 2 * n;
+        count -= n;
+    }
+}
+
+void SpiDisplayStream::flush(){
+    if(pending == 0){
+        return;
+    }
+    begin();
+    sink.write(buffer[active], pending); // waits for the transfer of the other half
+    active ^= 1;
+    pending = 0;
+}
+
+void SpiDisplayStream::end(){
+    flush();
+    if(selected){
+        sink.wait();
+        sink.select(false);
+        selected = false;
+    }
+}
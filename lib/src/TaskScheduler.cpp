@@ -0,0 +1,106 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TaskScheduler.h"
+#include "Ticks.h"
+
+#if BREWPI_PROFILING
+void TaskStatistics::reset(){
+    RunTimeStatistics::reset();
+    maxLateness = 0;
+    missedDeadlines = 0;
+    lateness.reset();
+}
+#endif
+
+void Task::run(ticks_millis_t now){
+#if BREWPI_PROFILING
+    ticks_millis_t lateness = now - nextRelease;
+    ticks_micros_t start = ticks.micros();
+#endif
+
+    function();
+
+#if BREWPI_PROFILING
+    stats.add(ticks.micros() - start);
+    if(lateness > stats.maxLateness){
+        stats.maxLateness = lateness;
+    }
+    stats.lateness.add(lateness);
+    if(int32_t(ticks.millis() - absoluteDeadline()) > 0){
+        stats.missedDeadlines++;
+    }
+#endif
+
+    nextRelease += period;
+    ticks_millis_t late = now - nextRelease;
+    if(int32_t(late) >= 0){
+        // more than a period late: skip the missed releases instead of running the task back to back.
+        // The next release stays on the period grid, so tasks with the same period keep running in the same order.
+        nextRelease = period ? nextRelease + (late / period + 1) * period : now;
+    }
+}
+
+bool TaskScheduler::add(Task * task){
+    if(count >= TASK_SCHEDULER_MAX_TASKS){
+        return false;
+    }
+    task->nextRelease = ticks.millis();
+    tasks[count++] = task;
+    return true;
+}
+
+void TaskScheduler::remove(Task * task){
+    for(uint8_t i = 0; i < count; i++){
+        if(tasks[i] == task){
+            count--;
+            for(uint8_t j = i; j < count; j++){
+                tasks[j] = tasks[j + 1];
+            }
+            return;
+        }
+    }
+}
+
+Task * TaskScheduler::run(){
+    ticks_millis_t now = ticks.millis();
+    Task * selected = nullptr;
+    for(uint8_t i = 0; i < count; i++){
+        Task * t = tasks[i];
+        if(!t->isDue(now)){
+            continue;
+        }
+        if(selected == nullptr
+                || t->priority > selected->priority
+                || (t->priority == selected->priority
+                        && int32_t(t->absoluteDeadline() - selected->absoluteDeadline()) < 0)){
+            selected = t;
+        }
+    }
+    if(selected){
+        selected->run(now);
+    }
+    return selected;
+}
+
+void TaskScheduler::resetStatistics(){
+    for(uint8_t i = 0; i < count; i++){
+        tasks[i]->resetStatistics();
+    }
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Telemetry.h"
+
+uint16_t telemetryCrc(const uint8_t * data, uint16_t length, uint16_t crc){
+    for(uint16_t i = 0; i < length; i++){
+        crc ^= uint16_t(data[i]) << 8;
+        for(uint8_t bit = 0; bit < 8; bit++){
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint16_t cobsEncode(const uint8_t * in, uint16_t length, uint8_t * out){
+    uint16_t codePos = 0; // position of the code byte of the current block
+    uint16_t outPos = 1;
+    uint8_t code = 1;
+    for(uint16_t i = 0; i < length; i++){
+        if(in[i] == 0){
+            out[codePos] = code;
+            codePos = outPos++;
+            code = 1;
+            continue;
+        }
+        out[outPos++] = in[i];
+        if(++code == 0xFF){
+            // maximum block length, start a new block without an implicit zero
+            out[codePos] = code;
+            codePos = outPos++;
+            code = 1;
+        }
+    }
+    out[codePos] = code;
+    return outPos;
+}
+
+uint16_t cobsDecode(const uint8_t * in, uint16_t length, uint8_t * out){
+    uint16_t inPos = 0;
+    uint16_t outPos = 0;
+    while(inPos < length){
+        uint8_t code = in[inPos++];
+        if(code == 0 || inPos + code - 1 > length){
+            return 0;
+        }
+        for(uint8_t i = 1; i < code; i++){
+            if(in[inPos] == 0){
+                return 0;
+            }
+            out[outPos++] = in[inPos++];
+        }
+        if(code != 0xFF && inPos < length){
+            out[outPos++] = 0;
+        }
+    }
+    return outPos;
+}
+
+TelemetryWriter::TelemetryWriter(TelemetrySink & target, uint8_t keyframeInterval) :
+    sink(target),
+    sentIds(0),
+    length(0),
+    batchTime(0),
+    nextSequence(0),
+    interval(keyframeInterval),
+    keyframeCountdown(0),
+    keyframe(false)
+{
+}
+
+void TelemetryWriter::begin(uint32_t time){
+    batchTime = time;
+    keyframe = keyframeCountdown == 0;
+    keyframeCountdown = keyframe ? interval : keyframeCountdown - 1;
+    length = HEADER_SIZE;
+}
+
+void TelemetryWriter::add(uint8_t id, int32_t value){
+    if(id >= MAX_IDS){
+        return;
+    }
+    uint64_t mask = uint64_t(1) << id;
+    if(!keyframe && (sentIds & mask) && lastSent[id] == value){
+        return;
+    }
+
+    // smallest number of bytes that holds the signed value
+    uint8_t bytes = 4;
+    if(value >= -128 && value < 128){
+        bytes = 1;
+    }
+    else if(value >= -32768 && value < 32768){
+        bytes = 2;
+    }
+    else if(value >= -8388608 && value < 8388608){
+        bytes = 3;
+    }
+
+    if(length + 1 + bytes > HEADER_SIZE + PAYLOAD_SIZE){
+        flush(true);
+    }
+    frame[length++] = id | ((bytes - 1) << 6);
+    uint32_t raw = uint32_t(value);
+    for(uint8_t i = 0; i < bytes; i++){
+        frame[length++] = uint8_t(raw >> (8 * i));
+    }
+    lastSent[id] = value;
+    sentIds |= mask;
+}
+
+void TelemetryWriter::end(){
+    flush(false);
+}
+
+void TelemetryWriter::flush(bool more){
+    frame[0] = (keyframe ? TELEMETRY_KEYFRAME : 0) | (more ? TELEMETRY_MORE : 0);
+    frame[1] = nextSequence++;
+    for(uint8_t i = 0; i < 4; i++){
+        frame[2 + i] = uint8_t(batchTime >> (8 * i));
+    }
+    uint16_t crc = telemetryCrc(frame, length);
+    frame[length++] = uint8_t(crc);
+    frame[length++] = uint8_t(crc >> 8);
+
+    uint8_t encoded[ENCODED_SIZE];
+    encoded[0] = 0;
+    uint16_t encodedLength = cobsEncode(frame, length, encoded + 1) + 1;
+    encoded[encodedLength++] = 0;
+    sink.write(encoded, encodedLength);
+
+    length = HEADER_SIZE;
+}
+
+bool telemetryDecode(const uint8_t * encoded, uint16_t length, TelemetryFrame & frame){
+    uint8_t decoded[TelemetryWriter::FRAME_SIZE];
+    if(length > TelemetryWriter::ENCODED_SIZE - 2){
+        return false;
+    }
+    uint16_t size = cobsDecode(encoded, length, decoded);
+    if(size < TelemetryWriter::HEADER_SIZE + 2){
+        return false;
+    }
+    uint16_t crc = decoded[size - 2] | (uint16_t(decoded[size - 1]) << 8);
+    if(telemetryCrc(decoded, size - 2) != crc || (decoded[0] & TELEMETRY_LOG_BLOCK)){
+        return false;
+    }
+
+    frame.flags = decoded[0];
+    frame.sequence = decoded[1];
+    frame.time = 0;
+    for(uint8_t i = 0; i < 4; i++){
+        frame.time |= uint32_t(decoded[2 + i]) << (8 * i);
+    }
+    frame.count = 0;
+    uint16_t pos = TelemetryWriter::HEADER_SIZE;
+    while(pos < size - 2){
+        uint8_t header = decoded[pos++];
+        uint8_t bytes = (header >> 6) + 1;
+        if(pos + bytes > size - 2){
+            return false;
+        }
+        uint32_t raw = 0;
+        for(uint8_t i = 0; i < bytes; i++){
+            raw |= uint32_t(decoded[pos++]) << (8 * i);
+        }
+        if(bytes < 4 && (raw & (uint32_t(1) << (8 * bytes - 1)))){
+            raw |= ~uint32_t(0) << (8 * bytes); // sign extend
+        }
+        TelemetryRecord & record = frame.records[frame.count++];
+        record.id = header & 0x3F;
+        record.value = int32_t(raw);
+    }
+    return true;
+}
+
+static const uint16_t BLOCK_HEADER_SIZE = 5;
+static const uint16_t BLOCK_FRAME_SIZE = BLOCK_HEADER_SIZE + TELEMETRY_MAX_BLOCK_SIZE + 2;
+static const uint16_t BLOCK_ENCODED_SIZE = BLOCK_FRAME_SIZE + BLOCK_FRAME_SIZE / 254 + 1;
+
+void telemetrySendBlock(TelemetrySink & sink, uint32_t sequence, const uint8_t * block, uint16_t length){
+    if(length > TELEMETRY_MAX_BLOCK_SIZE){
+        return;
+    }
+    uint8_t frame[BLOCK_FRAME_SIZE];
+    frame[0] = TELEMETRY_LOG_BLOCK;
+    for(uint8_t i = 0; i < 4; i++){
+        frame[1 + i] = uint8_t(sequence >> (8 * i));
+    }
+    for(uint16_t i = 0; i < length; i++){
+        frame[BLOCK_HEADER_SIZE + i] = block[i];
+    }
+    uint16_t size = BLOCK_HEADER_SIZE + length;
+    uint16_t crc = telemetryCrc(frame, size);
+    frame[size++] = uint8_t(crc);
+    frame[size++] = uint8_t(crc >> 8);
+
+    uint8_t encoded[BLOCK_ENCODED_SIZE + 2];
+    encoded[0] = 0;
+    uint16_t encodedLength = cobsEncode(frame, size, encoded + 1) + 1;
+    encoded[encodedLength++] = 0;
+    sink.write(encoded, encodedLength);
+}
+
+bool telemetryDecodeBlock(const uint8_t * encoded, uint16_t length, uint32_t & sequence, uint8_t * block,
+                          uint16_t & blockLength){
+    uint8_t decoded[BLOCK_ENCODED_SIZE];
+    if(length > BLOCK_ENCODED_SIZE){
+        return false;
+    }
+    uint16_t size = cobsDecode(encoded, length, decoded);
+    if(size < BLOCK_HEADER_SIZE + 2 || size > BLOCK_FRAME_SIZE || decoded[0] != TELEMETRY_LOG_BLOCK){
+        return false;
+    }
+    uint16_t crc = decoded[size - 2] | (uint16_t(decoded[size - 1]) << 8);
+    if(telemetryCrc(decoded, size - 2) != crc){
+        return false;
+    }
+    sequence = 0;
+    for(uint8_t i = 0; i < 4; i++){
+        sequence |= uint32_t(decoded[1 + i]) << (8 * i);
+    }
+    blockLength = size - 2 - BLOCK_HEADER_SIZE;
+    for(uint16_t i = 0; i < blockLength; i++){
+        block[i] = decoded[BLOCK_HEADER_SIZE + i];
+    }
+    return true;
+}
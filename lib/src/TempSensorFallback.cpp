@@ -42,4 +42,5 @@ void TempSensorFallback::update() {
             onBackupSensor = true;
         }
     }
+    publishChange();
 }
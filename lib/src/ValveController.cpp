@@ -18,50 +18,51 @@
  */
 
 #include "ValveController.h"
+#include "DevicePools.h"
 
-/*
- * Updates the status of the member variables from what is read back from the valve
- * Checks whether the valve are is done with opening/closing and stops driving it.
- */
+POOL_ALLOCATION(ValveController, VALVE_CONTROLLER_POOL_SIZE)
 
-uint8_t maskSenseBits(uint8_t input){
-    return input | 0b00110011;
-}
-uint8_t maskWriteBitsA(uint8_t input){
-    return input & 0b00111111;
-}
-uint8_t maskWriteBitsB(uint8_t input){
-    return input & 0b11110011;
+// sense bits are inputs and are always written as 1
+static const uint8_t senseBits = 0b00110011;
+
+static uint8_t actionShift(pio_t pio){
+    return pio == 0 ? 6 : 2;
 }
 
-void ValveController::update() {
-    switchState = device.accessRead();
+void ValveController::parseState() {
     // content of switchState:
     // bit 7-6: Valve A action: 01 = open, 10 = close, 11 = off, 00 = off but LEDS on
     // bit 5-4: Valve A status: 01 = opened, 10 = closed, 11 = in between
     // bit 3-2: Valve B action: 01 = open, 10 = close, 11 = off, 00 = off but LEDS on
     // bit 1-0: Valve B status: 01 = opened, 10 = closed, 11 = in between
-
-    uint8_t output = switchState;
-
     if(pio == 0){
         act = (switchState >> 6) & 0x3;
         sense = (switchState >> 4) & 0x3;
-        if (act == sense) {
-            // fully opened/closed. Stop driving the valve
-            output |= (uint8_t(ValveActions::OFF) << 6);
-        }
     }
     else if(pio == 1){
         act = (switchState >> 2) & 0x3;
         sense = switchState & 0x3;
-        if (act == sense) {
-            // fully opened/closed. Stop driving the valve
-            output |= (uint8_t(ValveActions::OFF) << 2);
-        }
     }
-    if (output != switchState) {
-        device.accessWrite(maskSenseBits(output)); // write new state, but ensure keep sense bits as inputs
+}
+
+/*
+ * Updates the status of the member variables from what is read back from the valve
+ * Checks whether the valve are is done with opening/closing and stops driving it.
+ * The DS2408 is read once per control cycle for both valves and stopping the valve is written on the next flush,
+ * combined with changes for the other valve.
+ */
+void ValveController::update() {
+    if (device == nullptr) {
+        return;
+    }
+    device->refresh();
+    switchState = device->getCachedState();
+    parseState();
+
+    if (pio <= 1 && act == sense && act != uint8_t(ValveActions::OFF)) {
+        // fully opened/closed. Stop driving the valve
+        uint8_t shift = actionShift(pio);
+        device->latchWriteDeferred((0x3 << shift) | senseBits, (uint8_t(ValveActions::OFF) << shift) | senseBits);
     }
 }
 
@@ -81,18 +82,12 @@ uint8_t ValveController::read(bool doUpdate) {
 }
 
 void ValveController::write(ValveActions action) {
-    update();
-    uint8_t action_ = uint8_t(action);
-    uint8_t output = maskSenseBits(switchState);
-    if(pio == 0){
-        output = maskWriteBitsA(output);
-        output |= action_ << 6;
-        device.accessWrite(output);
-    }
-    else if(pio == 1){
-        output = maskWriteBitsB(output);
-        output |= action_ << 2;
-        device.accessWrite(output);
+    if(pio > 1 || device == nullptr){
+        return;
     }
-    update();
+    uint8_t shift = actionShift(pio);
+    device->latchWriteDeferred((0x3 << shift) | senseBits, (uint8_t(action) << shift) | senseBits);
+    device->flush();
+    switchState = device->getCachedState();
+    parseState();
 }
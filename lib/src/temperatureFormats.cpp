@@ -356,62 +356,152 @@ temp_long_t temp_long_t::operator/(uint16_t const rhs) {
     return result;
 }
 
+namespace {
+
+// powers of 5, used to multiply by 10^numDecimals / 2^numDecimals
+constexpr uint32_t pow5[] = {
+    1UL, 5UL, 25UL, 125UL, 625UL, 3125UL, 15625UL, 78125UL, 390625UL, 1953125UL,
+    9765625UL, 48828125UL, 244140625UL, 1220703125UL
+};
+
+// largest value that can be multiplied by pow5[i] without overflowing 32 bits
+constexpr uint32_t pow5Limit[] = {
+    UINT32_MAX / pow5[0], UINT32_MAX / pow5[1], UINT32_MAX / pow5[2], UINT32_MAX / pow5[3],
+    UINT32_MAX / pow5[4], UINT32_MAX / pow5[5], UINT32_MAX / pow5[6], UINT32_MAX / pow5[7],
+    UINT32_MAX / pow5[8], UINT32_MAX / pow5[9], UINT32_MAX / pow5[10], UINT32_MAX / pow5[11],
+    UINT32_MAX / pow5[12], UINT32_MAX / pow5[13]
+};
+
+constexpr uint8_t maxDecimals = sizeof(pow5) / sizeof(pow5[0]) - 1;
+
+// largest magnitude for which the conversion to Fahrenheit can be done with 32 bit arithmetic
+constexpr int32_t fahrenheitLimit = (INT32_MAX - (int32_t(32) << 25) - 25) / 90;
+
+/* Unsigned decimal value that is split into digits from the least significant side.
+ * Uses 64 bit division only while the value does not fit in 32 bits, which is only the case for large temp_long_t
+ * values and for temp_precise_t values with many decimals.
+ */
+class DecimalDigits {
+public:
+    DecimalDigits(uint64_t value) : wide(value), narrow(uint32_t(value)), isWide(value > UINT32_MAX) {}
+
+    bool isZero() const {
+        return !isWide && narrow == 0;
+    }
+
+    char next(){
+        if(isWide){
+            char c = '0' + char(wide % 10);
+            wide /= 10;
+            if(wide <= UINT32_MAX){
+                narrow = uint32_t(wide);
+                isWide = false;
+            }
+            return c;
+        }
+        char c = '0' + char(narrow % 10); // 32 bit division by a constant is a multiply on ARM
+        narrow /= 10;
+        return c;
+    }
+
+private:
+    uint64_t wide;
+    uint32_t narrow;
+    bool isWide;
+};
+
+/* Scales the magnitude of a fixed point value to an integer with numDecimals decimals, rounded.
+ * F is a template parameter, so the shifts are constants for each fixed point type.
+ */
+template <unsigned char F>
+uint64_t scaleToDecimals(uint64_t magnitude, uint8_t numDecimals){
+    // * 10^numDecimals / 2^F is done as * 5^numDecimals / 2^(F - numDecimals). Less chance of overflow
+    uint8_t shift = F - numDecimals;
+    if(magnitude <= pow5Limit[numDecimals]){
+        uint32_t scaled = uint32_t(magnitude) * pow5[numDecimals];
+        if(scaled <= UINT32_MAX - (uint32_t(1) << (shift - 1))){
+            return (scaled + (uint32_t(1) << (shift - 1))) >> shift; // divide rounded by fixed point scale
+        }
+    }
+    uint64_t scaled = magnitude * pow5[numDecimals];
+    return (scaled + (uint64_t(1) << (shift - 1))) >> shift;
+}
+
+uint64_t scaleToDecimals(uint64_t magnitude, unsigned char F, uint8_t numDecimals){
+    switch(F){
+    case temp_t::fractional_bit_count:
+        return scaleToDecimals<temp_t::fractional_bit_count>(magnitude, numDecimals);
+    case temp_precise_t::fractional_bit_count:
+        return scaleToDecimals<temp_precise_t::fractional_bit_count>(magnitude, numDecimals);
+    default:
+        uint64_t scaled = magnitude * pow5[numDecimals];
+        return (scaled + (uint64_t(1) << (F - numDecimals - 1))) >> (F - numDecimals);
+    }
+}
+
+} // end anonymous namespace
+
 // converts fixed point value to string, without using double/float
 // resulting string is always length len (including \0). Spaces are prepended to achieve that
 char * toStringImpl(const int32_t raw, // raw value of fixed point
         unsigned char const F, // number of fraction bits
         char buf[], // target buffer
-        uint8_t const numDecimals, // number of decimals to print
+        uint8_t numDecimals, // number of decimals to print
         uint8_t const len, // maximum number of characters to print
         char format, // C or F
         bool absolute) // is this an absolute temperature? need to subtract 32 for F
         {
-
-    char const digit[] = "0123456789";
     char* p;
     bool negative = false;
+    uint64_t magnitude;
 
-    // Use larger type to prevent overflow.
-    int64_t shifter = raw;
+    if(numDecimals > maxDecimals){
+        numDecimals = maxDecimals;
+    }
 
     if(format =='F'){
-        int8_t rounder = (shifter < 0) ? -25 : 25;
-        shifter = (shifter * 90 + rounder) / 50;
-        if(absolute){
-            shifter += 32 << F;
+        // Use larger type only when needed to prevent overflow.
+        if(raw <= fahrenheitLimit && raw >= -fahrenheitLimit){
+            int32_t rounder = (raw < 0) ? -25 : 25;
+            int32_t converted = (raw * 90 + rounder) / 50;
+            if(absolute){
+                converted += int32_t(32) << F;
+            }
+            negative = converted < 0;
+            magnitude = negative ? 0U - uint32_t(converted) : uint32_t(converted);
+        }
+        else {
+            int64_t rounder = (raw < 0) ? -25 : 25;
+            int64_t converted = (int64_t(raw) * 90 + rounder) / 50;
+            if(absolute){
+                converted += int64_t(32) << F;
+            }
+            negative = converted < 0;
+            magnitude = negative ? uint64_t(-converted) : uint64_t(converted);
         }
     }
-
-    if (shifter < 0) {
-        shifter = -shifter;
-        negative = true;
-    }
-    // code below looks a bit cryptic, but what it does is * 10^numDecimals / 2^F
-    for (uint8_t i = 0; i < numDecimals; i++) {
-        shifter = shifter * 5; // *5 instead of 10, combined with reduced shift below. Less chance of overflow
+    else {
+        negative = raw < 0;
+        magnitude = negative ? 0U - uint32_t(raw) : uint32_t(raw);
     }
-    shifter = (shifter + (1 << (F - numDecimals - 1))) >> (F - numDecimals); // divide rounded by fixed point scale
+
+    DecimalDigits digits(scaleToDecimals(magnitude, F, numDecimals));
 
     p = &buf[len - 1]; // start at the end of buffer
     *p = '\0';
-    lldiv_t dv { };
-    dv.quot = shifter;
     do { //Move back, inserting digits as u go
         if (p == &buf[len - 1 - numDecimals]) {
             *--p = '.'; // insert decimal point at right moment
+        } else if (!digits.isZero()) { // check if end of digits
+            *--p = digits.next();
+        } else if ((p - buf) > (len - numDecimals - 3)) { // still need to print some leading zeros
+            *--p = '0';
+        } else if (negative) {
+            // print minus sign if needed as last digit to print
+            *--p = '-';
+            break;
         } else {
-            dv = lldiv(dv.quot, 10);
-            if ((dv.quot || dv.rem)) { // check if end of digits
-                *--p = digit[std::abs(dv.rem)];
-            } else if ((p - buf) > (len - numDecimals - 3)) { // still need to print some leading zeros
-                *--p = '0';
-            } else if (negative) {
-                // print minus sign if needed as last digit to print
-                *--p = '-';
-                break;
-            } else {
-                break;
-            }
+            break;
         }
     } while (p > buf);
     char * pWithoutSpaces = p;
@@ -193,6 +193,158 @@ BOOST_AUTO_TEST_CASE(when_there_have_been_no_requests_for_a_while_dead_time_is_s
     BOOST_CHECK(!act2->isActive()); // not allowed, because of dead time
 }
 
+BOOST_AUTO_TEST_CASE(without_budget_a_cooler_held_off_by_its_minimum_off_time_does_not_block_the_heater) {
+    ticks.reset();
+    ActuatorBool coolerPin, heaterPin;
+    ActuatorTimeLimited coolerTimeLimited(&coolerPin, 10, 300); // still in its minimum off time
+    ActuatorMutexGroup mutex;
+    ActuatorMutexDriver cooler(&coolerTimeLimited, &mutex);
+    ActuatorMutexDriver heater(&heaterPin, &mutex);
+    mutex.setDeadTime(10000);
+    delay(20000); // the dead time has passed, the minimum off time of the cooler has not
+
+    cooler.setActive(true, 50);
+    BOOST_CHECK(!coolerPin.isActive());
+
+    // the cooler never went active, so there is no dead time and no open request of the cooler
+    heater.setActive(true, 10);
+    BOOST_CHECK(heaterPin.isActive());
+
+    // while the heater is active, the cooler cannot go active, whatever its priority
+    delay(300000);
+    cooler.setActive(true, 127);
+    BOOST_CHECK(!coolerPin.isActive());
+    BOOST_CHECK(heaterPin.isActive());
+}
+
+BOOST_AUTO_TEST_CASE(without_budget_an_active_actuator_is_not_preempted_by_a_higher_priority) {
+    ActuatorBool act1, act2;
+    ActuatorMutexGroup mutex;
+    ActuatorMutexDriver actm1(&act1, &mutex);
+    ActuatorMutexDriver actm2(&act2, &mutex);
+
+    actm1.setActive(true, 10);
+    actm2.setActive(true, 100);
+    BOOST_CHECK(act1.isActive());
+    BOOST_CHECK(!act2.isActive());
+
+    // requests with equal priority do not hold each other back
+    actm1.setActive(false);
+    actm1.setActive(true, 100);
+    BOOST_CHECK(act1.isActive());
+}
+
+BOOST_AUTO_TEST_CASE(power_budget_allows_multiple_actuators_that_fit) {
+    ActuatorBool act1, act2, act3;
+    ActuatorMutexGroup mutex;
+    ActuatorMutexDriver actm1(&act1, &mutex);
+    ActuatorMutexDriver actm2(&act2, &mutex);
+    ActuatorMutexDriver actm3(&act3, &mutex);
+    mutex.setPowerBudget(5000);
+    actm1.setLoad(2000);
+    actm2.setLoad(2000);
+    actm3.setLoad(2000);
+
+    actm1.setActive(true, 10);
+    actm2.setActive(true, 10);
+    BOOST_CHECK(act1.isActive());
+    BOOST_CHECK(act2.isActive()); // 4000 W fits in the budget
+    BOOST_CHECK_EQUAL(mutex.getActiveLoad(), 4000);
+
+    actm3.setActive(true, 10);
+    BOOST_CHECK(!act3.isActive()); // 6000 W does not fit
+
+    actm1.setActive(false);
+    actm3.setActive(true, 10);
+    BOOST_CHECK(act3.isActive()); // load of actuator 1 is released when it is inactive
+    BOOST_CHECK_EQUAL(mutex.getActiveLoad(), 4000);
+}
+
+BOOST_AUTO_TEST_CASE(power_budget_reserves_power_for_waiting_requests_with_higher_priority) {
+    ActuatorBool small1, small2, large;
+    ActuatorMutexGroup mutex;
+    ActuatorMutexDriver smallm1(&small1, &mutex);
+    ActuatorMutexDriver smallm2(&small2, &mutex);
+    ActuatorMutexDriver largem(&large, &mutex);
+    mutex.setPowerBudget(3000);
+    smallm1.setLoad(1000);
+    smallm2.setLoad(1000);
+    largem.setLoad(2500);
+
+    smallm1.setActive(true, 10);
+    BOOST_CHECK(small1.isActive());
+
+    largem.setActive(true, 50);
+    BOOST_CHECK(!large.isActive()); // does not fit while small 1 is active
+
+    smallm2.setActive(true, 20);
+    BOOST_CHECK(!small2.isActive()); // would fit, but the power is reserved for the large load
+
+    smallm1.setActive(false);
+    largem.setActive(true, 50);
+    BOOST_CHECK(large.isActive());
+}
+
+BOOST_AUTO_TEST_CASE(actuators_without_load_in_a_budget_group_are_not_limited) {
+    ActuatorBool act1, act2;
+    ActuatorMutexGroup mutex;
+    ActuatorMutexDriver actm1(&act1, &mutex);
+    ActuatorMutexDriver actm2(&act2, &mutex);
+    mutex.setPowerBudget(1000);
+
+    actm1.setActive(true, 10);
+    actm2.setActive(true, 20);
+    BOOST_CHECK(act1.isActive());
+    BOOST_CHECK(act2.isActive());
+}
+
+BOOST_AUTO_TEST_CASE(priorities_of_many_requests_are_ordered_correctly) {
+    const uint8_t count = 12;
+    ActuatorBool acts[count];
+    ActuatorMutexDriver * drivers[count];
+    ActuatorMutexGroup mutex;
+    mutex.setPowerBudget(1000);
+    for(uint8_t i = 0; i < count; i++){
+        drivers[i] = new ActuatorMutexDriver(&acts[i], &mutex);
+        drivers[i]->setLoad(1000);
+    }
+
+    // all request in a scrambled order while the budget is in use by the first one
+    drivers[0]->setActive(true, 1);
+    for(uint8_t i = 1; i < count; i++){
+        drivers[i]->setActive(true, int8_t((i * 7) % count + 10));
+        BOOST_CHECK(!acts[i].isActive());
+    }
+    uint8_t running = 0;
+
+    // the waiting requests take turns in order of priority
+    int8_t lastPriority = 127;
+    for(uint8_t turn = 1; turn < count; turn++){
+        drivers[running]->setActive(false);
+        drivers[running]->setMutex(nullptr); // done, leave the group
+
+        uint8_t started = count;
+        for(uint8_t i = 1; i < count; i++){
+            if(drivers[i]->getMutex() == nullptr){
+                continue;
+            }
+            int8_t prio = int8_t((i * 7) % count + 10);
+            drivers[i]->setActive(true, prio);
+            if(acts[i].isActive()){
+                BOOST_CHECK_EQUAL(started, count); // only one fits
+                BOOST_CHECK_LT(prio, lastPriority);
+                started = i;
+                lastPriority = prio;
+            }
+        }
+        BOOST_REQUIRE_LT(started, count);
+        running = started;
+    }
+    for(uint8_t i = 0; i < count; i++){
+        delete drivers[i];
+    }
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
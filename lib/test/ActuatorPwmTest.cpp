@@ -165,7 +165,32 @@ BOOST_AUTO_TEST_CASE(average_duty_cycle_is_correct_with_long_period) {
     BOOST_CHECK_CLOSE(randomIntervalTest(act, target, 99.0, 500), 99.0, 0.5);
 }
 
+#if BREWPI_PROFILING
+BOOST_AUTO_TEST_CASE(late_edges_are_counted_as_missed) {
+    ActuatorBool target;
+    ActuatorPwm act(&target, 4);
+    act.setValue(50.0);
+
+    // updating every ms makes every edge on time
+    while (!target.isActive()) {
+        delay(1);
+        act.update();
+    }
+    ActuatorPwm::resetMissedEdges();
+    for (int i = 0; i < 8000; i++) {
+        delay(1);
+        act.update();
+    }
+    BOOST_CHECK_EQUAL(ActuatorPwm::missedEdges(), 0u);
 
+    // updating every 700 ms makes the edges up to 700 ms late
+    for (int i = 0; i < 20; i++) {
+        delay(700);
+        act.update();
+    }
+    BOOST_CHECK(ActuatorPwm::missedEdges() > 0);
+}
+#endif
 
 BOOST_AUTO_TEST_CASE(output_stays_low_with_value_0) {
     ActuatorDigital * target = new ActuatorBool();
@@ -776,4 +801,113 @@ BOOST_AUTO_TEST_CASE(decreasing_pwm_value_after_long_high_time_and_mutex_wait){
     }
 }
 
+BOOST_AUTO_TEST_CASE(PWM_actuators_in_a_power_budget_group_share_the_budget){
+    // 3 elements of 2000 W on a circuit that can supply 4000 W
+    const uint8_t count = 3;
+    ActuatorBool boolActs[count];
+    ActuatorMutexDriver * drivers[count];
+    ActuatorPwm * pwms[count];
+    ActuatorMutexGroup mutex;
+    mutex.setPowerBudget(4000);
+    for(uint8_t i = 0; i < count; i++){
+        drivers[i] = new ActuatorMutexDriver(&boolActs[i], &mutex);
+        drivers[i]->setLoad(2000);
+        pwms[i] = new ActuatorPwm(drivers[i], 10);
+        pwms[i]->setValue(50.0);
+    }
+
+    uint32_t timeHigh[count] = {0};
+    uint32_t samples = 0;
+    ticks_millis_t start = ticks.millis();
+
+    ofstream csv("./test_results/" + boost_test_name() + ".csv");
+    csv << "1a#pin1, 1a#pin2, 1a#pin3" << endl;
+
+    while(ticks.millis() - start <= 300000){ // run for 300 seconds
+        uint8_t active = 0;
+        for(uint8_t i = 0; i < count; i++){
+            pwms[i]->update();
+        }
+        mutex.update();
+        for(uint8_t i = 0; i < count; i++){
+            if(boolActs[i].isActive()){
+                timeHigh[i]++;
+                active++;
+            }
+        }
+        BOOST_REQUIRE_LE(active, 2); // never more than the budget
+        BOOST_REQUIRE_LE(mutex.getActiveLoad(), 4000);
+        samples++;
+        csv << boolActs[0].isActive() << "," << boolActs[1].isActive() << "," << boolActs[2].isActive() << endl;
+        delay(100);
+    }
+
+    for(uint8_t i = 0; i < count; i++){
+        double avgDuty = double(timeHigh[i]) * 100.0 / samples;
+        BOOST_CHECK_CLOSE(avgDuty, 50.0, 5); // all elements get their share of the budget
+    }
+
+    for(uint8_t i = 0; i < count; i++){
+        delete pwms[i];
+        delete drivers[i];
+    }
+}
+
+BOOST_AUTO_TEST_CASE(PWM_actuators_in_a_power_budget_group_are_staggered){
+    // the budget allows all elements at once, but staggering spreads the load over the period
+    const uint8_t count = 3;
+    ActuatorBool boolActs[count];
+    ActuatorMutexDriver * drivers[count];
+    ActuatorPwm * pwms[count];
+    ActuatorMutexGroup mutex;
+    mutex.setPowerBudget(6000);
+    for(uint8_t i = 0; i < count; i++){
+        drivers[i] = new ActuatorMutexDriver(&boolActs[i], &mutex);
+        drivers[i]->setLoad(2000);
+        pwms[i] = new ActuatorPwm(drivers[i], 10);
+        pwms[i]->setValue(30.0);
+    }
+
+    uint32_t timeHigh[count] = {0};
+    uint32_t samples = 0;
+    uint32_t overlap = 0; // samples with more than one element active
+    ticks_millis_t start = ticks.millis();
+
+    ofstream csv("./test_results/" + boost_test_name() + ".csv");
+    csv << "1a#pin1, 1a#pin2, 1a#pin3" << endl;
+
+    while(ticks.millis() - start <= 300000){ // run for 300 seconds
+        uint8_t active = 0;
+        for(uint8_t i = 0; i < count; i++){
+            pwms[i]->update();
+        }
+        mutex.update();
+        for(uint8_t i = 0; i < count; i++){
+            if(boolActs[i].isActive()){
+                timeHigh[i]++;
+                active++;
+            }
+        }
+        if(active > 1){
+            overlap++;
+        }
+        samples++;
+        csv << boolActs[0].isActive() << "," << boolActs[1].isActive() << "," << boolActs[2].isActive() << endl;
+        delay(100);
+    }
+
+    for(uint8_t i = 0; i < count; i++){
+        double avgDuty = double(timeHigh[i]) * 100.0 / samples;
+        BOOST_CHECK_CLOSE(avgDuty, 30.0, 5);
+    }
+    // without staggering, all elements start together and overlap for 30% of the time
+    double overlapPercentage = double(overlap) * 100.0 / samples;
+    BOOST_CHECK_LT(overlapPercentage, 10.0);
+
+    for(uint8_t i = 0; i < count; i++){
+        delete pwms[i];
+        delete drivers[i];
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "BlockPool.h"
+#include "DevicePools.h"
+#include "OneWire.h"
+#include "OneWireTempSensor.h"
+#include <string.h>
+
+BOOST_AUTO_TEST_SUITE(BlockPoolTest)
+
+BOOST_AUTO_TEST_CASE(allocate_until_full_and_reuse_released_blocks){
+    BlockPool<12, 4, 3> pool("test");
+    void * a = pool.allocate();
+    void * b = pool.allocate();
+    void * c = pool.allocate();
+    BOOST_REQUIRE(a != nullptr && b != nullptr && c != nullptr);
+    BOOST_CHECK(a != b && b != c && a != c);
+    BOOST_CHECK_EQUAL(uintptr_t(a) % 4, 0u);
+
+    BOOST_CHECK(pool.allocate() == nullptr);
+    BOOST_CHECK_EQUAL(pool.statistics().getFailures(), 1);
+    BOOST_CHECK_EQUAL(pool.statistics().getUsed(), 3);
+
+    // the last released block is handed out first
+    pool.release(b);
+    pool.release(a);
+    BOOST_CHECK(pool.allocate() == a);
+    BOOST_CHECK(pool.allocate() == b);
+    BOOST_CHECK_EQUAL(pool.statistics().getHighWater(), 3);
+
+    pool.release(c);
+    pool.release(nullptr);
+    BOOST_CHECK_EQUAL(pool.statistics().getUsed(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(pools_are_listed_in_statistics){
+    BlockPool<8, 8, 2> pool("listed");
+    bool found = false;
+    for(PoolStatistics * p = PoolStatistics::first(); p != nullptr; p = p->getNext()){
+        if(strcmp(p->getName(), "listed") == 0){
+            found = true;
+            BOOST_CHECK_EQUAL(p->getCapacity(), 2);
+        }
+    }
+    BOOST_CHECK(found);
+}
+
+BOOST_AUTO_TEST_CASE(pool_allocated_class_returns_nullptr_when_pool_is_full){
+    OneWire wire(0);
+    DeviceAddress address = {0x28, 1, 2, 3, 4, 5, 6, 7};
+    OneWireTempSensor * sensors[ONEWIRE_TEMP_SENSOR_POOL_SIZE + 1];
+    uint8_t created = 0;
+    for(auto & s : sensors){
+        s = new OneWireTempSensor(&wire, address, temp_t(0.0));
+        if(s != nullptr){
+            created++;
+        }
+    }
+    BOOST_CHECK(created <= ONEWIRE_TEMP_SENSOR_POOL_SIZE);
+    BOOST_CHECK(sensors[ONEWIRE_TEMP_SENSOR_POOL_SIZE] == nullptr);
+
+    // released objects make room for new ones
+    for(auto s : sensors){
+        delete s;
+    }
+    OneWireTempSensor * s = new OneWireTempSensor(&wire, address, temp_t(0.0));
+    BOOST_CHECK(s != nullptr);
+    delete s;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
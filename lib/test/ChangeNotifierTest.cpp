@@ -0,0 +1,215 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "ChangeNotifier.h"
+#include "TempSensorMock.h"
+#include "TempSensor.h"
+#include "ActuatorMocks.h"
+#include "ActuatorTimeLimited.h"
+#include "Ticks.h"
+
+// counts notifications
+class ChangeCounter final : public ChangeListener<temp_t> {
+public:
+    ChangeCounter(temp_t deadband) : ChangeListener<temp_t>(deadband), count(0) {}
+
+    void changed(temp_t const & value) override final {
+        last = value;
+        count++;
+    }
+
+    temp_t last;
+    int count;
+};
+
+BOOST_AUTO_TEST_SUITE(ChangeNotifierTest)
+
+BOOST_AUTO_TEST_CASE(listener_is_notified_when_the_value_leaves_the_deadband){
+    ChangeNotifier<temp_t> notifier;
+    ChangeCounter listener(0.5);
+    notifier.subscribe(listener);
+
+    notifier.publish(20.0);
+    BOOST_CHECK_EQUAL(listener.count, 1); // the first value is always notified
+    notifier.publish(20.25);
+    notifier.publish(19.75);
+    notifier.publish(20.5);
+    BOOST_CHECK_EQUAL(listener.count, 1);
+    notifier.publish(20.75);
+    BOOST_CHECK_EQUAL(listener.count, 2);
+    BOOST_CHECK_EQUAL(listener.last, temp_t(20.75));
+    notifier.publish(20.5); // compared to the last notified value, not to the last published value
+    BOOST_CHECK_EQUAL(listener.count, 2);
+}
+
+BOOST_AUTO_TEST_CASE(becoming_invalid_or_valid_is_always_a_change){
+    ChangeNotifier<temp_t> notifier;
+    ChangeCounter listener(10.0);
+    notifier.subscribe(listener);
+
+    notifier.publish(20.0);
+    notifier.publish(temp_t::invalid());
+    BOOST_CHECK_EQUAL(listener.count, 2);
+    notifier.publish(temp_t::invalid());
+    BOOST_CHECK_EQUAL(listener.count, 2);
+    notifier.publish(20.0);
+    BOOST_CHECK_EQUAL(listener.count, 3);
+}
+
+BOOST_AUTO_TEST_CASE(listeners_have_their_own_deadband){
+    ChangeNotifier<temp_t> notifier;
+    ChangeCounter fine(0.0);
+    ChangeCounter coarse(1.0);
+    notifier.subscribe(fine);
+    notifier.subscribe(coarse);
+
+    for(double t = 20.0; t < 22.0; t += 0.125){
+        notifier.publish(t);
+    }
+    BOOST_CHECK_EQUAL(fine.count, 16);
+    BOOST_CHECK_EQUAL(coarse.count, 2);
+}
+
+BOOST_AUTO_TEST_CASE(unsubscribed_or_destroyed_listener_is_not_notified){
+    ChangeNotifier<temp_t> notifier;
+    ChangeCounter listener(0.0);
+    notifier.subscribe(listener);
+    notifier.subscribe(listener); // subscribing twice has no effect
+    notifier.publish(20.0);
+    BOOST_CHECK_EQUAL(listener.count, 1);
+
+    notifier.unsubscribe(listener);
+    BOOST_CHECK(!listener.isSubscribed());
+    notifier.publish(21.0);
+    BOOST_CHECK_EQUAL(listener.count, 1);
+
+    {
+        ChangeCounter shortLived(0.0);
+        notifier.subscribe(shortLived);
+    }
+    BOOST_CHECK(!notifier.hasListeners());
+    notifier.publish(22.0);
+}
+
+BOOST_AUTO_TEST_CASE(listener_is_unsubscribed_when_the_notifier_is_destroyed){
+    ChangeCounter listener(0.0);
+    {
+        ChangeNotifier<temp_t> shortLived;
+        shortLived.subscribe(listener);
+        BOOST_CHECK(listener.isSubscribed());
+    }
+    BOOST_CHECK(!listener.isSubscribed());
+    listener.unsubscribe(); // does not touch the destroyed notifier
+
+    ChangeNotifier<temp_t> notifier;
+    notifier.subscribe(listener);
+    listener.unsubscribe();
+    BOOST_CHECK(!notifier.hasListeners());
+}
+
+BOOST_AUTO_TEST_CASE(change_flag_keeps_the_newest_value_until_it_is_taken){
+    ChangeNotifier<temp_t> notifier;
+    ChangeFlag<temp_t> flag(0.0);
+    notifier.subscribe(flag);
+    temp_t value;
+
+    BOOST_CHECK(!flag.take(value));
+    notifier.publish(20.0);
+    notifier.publish(21.0);
+    BOOST_CHECK(flag.take(value));
+    BOOST_CHECK_EQUAL(value, temp_t(21.0));
+    BOOST_CHECK(!flag.take(value));
+}
+
+BOOST_AUTO_TEST_CASE(sensor_publishes_its_value_on_update){
+    TempSensorMock * mock = new TempSensorMock(20.0);
+    TempSensor sensor(mock);
+    ChangeCounter onMock(0.1);
+    ChangeCounter onSensor(0.1);
+    mock->subscribe(onMock);
+    sensor.subscribe(onSensor);
+
+    sensor.update();
+    BOOST_CHECK_EQUAL(onMock.count, 1);
+    BOOST_CHECK_EQUAL(onSensor.count, 1);
+    BOOST_CHECK_EQUAL(onSensor.last, temp_t(20.0));
+
+    mock->setTemp(20.0625);
+    sensor.update();
+    BOOST_CHECK_EQUAL(onSensor.count, 1);
+
+    mock->setTemp(21.0);
+    sensor.update();
+    BOOST_CHECK_EQUAL(onSensor.count, 2);
+    BOOST_CHECK_EQUAL(onSensor.last, temp_t(21.0));
+
+    mock->setConnected(false);
+    sensor.update();
+    BOOST_CHECK_EQUAL(onSensor.count, 3);
+    BOOST_CHECK_EQUAL(onSensor.last, temp_t::invalid());
+}
+
+BOOST_AUTO_TEST_CASE(digital_actuator_publishes_its_state){
+    ticks.reset();
+    ActuatorBool act;
+    ActuatorTimeLimited limited(&act, 0, 0);
+    delay(1000);
+    ChangeFlag<bool> onAct(false);
+    ChangeFlag<bool> onLimited(false);
+    act.subscribe(onAct);
+    limited.subscribe(onLimited);
+    bool state;
+
+    limited.setActive(true);
+    BOOST_CHECK(onAct.take(state));
+    BOOST_CHECK(state);
+    BOOST_CHECK(onLimited.take(state));
+    BOOST_CHECK(state);
+
+    limited.setActive(true);
+    BOOST_CHECK(!onAct.take(state));
+    BOOST_CHECK(!onLimited.take(state));
+
+    act.setActive(false); // turned off behind the time limited actuator
+    BOOST_CHECK(onAct.take(state));
+    BOOST_CHECK(!onLimited.take(state));
+    limited.update();
+    BOOST_CHECK(onLimited.take(state));
+    BOOST_CHECK(!state);
+}
+
+BOOST_AUTO_TEST_CASE(range_actuator_publishes_its_value_on_update){
+    ActuatorValue act(0.0, 0.0, 100.0);
+    ChangeFlag<temp_t> flag(1.0);
+    act.subscribe(flag);
+    temp_t value;
+
+    act.update();
+    BOOST_CHECK(flag.take(value));
+    act.setValue(50.0);
+    BOOST_CHECK(!flag.take(value));
+    act.update();
+    BOOST_CHECK(flag.take(value));
+    BOOST_CHECK_EQUAL(value, temp_t(50.0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "DS248x.h"
+#include "DS248xEmulated.h"
+#include "OneWireEmulatedDevices.h"
+#include "DallasTemperature.h"
+#include <string.h>
+
+static const uint8_t readScratchPadCommand = READSCRATCH;
+
+// DS2482-800 with channel 0 on the emulated bus of pin 0 and channel 1 on the bus of pin 1
+struct DS248xFixture {
+    DS248xFixture() :
+        bridge(0, 0),
+        ds(0),
+        bus0(OneWireEmulatedBus::forPin(0)),
+        bus1(OneWireEmulatedBus::forPin(1)),
+        sensor1(1, 21.0),
+        sensor2(2, 22.5),
+        sensor3(3, 30.0) {
+        bus0.clear();
+        bus1.clear();
+        bus0.attach(&sensor1);
+        bus0.attach(&sensor2);
+        bus1.attach(&sensor3);
+        Wire.attach(&bridge);
+        BOOST_REQUIRE(ds.init());
+    }
+    ~DS248xFixture() {
+        Wire.detach(&bridge);
+        bus0.clear();
+        bus1.clear();
+    }
+
+    void readScratchPad(OneWireTransaction & t, const OneWireEmulatedDevice & device, uint8_t * data){
+        t.select(device.getAddress());
+        t.writeData = &readScratchPadCommand;
+        t.writeLength = 1;
+        t.readData = data;
+        t.readLength = 9;
+    }
+
+    // polls until no transactions are pending and returns the number of polls
+    uint32_t pollAll(){
+        uint32_t polls = 1;
+        while(ds.poll()){
+            polls++;
+            BOOST_REQUIRE(polls < 10000);
+        }
+        return polls;
+    }
+
+    DS248xEmulated bridge;
+    DS248x ds;
+    OneWireEmulatedBus & bus0;
+    OneWireEmulatedBus & bus1;
+    DS18B20Emulated sensor1;
+    DS18B20Emulated sensor2;
+    DS18B20Emulated sensor3;
+};
+
+BOOST_FIXTURE_TEST_SUITE(DS248xTest, DS248xFixture)
+
+BOOST_AUTO_TEST_CASE(queued_scratchpad_reads_return_the_scratchpads_of_the_devices){
+    bridge.setBusyReads(3);
+    OneWireTransaction t1, t2;
+    uint8_t data1[9], data2[9];
+    readScratchPad(t1, sensor1, data1);
+    readScratchPad(t2, sensor2, data2);
+
+    BOOST_REQUIRE(ds.submit(t1));
+    BOOST_REQUIRE(ds.submit(t2));
+    BOOST_CHECK(!ds.submit(t1)); // already pending
+    BOOST_CHECK(t1.getStatus() == OneWireTransaction::Status::QUEUED);
+
+    BOOST_CHECK_GT(pollAll(), 1u);
+    BOOST_CHECK(t1.getStatus() == OneWireTransaction::Status::DONE);
+    BOOST_CHECK(t2.getStatus() == OneWireTransaction::Status::DONE);
+    BOOST_CHECK(memcmp(data1, sensor1.getScratchpad(), 9) == 0);
+    BOOST_CHECK(memcmp(data2, sensor2.getScratchpad(), 9) == 0);
+    BOOST_CHECK_EQUAL(bridge.getCommandsWhileBusy(), 0u);
+    BOOST_CHECK(!ds.hasPending());
+}
+
+BOOST_AUTO_TEST_CASE(poll_does_a_single_status_read_while_the_bridge_is_busy){
+    bridge.setBusyReads(1000);
+    OneWireTransaction t;
+    uint8_t data[9];
+    readScratchPad(t, sensor1, data);
+    BOOST_REQUIRE(ds.submit(t));
+
+    BOOST_CHECK(ds.poll()); // starts the reset
+    BOOST_CHECK(t.getStatus() == OneWireTransaction::Status::BUSY);
+
+    Wire.resetTransfers();
+    ticks_millis_t start = ticks.millis();
+    BOOST_CHECK(ds.poll());
+    BOOST_CHECK_EQUAL(Wire.getTransfers(), 1u);
+    BOOST_CHECK_EQUAL(ticks.millis(), start);
+    BOOST_CHECK(t.getStatus() == OneWireTransaction::Status::BUSY);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_times_out_when_the_bridge_stays_busy){
+    bridge.setBusyReads(100000);
+    OneWireTransaction t;
+    uint8_t data[9];
+    readScratchPad(t, sensor1, data);
+    BOOST_REQUIRE(ds.submit(t));
+
+    BOOST_CHECK(ds.poll());
+    delay(DS248X_QUEUE_TIMEOUT / 1000 + 1);
+    BOOST_CHECK(!ds.poll());
+    BOOST_CHECK(t.getStatus() == OneWireTransaction::Status::TIMEOUT);
+    BOOST_CHECK(ds.hasTimeout());
+}
+
+BOOST_AUTO_TEST_CASE(missing_device_is_reported_as_no_presence){
+    bus0.clear();
+    OneWireTransaction t;
+    uint8_t data[9];
+    readScratchPad(t, sensor1, data);
+    BOOST_REQUIRE(ds.submit(t));
+
+    pollAll();
+    BOOST_CHECK(t.getStatus() == OneWireTransaction::Status::NO_PRESENCE);
+}
+
+BOOST_AUTO_TEST_CASE(transactions_on_the_selected_channel_go_first){
+    BOOST_REQUIRE(ds.selectChannel(0));
+    OneWireTransaction a, b, c;
+    uint8_t dataA[9], dataB[9], dataC[9];
+    readScratchPad(a, sensor1, dataA);
+    readScratchPad(b, sensor3, dataB);
+    readScratchPad(c, sensor2, dataC);
+    a.channel = 0;
+    b.channel = 1;
+    c.channel = 0;
+    ds.submit(a);
+    ds.submit(b);
+    ds.submit(c);
+
+    pollAll();
+    BOOST_CHECK(a.getStatus() == OneWireTransaction::Status::DONE);
+    BOOST_CHECK(b.getStatus() == OneWireTransaction::Status::DONE);
+    BOOST_CHECK(c.getStatus() == OneWireTransaction::Status::DONE);
+    BOOST_CHECK(memcmp(dataA, sensor1.getScratchpad(), 9) == 0);
+    BOOST_CHECK(memcmp(dataB, sensor3.getScratchpad(), 9) == 0);
+    BOOST_CHECK(memcmp(dataC, sensor2.getScratchpad(), 9) == 0);
+    BOOST_CHECK_EQUAL(bridge.getChannel(), 1); // c was read before switching to channel 1 for b
+}
+
+BOOST_AUTO_TEST_CASE(blocking_calls_finish_queued_transactions_first){
+    OneWireTransaction t;
+    uint8_t data[9];
+    readScratchPad(t, sensor1, data);
+    BOOST_REQUIRE(ds.submit(t));
+
+    BOOST_CHECK(ds.reset());
+    BOOST_CHECK(t.getStatus() == OneWireTransaction::Status::DONE);
+    BOOST_CHECK(memcmp(data, sensor1.getScratchpad(), 9) == 0);
+    BOOST_CHECK(!ds.hasPending());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "FilterBank.h"
+#include "FilterCascaded.h"
+#include "FilterFixed.h"
+#include <chrono>
+#include <string.h>
+
+// reference implementation: NUM_SECTIONS FixedFilter objects in series, like FilterCascaded was implemented before
+struct ReferenceFilter {
+    FixedFilter sections[NUM_SECTIONS];
+
+    ReferenceFilter(uint8_t b = 2){
+        setFiltering(b);
+        init(temp_precise_t(0.0));
+    }
+    void setFiltering(uint8_t b){
+        for(FixedFilter & s : sections){
+            s.setFiltering(b);
+        }
+    }
+    void init(temp_precise_t val){
+        for(FixedFilter & s : sections){
+            s.init(val);
+        }
+    }
+    temp_precise_t add(temp_precise_t val){
+        for(FixedFilter & s : sections){
+            val = s.add(val);
+        }
+        return val;
+    }
+    FixedFilter & last(){
+        return sections[NUM_SECTIONS - 1];
+    }
+};
+
+static uint32_t lcg = 12345;
+
+// random temperature, with now and then a value close to the limits of temp_precise_t to trigger saturation
+static temp_precise_t randomInput(){
+    lcg = lcg * 1664525u + 1013904223u;
+    temp_precise_t result;
+    switch(lcg >> 28){
+    case 0:
+        result = temp_precise_t::max();
+        break;
+    case 1:
+        result = temp_precise_t::min();
+        break;
+    default:
+        result.setRaw(int32_t(lcg) >> 4); // within +/- 8 degrees of the limits
+        break;
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_SUITE(FilterBankTest)
+
+BOOST_AUTO_TEST_CASE(filter_cascaded_is_bit_exact_with_fixed_filters){
+    bool ok = true;
+    for(uint8_t b = 0; b <= 6; b++){
+        FilterCascaded f;
+        ReferenceFilter ref(b);
+        f.setFiltering(b);
+        for(int i = 0; i < 5000 && ok; i++){
+            temp_precise_t in = randomInput();
+            temp_precise_t out = f.add(in);
+            temp_precise_t expected = ref.add(in);
+            if(out != expected || f.readPrevOutput() != ref.last().readPrevOutput() || f.readInput() != in){
+                BOOST_ERROR("b=" << int(b) << ", sample " << i << ": " << out.getRaw() << " != " << expected.getRaw());
+                ok = false;
+            }
+        }
+    }
+    BOOST_CHECK(ok);
+}
+
+BOOST_AUTO_TEST_CASE(bank_channels_are_bit_exact_with_fixed_filters){
+    const uint8_t channels = 11; // not a multiple of the SIMD width
+    FilterBank<channels> bank;
+    ReferenceFilter ref[channels];
+    for(uint8_t ch = 0; ch < channels; ch++){
+        bank.setFiltering(ch, ch % 7);
+        ref[ch].setFiltering(ch % 7);
+        temp_precise_t start = randomInput();
+        bank.init(ch, start);
+        ref[ch].init(start);
+    }
+
+    bool ok = true;
+    for(int i = 0; i < 5000 && ok; i++){
+        temp_precise_t in[channels];
+        for(uint8_t ch = 0; ch < channels; ch++){
+            in[ch] = randomInput();
+            bank.setInput(ch, in[ch]);
+        }
+        bank.update();
+        for(uint8_t ch = 0; ch < channels; ch++){
+            temp_precise_t expected = ref[ch].add(in[ch]);
+            temp_precise_t peak = temp_precise_t(0.0);
+            temp_precise_t expectedPeak = temp_precise_t(0.0);
+            bool same = bank.readOutput(ch) == expected
+                    && bank.readPrevOutput(ch) == ref[ch].last().readPrevOutput()
+                    && bank.readInput(ch) == in[ch]
+                    && bank.isRising(ch) == ref[ch].last().isRising()
+                    && bank.isFalling(ch) == ref[ch].last().isFalling()
+                    && bank.detectPosPeak(ch, &peak) == ref[ch].last().detectPosPeak(&expectedPeak)
+                    && bank.detectNegPeak(ch, &peak) == ref[ch].last().detectNegPeak(&expectedPeak)
+                    && peak == expectedPeak;
+            if(!same){
+                BOOST_ERROR("channel " << int(ch) << ", sample " << i << ": "
+                        << bank.readOutput(ch).getRaw() << " != " << expected.getRaw());
+                ok = false;
+            }
+        }
+    }
+    BOOST_CHECK(ok);
+}
+
+BOOST_AUTO_TEST_CASE(vector_and_scalar_implementation_are_identical){
+    const uint8_t stride = 16;
+    int32_t vectorState[NUM_SECTIONS * 6 * stride];
+    int32_t scalarState[NUM_SECTIONS * 6 * stride];
+    int32_t b[stride];
+    for(uint8_t ch = 0; ch < stride; ch++){
+        b[ch] = (ch < 8) ? 3 : ch % 7; // the first channels share their filtering, which has a faster implementation
+    }
+    for(int32_t & s : vectorState){
+        s = randomInput().getRaw();
+    }
+    memcpy(scalarState, vectorState, sizeof(scalarState));
+
+    uint8_t vectorHead = 0;
+    uint8_t scalarHead = 0;
+    bool ok = true;
+    for(int i = 0; i < 5000 && ok; i++){
+        for(uint8_t ch = 0; ch < stride; ch++){
+            int32_t in = randomInput().getRaw();
+            vectorState[((vectorHead + 2) % 3) * stride + ch] = in;
+            scalarState[((scalarHead + 2) % 3) * stride + ch] = in;
+        }
+        vectorHead = filterBankUpdate(vectorState, b, vectorHead, stride);
+        scalarHead = filterBankUpdateScalar(scalarState, b, scalarHead, stride);
+        ok = vectorHead == scalarHead && memcmp(vectorState, scalarState, sizeof(scalarState)) == 0;
+    }
+    BOOST_CHECK(ok);
+}
+
+BOOST_AUTO_TEST_CASE(benchmark_bank_against_separate_filters){
+    const uint8_t channels = 16;
+    const int samples = 20000;
+    FilterBank<channels> bank;
+    FilterCascaded filters[channels];
+    ReferenceFilter ref[channels];
+    temp_precise_t in = 20.0;
+    int32_t checksum = 0; // prevent the filters from being optimized away
+
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < samples; i++){
+        for(uint8_t ch = 0; ch < channels; ch++){
+            checksum += ref[ch].add(in).getRaw();
+        }
+    }
+    auto referenceTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < samples; i++){
+        for(uint8_t ch = 0; ch < channels; ch++){
+            checksum -= filters[ch].add(in).getRaw();
+        }
+    }
+    auto cascadedTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < samples; i++){
+        for(uint8_t ch = 0; ch < channels; ch++){
+            bank.setInput(ch, in);
+        }
+        bank.update();
+    }
+    auto bankTime = std::chrono::steady_clock::now() - start;
+
+    BOOST_CHECK_EQUAL(checksum, 0);
+    BOOST_CHECK_EQUAL(bank.readOutput(0), filters[0].readOutput());
+    BOOST_TEST_MESSAGE(int(channels) << " channels x " << samples << " samples: "
+            << "FixedFilter cascade " << std::chrono::duration_cast<std::chrono::microseconds>(referenceTime).count() << " us"
+            << ", FilterCascaded " << std::chrono::duration_cast<std::chrono::microseconds>(cascadedTime).count() << " us"
+            << ", FilterBank " << std::chrono::duration_cast<std::chrono::microseconds>(bankTime).count() << " us"
+            << " (SIMD width " << FILTER_BANK_SIMD_WIDTH << ")");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "JsonTokenizer.h"
+#include <string>
+
+static void appendPair(const char * key, const char * val, void * data){
+    std::string * pairs = static_cast<std::string *>(data);
+    *pairs += key;
+    *pairs += '=';
+    *pairs += val;
+    *pairs += ';';
+}
+
+struct JsonTokenizerFixture {
+    JsonTokenizer::Status feed(const char * input){
+        JsonTokenizer::Status result = tokenizer.getStatus();
+        for(; *input; input++){
+            result = tokenizer.feed(*input);
+        }
+        return result;
+    }
+
+    JsonTokenizer tokenizer;
+    std::string pairs;
+};
+
+BOOST_FIXTURE_TEST_SUITE(JsonTokenizerTest, JsonTokenizerFixture)
+
+BOOST_AUTO_TEST_CASE(parses_key_value_pairs){
+    tokenizer.begin(appendPair, &pairs);
+    BOOST_CHECK_EQUAL(feed("{\"mode\":\"b\", \"beerSet\":20.5}"), JsonTokenizer::DONE);
+    BOOST_CHECK_EQUAL(pairs, "mode=b;beerSet=20.5;");
+}
+
+BOOST_AUTO_TEST_CASE(parsing_can_be_resumed_when_more_input_arrives){
+    tokenizer.begin(appendPair, &pairs);
+    BOOST_CHECK_EQUAL(feed("{\"heater1_kp\":1"), JsonTokenizer::BUSY);
+    BOOST_CHECK_EQUAL(pairs, "");
+    BOOST_CHECK_EQUAL(feed("0.5,\"heat"), JsonTokenizer::BUSY);
+    BOOST_CHECK_EQUAL(pairs, "heater1_kp=10.5;");
+    BOOST_CHECK_EQUAL(feed("er1_ti\":300}"), JsonTokenizer::DONE);
+    BOOST_CHECK_EQUAL(pairs, "heater1_kp=10.5;heater1_ti=300;");
+}
+
+BOOST_AUTO_TEST_CASE(input_without_opening_brace_is_rejected){
+    tokenizer.begin(appendPair, &pairs);
+    BOOST_CHECK_EQUAL(feed("mode:b}"), JsonTokenizer::ERROR_NO_OBJECT);
+    BOOST_CHECK_EQUAL(pairs, "");
+}
+
+BOOST_AUTO_TEST_CASE(empty_keys_and_values_are_skipped){
+    tokenizer.begin(appendPair, &pairs);
+    BOOST_CHECK_EQUAL(feed("{\"mode\":\"\",\"\":5,\"beerSet\":1}"), JsonTokenizer::DONE);
+    BOOST_CHECK_EQUAL(pairs, "beerSet=1;");
+}
+
+BOOST_AUTO_TEST_CASE(tokens_longer_than_buffer_end_parsing){
+    tokenizer.begin(appendPair, &pairs);
+    std::string input = "{\"a\":1,\"b\":\"" + std::string(JSON_TOKENIZER_MAX_TOKEN_LENGTH, 'x') + "\"}";
+    BOOST_CHECK_EQUAL(feed(input.c_str()), JsonTokenizer::ERROR_TOO_LONG);
+    BOOST_CHECK_EQUAL(pairs, "a=1;");
+
+    // longest token that fits
+    pairs.clear();
+    tokenizer.begin(appendPair, &pairs);
+    std::string value(JSON_TOKENIZER_MAX_TOKEN_LENGTH - 1, 'y');
+    input = "{\"b\":\"" + value + "\"}";
+    BOOST_CHECK_EQUAL(feed(input.c_str()), JsonTokenizer::DONE);
+    BOOST_CHECK_EQUAL(pairs, "b=" + value + ";");
+}
+
+BOOST_AUTO_TEST_CASE(finish_processes_pending_pair){
+    tokenizer.begin(appendPair, &pairs);
+    feed("{\"mode\":\"o\",\"beerSet\":21");
+    BOOST_CHECK_EQUAL(pairs, "mode=o;");
+    BOOST_CHECK_EQUAL(tokenizer.finish(), JsonTokenizer::DONE);
+    BOOST_CHECK_EQUAL(pairs, "mode=o;beerSet=21;");
+    BOOST_CHECK(!tokenizer.busy());
+    BOOST_CHECK_EQUAL(tokenizer.feed(','), JsonTokenizer::DONE); // input after the end is ignored
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "LcdShadow.h"
+#include <string.h>
+
+BOOST_AUTO_TEST_SUITE(LcdShadowTest)
+
+BOOST_AUTO_TEST_CASE(rows_are_mapped_to_ddram_addresses){
+    BOOST_CHECK_EQUAL(LcdShadow::address(0, 0), 0x00);
+    BOOST_CHECK_EQUAL(LcdShadow::address(1, 0), 0x40);
+    BOOST_CHECK_EQUAL(LcdShadow::address(2, 5), 0x19);
+    BOOST_CHECK_EQUAL(LcdShadow::address(3, 19), 0x67);
+}
+
+BOOST_AUTO_TEST_CASE(unchanged_characters_are_not_transmitted){
+    LcdShadow shadow;
+    BOOST_CHECK_EQUAL(shadow.write(0, 0, ' '), LcdShadow::UNCHANGED);
+    BOOST_CHECK_EQUAL(shadow.write(0, 0, 'a'), LcdShadow::AT_CURSOR); // cursor is home after clear
+    BOOST_CHECK_EQUAL(shadow.write(0, 0, 'a'), LcdShadow::UNCHANGED);
+    BOOST_CHECK_EQUAL(shadow.line(0)[0], 'a');
+}
+
+BOOST_AUTO_TEST_CASE(a_run_of_changed_characters_needs_one_cursor_move){
+    LcdShadow shadow;
+    const char * text = "  abc";
+    uint8_t moves = 0;
+    uint8_t transmitted = 0;
+    for(uint8_t i = 0; i < 5; i++){
+        uint8_t result = shadow.write(2, 10 + i, text[i]);
+        if(result != LcdShadow::UNCHANGED){
+            transmitted++;
+            if(result != LcdShadow::AT_CURSOR){
+                moves++;
+                BOOST_CHECK_EQUAL(result, LcdShadow::address(2, 12));
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(transmitted, 3);
+    BOOST_CHECK_EQUAL(moves, 1);
+
+    // writing the same text again transmits nothing
+    for(uint8_t i = 0; i < 5; i++){
+        BOOST_CHECK_EQUAL(shadow.write(2, 10 + i, text[i]), LcdShadow::UNCHANGED);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cursor_is_unknown_after_invalidate_and_home_after_home){
+    LcdShadow shadow;
+    shadow.invalidateCursor();
+    BOOST_CHECK_EQUAL(shadow.write(0, 0, 'x'), LcdShadow::address(0, 0));
+    shadow.home();
+    BOOST_CHECK_EQUAL(shadow.write(0, 0, 'y'), LcdShadow::AT_CURSOR);
+    shadow.clear();
+    BOOST_CHECK_EQUAL(shadow.line(0)[0], ' ');
+    BOOST_CHECK_EQUAL(shadow.write(0, 1, 'z'), LcdShadow::address(0, 1));
+}
+
+BOOST_AUTO_TEST_CASE(store_does_not_move_the_cursor){
+    LcdShadow shadow;
+    shadow.store(1, 3, 'q');
+    BOOST_CHECK_EQUAL(shadow.write(1, 3, 'q'), LcdShadow::UNCHANGED);
+    BOOST_CHECK_EQUAL(shadow.write(0, 0, 'a'), LcdShadow::AT_CURSOR);
+}
+
+BOOST_AUTO_TEST_CASE(get_line_replaces_degree_sign){
+    LcdShadow shadow;
+    shadow.store(0, 0, 0b11011111);
+    char buffer[21];
+    shadow.getLine(0, buffer);
+    BOOST_CHECK_EQUAL(uint8_t(buffer[0]), 0xB0);
+    BOOST_CHECK_EQUAL(strlen(buffer), 20u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
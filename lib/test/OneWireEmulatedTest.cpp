@@ -0,0 +1,335 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "OneWire.h"
+#include "OneWireEmulatedDevices.h"
+#include "DallasTemperature.h"
+#include "OneWireTempSensor.h"
+#include "DS2413.h"
+#include "ValveController.h"
+#include <string.h>
+
+struct EmulatedBusFixture {
+    EmulatedBusFixture() : wire(2), bus(OneWireEmulatedBus::forPin(2)) {
+        bus.clear();
+    }
+    ~EmulatedBusFixture() {
+        bus.clear();
+    }
+
+    void copyAddress(DeviceAddress & dest, const OneWireEmulatedDevice & device){
+        memcpy(dest, device.getAddress(), sizeof(DeviceAddress));
+    }
+
+    // bus time in microseconds for a number of resets and bits
+    static uint32_t busTime(uint32_t resets, uint32_t bits){
+        return resets * ONEWIRE_RESET_TIME + bits * ONEWIRE_SLOT_TIME;
+    }
+
+    OneWire wire;
+    OneWireEmulatedBus & bus;
+};
+
+BOOST_FIXTURE_TEST_SUITE(OneWireEmulatedTest, EmulatedBusFixture)
+
+BOOST_AUTO_TEST_CASE(empty_bus_has_no_presence_pulse){
+    BOOST_CHECK(!wire.reset());
+    BOOST_CHECK_EQUAL(wire.read(), 0xFF); // bus is pulled up
+}
+
+BOOST_AUTO_TEST_CASE(search_finds_all_devices){
+    DS18B20Emulated s1(1), s2(2), s3(0x123456);
+    DS2413Emulated sw(4);
+    DS2408Emulated valves(5);
+    const OneWireEmulatedDevice * devices[] = {&s1, &s2, &s3, &sw, &valves};
+    for(auto d : devices){
+        bus.attach(const_cast<OneWireEmulatedDevice *>(d));
+    }
+
+    bool found[5] = {false};
+    DeviceAddress address;
+    uint8_t count = 0;
+    wire.reset_search();
+    while(wire.search(address)){
+        BOOST_CHECK_EQUAL(OneWire::crc8(address, 7), address[7]);
+        for(uint8_t i = 0; i < 5; i++){
+            if(memcmp(address, devices[i]->getAddress(), 8) == 0){
+                BOOST_CHECK(!found[i]);
+                found[i] = true;
+            }
+        }
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, 5);
+    for(bool f : found){
+        BOOST_CHECK(f);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(temperature_is_available_after_conversion_time){
+    DS18B20Emulated sensor(1, 21.5);
+    bus.attach(&sensor);
+    DeviceAddress address;
+    copyAddress(address, sensor);
+    DallasTemperature dallas(&wire);
+
+    BOOST_REQUIRE(dallas.initConnection(address));
+    sensor.setTemperature(23.0625);
+    dallas.requestTemperaturesByAddress(address);
+    BOOST_CHECK(sensor.isConverting());
+
+    // read time slots are 0 while converting
+    BOOST_CHECK_EQUAL(wire.read_bit(), 0);
+    delay(sensor.conversionTime() - 1);
+    BOOST_CHECK_EQUAL(wire.read_bit(), 0);
+    BOOST_CHECK_EQUAL(dallas.getTempRaw(address), 0x0550); // previous value, 85 degrees after power on
+    delay(1);
+    BOOST_CHECK(!sensor.isConverting());
+    BOOST_CHECK_EQUAL(dallas.getTempRaw(address), int16_t(23.0625 * 16));
+}
+
+BOOST_AUTO_TEST_CASE(power_on_reset_of_sensor_is_detected){
+    DS18B20Emulated sensor(1);
+    bus.attach(&sensor);
+    DeviceAddress address;
+    copyAddress(address, sensor);
+    DallasTemperature dallas(&wire);
+
+    BOOST_REQUIRE(dallas.initConnection(address));
+    BOOST_CHECK_EQUAL(sensor.getEepromWrites(), 1); // high alarm is cleared in EEPROM
+    BOOST_CHECK(dallas.getTempRaw(address) != DEVICE_DISCONNECTED_RAW);
+
+    sensor.powerOnReset();
+    BOOST_CHECK_EQUAL(dallas.getTempRaw(address), DEVICE_DISCONNECTED_RAW);
+
+    BOOST_REQUIRE(dallas.initConnection(address));
+    BOOST_CHECK_EQUAL(sensor.getEepromWrites(), 1); // EEPROM already had the right settings
+    BOOST_CHECK(dallas.getTempRaw(address) != DEVICE_DISCONNECTED_RAW);
+}
+
+BOOST_AUTO_TEST_CASE(scratchpad_with_crc_error_is_read_again){
+    DS18B20Emulated sensor(1, 21.5);
+    sensor.setConversionTime(0);
+    bus.attach(&sensor);
+    DeviceAddress address;
+    copyAddress(address, sensor);
+    DallasTemperature dallas(&wire);
+    BOOST_REQUIRE(dallas.initConnection(address));
+    dallas.requestTemperaturesByAddress(address);
+
+    bus.resetStatistics();
+    BOOST_CHECK_EQUAL(dallas.getTempRaw(address), 21.5 * 16);
+    uint32_t bitsRead = bus.statistics().bitsRead;
+    BOOST_CHECK_EQUAL(bitsRead, 9 * 8);
+
+    bus.resetStatistics();
+    sensor.injectCrcError();
+    BOOST_CHECK_EQUAL(dallas.getTempRaw(address), 21.5 * 16);
+    BOOST_CHECK_EQUAL(bus.statistics().bitsRead, 2 * bitsRead);
+}
+
+BOOST_AUTO_TEST_CASE(temp_sensor_reconnects_after_dropout){
+    DS18B20Emulated sensor(1, 19.0);
+    bus.attach(&sensor);
+    DeviceAddress address;
+    copyAddress(address, sensor);
+    OneWireTempSensor tempSensor(&wire, address, temp_t(0.0));
+
+    tempSensor.init();
+    delay(1000);
+    tempSensor.update();
+    BOOST_CHECK(tempSensor.isConnected());
+    BOOST_CHECK_EQUAL(tempSensor.read(), temp_t(19.0));
+
+    sensor.setPresent(false);
+    delay(1000);
+    tempSensor.update();
+    BOOST_CHECK(!tempSensor.isConnected());
+    BOOST_CHECK(tempSensor.read() == TEMP_SENSOR_DISCONNECTED);
+
+    // the conversion that was requested while the sensor was disconnected was missed
+    sensor.setPresent(true);
+    sensor.setTemperature(19.5);
+    delay(1000);
+    tempSensor.update();
+    BOOST_CHECK(tempSensor.isConnected());
+    BOOST_CHECK_EQUAL(tempSensor.read(), temp_t(19.0));
+    delay(1000);
+    tempSensor.update();
+    BOOST_CHECK_EQUAL(tempSensor.read(), temp_t(19.5));
+}
+
+BOOST_AUTO_TEST_CASE(temp_sensor_is_reinitialized_after_power_on_reset){
+    DS18B20Emulated sensor(1, 19.0);
+    sensor.setConversionTime(0); // OneWireTempSensor::init() waits for the conversion, which is a no-op in tests
+    bus.attach(&sensor);
+    DeviceAddress address;
+    copyAddress(address, sensor);
+    DallasTemperature dallas(&wire);
+    BOOST_REQUIRE(dallas.initConnection(address)); // sensor was used before
+    sensor.powerOnReset();
+
+    OneWireTempSensor tempSensor(&wire, address, temp_t(0.0));
+    BOOST_CHECK(tempSensor.init());
+    BOOST_CHECK_EQUAL(tempSensor.read(), temp_t(19.0)); // not the 85 degrees of the power on scratchpad
+
+    sensor.powerOnReset();
+    sensor.setTemperature(19.5);
+    delay(1000);
+    tempSensor.update();
+    BOOST_CHECK(tempSensor.isConnected());
+    BOOST_CHECK_EQUAL(tempSensor.read(), temp_t(19.5));
+}
+
+BOOST_AUTO_TEST_CASE(ds2413_latches_and_sense){
+    DS2413Emulated emulated(1);
+    bus.attach(&emulated);
+    DeviceAddress address;
+    copyAddress(address, emulated);
+    DS2413 ds;
+    ds.init(&wire, address);
+
+    BOOST_CHECK(!emulated.latch(0));
+    BOOST_CHECK(ds.latchWrite(1, true, false));
+    BOOST_CHECK(emulated.latch(1));
+    BOOST_CHECK(!emulated.latch(0));
+    BOOST_CHECK(ds.latchRead(1, false, false));
+    BOOST_CHECK(!ds.latchRead(0, true, false));
+
+    BOOST_CHECK(ds.sense(0, false));
+    emulated.setExternalLow(0, true);
+    BOOST_CHECK(!ds.sense(0, true));
+
+    // writing the latch state the device already has does not use the bus
+    uint16_t writes = emulated.getLatchWrites();
+    BOOST_CHECK(ds.latchWrite(1, true, true));
+    BOOST_CHECK_EQUAL(emulated.getLatchWrites(), writes);
+}
+
+BOOST_AUTO_TEST_CASE(ds2413_on_shorted_bus_reports_failure){
+    DS2413Emulated emulated(1);
+    bus.attach(&emulated);
+    DeviceAddress address;
+    copyAddress(address, emulated);
+    DS2413 ds;
+    ds.init(&wire, address);
+
+    bus.setShorted(true);
+    BOOST_CHECK(!ds.latchWrite(0, true, false));
+    BOOST_CHECK(!emulated.latch(0));
+    BOOST_CHECK(ds.latchRead(0, true, false)); // default value
+}
+
+BOOST_AUTO_TEST_CASE(ds2413_read_errors_are_detected){
+    DS2413Emulated emulated(1);
+    bus.attach(&emulated);
+    DeviceAddress address;
+    copyAddress(address, emulated);
+    DS2413 ds;
+    ds.init(&wire, address);
+
+    // every 8th bit that is read is inverted, which corrupts each status byte
+    bus.setReadErrorInterval(8);
+    ds.update();
+    BOOST_CHECK(!ds.cacheIsValid());
+    bus.setReadErrorInterval(0);
+    ds.update();
+    BOOST_CHECK(ds.cacheIsValid());
+}
+
+BOOST_AUTO_TEST_CASE(ds2408_pio_registers_have_valid_crc){
+    DS2408Emulated emulated(1);
+    bus.attach(&emulated);
+    emulated.setExternalLow(0x81);
+
+    uint8_t buf[3 + 8 + 2] = {0xF0, 0x88, 0x00}; // read PIO registers from 0x88
+    BOOST_REQUIRE(wire.reset());
+    wire.select(emulated.getAddress());
+    wire.write_bytes(buf, 3);
+    wire.read_bytes(buf + 3, 10);
+    BOOST_CHECK(OneWire::check_crc16(buf, 11, &buf[11]));
+    BOOST_CHECK_EQUAL(buf[3], 0x7E); // pin state
+    BOOST_CHECK_EQUAL(buf[4], 0xFF); // output latch state
+    BOOST_CHECK_EQUAL(buf[5], 0x81); // activity latch
+}
+
+BOOST_AUTO_TEST_CASE(valve_controller_stops_driving_when_valve_is_open){
+    DS2408Emulated emulated(1);
+    bus.attach(&emulated);
+    DeviceAddress address;
+    copyAddress(address, emulated);
+    ValveController valve(&wire, address, 0);
+
+    valve.write(ValveController::ValveActions::OPEN);
+    BOOST_CHECK_EQUAL(emulated.latches() >> 6, uint8_t(ValveController::ValveActions::OPEN));
+    BOOST_CHECK_EQUAL(valve.read(false), uint8_t(ValveController::ValveActions::OPENING));
+
+    emulated.setExternalLow(0x20); // limit switch of valve A reports opened
+    OneWireSwitch::nextCycle();
+    valve.update();
+    OneWireSwitch::flushAll();
+    BOOST_CHECK_EQUAL(emulated.latches() >> 6, uint8_t(ValveController::ValveActions::OFF));
+    BOOST_CHECK_EQUAL(valve.read(false), uint8_t(ValveController::ValveActions::OPEN));
+}
+
+BOOST_AUTO_TEST_CASE(bus_time_of_temperature_control_cycle){
+    const uint8_t numSensors = 4;
+    DS18B20Emulated sensors[numSensors] = {{1, 20.0}, {2, 20.5}, {3, 21.0}, {4, 21.5}};
+    OneWireTempSensor * tempSensors[numSensors];
+    for(uint8_t i = 0; i < numSensors; i++){
+        bus.attach(&sensors[i]);
+        DeviceAddress address;
+        copyAddress(address, sensors[i]);
+        tempSensors[i] = new OneWireTempSensor(&wire, address, temp_t(0.0));
+        tempSensors[i]->init();
+    }
+    delay(1000);
+    for(auto s : tempSensors){
+        s->update();
+    }
+
+    // one control cycle: all sensors are updated once per second
+    bus.resetStatistics();
+    delay(1000);
+    for(auto s : tempSensors){
+        s->update();
+    }
+    const OneWireBusStatistics & stats = bus.statistics();
+
+    // a conversion is started for all sensors with Skip ROM, each scratchpad is read with Match ROM.
+    // The scratchpad reads are queued transactions, which do not reset the bus after reading.
+    uint32_t resets = 1 + numSensors;
+    uint32_t bitsWritten = 16 + numSensors * (8 + 64 + 8);
+    uint32_t bitsRead = numSensors * 9 * 8;
+    BOOST_CHECK_EQUAL(stats.resets, resets);
+    BOOST_CHECK_EQUAL(stats.bitsWritten, bitsWritten);
+    BOOST_CHECK_EQUAL(stats.bitsRead, bitsRead);
+    BOOST_CHECK_EQUAL(stats.busTime, busTime(resets, bitsWritten + bitsRead));
+    BOOST_TEST_MESSAGE("Bus time of " << int(numSensors) << " sensors per control cycle: " << stats.busTime << " us");
+
+    for(uint8_t i = 0; i < numSensors; i++){
+        BOOST_CHECK_EQUAL(tempSensors[i]->read(), temp_t(20.0 + i * 0.5));
+        delete tempSensors[i];
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
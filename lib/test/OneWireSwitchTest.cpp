@@ -0,0 +1,187 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "OneWire.h"
+#include "OneWireEmulatedDevices.h"
+#include "DS2413.h"
+#include "DS2408.h"
+#include "ValveController.h"
+#include "DevicePools.h"
+#include <string.h>
+
+struct SharedSwitchFixture {
+    SharedSwitchFixture() : wire(2), bus(OneWireEmulatedBus::forPin(2)), ds2413(1), ds2408(2) {
+        bus.clear();
+        bus.attach(&ds2413);
+        bus.attach(&ds2408);
+        memcpy(ds2413Address, ds2413.getAddress(), sizeof(DeviceAddress));
+        memcpy(ds2408Address, ds2408.getAddress(), sizeof(DeviceAddress));
+        OneWireSwitch::nextCycle();
+    }
+    ~SharedSwitchFixture() {
+        bus.clear();
+    }
+
+    OneWire wire;
+    OneWireEmulatedBus & bus;
+    DS2413Emulated ds2413;
+    DS2408Emulated ds2408;
+    DeviceAddress ds2413Address;
+    DeviceAddress ds2408Address;
+};
+
+BOOST_FIXTURE_TEST_SUITE(OneWireSwitchTest, SharedSwitchFixture)
+
+BOOST_AUTO_TEST_CASE(switches_with_same_address_are_shared){
+    DS2413 * a = OneWireSwitch::acquire<DS2413>(&wire, ds2413Address);
+    DS2413 * b = OneWireSwitch::acquire<DS2413>(&wire, ds2413Address);
+    DS2408 * c = OneWireSwitch::acquire<DS2408>(&wire, ds2408Address);
+    BOOST_CHECK(a == b);
+    BOOST_CHECK(static_cast<OneWireSwitch *>(a) != static_cast<OneWireSwitch *>(c));
+
+    OneWireSwitch::release(b);
+    OneWireSwitch::release(c);
+    DS2413 * d = OneWireSwitch::acquire<DS2413>(&wire, ds2413Address);
+    BOOST_CHECK(a == d); // a is still in use
+    OneWireSwitch::release(a);
+    OneWireSwitch::release(d);
+}
+
+BOOST_AUTO_TEST_CASE(shared_ds2413_is_read_once_per_cycle){
+    DS2413 * a = OneWireSwitch::acquire<DS2413>(&wire, ds2413Address);
+    DS2413 * b = OneWireSwitch::acquire<DS2413>(&wire, ds2413Address);
+
+    bus.resetStatistics();
+    a->refresh();
+    b->refresh();
+    BOOST_CHECK_EQUAL(bus.statistics().resets, 1);
+    BOOST_CHECK(a->cacheIsValid());
+
+    OneWireSwitch::nextCycle();
+    b->refresh();
+    a->refresh();
+    BOOST_CHECK_EQUAL(bus.statistics().resets, 2);
+
+    OneWireSwitch::release(a);
+    OneWireSwitch::release(b);
+}
+
+BOOST_AUTO_TEST_CASE(ds2413_latch_changes_are_combined_in_one_write){
+    DS2413 * ds = OneWireSwitch::acquire<DS2413>(&wire, ds2413Address);
+    ds->refresh();
+    ds->latchWriteDeferred(0, true);
+    ds->latchWriteDeferred(1, true);
+
+    // pending writes are visible in the cache before they are written
+    BOOST_CHECK(ds->latchReadCached(0, false));
+    BOOST_CHECK(ds->latchReadCached(1, false));
+    BOOST_CHECK_EQUAL(ds2413.getLatchWrites(), 0);
+
+    bus.resetStatistics();
+    BOOST_CHECK(OneWireSwitch::flushAll());
+    BOOST_CHECK_EQUAL(ds2413.getLatchWrites(), 1);
+    BOOST_CHECK(ds2413.latch(0));
+    BOOST_CHECK(ds2413.latch(1));
+
+    // the state sent after the acknowledgement updates the cache, it is not read again
+    BOOST_CHECK(ds->cacheIsValid());
+    BOOST_CHECK(ds->latchRead(0, false, true));
+    BOOST_CHECK(ds->latchRead(1, false, true));
+    BOOST_CHECK_EQUAL(bus.statistics().resets, 2); // write and the reset after it
+
+    // a flush without changes does not use the bus
+    ds->latchWriteDeferred(1, true);
+    BOOST_CHECK(OneWireSwitch::flushAll());
+    BOOST_CHECK_EQUAL(bus.statistics().resets, 2);
+
+    OneWireSwitch::release(ds);
+}
+
+BOOST_AUTO_TEST_CASE(pending_write_is_flushed_on_last_release){
+    DS2413 * ds = OneWireSwitch::acquire<DS2413>(&wire, ds2413Address);
+    ds->refresh();
+    ds->latchWriteDeferred(1, true);
+    OneWireSwitch::release(ds);
+    BOOST_CHECK(ds2413.latch(1));
+}
+
+BOOST_AUTO_TEST_CASE(valves_on_same_ds2408_share_reads_and_writes){
+    ValveController valveA(&wire, ds2408Address, 0);
+    ValveController valveB(&wire, ds2408Address, 1);
+    valveA.open();
+    valveB.close();
+    BOOST_CHECK_EQUAL(ds2408.latches(), 0b01111011);
+    BOOST_CHECK_EQUAL(valveA.read(false), uint8_t(ValveController::ValveActions::OPENING));
+    BOOST_CHECK_EQUAL(valveB.read(false), uint8_t(ValveController::ValveActions::CLOSING));
+
+    // both limit switches report the end position in the same cycle
+    ds2408.setExternalLow(0x21);
+    OneWireSwitch::nextCycle();
+    uint16_t writes = ds2408.getLatchWrites();
+    bus.resetStatistics();
+    valveA.update();
+    valveB.update();
+    OneWireSwitch::flushAll();
+
+    // one read for both valves and one write to stop driving both
+    BOOST_CHECK_EQUAL(ds2408.getLatchWrites(), writes + 1);
+    BOOST_CHECK_EQUAL(bus.statistics().resets, 3);
+    BOOST_CHECK_EQUAL(ds2408.latches(), 0xFF);
+    BOOST_CHECK_EQUAL(valveA.read(false), uint8_t(ValveController::ValveActions::OPEN));
+    BOOST_CHECK_EQUAL(valveB.read(false), uint8_t(ValveController::ValveActions::CLOSE));
+    BOOST_TEST_MESSAGE("Bus time of 2 valves per control cycle: " << bus.statistics().busTime << " us");
+
+    // writing the action a valve already has does not use the bus
+    OneWireSwitch::nextCycle();
+    valveA.update();
+    bus.resetStatistics();
+    valveA.stop();
+    BOOST_CHECK_EQUAL(bus.statistics().resets, 0);
+}
+
+BOOST_AUTO_TEST_CASE(valve_stays_inactive_when_no_ds2408_is_available){
+    DS2408 * switches[DS2408_POOL_SIZE];
+    for(uint8_t i = 0; i < DS2408_POOL_SIZE; i++){
+        DeviceAddress address = {0x29, 0, 0, 0, 0, 0, uint8_t(i + 1), 0};
+        switches[i] = OneWireSwitch::acquire<DS2408>(&wire, address);
+        BOOST_REQUIRE(switches[i] != nullptr);
+    }
+
+    ValveController valve;
+    BOOST_CHECK(!valve.init(&wire, ds2408Address, 0));
+    uint16_t writes = ds2408.getLatchWrites();
+    valve.open();
+    valve.update();
+    BOOST_CHECK(!valve.isActive());
+    BOOST_CHECK_EQUAL(ds2408.getLatchWrites(), writes);
+
+    OneWireSwitch::release(switches[0]);
+    BOOST_CHECK(valve.init(&wire, ds2408Address, 0));
+    valve.open();
+    BOOST_CHECK(valve.isActive());
+
+    for(uint8_t i = 1; i < DS2408_POOL_SIZE; i++){
+        OneWireSwitch::release(switches[i]);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "OneWire.h"
+#include "OneWireTempSensor.h"
+#include "OneWireTempSensorScheduler.h"
+#include "OneWireEmulatedDevices.h"
+#include <string.h>
+
+BOOST_AUTO_TEST_SUITE(OneWireTempSensorSchedulerTest)
+
+static DeviceAddress address1 = {0x28, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+static DeviceAddress address2 = {0x28, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17};
+
+BOOST_AUTO_TEST_CASE(sensors_on_the_same_bus_share_a_scheduler){
+    OneWire bus1(0);
+    OneWire bus2(1);
+    OneWireTempSensor s1(&bus1, address1, temp_t(0.0));
+    OneWireTempSensor s2(&bus1, address2, temp_t(0.0));
+    OneWireTempSensor s3(&bus2, address1, temp_t(0.0));
+
+    OneWireTempSensorScheduler * scheduler1 = OneWireTempSensorScheduler::forBus(&bus1);
+    OneWireTempSensorScheduler * scheduler2 = OneWireTempSensorScheduler::forBus(&bus2);
+
+    BOOST_REQUIRE(scheduler1 != nullptr);
+    BOOST_REQUIRE(scheduler2 != nullptr);
+    BOOST_CHECK(scheduler1 != scheduler2);
+    BOOST_CHECK(scheduler1->getBus() == &bus1);
+    BOOST_CHECK_EQUAL(scheduler1->sensorCount(), 2);
+    BOOST_CHECK_EQUAL(scheduler2->sensorCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(destroyed_sensors_are_removed_from_scheduler){
+    OneWire bus(0);
+    OneWireTempSensorScheduler * scheduler;
+    {
+        OneWireTempSensor s1(&bus, address1, temp_t(0.0));
+        scheduler = OneWireTempSensorScheduler::forBus(&bus);
+        {
+            OneWireTempSensor s2(&bus, address2, temp_t(0.0));
+            BOOST_CHECK_EQUAL(scheduler->sensorCount(), 2);
+        }
+        BOOST_CHECK_EQUAL(scheduler->sensorCount(), 1);
+    }
+    BOOST_CHECK_EQUAL(scheduler->sensorCount(), 0);
+    BOOST_CHECK(scheduler->getBus() == nullptr); // slot is released
+}
+
+BOOST_AUTO_TEST_CASE(conversion_completes_after_conversion_time_without_blocking){
+    OneWire bus(0);
+    OneWireTempSensor s1(&bus, address1, temp_t(0.0));
+    OneWireTempSensorScheduler * scheduler = OneWireTempSensorScheduler::forBus(&bus);
+
+    BOOST_CHECK(!scheduler->conversionComplete());
+
+    ticks_millis_t start = ticks.millis();
+    scheduler->requestConversion();
+    BOOST_CHECK_EQUAL(ticks.millis(), start); // did not wait
+    BOOST_CHECK(!scheduler->conversionComplete());
+
+    delay(ONEWIRE_TEMP_SENSOR_CONVERSION_TIME - 1);
+    BOOST_CHECK(!scheduler->conversionComplete());
+
+    delay(1);
+    BOOST_CHECK(scheduler->conversionComplete());
+}
+
+BOOST_AUTO_TEST_CASE(update_starts_new_conversion_after_reading_all_sensors){
+    OneWire bus(0);
+    OneWireTempSensor s1(&bus, address1, temp_t(0.0));
+    OneWireTempSensor s2(&bus, address2, temp_t(0.0));
+    OneWireTempSensorScheduler * scheduler = OneWireTempSensorScheduler::forBus(&bus);
+
+    s1.update(); // first update starts a conversion
+    BOOST_CHECK(!scheduler->conversionComplete());
+
+    delay(ONEWIRE_TEMP_SENSOR_CONVERSION_TIME);
+    BOOST_CHECK(scheduler->conversionComplete());
+
+    s1.update(); // reads both sensors and starts the next conversion
+    BOOST_CHECK(!scheduler->conversionComplete());
+    s2.update(); // nothing to do until the next conversion completes
+    BOOST_CHECK(!scheduler->conversionComplete());
+}
+
+// two sensors on an emulated bus, so the scheduler can be checked by the traffic on the bus
+struct EmulatedSensorsFixture {
+    EmulatedSensorsFixture() :
+        wire(3),
+        bus(OneWireEmulatedBus::forPin(3)),
+        device1(1),
+        device2(2) {
+        bus.clear();
+        bus.attach(&device1);
+        bus.attach(&device2);
+        memcpy(emulatedAddress1, device1.getAddress(), sizeof(DeviceAddress));
+        memcpy(emulatedAddress2, device2.getAddress(), sizeof(DeviceAddress));
+    }
+    ~EmulatedSensorsFixture() {
+        bus.clear();
+    }
+
+    OneWire wire;
+    OneWireEmulatedBus & bus;
+    DS18B20Emulated device1;
+    DS18B20Emulated device2;
+    DeviceAddress emulatedAddress1;
+    DeviceAddress emulatedAddress2;
+};
+
+BOOST_FIXTURE_TEST_CASE(init_does_not_restart_a_running_conversion, EmulatedSensorsFixture){
+    OneWireTempSensor s1(&wire, emulatedAddress1, temp_t(0.0));
+    OneWireTempSensor s2(&wire, emulatedAddress2, temp_t(0.0));
+    OneWireTempSensorScheduler * scheduler = OneWireTempSensorScheduler::forBus(&wire);
+
+    BOOST_REQUIRE(s1.init()); // starts a conversion on the bus
+    uint16_t conversions = device1.getConversions();
+    BOOST_REQUIRE(s2.init());
+    BOOST_CHECK_EQUAL(device1.getConversions(), conversions);
+
+    delay(ONEWIRE_TEMP_SENSOR_CONVERSION_TIME);
+    BOOST_CHECK(scheduler->conversionComplete());
+}
+
+BOOST_FIXTURE_TEST_CASE(first_update_after_the_conversion_reads_all_sensors_in_a_batch, EmulatedSensorsFixture){
+    OneWireTempSensor s1(&wire, emulatedAddress1, temp_t(0.0));
+    OneWireTempSensor s2(&wire, emulatedAddress2, temp_t(0.0));
+    BOOST_REQUIRE(s1.init());
+    BOOST_REQUIRE(s2.init());
+
+    device1.setTemperature(25.0);
+    device2.setTemperature(30.0);
+    delay(ONEWIRE_TEMP_SENSOR_CONVERSION_TIME);
+    s1.update(); // reads the old temperatures and starts a conversion that latches the new ones
+    delay(ONEWIRE_TEMP_SENSOR_CONVERSION_TIME);
+
+    bus.resetStatistics();
+    s1.update();
+    BOOST_CHECK_EQUAL(s1.read(), temp_t(25.0));
+    BOOST_CHECK_EQUAL(s2.read(), temp_t(30.0)); // read by the update of s1
+    // each scratchpad is read in a queued transaction with Match ROM, without a reset after it,
+    // and a single conversion is started for both sensors with Skip ROM
+    uint32_t resets = 2 + 1;
+    BOOST_CHECK_EQUAL(bus.statistics().resets, resets);
+
+    s2.update(); // nothing left to do in this cycle
+    BOOST_CHECK_EQUAL(bus.statistics().resets, resets);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
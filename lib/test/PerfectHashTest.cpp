@@ -0,0 +1,55 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "PerfectHash.h"
+#include <cstring>
+
+static constexpr char keyMode[] = "mode";
+static constexpr char keyBeerSet[] = "beerSet";
+static constexpr char keyFridgeSet[] = "fridgeSet";
+static constexpr char keyHeaterKp[] = "heater1_kp";
+static constexpr char keyHeaterTi[] = "heater1_ti";
+static constexpr char keyHeaterTd[] = "heater1_td";
+
+static constexpr const char * keys[] = {
+    keyMode, keyBeerSet, keyFridgeSet, keyHeaterKp, keyHeaterTi, keyHeaterTd
+};
+
+static constexpr PerfectHash::Index<sizeof(keys) / sizeof(keys[0]), 4> keyIndex(keys);
+static_assert(keyIndex.isValid(), "no collision free seed found");
+
+BOOST_AUTO_TEST_SUITE(PerfectHashTest)
+
+BOOST_AUTO_TEST_CASE(each_key_maps_to_its_own_index){
+    for(int16_t i = 0; i < int16_t(sizeof(keys) / sizeof(keys[0])); i++){
+        BOOST_CHECK_EQUAL(keyIndex.candidate(keys[i]), i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(unknown_keys_map_to_no_key_or_a_key_that_does_not_match){
+    const char * unknown[] = {"", "modes", "heater1_kq", "coolerPwmPeriod", "x"};
+    for(const char * s : unknown){
+        int16_t i = keyIndex.candidate(s);
+        BOOST_CHECK(i == -1 || strcmp(keys[i], s) != 0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "ProfileEngine.h"
+
+// 3 steps: 1000 to 2000 in 100 time units, 2000 to -1000 in 300 time units, then hold -1000
+static const ProfilePoint points[] = {{100, 1000}, {300, 2000}, {0, -1000}};
+
+BOOST_AUTO_TEST_SUITE(ProfileEngineTest)
+
+BOOST_AUTO_TEST_CASE(engine_updates_all_running_profiles){
+    SetpointProfile a, b;
+    a.load(points, 3, INTERPOLATION_LINEAR);
+    b.load(points, 3, INTERPOLATION_SMOOTHER);
+
+    ProfileEngine<4> engine;
+    uint8_t slotA = engine.start(&a, 1000);
+    uint8_t slotB = engine.start(&b, 1000, 200);
+    BOOST_CHECK_EQUAL(slotA, 0);
+    BOOST_CHECK_EQUAL(slotB, 1);
+
+    for(uint32_t now = 1000; now < 1600; now += 7){
+        engine.update(now);
+        BOOST_CHECK_EQUAL(engine.value(slotA), a.valueAt(now - 1000));
+        BOOST_CHECK_EQUAL(engine.value(slotB), b.valueAt(now - 800));
+        BOOST_CHECK_EQUAL(engine.elapsed(slotB, now), now - 800);
+    }
+    BOOST_CHECK_EQUAL(engine.currentStep(slotA), 2);
+}
+
+BOOST_AUTO_TEST_CASE(a_paused_profile_keeps_its_value_and_can_resume_with_seek){
+    SetpointProfile a;
+    a.load(points, 3, INTERPOLATION_LINEAR);
+    ProfileEngine<2> engine;
+    uint8_t slot = engine.start(&a, 0);
+    engine.update(50);
+    BOOST_CHECK_EQUAL(engine.value(slot), 1500);
+
+    uint32_t position = engine.elapsed(slot, 50);
+    engine.pause(slot);
+    BOOST_CHECK(!engine.isRunning(slot));
+    engine.update(250);
+    BOOST_CHECK_EQUAL(engine.value(slot), 1500);
+
+    // after a reboot, resume at the stored position
+    engine.seek(slot, 0, position);
+    BOOST_CHECK(engine.isRunning(slot));
+    BOOST_CHECK_EQUAL(engine.value(slot), 1500);
+    engine.update(150);
+    BOOST_CHECK_EQUAL(engine.value(slot), a.valueAt(200));
+}
+
+BOOST_AUTO_TEST_CASE(engine_reports_when_all_slots_are_used){
+    SetpointProfile a;
+    a.load(points, 3, INTERPOLATION_NONE);
+    ProfileEngine<2> engine;
+    BOOST_CHECK_EQUAL(engine.start(&a, 0), 0);
+    BOOST_CHECK_EQUAL(engine.start(&a, 0), 1);
+    BOOST_CHECK_EQUAL(engine.start(&a, 0), ProfileEngine<2>::NO_SLOT);
+    engine.stop(0);
+    BOOST_CHECK_EQUAL(engine.start(&a, 0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(engine_matches_direct_evaluation_over_a_multi_week_replay){
+    // 16 steps of one day each, updated once per second
+    ProfilePoint days[16];
+    for(uint8_t i = 0; i < 16; i++){
+        days[i].duration = 24 * 3600;
+        days[i].setpoint = int16_t((i % 2) ? 18 * 512 : 20 * 512);
+    }
+    SetpointProfile profiles[8];
+    ProfileEngine<8> engine;
+    for(uint8_t i = 0; i < 8; i++){
+        profiles[i].load(days, 16, ProfileInterpolation(i % 4));
+        engine.start(&profiles[i], 0, i * 3600);
+    }
+
+    const uint32_t seconds = 16 * 24 * 3600;
+    for(uint32_t now = 0; now < seconds; now += 61){
+        engine.update(now);
+        uint8_t i = now & 7;
+        BOOST_REQUIRE_EQUAL(engine.value(i), profiles[i].valueAt(now + i * 3600));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "SampleLog.h"
+#include <vector>
+
+// keeps the blocks in memory
+class SampleStoreMock final : public SampleStore {
+public:
+    struct Block {
+        uint32_t sequence;
+        std::vector<uint8_t> data;
+    };
+
+    SampleStoreMock() : readPos(0) {}
+    ~SampleStoreMock() = default;
+
+    bool append(uint32_t sequence, const uint8_t * block, uint16_t length) override final {
+        blocks.push_back(Block{sequence, std::vector<uint8_t>(block, block + length)});
+        return true;
+    }
+
+    uint32_t lastSequence() override final {
+        return blocks.empty() ? NO_SEQUENCE : blocks.back().sequence;
+    }
+
+    bool seek(uint32_t sequence) override final {
+        for(readPos = 0; readPos < blocks.size() && blocks[readPos].sequence < sequence; readPos++){
+        }
+        return !blocks.empty();
+    }
+
+    int16_t read(uint32_t & sequence, uint8_t * block, uint16_t maxLength) override final {
+        if(readPos >= blocks.size() || blocks[readPos].data.size() > maxLength){
+            return -1;
+        }
+        const Block & next = blocks[readPos++];
+        sequence = next.sequence;
+        for(size_t i = 0; i < next.data.size(); i++){
+            block[i] = next.data[i];
+        }
+        return next.data.size();
+    }
+
+    std::vector<Block> blocks;
+    size_t readPos;
+};
+
+struct Sample {
+    uint32_t time;
+    int32_t values[3];
+};
+
+// decodes all samples in the stored blocks
+static std::vector<Sample> decodeAll(SampleStoreMock & store){
+    std::vector<Sample> samples;
+    for(const SampleStoreMock::Block & block : store.blocks){
+        SampleBlockReader reader;
+        BOOST_REQUIRE(reader.begin(block.data.data(), block.data.size()));
+        BOOST_REQUIRE_EQUAL(reader.channels(), 3);
+        Sample sample;
+        while(reader.next(sample.time, sample.values)){
+            samples.push_back(sample);
+        }
+    }
+    return samples;
+}
+
+BOOST_AUTO_TEST_SUITE(SampleLogTest)
+
+BOOST_AUTO_TEST_CASE(samples_are_decoded_with_their_time){
+    SampleBlockWriter writer;
+    writer.begin(3, 1000);
+    std::vector<Sample> written;
+    uint32_t time = 123456;
+    for(int32_t i = 0; i < 40; i++){
+        Sample sample;
+        sample.time = time;
+        sample.values[0] = 5000 + i / 4; // changes every 4 samples, so there are runs of repeats
+        sample.values[1] = (i < 20) ? INT32_MIN : INT32_MAX;
+        sample.values[2] = -i / 8;
+        BOOST_REQUIRE(writer.add(sample.time, sample.values));
+        written.push_back(sample);
+        time += (i == 10) ? 3500 : 1000; // a few missed samples
+        if(i == 30){
+            time -= 200;
+        }
+    }
+    const uint8_t * block = writer.finish();
+
+    SampleBlockReader reader;
+    BOOST_REQUIRE(reader.begin(block, writer.size()));
+    BOOST_CHECK_EQUAL(reader.interval(), 1000);
+    for(const Sample & expected : written){
+        Sample sample;
+        BOOST_REQUIRE(reader.next(sample.time, sample.values));
+        BOOST_CHECK_EQUAL(sample.time, expected.time);
+        for(uint8_t i = 0; i < 3; i++){
+            BOOST_CHECK_EQUAL(sample.values[i], expected.values[i]);
+        }
+    }
+    Sample sample;
+    BOOST_CHECK(!reader.next(sample.time, sample.values));
+}
+
+BOOST_AUTO_TEST_CASE(a_run_of_unchanged_samples_takes_a_few_bytes){
+    SampleBlockWriter writer;
+    writer.begin(3, 1000);
+    int32_t values[3] = {5000, 4800, 0};
+    for(uint32_t i = 0; i < 3600; i++){
+        BOOST_REQUIRE(writer.add(i * 1000, values));
+    }
+    writer.finish();
+    BOOST_CHECK_EQUAL(writer.samples(), 3600);
+    BOOST_CHECK_LE(writer.size(), SampleBlockWriter::HEADER_SIZE + 8 + 3);
+}
+
+BOOST_AUTO_TEST_CASE(a_full_block_refuses_samples_and_stays_valid){
+    SampleBlockWriter writer;
+    writer.begin(3, 1000);
+    int32_t values[3] = {0, 0, 0};
+    uint32_t added = 0;
+    while(true){
+        values[0] += 100000; // 4 byte deltas
+        values[1] -= 100000;
+        values[2] ^= 0x7FFFFFFF;
+        if(!writer.add(added * 1000, values)){
+            break;
+        }
+        added++;
+    }
+    writer.finish();
+    BOOST_CHECK_LE(writer.size(), SampleBlockWriter::BLOCK_SIZE);
+    BOOST_CHECK_EQUAL(writer.samples(), added);
+
+    SampleBlockReader reader;
+    BOOST_REQUIRE(reader.begin(writer.finish(), writer.size()));
+    uint32_t decoded = 0;
+    uint32_t time;
+    while(reader.next(time, values)){
+        decoded++;
+    }
+    BOOST_CHECK_EQUAL(decoded, added);
+}
+
+BOOST_AUTO_TEST_CASE(a_truncated_block_ends_without_reading_past_its_length){
+    SampleBlockWriter writer;
+    writer.begin(3, 1000);
+    int32_t values[3] = {1000, 2000, 3000};
+    for(uint32_t i = 0; i < 10; i++){
+        values[i % 3] += 1000;
+        writer.add(i * 1000, values);
+    }
+    const uint8_t * block = writer.finish();
+    for(uint16_t length = 0; length < writer.size(); length++){
+        SampleBlockReader reader;
+        uint32_t decoded = 0;
+        uint32_t time;
+        if(reader.begin(block, length)){
+            while(reader.next(time, values)){
+                decoded++;
+            }
+        }
+        BOOST_CHECK_LT(decoded, 10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(logger_stores_old_blocks_and_continues_sequence_numbers){
+    SampleStoreMock store;
+    store.append(41, nullptr, 0); // blocks from before a reset
+    SampleLogger logger(store, 3, 1000, 60000);
+    logger.init();
+    BOOST_CHECK_EQUAL(logger.lastSequence(), 41);
+
+    int32_t values[3] = {5000, 4800, 1};
+    uint32_t now = 10000;
+    for(uint32_t i = 0; i < 150; i++){
+        BOOST_REQUIRE(logger.due(now));
+        logger.add(now, values);
+        values[0] += 1;
+        now += 1000 + (i % 7); // the task runs a few ms late
+    }
+    BOOST_CHECK_EQUAL(logger.lastSequence(), 43); // a block per minute
+    logger.flush();
+    BOOST_CHECK_EQUAL(logger.lastSequence(), 44);
+
+    store.blocks.erase(store.blocks.begin());
+    std::vector<Sample> samples = decodeAll(store);
+    BOOST_REQUIRE_EQUAL(samples.size(), 150);
+    for(uint32_t i = 0; i < 150; i++){
+        BOOST_CHECK_EQUAL(samples[i].values[0], int32_t(5000 + i));
+        if(i > 0){
+            uint32_t dt = samples[i].time - samples[i - 1].time;
+            BOOST_CHECK(dt == 1000 || dt == 2000); // on the grid, the late samples add up to one skipped sample
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(changing_the_interval_starts_a_new_block){
+    SampleStoreMock store;
+    SampleLogger logger(store, 3, 1000, 600000);
+    logger.init();
+    int32_t values[3] = {1, 2, 3};
+    logger.add(0, values);
+    logger.add(1000, values);
+    logger.setInterval(5000);
+    BOOST_REQUIRE_EQUAL(store.blocks.size(), 1);
+    BOOST_CHECK_EQUAL(store.blocks[0].sequence, 0);
+    BOOST_CHECK(!logger.due(5000));
+    BOOST_CHECK(logger.due(6000));
+    logger.add(6000, values);
+    logger.flush();
+    BOOST_REQUIRE_EQUAL(store.blocks.size(), 2);
+
+    SampleBlockReader reader;
+    BOOST_REQUIRE(reader.begin(store.blocks[1].data.data(), store.blocks[1].data.size()));
+    BOOST_CHECK_EQUAL(reader.interval(), 5000);
+}
+
+BOOST_AUTO_TEST_CASE(log_of_a_fermentation_is_much_smaller_than_raw_samples){
+    // a beer and fridge temperature that wander, settings that are constant and a cooler that cycles
+    SampleStoreMock store;
+    SampleLogger logger(store, 3, 1000, 300000);
+    logger.init();
+    int32_t values[3];
+    const uint32_t seconds = 24 * 3600;
+    for(uint32_t t = 0; t < seconds; t++){
+        values[0] = 20 * 256 + int32_t((t / 40) % 16);     // changes every 40 s
+        values[1] = 18 * 256 + int32_t((t / 7) % 64) - 32; // changes every 7 s
+        values[2] = ((t / 600) % 3) == 0;                  // cooler on for 10 minutes every 30 minutes
+        logger.add(t * 1000, values);
+    }
+    logger.flush();
+    uint32_t bytes = 0;
+    for(const SampleStoreMock::Block & block : store.blocks){
+        bytes += block.data.size();
+    }
+    BOOST_CHECK_EQUAL(decodeAll(store).size(), seconds);
+    BOOST_TEST_MESSAGE("24 hours of 3 channels: " << bytes << " bytes in " << store.blocks.size() << " blocks");
+    BOOST_CHECK_LT(bytes * 20, seconds * (4 + 3 * 4)); // raw samples with a time stamp
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "SetpointProfile.h"
+#include <cmath>
+
+// 3 steps: 1000 to 2000 in 100 time units, 2000 to -1000 in 300 time units, then hold -1000
+static const ProfilePoint points[] = {{100, 1000}, {300, 2000}, {0, -1000}};
+
+static double reference(ProfileInterpolation interpolation, double u){
+    switch(interpolation){
+    case INTERPOLATION_NONE: return 0;
+    case INTERPOLATION_LINEAR: return u;
+    case INTERPOLATION_SMOOTH: return u * u * (3 - 2 * u);
+    case INTERPOLATION_SMOOTHER: return u * u * u * (u * (u * 6 - 15) + 10);
+    }
+    return 0;
+}
+
+BOOST_AUTO_TEST_SUITE(SetpointProfileTest)
+
+BOOST_AUTO_TEST_CASE(steps_are_found_with_binary_search){
+    SetpointProfile profile;
+    BOOST_REQUIRE(profile.load(points, 3, INTERPOLATION_LINEAR));
+    BOOST_CHECK_EQUAL(profile.stepCount(), 3);
+    BOOST_CHECK_EQUAL(profile.duration(), 400);
+    BOOST_CHECK_EQUAL(profile.stepAt(0), 0);
+    BOOST_CHECK_EQUAL(profile.stepAt(99), 0);
+    BOOST_CHECK_EQUAL(profile.stepAt(100), 1);
+    BOOST_CHECK_EQUAL(profile.stepAt(399), 1);
+    BOOST_CHECK_EQUAL(profile.stepAt(400), 2);
+    BOOST_CHECK_EQUAL(profile.stepAt(100000), 2);
+    BOOST_CHECK_EQUAL(profile.stepDuration(1), 300);
+    BOOST_CHECK_EQUAL(profile.stepDuration(2), 0);
+}
+
+BOOST_AUTO_TEST_CASE(interpolation_matches_floating_point_reference){
+    for(ProfileInterpolation interpolation :
+            {INTERPOLATION_NONE, INTERPOLATION_LINEAR, INTERPOLATION_SMOOTH, INTERPOLATION_SMOOTHER}){
+        SetpointProfile profile;
+        profile.load(points, 3, interpolation);
+        for(uint32_t t = 0; t < 500; t++){
+            double expected;
+            if(t < 100){
+                expected = 1000 + 1000 * reference(interpolation, t / 100.0);
+            }
+            else if(t < 400){
+                expected = 2000 - 3000 * reference(interpolation, (t - 100) / 300.0);
+            }
+            else {
+                expected = -1000;
+            }
+            BOOST_CHECK_SMALL(profile.valueAt(t) - expected, 0.51);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(steps_without_duration_are_skipped){
+    const ProfilePoint jump[] = {{10, 100}, {0, 500}, {10, 200}, {0, 300}};
+    SetpointProfile profile;
+    profile.load(jump, 4, INTERPOLATION_LINEAR);
+    BOOST_CHECK_EQUAL(profile.stepAt(10), 2);
+    BOOST_CHECK_EQUAL(profile.valueAt(9), 460); // interpolates towards the zero length step
+    BOOST_CHECK_EQUAL(profile.valueAt(10), 200);
+    BOOST_CHECK_EQUAL(profile.valueAt(20), 300);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
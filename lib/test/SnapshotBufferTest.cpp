@@ -0,0 +1,145 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "SnapshotBuffer.h"
+#include <functional>
+#include <thread>
+
+struct Sample {
+    uint32_t count;
+    uint32_t inverted; // ~count, to detect torn copies
+    int16_t temps[8];
+};
+
+static Sample sample(uint32_t count){
+    Sample s;
+    s.count = count;
+    s.inverted = ~count;
+    for(uint8_t i = 0; i < 8; i++){
+        s.temps[i] = int16_t(count + i);
+    }
+    return s;
+}
+
+static bool consistent(const Sample & s){
+    if(s.inverted != ~s.count){
+        return false;
+    }
+    for(uint8_t i = 0; i < 8; i++){
+        if(s.temps[i] != int16_t(s.count + i)){
+            return false;
+        }
+    }
+    return true;
+}
+
+// a value that lets the test run code in the middle of a copy, like a writer preempting the reader
+struct Interrupted {
+    int value;
+    std::function<void()> duringCopy;
+
+    Interrupted & operator=(const Interrupted & other){
+        value = other.value;
+        if(duringCopy){
+            duringCopy();
+        }
+        return *this;
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(SnapshotBufferTest)
+
+BOOST_AUTO_TEST_CASE(reader_gets_the_newest_snapshot){
+    SnapshotBuffer<Sample> buffer;
+    BOOST_CHECK_EQUAL(buffer.version(), 0);
+    buffer.publish(sample(1));
+    buffer.publish(sample(2));
+    BOOST_CHECK_EQUAL(buffer.version(), 2);
+
+    Sample s;
+    BOOST_CHECK(buffer.tryRead(s));
+    BOOST_CHECK_EQUAL(s.count, 2);
+    BOOST_CHECK(consistent(s));
+    BOOST_CHECK_EQUAL(buffer.read().count, 2);
+}
+
+BOOST_AUTO_TEST_CASE(one_publish_during_a_read_does_not_disturb_the_reader){
+    SnapshotBuffer<Interrupted> buffer;
+    buffer.publish(Interrupted{1, nullptr});
+
+    Interrupted out{0, [&buffer]{ buffer.publish(Interrupted{2, nullptr}); }};
+    BOOST_CHECK(buffer.tryRead(out));
+    BOOST_CHECK_EQUAL(out.value, 1);
+    BOOST_CHECK_EQUAL(buffer.read().value, 2);
+}
+
+BOOST_AUTO_TEST_CASE(a_read_overtaken_by_two_publishes_is_detected){
+    SnapshotBuffer<Interrupted> buffer;
+    buffer.publish(Interrupted{1, nullptr});
+
+    Interrupted out{0, [&buffer]{
+        buffer.publish(Interrupted{2, nullptr});
+        buffer.publish(Interrupted{3, nullptr}); // overwrites the slot that is being read
+    }};
+    BOOST_CHECK(!buffer.tryRead(out));
+    out.duringCopy = nullptr;
+    BOOST_CHECK(buffer.tryRead(out));
+    BOOST_CHECK_EQUAL(out.value, 3);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_readers_never_see_torn_snapshots){
+    SnapshotBuffer<Sample> buffer;
+    buffer.publish(sample(0));
+    const uint32_t publishes = 200000;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> backwards(0);
+
+    auto reader = [&]{
+        uint32_t last = 0;
+        while(!done.load()){
+            Sample s = buffer.read();
+            if(!consistent(s)){
+                torn++;
+            }
+            if(s.count < last){
+                backwards++;
+            }
+            last = s.count;
+        }
+    };
+
+    std::thread r1(reader);
+    std::thread r2(reader);
+    for(uint32_t i = 1; i <= publishes; i++){
+        buffer.publish(sample(i));
+    }
+    done = true;
+    r1.join();
+    r2.join();
+
+    BOOST_CHECK_EQUAL(torn.load(), 0);
+    BOOST_CHECK_EQUAL(backwards.load(), 0);
+    BOOST_CHECK_EQUAL(buffer.read().count, publishes);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "SpiDisplayStream.h"
+#include "SpiSinkMock.h"
+
+BOOST_AUTO_TEST_SUITE(SpiDisplayStreamTest)
+
+BOOST_AUTO_TEST_CASE(set_window_sends_column_and_page_address){
+    SpiSinkMock sink;
+    SpiDisplayStream stream(sink);
+    stream.setWindow(0x0102, 0x0304, 0x0506, 0x0708);
+    stream.end();
+
+    const uint8_t expected[] = {0x2A, 0x01, 0x02, 0x05, 0x06, 0x2B, 0x03, 0x04, 0x07, 0x08, 0x2C};
+    const bool isCommand[] = {true, false, false, false, false, true, false, false, false, false, true};
+    BOOST_REQUIRE_EQUAL(sink.bytes.size(), sizeof(expected));
+    for(size_t i = 0; i < sizeof(expected); i++){
+        BOOST_CHECK_EQUAL(sink.bytes[i], expected[i]);
+        BOOST_CHECK_EQUAL(sink.commandFlags[i], isCommand[i]);
+    }
+    BOOST_CHECK_EQUAL(sink.commands, 3);
+    BOOST_CHECK_EQUAL(sink.selections, 1);
+}
+
+BOOST_AUTO_TEST_CASE(pixels_are_sent_msb_first){
+    SpiSinkMock sink;
+    SpiDisplayStream stream(sink);
+    const uint16_t colors[] = {0xF800, 0x07E0, 0x001F};
+    stream.pushColors(colors, 3);
+    stream.pushColor(0x1234, 2);
+    stream.end();
+
+    const uint8_t expected[] = {0xF8, 0x00, 0x07, 0xE0, 0x00, 0x1F, 0x12, 0x34, 0x12, 0x34};
+    BOOST_REQUIRE_EQUAL(sink.bytes.size(), sizeof(expected));
+    for(size_t i = 0; i < sizeof(expected); i++){
+        BOOST_CHECK_EQUAL(sink.bytes[i], expected[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(nothing_is_sent_before_flush_and_chip_select_is_released_at_end){
+    SpiSinkMock sink;
+    SpiDisplayStream stream(sink);
+    stream.pushColor(0xFFFF, 4);
+    BOOST_CHECK_EQUAL(sink.totalBytes(), 0);
+    BOOST_CHECK(!sink.selected);
+
+    stream.flush();
+    BOOST_CHECK_EQUAL(sink.totalBytes(), 8);
+    BOOST_CHECK(sink.selected);
+
+    stream.end();
+    BOOST_CHECK(!sink.selected);
+    BOOST_CHECK(!stream.isSelected());
+    BOOST_CHECK_EQUAL(sink.unselectedBytes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(a_command_is_sent_after_pending_data){
+    SpiSinkMock sink;
+    SpiDisplayStream stream(sink);
+    stream.data(0x11);
+    stream.data(0x22);
+    stream.command(0x33);
+    stream.data(0x44);
+    stream.end();
+
+    const uint8_t expected[] = {0x11, 0x22, 0x33, 0x44};
+    BOOST_REQUIRE_EQUAL(sink.bytes.size(), sizeof(expected));
+    for(size_t i = 0; i < sizeof(expected); i++){
+        BOOST_CHECK_EQUAL(sink.bytes[i], expected[i]);
+    }
+    BOOST_CHECK(!sink.commandFlags[1]);
+    BOOST_CHECK(sink.commandFlags[2]);
+    BOOST_CHECK(!sink.commandFlags[3]);
+    BOOST_CHECK(sink.dataLine);
+}
+
+BOOST_AUTO_TEST_CASE(long_runs_are_split_in_full_buffers){
+    SpiSinkMock sink;
+    SpiDisplayStream stream(sink);
+    stream.data(0xAA); // odd number of pending bytes, pixels must still end up in order
+    stream.pushColor(0xBEEF, 100);
+    stream.end();
+
+    BOOST_REQUIRE_EQUAL(sink.bytes.size(), 201);
+    BOOST_CHECK_EQUAL(sink.bytes[0], 0xAA);
+    for(size_t i = 1; i < 201; i += 2){
+        BOOST_CHECK_EQUAL(sink.bytes[i], 0xBE);
+        BOOST_CHECK_EQUAL(sink.bytes[i + 1], 0xEF);
+    }
+    BOOST_CHECK_EQUAL(sink.writes, 4); // 63 bytes, because a pixel is not split, then 64, 64 and 10 bytes
+}
+
+BOOST_AUTO_TEST_CASE(full_screen_fill_benchmark){
+    SpiSinkMock sink;
+    sink.recording = false;
+    SpiDisplayStream stream(sink);
+
+    const uint16_t width = 320;
+    const uint16_t height = 240;
+    stream.setWindow(0, 0, width - 1, height - 1);
+    stream.pushColor(0x0000, uint32_t(width) * height);
+    stream.end();
+
+    uint32_t pixelBytes = uint32_t(width) * height * 2;
+    BOOST_CHECK_EQUAL(sink.dataBytes, pixelBytes + 8);
+    BOOST_CHECK_EQUAL(sink.commands, 3);
+    BOOST_CHECK_EQUAL(sink.selections, 1);
+    BOOST_CHECK_EQUAL(sink.unselectedBytes, 0);
+
+    // Sending each byte separately selects the display for every byte
+    SpiSinkMock perByte;
+    perByte.recording = false;
+    for(uint32_t i = 0; i < sink.totalBytes(); i++){
+        uint8_t b = 0;
+        perByte.select(true);
+        perByte.write(&b, 1);
+        perByte.select(false);
+    }
+
+    const uint32_t clockHz = 60000000 / 64; // Photon APB2 clock at the divider used for the display
+    uint32_t burstMicros = sink.estimatedMicros(clockHz, 1);
+    uint32_t perByteMicros = perByte.estimatedMicros(clockHz, 1);
+    BOOST_TEST_MESSAGE("Full screen fill: " << sink.totalBytes() << " bytes in " << sink.writes << " writes, "
+            << burstMicros << " us (" << perByteMicros << " us when sent per byte)");
+    BOOST_CHECK_LT(sink.writes * 32, perByte.writes);
+    BOOST_CHECK_LT(burstMicros, perByteMicros);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
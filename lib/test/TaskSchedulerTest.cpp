@@ -0,0 +1,233 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "TaskScheduler.h"
+#include <string>
+
+static std::string trace;
+
+static void fastTask(){ trace += 'f'; }
+static void slowTask(){ trace += 's'; delay(30); }
+static void otherSlowTask(){ trace += 'o'; }
+static void idleTask(){ trace += 'i'; }
+
+static ticks_millis_t overrun = 0;
+static void overrunTask(){ trace += 'o'; delay(overrun); overrun = 0; }
+
+struct TaskSchedulerFixture {
+    TaskSchedulerFixture() :
+        fast(fastTask, 10, 5, 200, "fast"),
+        slow(slowTask, 1000, 500, 100, "slow"),
+        otherSlow(otherSlowTask, 1000, 500, 90, "other"),
+        idle(idleTask, 0, 1000, 10, "idle") {
+        trace.clear();
+    }
+
+    Task fast;
+    Task slow;
+    Task otherSlow;
+    Task idle;
+    TaskScheduler scheduler;
+};
+
+BOOST_AUTO_TEST_SUITE(TaskSchedulerTest)
+
+BOOST_FIXTURE_TEST_CASE(due_tasks_run_in_order_of_priority, TaskSchedulerFixture){
+    scheduler.add(&otherSlow);
+    scheduler.add(&slow);
+    scheduler.add(&fast);
+
+    BOOST_CHECK(scheduler.run() == &fast);
+    BOOST_CHECK(scheduler.run() == &slow); // takes 30 ms
+    BOOST_CHECK(scheduler.run() == &fast); // fast task was due again, and is serviced before the other slow task
+    BOOST_CHECK(scheduler.run() == &otherSlow);
+    BOOST_CHECK(scheduler.run() == nullptr);
+    BOOST_CHECK_EQUAL(trace, "fsfo");
+}
+
+BOOST_FIXTURE_TEST_CASE(idle_task_with_zero_period_runs_when_nothing_else_is_due, TaskSchedulerFixture){
+    scheduler.add(&fast);
+    scheduler.add(&idle);
+
+    scheduler.run();
+    scheduler.run();
+    scheduler.run();
+    delay(10);
+    scheduler.run();
+    scheduler.run();
+    BOOST_CHECK_EQUAL(trace, "fiifi");
+}
+
+BOOST_FIXTURE_TEST_CASE(periodic_task_runs_once_per_period, TaskSchedulerFixture){
+    scheduler.add(&fast);
+
+    for(int i = 0; i < 1000; i++){
+        scheduler.run();
+        delay(1);
+    }
+    BOOST_CHECK_EQUAL(fast.statistics().runs, 100u);
+    BOOST_CHECK_EQUAL(fast.statistics().maxLateness, 0u);
+    BOOST_CHECK_EQUAL(fast.statistics().missedDeadlines, 0u);
+}
+
+#if BREWPI_PROFILING
+BOOST_FIXTURE_TEST_CASE(statistics_track_runtime_and_lateness, TaskSchedulerFixture){
+    scheduler.add(&fast);
+    scheduler.add(&slow);
+
+    scheduler.run(); // fast
+    scheduler.run(); // slow, 30 ms
+    delay(2);
+    scheduler.run(); // fast, 22 ms late, which is after its deadline
+
+    BOOST_CHECK_EQUAL(slow.statistics().runs, 1u);
+    BOOST_CHECK_EQUAL(slow.statistics().maxRunTime, 30000u);
+    BOOST_CHECK_EQUAL(slow.statistics().totalRunTime, 30000u);
+
+    BOOST_CHECK_EQUAL(fast.statistics().runs, 2u);
+    BOOST_CHECK_EQUAL(fast.statistics().maxLateness, 22u);
+    BOOST_CHECK_EQUAL(fast.statistics().missedDeadlines, 1u);
+
+    scheduler.resetStatistics();
+    BOOST_CHECK_EQUAL(fast.statistics().runs, 0u);
+    BOOST_CHECK_EQUAL(fast.statistics().missedDeadlines, 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(statistics_keep_min_and_recent_run_times_and_lateness_histogram, TaskSchedulerFixture){
+    scheduler.add(&fast);
+    scheduler.add(&slow);
+
+    scheduler.run(); // fast, on time
+    scheduler.run(); // slow, 30 ms
+    scheduler.run(); // fast, 20 ms late
+    delay(10);
+    scheduler.run(); // fast, on time
+
+    const TaskStatistics & stats = fast.statistics();
+    BOOST_CHECK_EQUAL(stats.runs, 3u);
+    BOOST_CHECK_EQUAL(stats.minRunTime, 0u);
+    BOOST_CHECK_EQUAL(slow.statistics().minRunTime, 30000u);
+    BOOST_CHECK_EQUAL(slow.statistics().recentMaxRunTime(), 30000u);
+    BOOST_CHECK_EQUAL(slow.statistics().meanRunTime(), 30000u);
+
+    // 0 ms late in bin 0, 16-31 ms late in bin 5
+    BOOST_CHECK_EQUAL(stats.lateness.bins[0], 2);
+    BOOST_CHECK_EQUAL(stats.lateness.bins[5], 1);
+}
+
+BOOST_AUTO_TEST_CASE(recent_maximum_forgets_old_outlier){
+    RunTimeStatistics stats;
+    stats.reset();
+    stats.add(100);
+    for(int i = 0; i < PROFILING_RECENT_RUNS; i++){
+        BOOST_CHECK_EQUAL(stats.recentMaxRunTime(), 100u);
+        stats.add(10);
+    }
+    BOOST_CHECK_EQUAL(stats.maxRunTime, 100u);
+    BOOST_CHECK_EQUAL(stats.recentMaxRunTime(), 10u);
+    BOOST_CHECK_EQUAL(stats.minRunTime, 10u);
+}
+
+BOOST_AUTO_TEST_CASE(profile_section_measures_scope){
+    ProfileSection section("section");
+    for(int i = 1; i <= 3; i++){
+        PROFILE_SCOPE(section)
+        delay(i);
+    }
+    BOOST_CHECK_EQUAL(section.statistics().runs, 3u);
+    BOOST_CHECK_EQUAL(section.statistics().minRunTime, 1000u);
+    BOOST_CHECK_EQUAL(section.statistics().maxRunTime, 3000u);
+    BOOST_CHECK_EQUAL(section.statistics().meanRunTime(), 2000u);
+    BOOST_CHECK(ProfileSection::first() == &section);
+}
+#endif
+
+BOOST_FIXTURE_TEST_CASE(late_task_skips_missed_releases, TaskSchedulerFixture){
+    scheduler.add(&fast);
+
+    scheduler.run();
+    delay(55);
+    scheduler.run();
+    scheduler.run();
+    BOOST_CHECK_EQUAL(trace, "ff"); // does not try to catch up by running 5 times
+    delay(10);
+    scheduler.run();
+    BOOST_CHECK_EQUAL(trace, "fff");
+}
+
+BOOST_FIXTURE_TEST_CASE(late_task_stays_on_its_period_grid, TaskSchedulerFixture){
+    scheduler.add(&fast);
+
+    scheduler.run();
+    delay(55);
+    scheduler.run(); // released at 10, next releases are at multiples of 10
+    delay(4);
+    scheduler.run();
+    BOOST_CHECK_EQUAL(trace, "ff");
+    delay(1);
+    scheduler.run();
+    BOOST_CHECK_EQUAL(trace, "fff");
+    BOOST_CHECK_EQUAL(fast.statistics().lateness.bins[0], 2u); // the run at 60 was on time
+}
+
+BOOST_FIXTURE_TEST_CASE(tasks_with_the_same_period_keep_their_order_after_an_overrun, TaskSchedulerFixture){
+    Task sensors(fastTask, 100, 100, 3, "sensors");
+    Task pids(overrunTask, 100, 100, 2, "pids");
+    Task actuators(idleTask, 100, 100, 1, "actuators");
+    scheduler.add(&sensors);
+    scheduler.add(&pids);
+    scheduler.add(&actuators);
+
+    overrun = 150; // the actuators start their first run 150 ms late
+    while(scheduler.run()){}
+    BOOST_CHECK_EQUAL(trace, "fofoi");
+
+    // all three are released again at 200, so the actuators still follow the sensors and pids
+    trace.clear();
+    delay(50);
+    while(scheduler.run()){}
+    BOOST_CHECK_EQUAL(trace, "foi");
+}
+
+BOOST_FIXTURE_TEST_CASE(disabled_and_removed_tasks_do_not_run, TaskSchedulerFixture){
+    scheduler.add(&fast);
+    scheduler.add(&slow);
+    BOOST_CHECK_EQUAL(scheduler.taskCount(), 2);
+
+    fast.setEnabled(false);
+    BOOST_CHECK(scheduler.run() == &slow);
+
+    scheduler.remove(&slow);
+    BOOST_CHECK_EQUAL(scheduler.taskCount(), 1);
+    BOOST_CHECK(scheduler.task(0) == &fast);
+    BOOST_CHECK(scheduler.task(1) == nullptr);
+    BOOST_CHECK(scheduler.run() == nullptr);
+}
+
+BOOST_FIXTURE_TEST_CASE(scheduler_has_fixed_capacity, TaskSchedulerFixture){
+    for(int i = 0; i < TASK_SCHEDULER_MAX_TASKS; i++){
+        BOOST_CHECK(scheduler.add(&idle));
+    }
+    BOOST_CHECK(!scheduler.add(&fast));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
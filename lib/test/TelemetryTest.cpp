@@ -0,0 +1,234 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "runner.h"
+#include "Telemetry.h"
+#include <vector>
+#include <stdio.h>
+
+// splits the received bytes into frames at the zero delimiters and decodes them
+class TelemetrySinkMock final : public TelemetrySink {
+public:
+    TelemetrySinkMock() : bytes(0) {}
+    ~TelemetrySinkMock() = default;
+
+    void write(const uint8_t * data, uint16_t length) override final {
+        bytes += length;
+        for(uint16_t i = 0; i < length; i++){
+            if(data[i] != 0){
+                pending.push_back(data[i]);
+            }
+            else if(!pending.empty()){
+                TelemetryFrame frame;
+                if(telemetryDecode(pending.data(), pending.size(), frame)){
+                    frames.push_back(frame);
+                }
+                else {
+                    invalid++;
+                }
+                pending.clear();
+            }
+        }
+    }
+
+    std::vector<TelemetryFrame> frames;
+    std::vector<uint8_t> pending;
+    uint32_t bytes;
+    uint32_t invalid = 0;
+};
+
+BOOST_AUTO_TEST_SUITE(TelemetryTest)
+
+BOOST_AUTO_TEST_CASE(cobs_round_trip_removes_all_zeros){
+    for(uint16_t length : {0, 1, 5, 253, 254, 255, 300}){
+        std::vector<uint8_t> in(length);
+        for(uint16_t i = 0; i < length; i++){
+            in[i] = (length == 300) ? uint8_t(i % 7) : uint8_t(i % 255 + 1); // with and without zeros
+        }
+        std::vector<uint8_t> encoded(length + length / 254 + 1);
+        uint16_t encodedLength = cobsEncode(in.data(), length, encoded.data());
+        BOOST_CHECK_LE(encodedLength, encoded.size());
+        for(uint16_t i = 0; i < encodedLength; i++){
+            BOOST_REQUIRE_NE(encoded[i], 0);
+        }
+        std::vector<uint8_t> decoded(encodedLength);
+        BOOST_REQUIRE_EQUAL(cobsDecode(encoded.data(), encodedLength, decoded.data()), length);
+        for(uint16_t i = 0; i < length; i++){
+            BOOST_CHECK_EQUAL(decoded[i], in[i]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(crc_matches_ccitt_check_value){
+    const char * check = "123456789";
+    BOOST_CHECK_EQUAL(telemetryCrc((const uint8_t *) check, 9), 0x29B1);
+}
+
+BOOST_AUTO_TEST_CASE(values_of_all_sizes_are_decoded){
+    TelemetrySinkMock sink;
+    TelemetryWriter writer(sink);
+    const int32_t values[] = {0, -1, 127, -128, 128, -32768, 32767, 40000, -8388608, 8388607, 8388608, INT32_MIN, INT32_MAX};
+    writer.begin(123456789);
+    for(uint8_t i = 0; i < 13; i++){
+        writer.add(i, values[i]);
+    }
+    writer.end();
+
+    BOOST_REQUIRE_EQUAL(sink.frames.size(), 1);
+    const TelemetryFrame & frame = sink.frames[0];
+    BOOST_CHECK_EQUAL(frame.time, 123456789);
+    BOOST_CHECK_EQUAL(frame.flags, TELEMETRY_KEYFRAME);
+    BOOST_REQUIRE_EQUAL(frame.count, 13);
+    for(uint8_t i = 0; i < 13; i++){
+        BOOST_CHECK_EQUAL(frame.records[i].id, i);
+        BOOST_CHECK_EQUAL(frame.records[i].value, values[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(only_changed_values_are_sent_until_the_next_keyframe){
+    TelemetrySinkMock sink;
+    TelemetryWriter writer(sink, 2);
+    for(uint32_t second = 0; second < 4; second++){
+        writer.begin(second * 1000);
+        writer.add(0, 5000);
+        writer.add(1, second < 2 ? 100 : 200);
+        writer.end();
+    }
+    BOOST_REQUIRE_EQUAL(sink.frames.size(), 4);
+    BOOST_CHECK_EQUAL(sink.frames[0].count, 2); // keyframe
+    BOOST_CHECK_EQUAL(sink.frames[1].count, 0); // nothing changed, only the time
+    BOOST_CHECK_EQUAL(sink.frames[2].count, 1);
+    BOOST_CHECK_EQUAL(sink.frames[2].records[0].id, 1);
+    BOOST_CHECK_EQUAL(sink.frames[2].records[0].value, 200);
+    BOOST_CHECK_EQUAL(sink.frames[3].flags, TELEMETRY_KEYFRAME); // after the interval of 2 batches
+    BOOST_CHECK_EQUAL(sink.frames[3].count, 2);
+
+    writer.requestKeyframe();
+    writer.begin(5000);
+    writer.add(0, 5000);
+    writer.end();
+    BOOST_CHECK_EQUAL(sink.frames[4].count, 1);
+    BOOST_CHECK_EQUAL(sink.frames[4].sequence, 4);
+}
+
+BOOST_AUTO_TEST_CASE(a_large_batch_is_split_in_frames){
+    TelemetrySinkMock sink;
+    TelemetryWriter writer(sink);
+    writer.begin(0);
+    for(uint8_t id = 0; id < 50; id++){
+        writer.add(id, 1000 + id); // 3 bytes per record
+    }
+    writer.end();
+
+    BOOST_REQUIRE_EQUAL(sink.frames.size(), 2);
+    BOOST_CHECK_EQUAL(sink.frames[0].flags, TELEMETRY_KEYFRAME | TELEMETRY_MORE);
+    BOOST_CHECK_EQUAL(sink.frames[1].flags, TELEMETRY_KEYFRAME);
+    BOOST_CHECK_EQUAL(sink.frames[0].count + sink.frames[1].count, 50);
+    BOOST_CHECK_EQUAL(sink.frames[1].records[sink.frames[1].count - 1].value, 1049);
+}
+
+// stores the encoded bytes
+class TelemetryRecorder final : public TelemetrySink {
+public:
+    TelemetryRecorder() = default;
+    ~TelemetryRecorder() = default;
+
+    void write(const uint8_t * data, uint16_t length) override final {
+        bytes.insert(bytes.end(), data, data + length);
+    }
+
+    std::vector<uint8_t> bytes;
+};
+
+BOOST_AUTO_TEST_CASE(corrupted_frames_are_rejected){
+    TelemetryRecorder recorder;
+    TelemetryWriter writer(recorder);
+    writer.begin(0);
+    writer.add(3, 1234);
+    writer.end();
+    const std::vector<uint8_t> & encoded = recorder.bytes;
+    BOOST_REQUIRE_EQUAL(encoded.front(), 0);
+    BOOST_REQUIRE_EQUAL(encoded.back(), 0);
+
+    TelemetrySinkMock sink;
+    sink.write(encoded.data(), encoded.size());
+    BOOST_REQUIRE_EQUAL(sink.frames.size(), 1);
+
+    // flip a bit in each byte between the delimiters
+    for(size_t i = 1; i < encoded.size() - 1; i++){
+        std::vector<uint8_t> corrupt(encoded);
+        corrupt[i] ^= 0x01;
+        sink.write(corrupt.data(), corrupt.size());
+    }
+    BOOST_CHECK_EQUAL(sink.frames.size(), 1);
+    BOOST_CHECK_GE(sink.invalid, encoded.size() - 2);
+}
+
+BOOST_AUTO_TEST_CASE(log_blocks_are_framed_and_not_mistaken_for_telemetry){
+    TelemetryRecorder recorder;
+    uint8_t block[TELEMETRY_MAX_BLOCK_SIZE];
+    for(uint16_t i = 0; i < TELEMETRY_MAX_BLOCK_SIZE; i++){
+        block[i] = uint8_t(i % 5); // with zeros
+    }
+    telemetrySendBlock(recorder, 0x12345678, block, TELEMETRY_MAX_BLOCK_SIZE);
+    const std::vector<uint8_t> & encoded = recorder.bytes;
+    BOOST_REQUIRE_EQUAL(encoded.front(), 0);
+    BOOST_REQUIRE_EQUAL(encoded.back(), 0);
+
+    uint32_t sequence = 0;
+    uint8_t decoded[TELEMETRY_MAX_BLOCK_SIZE];
+    uint16_t length = 0;
+    BOOST_REQUIRE(telemetryDecodeBlock(encoded.data() + 1, encoded.size() - 2, sequence, decoded, length));
+    BOOST_CHECK_EQUAL(sequence, 0x12345678);
+    BOOST_REQUIRE_EQUAL(length, TELEMETRY_MAX_BLOCK_SIZE);
+    for(uint16_t i = 0; i < length; i++){
+        BOOST_CHECK_EQUAL(decoded[i], block[i]);
+    }
+
+    TelemetrySinkMock sink;
+    sink.write(encoded.data(), encoded.size());
+    BOOST_CHECK_EQUAL(sink.frames.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(telemetry_is_smaller_than_json){
+    // 24 temperatures and outputs that change every second, 8 settings that don't change
+    TelemetrySinkMock sink;
+    TelemetryWriter writer(sink);
+    uint32_t jsonBytes = 0;
+    char buffer[32];
+    for(uint32_t second = 0; second < 60; second++){
+        writer.begin(second * 1000);
+        jsonBytes += 3; // T:{
+        for(uint8_t id = 0; id < 32; id++){
+            int32_t value = (id < 24) ? int32_t(20 * 256 + second * 7 + id) : 18 * 256;
+            writer.add(id, value);
+            jsonBytes += snprintf(buffer, sizeof(buffer), "\"value%u\":%.2f,", id, value / 256.0);
+        }
+        writer.end();
+        jsonBytes += 2; // }\n
+    }
+    BOOST_CHECK_EQUAL(sink.invalid, 0);
+    BOOST_CHECK_EQUAL(sink.frames.size(), 60);
+    BOOST_TEST_MESSAGE("60 s of telemetry: " << sink.bytes << " bytes binary, " << jsonBytes << " bytes as JSON");
+    BOOST_CHECK_LT(sink.bytes * 4, jsonBytes);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
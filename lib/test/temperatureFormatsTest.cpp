@@ -23,8 +23,76 @@
 #include <iostream>
 #include <cstdio>
 #include <boost/test/output_test_stream.hpp>
+#include <chrono>
 using boost::test_tools::output_test_stream;
 
+// Previous implementation of toStringImpl, which uses 64 bit division for every digit.
+// Used as a reference to check that the optimized formatter gives byte-identical output, and to benchmark against.
+static char * toStringReference(const int32_t raw, unsigned char const F, char buf[], uint8_t const numDecimals,
+        uint8_t const len, char format, bool absolute){
+    char const digit[] = "0123456789";
+    char* p;
+    bool negative = false;
+    int64_t shifter = raw;
+
+    if(format =='F'){
+        int8_t rounder = (shifter < 0) ? -25 : 25;
+        shifter = (shifter * 90 + rounder) / 50;
+        if(absolute){
+            shifter += 32 << F;
+        }
+    }
+    if (shifter < 0) {
+        shifter = -shifter;
+        negative = true;
+    }
+    for (uint8_t i = 0; i < numDecimals; i++) {
+        shifter = shifter * 5;
+    }
+    shifter = (shifter + (1 << (F - numDecimals - 1))) >> (F - numDecimals);
+
+    p = &buf[len - 1];
+    *p = '\0';
+    lldiv_t dv { };
+    dv.quot = shifter;
+    do {
+        if (p == &buf[len - 1 - numDecimals]) {
+            *--p = '.';
+        } else {
+            dv = lldiv(dv.quot, 10);
+            if ((dv.quot || dv.rem)) {
+                *--p = digit[std::abs(dv.rem)];
+            } else if ((p - buf) > (len - numDecimals - 3)) {
+                *--p = '0';
+            } else if (negative) {
+                *--p = '-';
+                break;
+            } else {
+                break;
+            }
+        }
+    } while (p > buf);
+    char * pWithoutSpaces = p;
+    while (p > buf) {
+        *(--p) = ' ';
+    }
+    return pWithoutSpaces;
+}
+
+// checks one conversion against the reference implementation, including the padding spaces
+static bool formatsLikeReference(int32_t raw, unsigned char F, uint8_t numDecimals, uint8_t len, char format, bool absolute){
+    char s1[20];
+    char s2[20];
+    char * r1 = toStringImpl(raw, F, s1, numDecimals, len, format, absolute);
+    char * r2 = toStringReference(raw, F, s2, numDecimals, len, format, absolute);
+    bool equal = (r1 - s1) == (r2 - s2) && strcmp(s1, s2) == 0;
+    if(!equal){
+        BOOST_ERROR("raw " << raw << " F " << int(F) << " decimals " << int(numDecimals) << " format " << format
+                << (absolute ? " absolute" : "") << ": \"" << s1 << "\" should be \"" << s2 << "\"");
+    }
+    return equal;
+}
+
 BOOST_AUTO_TEST_SUITE( temperature_suite )
 
 
@@ -680,6 +748,68 @@ BOOST_AUTO_TEST_CASE(temp_disabled_or_invalid_prints_null){
     BOOST_REQUIRE_MESSAGE(strcmp(s1, s2) == 0, "\"" << s1 << "\" should be \"" << s2 << "\"" << " converting " << t);
 }
 
+BOOST_AUTO_TEST_CASE(all_temp_values_format_identical_to_reference){
+    const unsigned char F = temp_t::fractional_bit_count;
+    bool ok = true;
+    for(int32_t raw = INT16_MIN; raw <= INT16_MAX && ok; raw++){ // stop at the first difference
+        for(uint8_t decimals = 0; decimals <= 4; decimals++){
+            ok = ok && formatsLikeReference(raw, F, decimals, 12, 'C', false)
+                    && formatsLikeReference(raw, F, decimals, 12, 'F', true)
+                    && formatsLikeReference(raw, F, decimals, 12, 'F', false);
+        }
+    }
+    BOOST_CHECK(ok);
+}
+
+BOOST_AUTO_TEST_CASE(temp_long_and_temp_precise_values_format_identical_to_reference){
+    int32_t edges[] = {INT32_MIN, INT32_MIN + 1, -1, 0, 1, INT32_MAX - 1, INT32_MAX};
+    uint32_t random = 12345;
+    bool ok = true;
+    for(int i = 0; i < 200000 && ok; i++){ // stop at the first difference
+        random = random * 1103515245 + 12345; // simple LCG, reproducible
+        int32_t raw = (i < 7) ? edges[i] : int32_t(random);
+        if(i % 2){
+            raw >>= (i % 24); // also cover smaller values
+        }
+        for(uint8_t decimals = 0; decimals <= 4; decimals++){
+            ok = ok && formatsLikeReference(raw, temp_long_t::fractional_bit_count, decimals, 18, 'C', false)
+                    && formatsLikeReference(raw, temp_long_t::fractional_bit_count, decimals, 18, 'F', true)
+                    && formatsLikeReference(raw, temp_long_t::fractional_bit_count, decimals, 18, 'F', false);
+        }
+        for(uint8_t decimals = 0; decimals <= 8; decimals++){
+            ok = ok && formatsLikeReference(raw, temp_precise_t::fractional_bit_count, decimals, 18, 'C', false)
+                    && formatsLikeReference(raw, temp_precise_t::fractional_bit_count, decimals, 18, 'F', true)
+                    && formatsLikeReference(raw, temp_precise_t::fractional_bit_count, decimals, 18, 'F', false);
+        }
+    }
+    BOOST_CHECK(ok);
+}
+
+BOOST_AUTO_TEST_CASE(benchmark_to_string_against_reference){
+    const int32_t count = 200000;
+    char buf[16];
+    uint32_t checksum = 0; // prevent the conversions from being optimized away
+
+    auto start = std::chrono::steady_clock::now();
+    for(int32_t i = 0; i < count; i++){
+        checksum += *toStringReference(i - count / 2, temp_t::fractional_bit_count, buf, 2, 12, 'C', false);
+        checksum += *toStringReference(i * 10000, temp_precise_t::fractional_bit_count, buf, 8, 15, 'C', false);
+    }
+    auto referenceTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for(int32_t i = 0; i < count; i++){
+        checksum -= *toStringImpl(i - count / 2, temp_t::fractional_bit_count, buf, 2, 12, 'C', false);
+        checksum -= *toStringImpl(i * 10000, temp_precise_t::fractional_bit_count, buf, 8, 15, 'C', false);
+    }
+    auto optimizedTime = std::chrono::steady_clock::now() - start;
+
+    BOOST_CHECK_EQUAL(checksum, 0u);
+    double referenceNs = std::chrono::duration_cast<std::chrono::nanoseconds>(referenceTime).count() / (2.0 * count);
+    double optimizedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(optimizedTime).count() / (2.0 * count);
+    BOOST_TEST_MESSAGE("toStringImpl per conversion: reference " << referenceNs << " ns, optimized " << optimizedNs << " ns");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -40,4 +40,7 @@ public:
     static void writeBlock(eptr_t target, const void* source, uint16_t size) {
             eeprom_update_block(source, (void*)target, size);
     }	
+
+    static void compact() {
+    }
 };
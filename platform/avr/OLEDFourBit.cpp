@@ -103,31 +103,25 @@ void OLEDFourBit::begin(uint8_t cols, uint8_t lines) {
 void OLEDFourBit::clear()
 {
 	command(LCD_CLEARDISPLAY);  // clear display, set cursor position to zero
-	
-	for(uint8_t i = 0; i<4; i++){
-		for(uint8_t j = 0; j<20; j++){
-			content[i][j]=' '; // initialize on all spaces
-		}
-		content[i][20]='\0'; // NULL terminate string
-	}	
+	shadow.clear();
 }
 
 void OLEDFourBit::home()
 {
 	command(LCD_RETURNHOME);  // set cursor position to zero
+	shadow.home();
 	_currline = 0;
 	_currpos = 0;
 }
 
+// The cursor of the display is only moved when a character that differs from the display content is written.
 void OLEDFourBit::setCursor(uint8_t col, uint8_t row)
 {
-	uint8_t row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
 	if ( row >= _numlines ) {
 		row = 0;  //write to first line if out off bounds
 	}
 	_currline = row;
 	_currpos = col;
-	command(LCD_SETDDRAMADDR | (col + row_offsets[row]));
 }
 
 // Turn the display on/off (quickly)
@@ -198,8 +192,10 @@ void OLEDFourBit::createChar(uint8_t location, uint8_t charmap[]) {
 	location &= 0x7; // we only have 8 locations 0-7
 	command(LCD_SETCGRAMADDR | (location << 3));
 	for (int i=0; i<8; i++) {
-		write(charmap[i]);
+		send(charmap[i], HIGH);
+		waitBusy();
 	}
+	shadow.invalidateCursor(); // address counter points to CGRAM now
 }
 
 /*********** mid level commands, for sending data/cmds */
@@ -209,11 +205,18 @@ inline void OLEDFourBit::command(uint8_t value) {
 	waitBusy();
 }
 
+// Only characters that differ from the display content are transmitted. The cursor is moved first when the display's
+// cursor is not at the position of the character, so a run of changed characters needs a single cursor move.
 inline size_t OLEDFourBit::write(uint8_t value) {
-	send(value, HIGH);
-	content[_currline][_currpos] = value;
+	uint8_t move = shadow.write(_currline, _currpos, value);
+	if (move != LcdShadow::UNCHANGED) {
+		if (move != LcdShadow::AT_CURSOR) {
+			command(LCD_SETDDRAMADDR | move);
+		}
+		send(value, HIGH);
+		waitBusy();
+	}
 	_currpos++;
-	waitBusy();
 	return 1;
 }
 
@@ -288,31 +291,27 @@ char OLEDFourBit::readChar(void){
 }
 
 void OLEDFourBit::getLine(uint8_t lineNumber, char * buffer){
-	const char* src = content[lineNumber];
-	for(uint8_t i =0;i<20;i++){
-		char c = src[i];
-		buffer[i] = (c == 0b11011111) ? 0xB0 : c;
-	}
-	buffer[20] = '\0'; // NULL terminate string
+	shadow.getLine(lineNumber, buffer);
 }	
 
 // Read the content from the display and store it in the local string buffer.
 // Buffer should always stay up to date, so this function is not really needed.
 void OLEDFourBit::readContent(void){
-	setCursor(0,0);
+	command(LCD_SETDDRAMADDR | LcdShadow::address(0, 0));
 	for(uint8_t i =0;i<20;i++){
-		content[0][i] = readChar();
+		shadow.store(0, i, readChar());
 	}
 	for(uint8_t i =0;i<20;i++){
-		content[2][i] = readChar();
+		shadow.store(2, i, readChar());
 	}
-	setCursor(0,1);
+	command(LCD_SETDDRAMADDR | LcdShadow::address(1, 0));
 	for(uint8_t i =0;i<20;i++){
-		content[1][i] = readChar();
+		shadow.store(1, i, readChar());
 	}
 	for(uint8_t i =0;i<20;i++){
-		content[3][i] = readChar();
+		shadow.store(3, i, readChar());
 	}
+	shadow.invalidateCursor(); // reading moved the cursor
 }
 
 void OLEDFourBit::printSpacesToRestOfLine(void){
@@ -28,6 +28,7 @@
 #include <inttypes.h>
 #include "Print.h"
 #include "Board.h"
+#include "LcdShadow.h"
 
 // commands
 #define LCD_CLEARDISPLAY 0x01
@@ -147,7 +148,8 @@ class OLEDFourBit : public Print {
 	uint8_t _currpos;
 	uint8_t _numlines;
 	
-	char content[4][21]; // always keep a copy of the display content in this variable
+	// copy of the display content, only characters that differ from it are transmitted
+	LcdShadow shadow;
 	
 	bool	_bufferOnly;
 
@@ -83,31 +83,25 @@ void SpiLcd::begin(uint8_t cols, uint8_t lines) {
 void SpiLcd::clear()
 {
 	command(LCD_CLEARDISPLAY);  // clear display, set cursor position to zero
-	
-	for(uint8_t i = 0; i<4; i++){
-		for(uint8_t j = 0; j<20; j++){
-			content[i][j]=' '; // initialize on all spaces
-		}
-		content[i][20]='\0'; // NULL terminate string
-	}
+	shadow.clear();
 }
 
 void SpiLcd::home()
 {
 	command(LCD_RETURNHOME);  // set cursor position to zero
+	shadow.home();
 	_currline = 0;
 	_currpos = 0;
 }
 
+// The cursor of the display is only moved when a character that differs from the display content is written.
 void SpiLcd::setCursor(uint8_t col, uint8_t row)
 {
-	const uint8_t row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
 	if ( row >= _numlines ) {
 		row = 0;  //write to first line if out off bounds
 	}
 	_currline = row;
 	_currpos = col;
-	command(LCD_SETDDRAMADDR | (col + row_offsets[row]));
 }
 
 // Turn the display on/off (quickly)
@@ -178,8 +172,10 @@ void SpiLcd::createChar(uint8_t location, uint8_t charmap[]) {
 	location &= 0x7; // we only have 8 locations 0-7
 	command(LCD_SETCGRAMADDR | (location << 3));
 	for (int i=0; i<8; i++) {
-		write(charmap[i]);
+		send(charmap[i], HIGH);
+		waitBusy();
 	}
+	shadow.invalidateCursor(); // address counter points to CGRAM now
 }
 
 // This resets the backlight timer and updates the SPI output
@@ -196,12 +192,29 @@ void SpiLcd::updateBacklight(void){
 
 // Puts the content of one LCD line into the provided buffer.
 void SpiLcd::getLine(uint8_t lineNumber, char * buffer){
-	const char* src = content[lineNumber];
-	for(uint8_t i =0;i<20;i++){
-		uint8_t c = src[i];
-		buffer[i] = (c == 0b11011111) ? 0xB0 : c;
+	shadow.getLine(lineNumber, buffer);
+}
+
+void SpiLcd::setBufferOnly(bool bufferOnly){
+	bool wasBufferOnly = _bufferOnly;
+	_bufferOnly = bufferOnly;
+	if(wasBufferOnly && !bufferOnly){
+		refresh();
+	}
+}
+
+// Transmits the entire shadow copy, after the display was not updated for a while
+void SpiLcd::refresh(){
+	for(uint8_t row = 0; row < _numlines; row++){
+		command(LCD_SETDDRAMADDR | LcdShadow::address(row, 0));
+		shadow.moveCursor(row, 0);
+		const char * line = shadow.line(row);
+		for(uint8_t col = 0; col < LcdShadow::COLS; col++){
+			send(line[col], HIGH);
+			waitBusy();
+			shadow.advanceCursor();
+		}
 	}
-	buffer[20] = '\0'; // NULL terminate string
 }
 
 /*********** mid level commands, for sending data/cmds */
@@ -211,14 +224,27 @@ inline void SpiLcd::command(uint8_t value) {
 	waitBusy();
 }
 
+// Only characters that differ from the display content are transmitted. The cursor is moved first when the display's
+// cursor is not at the position of the character, so a run of changed characters needs a single cursor move.
 inline size_t SpiLcd::write(uint8_t value) {
-	content[_currline][_currpos] = value;
-	_currpos++;
-	if (!_bufferOnly)
+	if (_bufferOnly)
 	{
-		send(value, HIGH);
-		waitBusy();		
+		shadow.store(_currline, _currpos, value);
 	}
+	else
+	{
+		uint8_t move = shadow.write(_currline, _currpos, value);
+		if (move != LcdShadow::UNCHANGED)
+		{
+			if (move != LcdShadow::AT_CURSOR)
+			{
+				command(LCD_SETDDRAMADDR | move);
+			}
+			send(value, HIGH);
+			waitBusy();
+		}
+	}
+	_currpos++;
 	return 1;
 }
 
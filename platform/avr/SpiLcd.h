@@ -29,6 +29,7 @@
 #include <stdint.h>
 #include <Print.h>
 #include "Ticks.h"
+#include "LcdShadow.h"
 
 // commands
 #define LCD_CLEARDISPLAY 0x01
@@ -127,7 +128,8 @@ class SpiLcd : public Print {
 	void command(uint8_t);
 	char readChar(void);
 
-	void setBufferOnly(bool bufferOnly) { _bufferOnly = bufferOnly; }
+	// When buffer only is turned off, the display is updated with everything that was written in the mean time
+	void setBufferOnly(bool bufferOnly);
 
 	void resetBacklightTimer(void);
 
@@ -152,6 +154,7 @@ class SpiLcd : public Print {
 	void write4bits(uint8_t);
 	void pulseEnable();
 	void waitBusy();
+	void refresh();
 		
 	// Define shift register byte, keep pin state in this byte and send it out for each write.
 	volatile uint8_t _spiByte;
@@ -166,7 +169,8 @@ class SpiLcd : public Print {
 	bool	_bufferOnly;
 	uint16_t _backlightTime;
 
-	char content[4][21]; // always keep a copy of the display content in this variable
+	// copy of the display content, only characters that differ from it are transmitted
+	LcdShadow shadow;
 	
 };
 
@@ -386,6 +386,864 @@ public:
     
 };
 
+/**
+ * CRC-16/CCITT (polynomial 0x1021), continuing from crc. Start with 0xFFFF.
+ */
+inline uint16_t crc16ccitt(uint16_t crc, const void* data, page_size_t length) {
+    const uint8_t* p = as_bytes(data);
+    while (length-- > 0) {
+        crc ^= uint16_t(*p++) << 8;
+        for (uint8_t i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    return crc;
+}
+
+/**
+ * An append-only store of small values, each identified by a 16-bit key.
+ *
+ * Values are never overwritten in place. Each write appends a record with the
+ * key, the length and a CRC of the value to the newest page, so a write costs
+ * the size of the record instead of a page erase. When the pages run out,
+ * the oldest page is compacted: its live records are copied to the newest page
+ * and the page is erased. One page is always kept free for compaction.
+ *
+ * Each page starts with a header holding a sequence number, so the order of
+ * the pages is known after a reset. The index from key to record address is
+ * kept in RAM and is rebuilt by begin() with a single scan over the pages.
+ * A record with a CRC mismatch (an interrupted write) ends the scan of its
+ * page, the rest of that page is not used anymore.
+ *
+ * The flash device must allow destructive writes (AND semantics) without
+ * erasing, so use a plain region of flash, such as Devices::createUserFlashRegion()
+ * and not one of the eeprom emulations.
+ */
+class LogStore {
+public:
+    typedef uint16_t key_t;
+
+    /**
+     * Key value that is reserved to mark the end of the records in a page.
+     */
+    static const key_t END_KEY = 0xFFFF;
+
+    struct Statistics {
+        uint32_t appends;           // records appended by write() and remove()
+        uint32_t bytesRequested;    // value bytes passed to write()
+        uint32_t bytesWritten;      // bytes written to flash, including headers and relocated records
+        uint32_t pageErases;
+        uint32_t compactions;       // pages compacted
+        uint32_t recordsScanned;    // records read by the last begin()
+    };
+
+private:
+    static const uint32_t PAGE_MAGIC = 0x534C4642;    // "BFLS"
+    static const uint16_t TOMBSTONE = 0x8000;          // flag in the length of a record for a removed key
+    static const page_count_t NO_PAGE = page_count_t(-1);
+    static const uint32_t FREE_SEQUENCE = uint32_t(-1);
+
+    struct PageHeader {
+        uint32_t magic;
+        uint32_t sequence;
+    };
+
+    struct RecordHeader {
+        key_t key;
+        uint16_t length;
+        uint16_t crc;
+    };
+
+    struct Entry {
+        key_t key;
+        uint16_t length;
+        flash_addr_t address;   // address of the record header
+    };
+
+    FlashDevice& flash;
+    Entry* entries;             // sorted by key
+    uint16_t count;
+    const uint16_t maxKeys;
+    page_count_t pagesUsed;
+    page_count_t headPage;
+    page_size_t headOffset;
+    uint32_t headSequence;
+    flash_addr_t liveBytes;     // size of all live records, including their headers
+    Statistics stats;
+
+    static uint16_t recordCrc(key_t key, uint16_t length, const void* data, page_size_t dataLength) {
+        uint16_t crc = crc16ccitt(0xFFFF, &key, sizeof(key));
+        crc = crc16ccitt(crc, &length, sizeof(length));
+        return crc16ccitt(crc, data, dataLength);
+    }
+
+    static uint16_t valueLength(uint16_t length) {
+        return length & ~TOMBSTONE;
+    }
+
+    static page_size_t recordSize(uint16_t length) {
+        return sizeof(RecordHeader) + valueLength(length);
+    }
+
+    bool readPageHeader(page_count_t page, PageHeader& header) {
+        return flash.readPage(&header, flash.pageAddress(page), sizeof(header))
+            && header.magic == PAGE_MAGIC && header.sequence != FREE_SEQUENCE;
+    }
+
+    /**
+     * Finds the page in use with the lowest sequence number.
+     */
+    page_count_t oldestPage() {
+        page_count_t result = NO_PAGE;
+        uint32_t sequence = FREE_SEQUENCE;
+        PageHeader header;
+        for (page_count_t page = 0; page < flash.pageCount(); page++) {
+            if (readPageHeader(page, header) && header.sequence < sequence) {
+                result = page;
+                sequence = header.sequence;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Computes the CRC of a record as stored in flash.
+     */
+    uint16_t storedCrc(flash_addr_t address, const RecordHeader& header) {
+        uint8_t buf[STACK_BUFFER_SIZE];
+        uint16_t crc = crc16ccitt(0xFFFF, &header.key, sizeof(header.key));
+        crc = crc16ccitt(crc, &header.length, sizeof(header.length));
+        page_size_t length = valueLength(header.length);
+        address += sizeof(RecordHeader);
+        while (length > 0) {
+            page_size_t chunk = min(length, page_size_t(sizeof(buf)));
+            flash.readPage(buf, address, chunk);
+            crc = crc16ccitt(crc, buf, chunk);
+            address += chunk;
+            length -= chunk;
+        }
+        return crc;
+    }
+
+    int find(key_t key) const {
+        int low = 0, high = int(count) - 1;
+        while (low <= high) {
+            int mid = (low + high) / 2;
+            if (entries[mid].key == key)
+                return mid;
+            if (entries[mid].key < key)
+                low = mid + 1;
+            else
+                high = mid - 1;
+        }
+        return -(low + 1);
+    }
+
+    /**
+     * Points the index for the key to a record, or removes the key for a tombstone.
+     * @return false if the index is full.
+     */
+    bool index(key_t key, uint16_t length, flash_addr_t address) {
+        int i = find(key);
+        if (i >= 0) {
+            liveBytes -= recordSize(entries[i].length);
+            if (length & TOMBSTONE) {
+                memmove(entries + i, entries + i + 1, (count - i - 1) * sizeof(Entry));
+                count--;
+                return true;
+            }
+        }
+        else {
+            if (length & TOMBSTONE)
+                return true;
+            if (count == maxKeys)
+                return false;
+            i = -(i + 1);
+            memmove(entries + i + 1, entries + i, (count - i) * sizeof(Entry));
+            count++;
+        }
+        entries[i].key = key;
+        entries[i].length = length;
+        entries[i].address = address;
+        liveBytes += recordSize(length);
+        return true;
+    }
+
+    /**
+     * Reads the records of a page into the index.
+     * @param complete Set to false when a key did not fit in the index.
+     * @return The offset after the last valid record.
+     */
+    page_size_t scanPage(page_count_t page, bool& complete) {
+        flash_addr_t start = flash.pageAddress(page);
+        page_size_t offset = sizeof(PageHeader);
+        RecordHeader header;
+        while (offset + sizeof(RecordHeader) <= flash.pageSize()) {
+            flash_addr_t address = start + offset;
+            if (!flash.readPage(&header, address, sizeof(header)))
+                return flash.pageSize();
+            if (header.key == END_KEY && header.length == 0xFFFF && header.crc == 0xFFFF)
+                break;  // erased, end of the records in this page
+            if (offset + recordSize(header.length) > flash.pageSize() || header.key == END_KEY
+                || storedCrc(address, header) != header.crc)
+                return flash.pageSize();   // interrupted write, don't append after it
+            stats.recordsScanned++;
+            complete = index(header.key, header.length, address) && complete;
+            offset += recordSize(header.length);
+        }
+        return offset;
+    }
+
+    bool isErased(page_count_t page) {
+        uint8_t buf[STACK_BUFFER_SIZE];
+        flash_addr_t address = flash.pageAddress(page);
+        for (page_size_t offset = 0; offset < flash.pageSize(); offset += sizeof(buf)) {
+            page_size_t chunk = min(page_size_t(sizeof(buf)), flash.pageSize() - offset);
+            if (!flash.readPage(buf, address + offset, chunk))
+                return false;
+            for (page_size_t i = 0; i < chunk; i++) {
+                if (buf[i] != 0xFF)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool erasePage(page_count_t page) {
+        stats.pageErases++;
+        return flash.erasePage(flash.pageAddress(page));
+    }
+
+    /**
+     * Starts a new head page, after the current head page.
+     */
+    bool openPage() {
+        PageHeader header;
+        page_count_t pages = flash.pageCount();
+        page_count_t start = headPage == NO_PAGE ? 0 : headPage + 1;
+        for (page_count_t i = 0; i < pages; i++) {
+            page_count_t page = (start + i) % pages;
+            if (readPageHeader(page, header))
+                continue;
+            if (!isErased(page) && !erasePage(page))
+                return false;
+            header.magic = PAGE_MAGIC;
+            header.sequence = ++headSequence;
+            if (!flash.writePage(&header, flash.pageAddress(page), sizeof(header)))
+                return false;
+            stats.bytesWritten += sizeof(header);
+            headPage = page;
+            headOffset = sizeof(header);
+            pagesUsed++;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Makes sure the head page has room for a record of the given size.
+     * @param keepSpare When true, the last free page is not used, but pages are compacted instead.
+     */
+    bool reserve(page_size_t size, bool keepSpare) {
+        page_count_t attempts = flash.pageCount();
+        while (headPage == NO_PAGE || headOffset + size > flash.pageSize()) {
+            if (freePages() > (keepSpare ? 1 : 0)) {
+                if (!openPage())
+                    return false;
+            }
+            else if (!keepSpare || !attempts-- || !compactPage(oldestPage())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Copies a record to the head page.
+     */
+    bool relocate(Entry& entry) {
+        uint8_t buf[STACK_BUFFER_SIZE];
+        page_size_t size = recordSize(entry.length);
+        if (!reserve(size, false))
+            return false;
+        flash_addr_t target = flash.pageAddress(headPage) + headOffset;
+        for (page_size_t offset = 0; offset < size; offset += sizeof(buf)) {
+            page_size_t chunk = min(page_size_t(sizeof(buf)), size - offset);
+            if (!flash.readPage(buf, entry.address + offset, chunk) || !flash.writePage(buf, target + offset, chunk))
+                return false;
+        }
+        stats.bytesWritten += size;
+        entry.address = target;
+        headOffset += size;
+        return true;
+    }
+
+    /**
+     * Moves the live records of a page to the head page and erases the page.
+     */
+    bool compactPage(page_count_t page) {
+        if (page == NO_PAGE)
+            return false;
+        if (page == headPage) {
+            if (freePages() == 0)
+                return false;
+            headOffset = flash.pageSize();  // relocated records go to a new page
+        }
+        for (uint16_t i = 0; i < count; i++) {
+            if (flash.addressPage(entries[i].address) == page && !relocate(entries[i]))
+                return false;
+        }
+        if (!erasePage(page))
+            return false;
+        pagesUsed--;
+        stats.compactions++;
+        return true;
+    }
+
+    bool append(key_t key, uint16_t length, const void* data) {
+        RecordHeader header;
+        header.key = key;
+        header.length = length;
+        header.crc = recordCrc(key, length, data, valueLength(length));
+        page_size_t size = recordSize(length);
+        if (!reserve(size, true))
+            return false;
+        flash_addr_t address = flash.pageAddress(headPage) + headOffset;
+        if (!flash.writePage(&header, address, sizeof(header))
+            || (valueLength(length) && !flash.writePage(data, address + sizeof(header), valueLength(length))))
+            return false;
+        headOffset += size;
+        stats.appends++;
+        stats.bytesWritten += size;
+        return index(key, length, address);
+    }
+
+    bool sameValue(const Entry& entry, const void* data, uint16_t length) {
+        uint8_t buf[STACK_BUFFER_SIZE];
+        if (entry.length != length)
+            return false;
+        const uint8_t* p = as_bytes(data);
+        flash_addr_t address = entry.address + sizeof(RecordHeader);
+        for (page_size_t offset = 0; offset < length; offset += sizeof(buf)) {
+            page_size_t chunk = min(page_size_t(sizeof(buf)), page_size_t(length - offset));
+            if (!flash.readPage(buf, address + offset, chunk) || memcmp(buf, p + offset, chunk))
+                return false;
+        }
+        return true;
+    }
+
+public:
+
+    LogStore(FlashDevice& storage, uint16_t maxKeys_ = 32)
+    : flash(storage), entries(new Entry[maxKeys_]), count(0), maxKeys(maxKeys_) {
+        memset(&stats, 0, sizeof(stats));
+        reset();
+    }
+
+    ~LogStore() {
+        delete[] entries;
+    }
+
+    /**
+     * Builds the index from the records in flash. Pages are scanned from the
+     * oldest to the newest, so later records replace earlier ones.
+     * @return false when the device has less than 3 pages or the index overflowed.
+     */
+    bool begin() {
+        reset();
+        stats.recordsScanned = 0;
+        if (flash.pageCount() < 3)
+            return false;
+        // read each page header once, then scan the pages in order of their sequence number
+        page_count_t pages = flash.pageCount();
+        uint32_t* sequences = new uint32_t[pages];
+        PageHeader header;
+        for (page_count_t page = 0; page < pages; page++) {
+            sequences[page] = readPageHeader(page, header) ? header.sequence : FREE_SEQUENCE;
+        }
+        bool complete = true;
+        for (;;) {
+            page_count_t page = NO_PAGE;
+            for (page_count_t i = 0; i < pages; i++) {
+                if (sequences[i] != FREE_SEQUENCE && (page == NO_PAGE || sequences[i] < sequences[page]))
+                    page = i;
+            }
+            if (page == NO_PAGE)
+                break;
+            headPage = page;
+            headSequence = sequences[page];
+            headOffset = scanPage(page, complete);
+            pagesUsed++;
+            sequences[page] = FREE_SEQUENCE;
+        }
+        delete[] sequences;
+        return complete;
+    }
+
+    /**
+     * Stores a value. Nothing is written when the value is the same as the stored value.
+     * @return false if the value is too large, the index is full or the store has no free space.
+     */
+    bool write(key_t key, const void* data, uint16_t length) {
+        if (key == END_KEY || length > maxValueSize())
+            return false;
+        int i = find(key);
+        if (i >= 0 && sameValue(entries[i], data, length))
+            return true;
+        flash_addr_t live = liveBytes - (i >= 0 ? recordSize(entries[i].length) : 0) + recordSize(length);
+        if (live > capacity())
+            return false;
+        stats.bytesRequested += length;
+        return append(key, length, data);
+    }
+
+    /**
+     * Reads up to {@code length} bytes of a value.
+     * @return false if the key is not stored.
+     */
+    bool read(key_t key, void* data, uint16_t length) {
+        int i = find(key);
+        if (i < 0)
+            return false;
+        return flash.readPage(data, entries[i].address + sizeof(RecordHeader), min(length, entries[i].length));
+    }
+
+    /**
+     * Removes a key by appending a tombstone record.
+     */
+    bool remove(key_t key) {
+        if (find(key) < 0)
+            return true;
+        return append(key, TOMBSTONE, NULL);
+    }
+
+    bool contains(key_t key) const {
+        return find(key) >= 0;
+    }
+
+    /**
+     * @return The length of the stored value, or 0 if the key is not stored.
+     */
+    uint16_t valueSize(key_t key) const {
+        int i = find(key);
+        return i < 0 ? 0 : entries[i].length;
+    }
+
+    /**
+     * The number of keys stored. keyAt() enumerates them in ascending order.
+     */
+    uint16_t size() const {
+        return count;
+    }
+
+    key_t keyAt(uint16_t i) const {
+        return entries[i].key;
+    }
+
+    /**
+     * Compacts the oldest page when only the spare page is free, so a later
+     * write does not have to wait for compaction. Call this when idle.
+     * @return true if a page was compacted.
+     */
+    bool compact() {
+        return freePages() <= 1 && pagesUsed > 1 && compactPage(oldestPage());
+    }
+
+    /**
+     * Erases all pages and clears the index.
+     */
+    bool clear() {
+        bool success = true;
+        for (page_count_t page = 0; page < flash.pageCount(); page++) {
+            success = erasePage(page) && success;
+        }
+        reset();
+        return success;
+    }
+
+    page_count_t freePages() const {
+        return flash.pageCount() - pagesUsed;
+    }
+
+    /**
+     * @return false when begin() found no pages of a log store, because the flash is erased or holds other data.
+     */
+    bool hasPages() const {
+        return pagesUsed > 0;
+    }
+
+    /**
+     * The total size of the live records (values plus headers) that can be stored.
+     * Two pages are not counted: the spare page and slack in the pages being compacted.
+     */
+    flash_addr_t capacity() const {
+        page_count_t pages = flash.pageCount();
+        return pages < 3 ? 0 : (pages - 2) * (flash.pageSize() - sizeof(PageHeader));
+    }
+
+    flash_addr_t used() const {
+        return liveBytes;
+    }
+
+    uint16_t maxValueSize() const {
+        page_size_t size = flash.pageSize() - sizeof(PageHeader) - sizeof(RecordHeader);
+        return size < TOMBSTONE ? size : TOMBSTONE - 1;
+    }
+
+    const Statistics& statistics() const {
+        return stats;
+    }
+
+private:
+    void reset() {
+        count = 0;
+        pagesUsed = 0;
+        headPage = NO_PAGE;
+        headOffset = 0;
+        headSequence = 0;
+        liveBytes = 0;
+    }
+};
+
+/**
+ * A ring of variable size blocks that keeps the newest data, for a data log.
+ *
+ * Blocks are appended to the newest page. When it is full, the next page is
+ * erased and becomes the newest page, so the oldest page is overwritten.
+ * Each page starts with a header holding a sequence number and each block has
+ * a header with its length, a tag and a CRC over the tag and the data. Tags
+ * must not decrease, for example the number of the block, so seek() finds a
+ * block with a binary search over the pages.
+ *
+ * begin() finds the newest page from the page headers and the end of its
+ * blocks, so appending continues after a reset. A block with a CRC mismatch
+ * (an interrupted write) ends its page, like in LogStore.
+ *
+ * The flash device must allow destructive writes (AND semantics) without
+ * erasing, such as a region created with Devices::createUserFlashRegion().
+ */
+class BlockRing {
+public:
+    static const uint32_t NO_TAG = uint32_t(-1);
+
+    /**
+     * Position of a reader in the ring. The page sequence number detects that
+     * the page was overwritten while the reader was behind.
+     */
+    struct Cursor {
+        page_count_t page;
+        page_size_t offset;
+        uint32_t sequence;
+    };
+
+private:
+    static const uint32_t PAGE_MAGIC = 0x52424642;    // "BFBR"
+    static const page_count_t NO_PAGE = page_count_t(-1);
+    static const uint16_t END_LENGTH = 0xFFFF;         // erased flash after the last block
+
+    struct PageHeader {
+        uint32_t magic;
+        uint32_t sequence;
+    };
+
+    struct BlockHeader {
+        uint16_t length;
+        uint16_t crc;
+        uint32_t tag;
+    };
+
+    FlashDevice& flash;
+    page_count_t headPage;
+    page_size_t headOffset;
+    uint32_t headSequence;
+    page_count_t pagesUsed;
+    uint32_t newestTag;
+
+    bool readPageHeader(page_count_t page, PageHeader& header) const {
+        return flash.readPage(&header, flash.pageAddress(page), sizeof(header))
+            && header.magic == PAGE_MAGIC && header.sequence != uint32_t(-1);
+    }
+
+    /**
+     * Reads the header of the block at an offset in a page.
+     * @return false at the end of the blocks in the page.
+     */
+    bool readBlockHeader(page_count_t page, page_size_t offset, BlockHeader& header) const {
+        if (offset + sizeof(BlockHeader) > flash.pageSize())
+            return false;
+        return flash.readPage(&header, flash.pageAddress(page) + offset, sizeof(header))
+            && header.length != END_LENGTH
+            && offset + sizeof(BlockHeader) + header.length <= flash.pageSize();
+    }
+
+    static uint16_t blockCrc(const BlockHeader& header, const void* data) {
+        return crc16ccitt(crc16ccitt(0xFFFF, &header.tag, sizeof(header.tag)), data, header.length);
+    }
+
+    /**
+     * Checks the CRC of a block as stored in flash.
+     */
+    bool validBlock(page_count_t page, page_size_t offset, const BlockHeader& header) const {
+        uint8_t buf[STACK_BUFFER_SIZE];
+        uint16_t crc = crc16ccitt(0xFFFF, &header.tag, sizeof(header.tag));
+        flash_addr_t address = flash.pageAddress(page) + offset + sizeof(BlockHeader);
+        for (page_size_t done = 0; done < header.length; done += sizeof(buf)) {
+            page_size_t chunk = min(page_size_t(sizeof(buf)), page_size_t(header.length - done));
+            if (!flash.readPage(buf, address + done, chunk))
+                return false;
+            crc = crc16ccitt(crc, buf, chunk);
+        }
+        return crc == header.crc;
+    }
+
+    /**
+     * Finds the end of the valid blocks in a page.
+     * @param tag Set to the tag of the last valid block, unchanged when the page has no blocks.
+     */
+    page_size_t scanPage(page_count_t page, uint32_t& tag) const {
+        page_size_t offset = sizeof(PageHeader);
+        BlockHeader header;
+        while (readBlockHeader(page, offset, header) && validBlock(page, offset, header)) {
+            tag = header.tag;
+            offset += sizeof(BlockHeader) + header.length;
+        }
+        return offset;
+    }
+
+    page_count_t nextPage(page_count_t page) const {
+        return (page + 1) % flash.pageCount();
+    }
+
+    /**
+     * Checks that there is room for a block header at an offset that was not written.
+     */
+    bool isErased(page_count_t page, page_size_t offset) const {
+        uint8_t buf[sizeof(BlockHeader)];
+        page_size_t length = min(page_size_t(sizeof(buf)), page_size_t(flash.pageSize() - offset));
+        if (!flash.readPage(buf, flash.pageAddress(page) + offset, length))
+            return false;
+        for (page_size_t i = 0; i < length; i++) {
+            if (buf[i] != 0xFF)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * The pages in use are consecutive and end at the head page.
+     */
+    page_count_t oldestPage() const {
+        page_count_t pages = flash.pageCount();
+        return (headPage + pages + 1 - pagesUsed) % pages;
+    }
+
+    /**
+     * Erases the page after the head page, which drops the oldest page when all pages are in use,
+     * and makes it the head page.
+     */
+    bool openPage() {
+        page_count_t page = headPage == NO_PAGE ? 0 : nextPage(headPage);
+        PageHeader header;
+        if (readPageHeader(page, header))
+            pagesUsed--;
+        if (!flash.erasePage(flash.pageAddress(page)))
+            return false;
+        header.magic = PAGE_MAGIC;
+        header.sequence = ++headSequence;
+        if (!flash.writePage(&header, flash.pageAddress(page), sizeof(header)))
+            return false;
+        headPage = page;
+        headOffset = sizeof(PageHeader);
+        pagesUsed++;
+        return true;
+    }
+
+    /**
+     * Moves a cursor to the next page, if that page follows the page of the cursor.
+     */
+    bool advance(Cursor& cursor) const {
+        if (cursor.page == headPage)
+            return false;
+        PageHeader header;
+        page_count_t page = nextPage(cursor.page);
+        if (!readPageHeader(page, header) || header.sequence != cursor.sequence + 1)
+            return false;
+        cursor.page = page;
+        cursor.offset = sizeof(PageHeader);
+        cursor.sequence = header.sequence;
+        return true;
+    }
+
+    void reset() {
+        headPage = NO_PAGE;
+        headOffset = 0;
+        headSequence = 0;
+        pagesUsed = 0;
+        newestTag = NO_TAG;
+    }
+
+public:
+
+    BlockRing(FlashDevice& storage) : flash(storage) {
+        reset();
+    }
+
+    /**
+     * Finds the newest page and the end of its blocks.
+     * @return false when the device has less than 2 pages.
+     */
+    bool begin() {
+        reset();
+        if (flash.pageCount() < 2)
+            return false;
+        PageHeader header;
+        for (page_count_t page = 0; page < flash.pageCount(); page++) {
+            if (!readPageHeader(page, header))
+                continue;
+            pagesUsed++;
+            if (headPage == NO_PAGE || header.sequence > headSequence) {
+                headPage = page;
+                headSequence = header.sequence;
+            }
+        }
+        if (headPage == NO_PAGE)
+            return true;
+        headOffset = scanPage(headPage, newestTag);
+        if (!isErased(headPage, headOffset))
+            headOffset = flash.pageSize(); // an interrupted write, continue in the next page
+        if (newestTag == NO_TAG && pagesUsed > 1) {
+            // the newest page has no blocks yet, the newest tag is in the page before it
+            page_count_t previous = (headPage + flash.pageCount() - 1) % flash.pageCount();
+            scanPage(previous, newestTag);
+        }
+        return true;
+    }
+
+    /**
+     * Appends a block. Opens a new page when the block does not fit in the head page.
+     * @return false when the block is larger than maxBlockSize() or writing failed.
+     */
+    bool append(uint32_t tag, const void* data, uint16_t length) {
+        if (length > maxBlockSize() || tag == NO_TAG)
+            return false;
+        page_size_t size = sizeof(BlockHeader) + length;
+        if ((headPage == NO_PAGE || headOffset + size > flash.pageSize()) && !openPage())
+            return false;
+        BlockHeader header;
+        header.length = length;
+        header.tag = tag;
+        header.crc = blockCrc(header, data);
+        flash_addr_t address = flash.pageAddress(headPage) + headOffset;
+        if (!flash.writePage(&header, address, sizeof(header))
+            || (length && !flash.writePage(data, address + sizeof(header), length)))
+            return false;
+        headOffset += size;
+        newestTag = tag;
+        return true;
+    }
+
+    /**
+     * Positions a cursor at the first block with a tag of at least {@code tag}.
+     * @return false when the ring is empty.
+     */
+    bool seek(Cursor& cursor, uint32_t tag) const {
+        if (headPage == NO_PAGE)
+            return false;
+        // binary search for the last page that starts with a tag up to the tag searched for
+        page_count_t oldest = oldestPage();
+        page_count_t found = 0;
+        int low = 1, high = int(pagesUsed) - 1;
+        BlockHeader header;
+        while (low <= high) {
+            int mid = (low + high) / 2;
+            page_count_t page = (oldest + mid) % flash.pageCount();
+            if (readBlockHeader(page, sizeof(PageHeader), header) && header.tag <= tag) {
+                found = mid;
+                low = mid + 1;
+            }
+            else {
+                high = mid - 1;
+            }
+        }
+        PageHeader pageHeader;
+        cursor.page = (oldest + found) % flash.pageCount();
+        cursor.offset = sizeof(PageHeader);
+        cursor.sequence = readPageHeader(cursor.page, pageHeader) ? pageHeader.sequence : 0;
+
+        // skip the blocks before the tag
+        for (;;) {
+            if (!readBlockHeader(cursor.page, cursor.offset, header)) {
+                if (!advance(cursor))
+                    return true;
+                continue;
+            }
+            if (header.tag >= tag)
+                return true;
+            cursor.offset += sizeof(BlockHeader) + header.length;
+        }
+    }
+
+    /**
+     * Reads the block at a cursor and moves the cursor to the next block.
+     * @param maxLength The size of {@code data}. A larger block is skipped.
+     * @return The length of the block, or -1 when there are no more blocks
+     *  or the page of the cursor was overwritten. Seek again by tag in that case.
+     */
+    int read(Cursor& cursor, uint32_t& tag, void* data, uint16_t maxLength) const {
+        PageHeader pageHeader;
+        BlockHeader header;
+        for (;;) {
+            if (!readPageHeader(cursor.page, pageHeader) || pageHeader.sequence != cursor.sequence)
+                return -1;
+            if (!readBlockHeader(cursor.page, cursor.offset, header)) {
+                if (!advance(cursor))
+                    return -1;
+                continue;
+            }
+            flash_addr_t address = flash.pageAddress(cursor.page) + cursor.offset + sizeof(BlockHeader);
+            if (header.length > maxLength) {
+                cursor.offset += sizeof(BlockHeader) + header.length;
+                continue;
+            }
+            if (!flash.readPage(data, address, header.length) || blockCrc(header, data) != header.crc) {
+                // an interrupted write ends the page
+                if (!advance(cursor))
+                    return -1;
+                continue;
+            }
+            cursor.offset += sizeof(BlockHeader) + header.length;
+            tag = header.tag;
+            return header.length;
+        }
+    }
+
+    /**
+     * The tag of the newest block, NO_TAG when the ring is empty.
+     */
+    uint32_t lastTag() const {
+        return newestTag;
+    }
+
+    page_count_t usedPages() const {
+        return pagesUsed;
+    }
+
+    uint16_t maxBlockSize() const {
+        return flash.pageSize() - sizeof(PageHeader) - sizeof(BlockHeader);
+    }
+
+    /**
+     * Erases all pages.
+     */
+    bool clear() {
+        bool success = true;
+        for (page_count_t page = 0; page < flash.pageCount(); page++) {
+            success = flash.erasePage(flash.pageAddress(page)) && success;
+        }
+        reset();
+        return success;
+    }
+};
+
 class FlashStream {
 
 protected:
@@ -585,6 +1443,29 @@ Must align on a page boundary.
         FlashDevice* device = createUserFlashRegion(startAddress, endAddress, 2);
         return device ? new CircularBuffer(*device) : NULL;
     }
+
+    /**
+     * Creates a log structured key/value store that uses the pages given for storage.
+     * At least 3 pages are needed. The records are not indexed until LogStore::begin() is called.
+     */
+    static LogStore* createLogStore(flash_addr_t startAddress, flash_addr_t endAddress, uint16_t maxKeys = 32) {
+        FlashDevice* device = createUserFlashRegion(startAddress, endAddress, 3);
+        return device ? new LogStore(*device, maxKeys) : NULL;
+    }
+
+    /**
+     * Creates a ring of blocks that overwrites its oldest page when full, for
+     * data logs. See BlockRing.
+     * The returned ring has begin() called already.
+     */
+    static BlockRing* createBlockRing(flash_addr_t startAddress, flash_addr_t endAddress) {
+        FlashDevice* device = createUserFlashRegion(startAddress, endAddress, 2);
+        if (!device)
+            return NULL;
+        BlockRing* ring = new BlockRing(*device);
+        ring->begin();
+        return ring;
+    }
         
     /** 
      * Allocates a region of flash for storing a FAT filesystem. If an existing filesystem
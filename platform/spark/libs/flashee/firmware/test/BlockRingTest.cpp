@@ -0,0 +1,196 @@
+/**
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "flashee-eeprom.h"
+
+using namespace Flashee;
+
+class BlockRingTest : public ::testing::Test {
+
+    protected:
+        FakeFlashDevice base;
+        BlockRing sut;
+
+        /**
+         * Appends a block of 50 bytes, filled with the low byte of the tag.
+         */
+        void appendBlock(BlockRing& ring, uint32_t tag) {
+            uint8_t data[50];
+            memset(data, uint8_t(tag), sizeof(data));
+            ASSERT_TRUE(ring.append(tag, data, sizeof(data)));
+        }
+
+        /**
+         * Reads all blocks from a tag and checks that the tags are consecutive.
+         * @return the number of blocks read
+         */
+        uint32_t readFrom(BlockRing& ring, uint32_t tag, uint32_t& first) {
+            BlockRing::Cursor cursor;
+            uint8_t data[64];
+            uint32_t count = 0;
+            if (!ring.seek(cursor, tag))
+                return 0;
+            uint32_t readTag;
+            int length;
+            while ((length = ring.read(cursor, readTag, data, sizeof(data))) >= 0) {
+                EXPECT_EQ(50, length);
+                EXPECT_EQ(uint8_t(readTag), data[49]);
+                if (count == 0)
+                    first = readTag;
+                else
+                    EXPECT_EQ(first + count, readTag);
+                count++;
+            }
+            return count;
+        }
+
+    public:
+        // 8 pages of 256 bytes, 4 blocks of 58 bytes fit in a page
+        BlockRingTest() : base(8, 256), sut(base) {
+            base.eraseAll();
+            sut.begin();
+        }
+};
+
+TEST_F(BlockRingTest, EmptyRingHasNoBlocks) {
+    BlockRing::Cursor cursor;
+    EXPECT_FALSE(sut.seek(cursor, 0));
+    EXPECT_EQ(uint32_t(BlockRing::NO_TAG), sut.lastTag());
+    EXPECT_EQ(0, sut.usedPages());
+}
+
+TEST_F(BlockRingTest, BlocksAreReadInOrder) {
+    for (uint32_t tag = 1; tag <= 10; tag++) {
+        appendBlock(sut, tag);
+    }
+    uint32_t first = 0;
+    EXPECT_EQ(10, readFrom(sut, 0, first));
+    EXPECT_EQ(1, first);
+    EXPECT_EQ(10, sut.lastTag());
+    EXPECT_EQ(3, sut.usedPages());
+}
+
+TEST_F(BlockRingTest, SeekFindsFirstBlockWithTag) {
+    for (uint32_t tag = 1; tag <= 20; tag++) {
+        appendBlock(sut, tag);
+    }
+    uint32_t first = 0;
+    EXPECT_EQ(8, readFrom(sut, 13, first));
+    EXPECT_EQ(13, first);
+    EXPECT_EQ(1, readFrom(sut, 20, first));
+    EXPECT_EQ(0, readFrom(sut, 21, first));
+}
+
+TEST_F(BlockRingTest, OldestPageIsOverwrittenWhenFull) {
+    for (uint32_t tag = 1; tag <= 100; tag++) {
+        appendBlock(sut, tag);
+    }
+    uint32_t first = 0;
+    uint32_t count = readFrom(sut, 0, first);
+    EXPECT_EQ(8, sut.usedPages());
+    EXPECT_EQ(100, first + count - 1); // newest block is kept
+    EXPECT_GE(count, 7 * 4u);          // all pages except the one being filled hold 4 blocks
+    EXPECT_EQ(count, readFrom(sut, 1, first)); // seeking a lost tag starts at the oldest block
+}
+
+TEST_F(BlockRingTest, AppendingContinuesAfterReset) {
+    for (uint32_t tag = 1; tag <= 37; tag++) {
+        appendBlock(sut, tag);
+    }
+    BlockRing restored(base);
+    ASSERT_TRUE(restored.begin());
+    EXPECT_EQ(37, restored.lastTag());
+    for (uint32_t tag = 38; tag <= 45; tag++) {
+        appendBlock(restored, tag);
+    }
+    uint32_t first = 0;
+    uint32_t count = readFrom(restored, 0, first);
+    EXPECT_EQ(45, first + count - 1);
+}
+
+TEST_F(BlockRingTest, LastTagIsFoundWhenNewestPageIsEmpty) {
+    for (uint32_t tag = 1; tag <= 4; tag++) {
+        appendBlock(sut, tag); // fills the first page exactly
+    }
+    appendBlock(sut, 5);
+    BlockRing restored(base);
+    ASSERT_TRUE(restored.begin());
+    EXPECT_EQ(5, restored.lastTag());
+}
+
+TEST_F(BlockRingTest, InterruptedWriteEndsThePage) {
+    appendBlock(sut, 1);
+    appendBlock(sut, 2);
+    // corrupt the data of the second block, as if the write was interrupted
+    uint8_t zero = 0;
+    base.writePage(&zero, 8 + 58 + 8 + 10, 1);
+
+    BlockRing restored(base);
+    ASSERT_TRUE(restored.begin());
+    EXPECT_EQ(1, restored.lastTag());
+    appendBlock(restored, 3); // goes to the next page
+
+    uint32_t first = 0;
+    BlockRing::Cursor cursor;
+    ASSERT_TRUE(restored.seek(cursor, 0));
+    uint8_t data[64];
+    uint32_t tag;
+    EXPECT_EQ(50, restored.read(cursor, tag, data, sizeof(data)));
+    EXPECT_EQ(1, tag);
+    EXPECT_EQ(50, restored.read(cursor, tag, data, sizeof(data)));
+    EXPECT_EQ(3, tag);
+    EXPECT_EQ(-1, restored.read(cursor, tag, data, sizeof(data)));
+    EXPECT_EQ(1, readFrom(restored, 2, first)); // the lost block is skipped
+    EXPECT_EQ(3, first);
+}
+
+TEST_F(BlockRingTest, ReaderDetectsOverwrittenPage) {
+    for (uint32_t tag = 1; tag <= 4; tag++) {
+        appendBlock(sut, tag);
+    }
+    BlockRing::Cursor cursor;
+    ASSERT_TRUE(sut.seek(cursor, 1));
+    for (uint32_t tag = 5; tag <= 40; tag++) {
+        appendBlock(sut, tag); // wraps around and overwrites the first page
+    }
+    uint8_t data[64];
+    uint32_t tag;
+    EXPECT_EQ(-1, sut.read(cursor, tag, data, sizeof(data)));
+}
+
+TEST_F(BlockRingTest, ReaderFollowsAppendedBlocks) {
+    appendBlock(sut, 1);
+    BlockRing::Cursor cursor;
+    ASSERT_TRUE(sut.seek(cursor, 0));
+    uint8_t data[64];
+    uint32_t tag;
+    EXPECT_EQ(50, sut.read(cursor, tag, data, sizeof(data)));
+    EXPECT_EQ(-1, sut.read(cursor, tag, data, sizeof(data)));
+    for (uint32_t next = 2; next <= 6; next++) {
+        appendBlock(sut, next);
+        EXPECT_EQ(50, sut.read(cursor, tag, data, sizeof(data)));
+        EXPECT_EQ(next, tag);
+    }
+}
+
+TEST_F(BlockRingTest, TooLargeBlockIsRejected) {
+    uint8_t data[256];
+    EXPECT_EQ(256 - 8 - 8, sut.maxBlockSize());
+    EXPECT_FALSE(sut.append(1, data, sut.maxBlockSize() + 1));
+    EXPECT_TRUE(sut.append(1, data, sut.maxBlockSize()));
+}
@@ -0,0 +1,245 @@
+/**
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "flashee-eeprom.h"
+
+using namespace Flashee;
+
+class LogStoreTest : public ::testing::Test {
+
+    protected:
+        FakeFlashDevice base;
+        LogStore sut;
+
+        /**
+         * Simulates a reset: a new store indexes the same flash.
+         */
+        void reopen(LogStore& store) {
+            ASSERT_TRUE(store.begin());
+        }
+
+        uint32_t readValue(LogStore& store, LogStore::key_t key) {
+            uint32_t value = 0;
+            EXPECT_TRUE(store.read(key, &value, sizeof(value)));
+            return value;
+        }
+
+    public:
+        LogStoreTest() : base(8, 256), sut(base, 16) {
+            base.eraseAll();
+            sut.begin();
+        }
+};
+
+TEST_F(LogStoreTest, EmptyStoreHasNoKeys) {
+    uint8_t buf[4];
+    EXPECT_EQ(0, sut.size());
+    EXPECT_FALSE(sut.contains(1));
+    EXPECT_FALSE(sut.read(1, buf, sizeof(buf)));
+    EXPECT_EQ(8, sut.freePages());
+}
+
+TEST_F(LogStoreTest, CanReadWrittenValue) {
+    uint32_t value = 0x12345678;
+    ASSERT_TRUE(sut.write(5, &value, sizeof(value)));
+    EXPECT_TRUE(sut.contains(5));
+    EXPECT_EQ(sizeof(value), sut.valueSize(5));
+    EXPECT_EQ(0x12345678, readValue(sut, 5));
+}
+
+TEST_F(LogStoreTest, KeysAreEnumeratedInOrder) {
+    uint8_t value = 0;
+    sut.write(30, &value, 1);
+    sut.write(10, &value, 1);
+    sut.write(20, &value, 1);
+    ASSERT_EQ(3, sut.size());
+    EXPECT_EQ(10, sut.keyAt(0));
+    EXPECT_EQ(20, sut.keyAt(1));
+    EXPECT_EQ(30, sut.keyAt(2));
+}
+
+TEST_F(LogStoreTest, WritingTheSameValueDoesNotAppend) {
+    uint32_t value = 7;
+    sut.write(1, &value, sizeof(value));
+    uint32_t written = sut.statistics().bytesWritten;
+    ASSERT_TRUE(sut.write(1, &value, sizeof(value)));
+    EXPECT_EQ(1, sut.statistics().appends);
+    EXPECT_EQ(written, sut.statistics().bytesWritten);
+}
+
+TEST_F(LogStoreTest, ValuesAreRestoredByScan) {
+    for (uint32_t i = 0; i < 10; i++) {
+        uint32_t value = i * 100;
+        sut.write(i, &value, sizeof(value));
+        value++;
+        sut.write(i, &value, sizeof(value)); // the latest value wins
+    }
+    LogStore restored(base, 16);
+    reopen(restored);
+    ASSERT_EQ(10, restored.size());
+    for (uint32_t i = 0; i < 10; i++) {
+        EXPECT_EQ(i * 100 + 1, readValue(restored, i));
+    }
+    EXPECT_EQ(20, restored.statistics().recordsScanned);
+    EXPECT_EQ(sut.used(), restored.used());
+}
+
+TEST_F(LogStoreTest, RemovedKeysStayRemovedAfterScan) {
+    uint32_t value = 1;
+    sut.write(1, &value, sizeof(value));
+    sut.write(2, &value, sizeof(value));
+    ASSERT_TRUE(sut.remove(1));
+    EXPECT_FALSE(sut.contains(1));
+
+    LogStore restored(base, 16);
+    reopen(restored);
+    EXPECT_FALSE(restored.contains(1));
+    EXPECT_TRUE(restored.contains(2));
+}
+
+TEST_F(LogStoreTest, RejectsValuesLargerThanAPage) {
+    uint8_t buf[256] = { 0 };
+    EXPECT_FALSE(sut.write(1, buf, sut.maxValueSize() + 1));
+    EXPECT_TRUE(sut.write(1, buf, sut.maxValueSize()));
+}
+
+TEST_F(LogStoreTest, RejectsNewKeysWhenIndexIsFull) {
+    uint8_t value = 0;
+    for (LogStore::key_t key = 0; key < 16; key++) {
+        ASSERT_TRUE(sut.write(key, &value, 1));
+    }
+    EXPECT_FALSE(sut.write(16, &value, 1));
+    value = 1;
+    EXPECT_TRUE(sut.write(15, &value, 1)) << "existing keys can still be updated";
+}
+
+TEST_F(LogStoreTest, RejectsWritesBeyondCapacity) {
+    uint8_t buf[200] = { 0 };
+    LogStore::key_t key = 0;
+    while (sut.write(key, buf, sizeof(buf))) {
+        key++;
+    }
+    EXPECT_LE(sut.used(), sut.capacity());
+    EXPECT_GE(key, 5);
+    for (LogStore::key_t k = 0; k < key; k++) {
+        EXPECT_TRUE(sut.contains(k));
+    }
+}
+
+TEST_F(LogStoreTest, CompactionKeepsLatestValues) {
+    uint32_t values[12];
+    for (uint32_t round = 0; round < 200; round++) {
+        for (uint32_t key = 0; key < 12; key++) {
+            values[key] = round * 1000 + key;
+            ASSERT_TRUE(sut.write(key, &values[key], sizeof(values[key])));
+        }
+        ASSERT_GE(sut.freePages(), 1) << "the spare page must stay free";
+    }
+    EXPECT_GT(sut.statistics().compactions, 0);
+    for (uint32_t key = 0; key < 12; key++) {
+        EXPECT_EQ(values[key], readValue(sut, key));
+    }
+
+    LogStore restored(base, 16);
+    reopen(restored);
+    ASSERT_EQ(12, restored.size());
+    for (uint32_t key = 0; key < 12; key++) {
+        EXPECT_EQ(values[key], readValue(restored, key));
+    }
+}
+
+TEST_F(LogStoreTest, BackgroundCompactionFreesPages) {
+    uint32_t value = 0;
+    while (sut.freePages() > 1) {
+        value++;
+        sut.write(value % 4, &value, sizeof(value));
+    }
+    uint32_t erases = sut.statistics().pageErases;
+    EXPECT_TRUE(sut.compact());
+    EXPECT_EQ(2, sut.freePages());
+    EXPECT_EQ(erases + 1, sut.statistics().pageErases);
+    EXPECT_FALSE(sut.compact()) << "nothing to do when more than the spare page is free";
+    EXPECT_EQ(value, readValue(sut, value % 4));
+}
+
+TEST_F(LogStoreTest, InterruptedWriteIsIgnored) {
+    uint32_t value = 1;
+    sut.write(1, &value, sizeof(value));
+    value = 2;
+    sut.write(1, &value, sizeof(value));
+
+    // clear bits in the value of the second record, as if power failed while writing it
+    uint8_t zero = 0;
+    base.writePage(&zero, 8 + (6 + sizeof(value)) + 6, 1);
+
+    LogStore restored(base, 16);
+    reopen(restored);
+    EXPECT_EQ(1, readValue(restored, 1));
+
+    // new records are not appended after the damaged record
+    value = 3;
+    ASSERT_TRUE(restored.write(1, &value, sizeof(value)));
+    LogStore again(base, 16);
+    reopen(again);
+    EXPECT_EQ(3, readValue(again, 1));
+}
+
+TEST_F(LogStoreTest, FlashWithOtherDataHasNoPages) {
+    EXPECT_FALSE(sut.hasPages());
+
+    // data stored by another scheme, without the page header of a log store
+    uint8_t other[16];
+    memset(other, 0x5A, sizeof(other));
+    base.writePage(other, 0, sizeof(other));
+    LogStore foreign(base, 16);
+    ASSERT_TRUE(foreign.begin());
+    EXPECT_FALSE(foreign.hasPages());
+    EXPECT_EQ(0, foreign.size());
+
+    base.eraseAll();
+    uint32_t value = 1;
+    sut.begin();
+    ASSERT_TRUE(sut.write(1, &value, sizeof(value)));
+    LogStore restored(base, 16);
+    reopen(restored);
+    EXPECT_TRUE(restored.hasPages());
+}
+
+TEST(LogStore, WriteAmplificationIsLow) {
+    // 4 KB pages, like the external flash of the Spark Core
+    FakeFlashDevice flash(8, 4096);
+    flash.eraseAll();
+    LogStore store(flash);
+    store.begin();
+
+    // a settings object that is updated often, among a few that are not
+    uint8_t buf[40] = { 0 };
+    for (LogStore::key_t key = 1; key < 8; key++) {
+        store.write(key, buf, sizeof(buf));
+    }
+    for (uint32_t i = 0; i < 1000; i++) {
+        buf[0] = uint8_t(i);
+        buf[1] = uint8_t(i >> 8);
+        ASSERT_TRUE(store.write(0, buf, sizeof(buf)));
+    }
+    const LogStore::Statistics& stats = store.statistics();
+    double amplification = double(stats.bytesWritten) / stats.bytesRequested;
+    EXPECT_LT(amplification, 1.3);
+    // a page holds 88 of these records, so there are about 12 erases instead of an erase per update
+    EXPECT_LT(stats.pageErases, 15);
+}
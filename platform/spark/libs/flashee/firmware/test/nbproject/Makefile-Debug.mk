@@ -35,6 +35,7 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
+	${OBJECTDIR}/BlockRingTest.o \
 	${OBJECTDIR}/_ext/1472/ff.o \
 	${OBJECTDIR}/_ext/1472/flashee-eeprom.o \
 	${OBJECTDIR}/CircularBufferTest.o \
@@ -43,6 +44,7 @@ OBJECTFILES= \
 	${OBJECTDIR}/FakeFlashDeviceTest.o \
 	${OBJECTDIR}/FlashDeviceRegionTest.o \
 	${OBJECTDIR}/FlashDeviceTest.o \
+	${OBJECTDIR}/LogStoreTest.o \
 	${OBJECTDIR}/LogicalPageMapperTest.o \
 	${OBJECTDIR}/MultiWriteFlashStoreTest.o \
 	${OBJECTDIR}/PageSpanFlashDeviceTest.o \
@@ -85,6 +87,11 @@ ${OBJECTDIR}/_ext/1472/flashee-eeprom.o: ../flashee-eeprom.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -I.. -I. -I../../../core-firmware/inc -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/1472/flashee-eeprom.o ../flashee-eeprom.cpp
 
+${OBJECTDIR}/BlockRingTest.o: BlockRingTest.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -I.. -I. -I../../../core-firmware/inc -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/BlockRingTest.o BlockRingTest.cpp
+
 ${OBJECTDIR}/CircularBufferTest.o: CircularBufferTest.cpp 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -115,6 +122,11 @@ ${OBJECTDIR}/FlashDeviceTest.o: FlashDeviceTest.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -I.. -I. -I../../../core-firmware/inc -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/FlashDeviceTest.o FlashDeviceTest.cpp
 
+${OBJECTDIR}/LogStoreTest.o: LogStoreTest.cpp 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -I.. -I. -I../../../core-firmware/inc -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/LogStoreTest.o LogStoreTest.cpp
+
 ${OBJECTDIR}/LogicalPageMapperTest.o: LogicalPageMapperTest.cpp 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -27,7 +27,8 @@ MIT license, all text above must be included in any redistribution
 // A5 : MOSI(Master Out Slave In)
 // The other pins are: cs - Chip select (aka slave select), dc - D/C or A0 on the screen (Command/Data switch), rst - Reset
 
-Adafruit_ILI9341::Adafruit_ILI9341(uint8_t cs, uint8_t dc, uint8_t rst) : Adafruit_GFX(ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT) {
+Adafruit_ILI9341::Adafruit_ILI9341(uint8_t cs, uint8_t dc, uint8_t rst) : Adafruit_GFX(ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT),
+    sink(cs, dc), stream(sink) {
     _cs = cs;
     _dc = dc;
     _rst = rst;
@@ -41,26 +42,18 @@ void Adafruit_ILI9341::spiwrite(uint8_t c) {
     SPI.transfer(c);
 }
 
-void Adafruit_ILI9341::writecommand(uint8_t c) {
-
-    digitalWrite(_dc, LOW);
-    digitalWrite(_sclk, LOW);
-    digitalWrite(_cs, LOW);
+// Commands and data are buffered and sent in bursts with CS asserted, until endWrite()
 
-    spiwrite(c);
-
-    digitalWrite(_cs, HIGH);
+void Adafruit_ILI9341::writecommand(uint8_t c) {
+    stream.command(c);
 }
 
 void Adafruit_ILI9341::writedata(uint8_t c) {
+    stream.data(c);
+}
 
-    digitalWrite(_dc, HIGH);
-    digitalWrite(_sclk, LOW);
-    digitalWrite(_cs, LOW);
-
-    spiwrite(c);
-
-    digitalWrite(_cs, HIGH);
+void Adafruit_ILI9341::endWrite(void) {
+    stream.end();
 }
 
 // Rather than a bazillion writecommand() and writedata() calls, screen
@@ -93,14 +86,18 @@ void Adafruit_ILI9341::commandList(uint8_t *addr) {
             if (ms == 255) {
                 ms = 500; // If 255, delay for 500 ms
             }
+            endWrite();
             delay(ms);
         }
     }
+    endWrite();
 }
 
 void Adafruit_ILI9341::begin(void) {
     pinMode(_dc, OUTPUT);
+    digitalWrite(_dc, HIGH);
     pinMode(_cs, OUTPUT);
+    digitalWrite(_cs, HIGH);
     if (_rst != 255) { // 255 = no hardware reset pin, use software reset
         pinMode(_rst, OUTPUT);
         digitalWrite(_rst, LOW);
@@ -246,34 +243,20 @@ void Adafruit_ILI9341::begin(void) {
     writecommand(ILI9341_SLPOUT); //Exit Sleep 
     delay(120);
     writecommand(ILI9341_DISPON); //Display on 
+    endWrite();
 }
 
+// Column addr set, row addr set and write to RAM. Pixels pushed after it fill the window.
 void Adafruit_ILI9341::setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
-
-    writecommand(ILI9341_CASET); // Column addr set
-    writedata(x0 >> 8);
-    writedata(x0 & 0xFF); // XSTART 
-    writedata(x1 >> 8);
-    writedata(x1 & 0xFF); // XEND
-
-    writecommand(ILI9341_PASET); // Row addr set
-    writedata(y0 >> 8);
-    writedata(y0); // YSTART
-    writedata(y1 >> 8);
-    writedata(y1); // YEND
-
-    writecommand(ILI9341_RAMWR); // write to RAM
+    stream.setWindow(x0, y0, x1, y1);
 }
 
-void Adafruit_ILI9341::pushColor(uint16_t color) {
-
-    digitalWrite(_dc, HIGH);
-    digitalWrite(_cs, LOW);
-
-    spiwrite(color >> 8);
-    spiwrite(color);
+void Adafruit_ILI9341::pushColor(uint16_t color, uint32_t count) {
+    stream.pushColor(color, count);
+}
 
-    digitalWrite(_cs, HIGH);
+void Adafruit_ILI9341::pushColors(const uint16_t * colors, uint16_t count) {
+    stream.pushColors(colors, count);
 }
 
 void Adafruit_ILI9341::drawPixel(int16_t x, int16_t y, uint16_t color) {
@@ -283,14 +266,8 @@ void Adafruit_ILI9341::drawPixel(int16_t x, int16_t y, uint16_t color) {
     }
 
     setAddrWindow(x, y, x + 1, y + 1);
-
-    digitalWrite(_dc, HIGH);
-    digitalWrite(_cs, LOW);
-
-    spiwrite(color >> 8);
-    spiwrite(color);
-
-    digitalWrite(_cs, HIGH);
+    pushColor(color);
+    endWrite();
 }
 
 void Adafruit_ILI9341::drawFastVLine(int16_t x, int16_t y, int16_t h,
@@ -306,18 +283,8 @@ void Adafruit_ILI9341::drawFastVLine(int16_t x, int16_t y, int16_t h,
     }
 
     setAddrWindow(x, y, x, y + h - 1);
-
-    uint8_t hi = color >> 8, lo = color;
-
-    digitalWrite(_dc, HIGH);
-    digitalWrite(_cs, LOW);
-
-    while (h--) {
-        spiwrite(hi);
-        spiwrite(lo);
-    }
-
-    digitalWrite(_cs, HIGH);
+    pushColor(color, h);
+    endWrite();
 }
 
 void Adafruit_ILI9341::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
@@ -332,18 +299,8 @@ void Adafruit_ILI9341::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t c
     }
 
     setAddrWindow(x, y, x + w - 1, y);
-
-    uint8_t hi = color >> 8, lo = color;
-
-    digitalWrite(_dc, HIGH);
-    digitalWrite(_cs, LOW);
-
-    while (w--) {
-        spiwrite(hi);
-        spiwrite(lo);
-    }
-
-    digitalWrite(_cs, HIGH);
+    pushColor(color, w);
+    endWrite();
 }
 
 void Adafruit_ILI9341::drawCrossHair(int16_t x, int16_t y, int16_t s, uint16_t color) {
@@ -374,20 +331,8 @@ void Adafruit_ILI9341::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
     }
 
     setAddrWindow(x, y, x + w - 1, y + h - 1);
-
-    uint8_t hi = color >> 8, lo = color;
-
-    digitalWrite(_dc, HIGH);
-    digitalWrite(_cs, LOW);
-
-    for (y = h; y > 0; y--) {
-        for (x = w; x > 0; x--) {
-            spiwrite(hi);
-            spiwrite(lo);
-        }
-    }
-
-    digitalWrite(_cs, HIGH);
+    pushColor(color, uint32_t(w) * h);
+    endWrite();
 }
 
 // Pass 8-bit (each) R,G,B, get back 16-bit packed color
@@ -425,10 +370,12 @@ void Adafruit_ILI9341::setRotation(uint8_t m) {
             _height = ILI9341_TFTWIDTH;
             break;
     }
+    endWrite();
 }
 
 void Adafruit_ILI9341::invertDisplay(boolean i) {
     writecommand(i ? ILI9341_INVON : ILI9341_INVOFF);
+    endWrite();
 }
 
 ////////// stuff not actively being used, but kept for posterity
@@ -443,6 +390,7 @@ uint8_t Adafruit_ILI9341::spiread(void) {
 }
 
 uint8_t Adafruit_ILI9341::readdata(void) {
+    endWrite();
     digitalWrite(_dc, HIGH);
     digitalWrite(_cs, LOW);
     uint8_t r = spiread();
@@ -452,8 +400,8 @@ uint8_t Adafruit_ILI9341::readdata(void) {
 }
 
 uint8_t Adafruit_ILI9341::readcommand8(uint8_t c) {
+    endWrite();
     digitalWrite(_dc, LOW);
-    digitalWrite(_sclk, LOW);
     digitalWrite(_cs, LOW);
     spiwrite(c);
 
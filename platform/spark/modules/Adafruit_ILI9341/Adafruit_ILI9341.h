@@ -20,6 +20,8 @@ MIT license, all text above must be included in any redistribution
 // Hack to get this to work in Spark IDE
 #include "../Adafruit_mfGFX/Adafruit_mfGFX.h"
 #include "Platform.h"
+#include "ParticleSpiSink.h"
+#include "SpiDisplayStream.h"
 typedef unsigned char prog_uchar;
 
 #define ILI9341_TFTWIDTH  240
@@ -105,8 +107,12 @@ public:
 	Adafruit_ILI9341(uint8_t CS, uint8_t RS, uint8_t RST = 255);
 
 	void begin(void);
+	// Streaming pixels: set the window once, push runs or buffers of RGB565 pixels, then call endWrite().
+	// CS stays asserted from setAddrWindow() until endWrite().
         void setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
-	void pushColor(uint16_t color);
+	void pushColor(uint16_t color, uint32_t count = 1);
+	void pushColors(const uint16_t * colors, uint16_t count);
+	void endWrite(void);
         void fillScreen(uint16_t color);
 	void drawPixel(int16_t x, int16_t y, uint16_t color);
         void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
@@ -135,6 +141,9 @@ private:
 	volatile uint8_t *mosiport, *clkport, *dcport, *rsport, *csport;
 
 	uint8_t  _cs, _dc, _rst, _mosi, _miso, _sclk;
+
+	ParticleSpiSink sink;
+	SpiDisplayStream stream;
 };
 
 #endif
@@ -50,6 +50,20 @@
     #define BREWPI_BUZZER 1
 #endif
 
+// the Photon system firmware runs FreeRTOS. On the core, FreeRTOS is disabled to save space.
+#ifndef BREWPI_CONTROL_THREAD
+#if PLATFORM_ID==6
+    #define BREWPI_CONTROL_THREAD 1
+#else
+    #define BREWPI_CONTROL_THREAD 0
+#endif
+#endif
+
+// the data log needs the external flash of the core, the Photon only has the emulated EEPROM
+#ifndef BREWPI_DATA_LOG
+#define BREWPI_DATA_LOG (PLATFORM_ID==0)
+#endif
+
 // BREWPI_SENSOR_PINS - Only OneWire devices and digital outputs on the spark shield
 #ifndef BREWPI_SENSOR_PINS
 #define BREWPI_SENSOR_PINS 0
@@ -1,8 +1,176 @@
 
 #include "SparkEepromRegions.h"
 #include "EepromAccessImpl.h"
+#include <stddef.h>
 
-void SparkEepromAccess::init()
+#if EEPROM_LOG_STORE
+
+/*
+ * Each object in the EepromFormat image is stored as one record. The bytes after the EepromFormat struct are stored
+ * in chunks, so the whole MAX_EEPROM_SIZE image can still be read and written.
+ */
+static const Flashee::LogStore::key_t KEY_HEADER = 0x000;
+static const Flashee::LogStore::key_t KEY_CHAMBERS = 0x010; // + 0x10 per chamber, constants first and then the beers
+static const Flashee::LogStore::key_t KEY_DEVICES = 0x100;
+static const Flashee::LogStore::key_t KEY_UNUSED = 0x200;
+static const uint16_t UNUSED_CHUNK_SIZE = 32;
+
+static const uint16_t EEPROM_OBJECT_COUNT = 1 + EepromFormat::MAX_CHAMBERS * (1 + ChamberBlock::MAX_BEERS)
+        + EepromFormat::MAX_DEVICES + (EepromFormat::MAX_EEPROM_SIZE - sizeof(EepromFormat) + UNUSED_CHUNK_SIZE - 1) / UNUSED_CHUNK_SIZE;
+
+#define eepromMax(a, b) ((a) > (b) ? (a) : (b))
+static const uint16_t EEPROM_MAX_OBJECT_SIZE = eepromMax(eepromMax(offsetof(EepromFormat, chambers), offsetof(ChamberBlock, beer)),
+        eepromMax(eepromMax(sizeof(BeerBlock), sizeof(DeviceConfig)), UNUSED_CHUNK_SIZE));
+
+/**
+ * Finds the object that contains the byte at offset.
+ * @param start set to the offset of the first byte of the object
+ * @param size set to the size of the object
+ * @return the key of the object
+ */
+static Flashee::LogStore::key_t eepromObject(eptr_t offset, eptr_t & start, uint16_t & size)
+{
+    const eptr_t chambers = offsetof(EepromFormat, chambers);
+    const eptr_t devices = offsetof(EepromFormat, devices);
+    if (offset < chambers) {
+        start = 0;
+        size = chambers;
+        return KEY_HEADER;
+    }
+    if (offset < devices) {
+        uint8_t chamber = (offset - chambers) / sizeof(ChamberBlock);
+        eptr_t block = chambers + chamber * sizeof(ChamberBlock);
+        eptr_t beers = block + offsetof(ChamberBlock, beer);
+        if (offset < beers) {
+            start = block;
+            size = beers - block;
+            return KEY_CHAMBERS + chamber * 0x10;
+        }
+        uint8_t beer = (offset - beers) / sizeof(BeerBlock);
+        start = beers + beer * sizeof(BeerBlock);
+        size = sizeof(BeerBlock);
+        return KEY_CHAMBERS + chamber * 0x10 + 1 + beer;
+    }
+    if (offset < sizeof(EepromFormat)) {
+        uint8_t device = (offset - devices) / sizeof(DeviceConfig);
+        start = devices + device * sizeof(DeviceConfig);
+        size = sizeof(DeviceConfig);
+        return KEY_DEVICES + device;
+    }
+    uint16_t chunk = (offset - sizeof(EepromFormat)) / UNUSED_CHUNK_SIZE;
+    start = sizeof(EepromFormat) + chunk * UNUSED_CHUNK_SIZE;
+    size = EepromFormat::MAX_EEPROM_SIZE - start;
+    if (size > UNUSED_CHUNK_SIZE)
+        size = UNUSED_CHUNK_SIZE;
+    return KEY_UNUSED + chunk;
+}
+
+/**
+ * Reads an object from the store. Objects that were never written read as 0xFF, like erased flash.
+ */
+static void readObject(Flashee::LogStore * store, Flashee::LogStore::key_t key, uint8_t * data, uint16_t size)
+{
+    memset(data, 0xFF, size);
+    if (store != NULL)
+        store->read(key, data, size);
+}
+
+/**
+ * Before the log store, the Core stored the EEPROM image in the same region with an address erase device.
+ * When the region holds no pages of the log store, the image of the old device is read and stored as records, so the
+ * settings are kept when the firmware is upgraded.
+ * Creating the old device formats the region when it was not formatted by it, so it is only created for a region
+ * without log store pages. The image is read completely before the store writes to the region.
+ */
+void SparkEepromAccess::importAddressEraseImage()
+{
+    Flashee::FlashDevice* old = Flashee::Devices::createAddressErase(4096*EEPROM_CONTROLLER_START_BLOCK,
+            4096*EEPROM_CONTROLLER_END_BLOCK);
+    if (old == NULL)
+        return;
+    uint8_t* image = new uint8_t[EepromFormat::MAX_EEPROM_SIZE];
+    bool stored = old->read(image, 0, EepromFormat::MAX_EEPROM_SIZE)
+        && image[offsetof(EepromFormat, version)] != 0xFF; // 0xFF is erased flash, nothing was stored
+    delete old;
+    store->clear(); // erases the pages of the old device, which formats erased flash when it is created
+    if (stored) {
+        writeBlock(0, image, EepromFormat::MAX_EEPROM_SIZE);
+    }
+    delete[] image;
+}
+
+bool SparkEepromAccess::init()
+{
+    store = Flashee::Devices::createLogStore(4096*EEPROM_CONTROLLER_START_BLOCK, 4096*EEPROM_CONTROLLER_END_BLOCK,
+            EEPROM_OBJECT_COUNT);
+    if (store == NULL) {
+        return false; // reads as erased, the settings manager starts in safe mode
+    }
+    // false when the region holds more keys than the index. The indexed objects are kept and the settings manager
+    // checks their version, like for a complete index.
+    store->begin();
+    if (!store->hasPages()) {
+        importAddressEraseImage();
+    }
+    return true;
+}
+
+void SparkEepromAccess::readBlock(void* target, eptr_t offset, uint16_t size)
+{
+    uint8_t object[EEPROM_MAX_OBJECT_SIZE];
+    uint8_t* data = (uint8_t*) target;
+    while (size > 0) {
+        eptr_t start;
+        uint16_t objectSize;
+        Flashee::LogStore::key_t key = eepromObject(offset, start, objectSize);
+        uint16_t pos = offset - start;
+        uint16_t count = objectSize - pos;
+        if (count > size)
+            count = size;
+        readObject(store, key, object, objectSize);
+        memcpy(data, object + pos, count);
+        data += count;
+        offset += count;
+        size -= count;
+    }
+}
+
+void SparkEepromAccess::writeBlock(eptr_t target, const void* source, uint16_t size)
+{
+    uint8_t object[EEPROM_MAX_OBJECT_SIZE];
+    const uint8_t* data = (const uint8_t*) source;
+    while (size > 0) {
+        eptr_t start;
+        uint16_t objectSize;
+        Flashee::LogStore::key_t key = eepromObject(target, start, objectSize);
+        uint16_t pos = target - start;
+        uint16_t count = objectSize - pos;
+        if (count > size)
+            count = size;
+        readObject(store, key, object, objectSize);
+        memcpy(object + pos, data, count);
+        if (store != NULL)
+            store->write(key, object, objectSize); // does not append when the object is unchanged
+        data += count;
+        target += count;
+        size -= count;
+    }
+}
+
+size_t SparkEepromAccess::length()
+{
+    return EepromFormat::MAX_EEPROM_SIZE;
+}
+
+void SparkEepromAccess::compact()
+{
+    if (store != NULL)
+        store->compact();
+}
+
+#else
+
+bool SparkEepromAccess::init()
 {
 #if PLATFORM_ID==0
     flash = Flashee::Devices::createAddressErase(4096*EEPROM_CONTROLLER_START_BLOCK, 4096*EEPROM_CONTROLLER_END_BLOCK);
@@ -11,5 +179,7 @@ void SparkEepromAccess::init()
 #else
 #error Unknown Platform ID
 #endif
+    return true;
 }
 
+#endif
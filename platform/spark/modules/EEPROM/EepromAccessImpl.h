@@ -4,13 +4,34 @@
 
 namespace Flashee {
     class FlashDevice;
+    class LogStore;
 };
 
+/*
+ * On the Spark Core, the settings are stored as records in a log structured store in external flash, keyed by the
+ * object in EepromFormat they belong to (a chamber's constants, a beer's settings, a device config). Writes append a
+ * record for each object that changed, instead of rewriting bytes in place, which needs a page erase.
+ * The Photon stores the image in the emulated EEPROM of the system firmware, which already does its own wear leveling.
+ */
+#ifndef EEPROM_LOG_STORE
+#define EEPROM_LOG_STORE (PLATFORM_ID==0)
+#endif
+
 class SparkEepromAccess
 {
+#if EEPROM_LOG_STORE
+    Flashee::LogStore* store;
+
+    void importAddressEraseImage();
+#else
     Flashee::FlashDevice* flash;
+#endif
 public:
-    void init();
+    /**
+     * Opens the flash storage.
+     * @return false when the stored settings could not be loaded and the EEPROM has to be initialized
+     */
+    bool init();
     
     uint8_t readByte(eptr_t offset) {
         uint8_t value;
@@ -21,6 +42,17 @@ public:
         writeBlock(offset, &value, 1);
     }
 
+#if EEPROM_LOG_STORE
+    void readBlock(void* target, eptr_t offset, uint16_t size);
+    void writeBlock(eptr_t target, const void* source, uint16_t size);
+    size_t length();
+
+    /**
+     * Compacts the oldest flash page of the store when it is running out of free pages, so writes do not have to wait
+     * for a page erase. Call this when the controller is idle.
+     */
+    void compact();
+#else
     void readBlock(void* target, eptr_t offset, uint16_t size) {
         flash->read(target, offset, size);
     }
@@ -31,6 +63,9 @@ public:
     size_t length() {
         return flash->length();
     }
+
+    void compact() {}
+#endif
 };
 
-typedef SparkEepromAccess EepromAccess;
\ No newline at end of file
+typedef SparkEepromAccess EepromAccess;
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SampleLog.h"
+#include "flashee-eeprom.h"
+#include "SparkEepromRegions.h"
+
+/*
+ * Stores the blocks of the data log in a ring in external flash, tagged with their sequence number. When the ring is
+ * full, the page with the oldest blocks is erased. With 320 pages of 4kB, that is a few weeks of samples every second.
+ */
+class FlashSampleStore final : public SampleStore {
+public:
+    FlashSampleStore() : ring(nullptr) {}
+    ~FlashSampleStore() = default;
+
+    // @return false when the flash region could not be created
+    bool init(){
+        ring = Flashee::Devices::createBlockRing(4096 * DATA_LOG_START_BLOCK, 4096 * DATA_LOG_END_BLOCK);
+        return ring != nullptr;
+    }
+
+    bool append(uint32_t sequence, const uint8_t * block, uint16_t length) override final {
+        return ring && ring->append(sequence, block, length);
+    }
+
+    uint32_t lastSequence() override final {
+        return ring ? ring->lastTag() : NO_SEQUENCE; // NO_TAG is NO_SEQUENCE
+    }
+
+    bool seek(uint32_t sequence) override final {
+        return ring && ring->seek(cursor, sequence);
+    }
+
+    int16_t read(uint32_t & sequence, uint8_t * block, uint16_t maxLength) override final {
+        return ring ? ring->read(cursor, sequence, block, maxLength) : -1;
+    }
+
+private:
+    Flashee::BlockRing * ring;
+    Flashee::BlockRing::Cursor cursor;
+};
@@ -27,6 +27,8 @@
 #define EEPROM_CONTROLLER_END_BLOCK 32
 #define EEPROM_EGUI_SETTINGS_START_BLOCK 32
 #define EEPROM_EGUI_SETTINGS_END_BLOCK 64
+#define DATA_LOG_START_BLOCK 64
+#define DATA_LOG_END_BLOCK 384 // the rest of the 1.5MB user flash
 #elif PLATFORM_ID==6
 #define EEPROM_CONTROLLER_START_BLOCK 2
 #define EEPROM_CONTROLLER_END_BLOCK (EEPROM_CONTROLLER_START_BLOCK + EepromFormat::MAX_EEPROM_SIZE)
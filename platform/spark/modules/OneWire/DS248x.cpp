@@ -76,12 +76,15 @@ bool DS248x::init() {
 
 void DS248x::resetMaster() {
     mTimeout = 0;
+    mChannel = ONEWIRE_NO_CHANNEL;
+    mReadPtrStatus = false;
     Wire.beginTransmission(mAddress);
     Wire.write(DS248X_DRST);
     Wire.endTransmission();
 }
 
 bool DS248x::configure(uint8_t config) {
+    finishQueued();
     busyWait(true);
     Wire.beginTransmission(mAddress);
     Wire.write(DS248X_WCFG);
@@ -91,45 +94,50 @@ bool DS248x::configure(uint8_t config) {
     return readByte() == config;
 }
 
-bool DS248x::selectChannel(uint8_t channel) {
-    uint8_t ch, ch_read;
-
+// channel select code and the value read back from the channel selection register
+static void channelCodes(uint8_t channel, uint8_t * ch, uint8_t * ch_read) {
     switch (channel) {
         case 0:
         default:
-            ch = 0xf0;
-            ch_read = 0xb8;
+            *ch = 0xf0;
+            *ch_read = 0xb8;
             break;
         case 1:
-            ch = 0xe1;
-            ch_read = 0xb1;
+            *ch = 0xe1;
+            *ch_read = 0xb1;
             break;
         case 2:
-            ch = 0xd2;
-            ch_read = 0xaa;
+            *ch = 0xd2;
+            *ch_read = 0xaa;
             break;
         case 3:
-            ch = 0xc3;
-            ch_read = 0xa3;
+            *ch = 0xc3;
+            *ch_read = 0xa3;
             break;
         case 4:
-            ch = 0xb4;
-            ch_read = 0x9c;
+            *ch = 0xb4;
+            *ch_read = 0x9c;
             break;
         case 5:
-            ch = 0xa5;
-            ch_read = 0x95;
+            *ch = 0xa5;
+            *ch_read = 0x95;
             break;
         case 6:
-            ch = 0x96;
-            ch_read = 0x8e;
+            *ch = 0x96;
+            *ch_read = 0x8e;
             break;
         case 7:
-            ch = 0x87;
-            ch_read = 0x87;
+            *ch = 0x87;
+            *ch_read = 0x87;
             break;
     };
+}
+
+bool DS248x::selectChannel(uint8_t channel) {
+    uint8_t ch, ch_read;
+    channelCodes(channel, &ch, &ch_read);
 
+    finishQueued();
     busyWait(true);
     Wire.beginTransmission(mAddress);
     Wire.write(DS248X_CHSL);
@@ -139,10 +147,12 @@ bool DS248x::selectChannel(uint8_t channel) {
 
     uint8_t check = readByte();
 
+    mChannel = (check == ch_read) ? channel : ONEWIRE_NO_CHANNEL;
     return check == ch_read;
 }
 
 bool DS248x::reset() {
+    finishQueued();
     busyWait(true);
     Wire.beginTransmission(mAddress);
     Wire.write(DS248X_1WRS);
@@ -154,6 +164,7 @@ bool DS248x::reset() {
 }
 
 void DS248x::write(uint8_t b, uint8_t power) {
+    finishQueued();
     busyWait(true);
     Wire.beginTransmission(mAddress);
     Wire.write(DS248X_1WWB);
@@ -162,6 +173,7 @@ void DS248x::write(uint8_t b, uint8_t power) {
 }
 
 uint8_t DS248x::read() {
+    finishQueued();
     busyWait(true);
     Wire.beginTransmission(mAddress);
     Wire.write(DS248X_1WRB);
@@ -172,6 +184,7 @@ uint8_t DS248x::read() {
 }
 
 void DS248x::write_bit(uint8_t bit) {
+    finishQueued();
     busyWait(true);
     Wire.beginTransmission(mAddress);
     Wire.write(DS248X_1WSB);
@@ -192,6 +205,7 @@ uint8_t DS248x::search_triplet(uint8_t * search_direction, uint8_t * id_bit, uin
     //                           Repeat until 1WB bit has changed to 0
     //  [] indicates from slave
     //  SS indicates byte containing search direction bit value in msbit
+    finishQueued();
     busyWait(true);
     Wire.beginTransmission(mAddress);
     Wire.write(DS248X_1WT);
@@ -207,4 +221,187 @@ uint8_t DS248x::search_triplet(uint8_t * search_direction, uint8_t * id_bit, uin
             ((status & DS248X_STATUS_DIR) == DS248X_STATUS_DIR) ? (byte) 1 : (byte) 0;
 
     return status;
-}
\ No newline at end of file
+}
+
+//----------queued mode
+
+// steps of a queued transaction
+#define STEP_CHANNEL 0
+#define STEP_RESET 1
+#define STEP_PRESENCE 2
+#define STEP_ROM 3
+#define STEP_WRITE 4
+#define STEP_READ 5
+#define STEP_READ_RESULT 6
+
+#define MATCH_ROM 0x55
+#define SKIP_ROM 0xcc
+
+void DS248x::writeCommand(uint8_t command) {
+    Wire.beginTransmission(mAddress);
+    Wire.write(command);
+    Wire.endTransmission();
+    mReadPtrStatus = true; // 1-Wire commands set the read pointer to the status register
+    mStepStart = micros();
+}
+
+void DS248x::writeCommand(uint8_t command, uint8_t data) {
+    Wire.beginTransmission(mAddress);
+    Wire.write(command);
+    Wire.write(data);
+    Wire.endTransmission();
+    mReadPtrStatus = true;
+    mStepStart = micros();
+}
+
+bool DS248x::submit(OneWireTransaction & transaction) {
+    if (transaction.isPending()) {
+        return false;
+    }
+    transaction.status = OneWireTransaction::Status::QUEUED;
+    transaction.next = nullptr;
+    OneWireTransaction ** p = &mQueue;
+    while (*p != nullptr) {
+        p = &(*p)->next;
+    }
+    *p = &transaction;
+    return true;
+}
+
+OneWireTransaction * DS248x::nextQueued() {
+    OneWireTransaction ** p = &mQueue;
+    // prefer a transaction on the selected channel, otherwise take the oldest
+    for (OneWireTransaction ** q = &mQueue; *q != nullptr; q = &(*q)->next) {
+        if ((*q)->channel == ONEWIRE_NO_CHANNEL || (*q)->channel == mChannel) {
+            p = q;
+            break;
+        }
+    }
+    OneWireTransaction * t = *p;
+    if (t != nullptr) {
+        *p = t->next;
+        t->next = nullptr;
+        t->status = OneWireTransaction::Status::BUSY;
+        t->step = (t->channel == ONEWIRE_NO_CHANNEL || t->channel == mChannel) ? STEP_RESET : STEP_CHANNEL;
+        t->index = 0;
+        mStepStart = micros();
+    }
+    return t;
+}
+
+void DS248x::finish(OneWireTransaction::Status status) {
+    mCurrent->status = status;
+    mCurrent = nullptr;
+}
+
+/*
+ * Handles the result of the previous command and sends the next one.
+ * Returns true when a 1-Wire command was started, which keeps the DS248x busy.
+ */
+bool DS248x::nextStep(uint8_t status) {
+    OneWireTransaction & t = *mCurrent;
+    while (true) {
+        switch (t.step) {
+            case STEP_CHANNEL:
+            {
+                uint8_t ch, ch_read;
+                channelCodes(t.channel, &ch, &ch_read);
+                Wire.beginTransmission(mAddress);
+                Wire.write(DS248X_CHSL);
+                Wire.write(ch);
+                Wire.endTransmission();
+                mReadPtrStatus = false; // read pointer is at the channel selection register
+                if (readByte() != ch_read) {
+                    mChannel = ONEWIRE_NO_CHANNEL;
+                    finish(OneWireTransaction::Status::CHANNEL_ERROR);
+                    return false;
+                }
+                mChannel = t.channel;
+                t.step = STEP_RESET;
+                break;
+            }
+            case STEP_RESET:
+                writeCommand(DS248X_1WRS);
+                t.step = STEP_PRESENCE;
+                return true;
+            case STEP_PRESENCE:
+                if (!(status & DS248X_STATUS_PPD)) {
+                    finish(OneWireTransaction::Status::NO_PRESENCE);
+                    return false;
+                }
+                t.step = STEP_ROM;
+                t.index = 0;
+                break;
+            case STEP_ROM:
+                if (t.skipRom) {
+                    writeCommand(DS248X_1WWB, SKIP_ROM);
+                    t.step = STEP_WRITE;
+                    t.index = 0;
+                    return true;
+                }
+                writeCommand(DS248X_1WWB, t.index == 0 ? MATCH_ROM : t.rom[t.index - 1]);
+                if (++t.index > 8) {
+                    t.step = STEP_WRITE;
+                    t.index = 0;
+                }
+                return true;
+            case STEP_WRITE:
+                if (t.index < t.writeLength) {
+                    writeCommand(DS248X_1WWB, t.writeData[t.index++]);
+                    return true;
+                }
+                t.step = STEP_READ;
+                t.index = 0;
+                break;
+            case STEP_READ:
+                if (t.index < t.readLength) {
+                    writeCommand(DS248X_1WRB);
+                    t.step = STEP_READ_RESULT;
+                    return true;
+                }
+                finish(OneWireTransaction::Status::DONE);
+                return false;
+            case STEP_READ_RESULT:
+                setReadPtr(PTR_READ);
+                t.readData[t.index++] = readByte();
+                mReadPtrStatus = false;
+                t.step = STEP_READ;
+                break;
+            default:
+                finish(OneWireTransaction::Status::DONE);
+                return false;
+        }
+    }
+}
+
+bool DS248x::poll() {
+    for (uint8_t commands = 0; commands < DS248X_POLL_MAX_COMMANDS; commands++) {
+        if (mCurrent == nullptr) {
+            mCurrent = nextQueued();
+            if (mCurrent == nullptr) {
+                return false;
+            }
+        }
+
+        // a single status read, without waiting for the bridge
+        uint8_t status = wireReadStatus(!mReadPtrStatus);
+        mReadPtrStatus = true;
+        if (status & DS248X_STATUS_BUSY) {
+            if (micros() - mStepStart > DS248X_QUEUE_TIMEOUT) {
+                mTimeout = 1;
+                finish(OneWireTransaction::Status::TIMEOUT);
+                continue;
+            }
+            return true;
+        }
+        nextStep(status);
+    }
+    return hasPending();
+}
+
+void DS248x::finishQueued() {
+    while (poll()) {
+        delayMicroseconds(20);
+    }
+    mReadPtrStatus = false;
+}
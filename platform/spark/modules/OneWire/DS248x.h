@@ -21,6 +21,7 @@
 #include <inttypes.h>
 #include "application.h"
 #include "OneWireLowLevelInterface.h"
+#include "OneWireTransaction.h"
 
 #define DS248X_CONFIG_APU (0x1<<0)
 #define DS248X_CONFIG_PPM (0x1<<1)
@@ -48,12 +49,28 @@
 #define DS248X_1WT	0x78 // 1-Wire Triplet
 #define DS248X_ADJP	0xc3 // Adjust OneWire port config (DS2484 only))
 
+// time in microseconds a queued 1-Wire command may keep the DS248x busy before the transaction is aborted
+#ifndef DS248X_QUEUE_TIMEOUT
+#define DS248X_QUEUE_TIMEOUT 20000
+#endif
+
+// maximum number of I2C commands a single poll() sends, to bound the time spent in it
+#ifndef DS248X_POLL_MAX_COMMANDS
+#define DS248X_POLL_MAX_COMMANDS 4
+#endif
 
 class DS248x /*: public OneWireLowLevelInterface */ {
 public:
     //Address is 0-3
 
-    DS248x(uint8_t address) : mAddress(address) {
+    DS248x(uint8_t address) :
+        mAddress(address),
+        mTimeout(0),
+        mChannel(ONEWIRE_NO_CHANNEL),
+        mReadPtrStatus(false),
+        mStepStart(0),
+        mCurrent(nullptr),
+        mQueue(nullptr) {
         mAddress = 0x18 | mAddress;
     }
 
@@ -105,12 +122,46 @@ public:
     // Updates search direction, id_bit and cmp_id_bit
     uint8_t search_triplet(uint8_t * search_direction, uint8_t * id_bit, uint8_t * cmp_id_bit);
 
+    // Queued, non-blocking mode.
+    // The blocking functions above first finish all queued transactions.
+
+    /*
+     * Adds a transaction to the queue. Nothing is sent until poll() is called.
+     * /return false when the transaction is already pending
+     */
+    bool submit(OneWireTransaction & transaction);
+
+    /*
+     * Sends the next commands of the queued transactions when the DS248x is not busy. Never waits for the bridge,
+     * so the 1-Wire time slots run while the caller does other work. Transactions on the currently selected
+     * channel of a DS2482-800 go first to limit channel switching.
+     * /return true while transactions are pending
+     */
+    bool poll();
+
+    bool hasPending() const {
+        return mCurrent != nullptr || mQueue != nullptr;
+    }
+
 private:
 
     uint8_t mAddress;
     uint8_t mTimeout;
+    uint8_t mChannel; // selected channel, ONEWIRE_NO_CHANNEL when unknown
+    bool mReadPtrStatus; // read pointer is at the status register, which 1-Wire commands do
+    uint32_t mStepStart;
+    OneWireTransaction * mCurrent;
+    OneWireTransaction * mQueue;
+
     uint8_t readByte();
     void setReadPtr(uint8_t readPtr);
 
     uint8_t busyWait(bool setReadPtr = false); //blocks until
+
+    void finishQueued();
+    OneWireTransaction * nextQueued();
+    bool nextStep(uint8_t status);
+    void finish(OneWireTransaction::Status status);
+    void writeCommand(uint8_t command);
+    void writeCommand(uint8_t command, uint8_t data);
 };
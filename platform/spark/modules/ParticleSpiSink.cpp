@@ -0,0 +1,74 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParticleSpiSink.h"
+#include "application.h"
+
+#if PLATFORM_ID == 6
+#define SPI_SINK_DMA 1
+#else
+#define SPI_SINK_DMA 0
+#endif
+
+#if SPI_SINK_DMA
+// there is only one SPI peripheral for displays, so one transfer can be in progress
+static volatile bool transferBusy = false;
+
+static void transferComplete(void){
+    transferBusy = false;
+}
+#endif
+
+void ParticleSpiSink::select(bool selected){
+    if(selected){
+        pinResetFast(cs);
+    }
+    else{
+        pinSetFast(cs);
+    }
+}
+
+void ParticleSpiSink::dataMode(bool data){
+    if(data){
+        pinSetFast(dc);
+    }
+    else{
+        pinResetFast(dc);
+    }
+}
+
+void ParticleSpiSink::write(const uint8_t * data, uint16_t length){
+#if SPI_SINK_DMA
+    wait();
+    transferBusy = true;
+    SPI.transfer(const_cast<uint8_t *>(data), NULL, length, transferComplete);
+#else
+    for(uint16_t i = 0; i < length; i++){
+        SPI.transfer(data[i]);
+    }
+#endif
+}
+
+void ParticleSpiSink::wait(){
+#if SPI_SINK_DMA
+    while(transferBusy){
+        // the completion interrupt is raised when the last byte has been received, so the bus is idle after it
+    }
+#endif
+}
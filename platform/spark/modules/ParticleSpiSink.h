@@ -0,0 +1,43 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "SpiDisplayStream.h"
+#include <stdint.h>
+
+/*
+ * SPI sink for a display on the primary SPI bus of the Core or Photon.
+ * On the Photon, writes are DMA transfers that run while the next bytes are collected.
+ * The Core has no DMA support in its SPI HAL, it transmits the bytes one by one without toggling chip select.
+ */
+class ParticleSpiSink final : public SpiSink {
+public:
+    ParticleSpiSink(uint8_t csPin, uint8_t dcPin) : cs(csPin), dc(dcPin) {}
+    ~ParticleSpiSink() = default;
+
+    void select(bool selected) override final;
+    void dataMode(bool data) override final;
+    void write(const uint8_t * data, uint16_t length) override final;
+    void wait() override final;
+
+private:
+    uint8_t cs;
+    uint8_t dc;
+};
@@ -40,6 +40,8 @@ bool platform_init()
         EEPROM.write(0, EEPROM_MAGIC1);
         EEPROM.write(1, EEPROM_MAGIC2);
     }
-    eepromAccess.init();
+    if (!eepromAccess.init()) {
+        initialize = true;
+    }
     return initialize;
 }
@@ -607,7 +607,7 @@ D4D_BOOL D4D_ChangeText(D4D_STRING* pBuff, const D4D_TCHAR* pNewText, D4D_TCHAR
     
     // preserve one byte in the buffer
     if(pDest != pNewText) {
-      changed = strncmp(pDest, pNewText, n);
+      changed = strncmp(pDest, pNewText, n) != 0;
       while(n > 1 && *pNewText)
       {
         *pDest = *pNewText;
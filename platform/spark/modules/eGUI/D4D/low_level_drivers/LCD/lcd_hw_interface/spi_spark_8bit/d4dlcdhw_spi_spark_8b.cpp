@@ -62,6 +62,8 @@ extern "C" {
 // include of low level driver header file
 // it will be included into whole project only in case that this driver is selected in main D4D configuration file
 #include "low_level_drivers/LCD/lcd_hw_interface/spi_spark_8bit/d4dlcdhw_spi_spark_8b.h"
+#include "ParticleSpiSink.h"
+#include "SpiDisplayStream.h"
 
 /******************************************************************************
  * Macros
@@ -109,6 +111,10 @@ extern "C" const D4DLCDHW_FUNCTIONS d4dlcdhw_spi_spark_8b ={
   *
   ******************************************************************/
 
+// Bytes are collected and sent in bursts with CS asserted, until D4D flushes after drawing an element.
+static ParticleSpiSink spiSink(D4DLCD_CS, D4DLCD_DC);
+static SpiDisplayStream spiStream(spiSink);
+
 /**************************************************************//*!
   *
   * Functions bodies
@@ -133,7 +139,7 @@ static unsigned char D4DLCDHW_Init_Spi_Spark_8b(void) {
 #endif
 
     D4DLCD_DEASSERT_CS;
-    D4DLCD_ASSERT_DC;
+    D4DLCD_DEASSERT_DC; // data mode between commands
 
     D4DLCD_INIT_CS;
     D4DLCD_INIT_DC;
@@ -187,6 +193,7 @@ static unsigned char D4DLCDHW_DeInit_Spi_Spark_8b(void) {
 // FUNCTION:    D4DLCDHW_SendDataWord_Spi_Spark_8b
 // SCOPE:       Low Level Driver API function
 // DESCRIPTION: The function send the one 16 bit variable into LCD
+//              The byte is buffered and sent with the next burst
 //
 // PARAMETERS:  unsigned short value    variable to send
 //
@@ -194,11 +201,7 @@ static unsigned char D4DLCDHW_DeInit_Spi_Spark_8b(void) {
 //-----------------------------------------------------------------------------
 
 static void D4DLCDHW_SendDataWord_Spi_Spark_8b(unsigned short value) {
-    D4DLCD_ASSERT_CS;
-    // Send data byte
-    SPI.transfer(value);
-
-    D4DLCD_DEASSERT_CS;
+    spiStream.data(value);
 }
 
 //-----------------------------------------------------------------------------
@@ -212,9 +215,7 @@ static void D4DLCDHW_SendDataWord_Spi_Spark_8b(unsigned short value) {
 //-----------------------------------------------------------------------------
 
 static void D4DLCDHW_SendCmdWord_Spi_Spark_8b(unsigned short cmd) {
-    D4DLCD_ASSERT_DC; // DataCmd := 0
-    D4DLCDHW_SendDataWord_Spi_Spark_8b(cmd);
-    D4DLCD_DEASSERT_DC; // DataCmd := 1
+    spiStream.command(cmd); // sends buffered data first
 }
 
 
@@ -315,6 +316,7 @@ static unsigned char D4DLCDHW_PinCtl_Spi_Spark_8b(D4DLCDHW_PINS pinId, D4DHW_PIN
 // SCOPE:       Low Level Driver API function
 // DESCRIPTION: For buffered low level interfaces is used to inform
 //              driver the complete object is drawed and pending pixels should be flushed
+//              CS is released, so the touch screen controller can use the SPI bus
 //
 // PARAMETERS:  none
 //
@@ -323,6 +325,7 @@ static unsigned char D4DLCDHW_PinCtl_Spi_Spark_8b(D4DLCDHW_PINS pinId, D4DHW_PIN
 
 static void D4DLCD_FlushBuffer_Spi_Spark_8b(D4DLCD_FLUSH_MODE mode) {
     D4D_UNUSED(mode);
+    spiStream.end();
 }
 
 
@@ -182,6 +182,8 @@ static D4D_TOUCHSCREEN_LIMITS* D4DTCH_GetRawLimits_Tsc2046_brewpi(void) {
 
 static unsigned char D4DTCH_GetPositionRaw_Tsc2046_brewpi(unsigned short *TouchPositionX,
     unsigned short *TouchPositionY) {
+    // the display shares the SPI bus, send its pending bytes and release its CS
+    D4D_LLD_LCD.D4DLCD_FlushBuffer(D4DLCD_FLSH_FORCE);
     if(touch.update()){
         *TouchPositionX = touch.getXRaw();
         *TouchPositionY = touch.getYRaw();
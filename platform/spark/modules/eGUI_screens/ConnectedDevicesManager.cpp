@@ -55,16 +55,28 @@ void ConnectedDevicesManager::handleDevice(DeviceConfig* config, DeviceCallbackI
 {    
     if (config->deviceHardware == DEVICE_HARDWARE_ONEWIRE_TEMP) {     
         int slot = existingSlot(config);
+        if (slot >= 0 && installed[slot]) {
+            // the control can rebuild its objects, so its sensor is looked up again on each scan
+            TempSensorBasic* sensor = installedSensor(config, info);
+            if (sensor) {
+                devices[slot].pointer.tempSensor = sensor;
+                watchSensor(slot);
+            } else {
+                clearSlot(slot); // no longer installed, add it again as a device of its own
+                slot = -1;
+            }
+        }
         if (slot >= 0) { // found the device still active
-            devices[slot].pointer.tempSensor->update();
-            temp_t newTemp = devices[slot].pointer.tempSensor->read();
-            if(newTemp == TEMP_SENSOR_DISCONNECTED){
+            if (!installed[slot])
+                devices[slot].pointer.tempSensor->update(); // installed sensors are updated by the control
+            if(devices[slot].pointer.tempSensor->read() == TEMP_SENSOR_DISCONNECTED){
                 devices[slot].lastSeen+=2;                
             } 
             else {
                 devices[slot].lastSeen = 0; // seen this one now
-                // check if temperature has changed to notify that UI needs to be updated
-                if(newTemp != devices[slot].value.temp){
+                // the sensor notifies when the temperature changed enough for the UI to be updated
+                temp_t newTemp;
+                if(sensorChanged(slot, newTemp) && newTemp != TEMP_SENSOR_DISCONNECTED){
                     devices[slot].value.temp = newTemp;
                     changed(this, slot, devices + slot, UPDATED);
                 }
@@ -85,12 +97,17 @@ void ConnectedDevicesManager::handleDevice(DeviceConfig* config, DeviceCallbackI
                 device.connection.type = deviceConnection(device.dh);
                 memcpy(device.connection.address, config->hw.address, 8);
                 device.value.temp = temp_t::invalid(); // flag invalid
-                device.pointer.tempSensor = (TempSensorBasic*) DeviceManager::createDevice(*config, device.dt);
-                if (!device.pointer.tempSensor || !device.pointer.tempSensor->init()) {
+                device.pointer.tempSensor = installedSensor(config, info);
+                installed[slot] = device.pointer.tempSensor != NULL;
+                if (!installed[slot])
+                    device.pointer.tempSensor = (TempSensorBasic*) DeviceManager::createDevice(*config, device.dt);
+                if (!device.pointer.tempSensor || (!installed[slot] && !device.pointer.tempSensor->init())) {
                     clearSlot(slot);
                     device.lastSeen = -1; // don't send REMOVED event since no added event has been sent
-                } else
-                    changed(this, slot, &device, ADDED); // new device added					
+                } else {
+                    watchSensor(slot);
+                    changed(this, slot, &device, ADDED); // new device added
+                }
             }
             // just ignore the device - not enough free slots
         }
@@ -106,6 +123,12 @@ void ConnectedDevicesManager::update()
     spec.pin = -1; // any pin
     spec.hardware = -1; // any hardware
 
+    // the actuators can also be switched by the control, which drives the same pins through its own actuators
+    for (int i = 0; i < MAX_ACTUATOR_COUNT; i++) {
+        if (actuators[i])
+            actuators[i]->update();
+    }
+
     // increment the last seen for all devices        
     for (int i = 0; i < MAX_CONNECTED_DEVICES; i++) {
         if (devices[i].pointer.any)
@@ -22,6 +22,8 @@
 #include "EepromManager.h"		// for clear()
 #include "DeviceManager.h"
 #include "TempSensorBasic.h"
+#include "TempSensor.h"
+#include "ChangeNotifier.h"
 #include "ActuatorInterfaces.h"
 #include "Sensor.h"
 #include "PiLink.h"
@@ -95,6 +97,16 @@ class ConnectedDevicesManager
     NotifyDevicesChanged changed;
 
     ActuatorDigital* actuators[MAX_ACTUATOR_COUNT];
+    ChangeFlag<bool>* actuatorChanges[MAX_ACTUATOR_COUNT];
+
+    /**
+     * Sensors that are installed in the control are not created again, the slot listens to the control's sensor.
+     * The control updates it every second, so the device test screen does not add reads on the OneWire bus.
+     * The pointer to the control's sensor is only used during the scan that looked it up, because the control
+     * objects can be rebuilt between scans.
+     */
+    bool installed[MAX_CONNECTED_DEVICES];
+    ChangeFlag<temp_t>* sensorChanges[MAX_CONNECTED_DEVICES];
 
     /**
      * Find a slot that matches the given device config.
@@ -137,10 +149,41 @@ class ConnectedDevicesManager
 
     void clearSlot(int slot) {
         ConnectedDevice& connectedDevice = devices[slot];
-        DeviceManager::disposeDevice(connectedDevice.dt, connectedDevice.pointer.any);
+        if (sensorChanges[slot])
+            sensorChanges[slot]->unsubscribe(); // the control's sensor can already be destroyed
+        if (!installed[slot])
+            DeviceManager::disposeDevice(connectedDevice.dt, connectedDevice.pointer.any);
         if (connectedDevice.pointer.any)
             connectedDevice.lastSeen = 0; // flag to send the REMOVED event
         connectedDevice.pointer.any = NULL;
+        installed[slot] = false;
+    }
+
+    void watchSensor(int slot) {
+        if (sensorChanges[slot])
+            devices[slot].pointer.tempSensor->subscribe(*sensorChanges[slot]); // no effect when still subscribed
+    }
+
+    /**
+     * Returns true when the temperature of the sensor in the slot changed enough to update the UI.
+     * Without a change flag, because it could not be allocated, each reading is a change.
+     */
+    bool sensorChanged(int slot, temp_t& newTemp) {
+        if (!sensorChanges[slot]) {
+            newTemp = devices[slot].pointer.tempSensor->read();
+            return true;
+        }
+        return sensorChanges[slot]->take(newTemp);
+    }
+
+    /**
+     * Returns the control's sensor for a device that is installed, NULL when the device is not installed.
+     */
+    static TempSensorBasic* installedSensor(DeviceConfig* config, DeviceCallbackInfo* info) {
+        if (!isDefinedSlot(info->slot) || config->hw.deactivate ||
+            deviceType(config->deviceFunction)!=DEVICETYPE_TEMP_SENSOR)
+            return NULL;
+        return (TempSensor*) DeviceManager::deviceTarget(*config);
     }
 
     static void deviceCallback(DeviceConfig* config, DeviceCallbackInfo* info) {
@@ -163,22 +206,32 @@ public:
         clear((uint8_t*) & devices, sizeof (devices));
         for (int i = 0; i < MAX_CONNECTED_DEVICES; i++) {
             devices[i].dt = DEVICETYPE_NONE;
+            installed[i] = false;
+            sensorChanges[i] = new ChangeFlag<temp_t>(temp_t(0.05)); // below the 0.1 degree shown on screen
         }
 
         // todo - pull the definitions of the static devices from the device manager.
+        // the pins come from a pool, an actuator that could not be created is left out of the test screen
         actuators[0] = new ActuatorPin(actuatorPin0, BREWPI_INVERT_ACTUATORS);
         actuators[1] = new ActuatorPin(actuatorPin1, BREWPI_INVERT_ACTUATORS);
         actuators[2] = new ActuatorPin(actuatorPin2, BREWPI_INVERT_ACTUATORS);
         actuators[3] = new ActuatorPin(actuatorPin3, BREWPI_INVERT_ACTUATORS);
+        for (int i=0; i<MAX_ACTUATOR_COUNT; i++) {
+            actuatorChanges[i] = new ChangeFlag<bool>(false);
+            if (actuators[i] && actuatorChanges[i])
+                actuators[i]->subscribe(*actuatorChanges[i]);
+        }
     }
 
     ~ConnectedDevicesManager() {
         for (int i=0; i<MAX_ACTUATOR_COUNT; i++) {
             delete actuators[i];
+            delete actuatorChanges[i];
         }
 
         for (int i = 0; i < MAX_CONNECTED_DEVICES; i++) {
             clearSlot(i);
+            delete sensorChanges[i];
         }
     }
 
@@ -189,10 +242,26 @@ public:
 
     void update();
 
+    /**
+     * Returns the actuator for the test screen, or NULL when it could not be created.
+     */
     ActuatorDigital* actuator(size_t index) {
         return actuators[index];
     }
 
+    /**
+     * Returns true once after the actuator changed state. Call with the ControlLock held.
+     */
+    bool actuatorChanged(size_t index, bool& active) {
+        if (!actuators[index])
+            return false;
+        if (!actuatorChanges[index]) {
+            active = actuators[index]->isActive();
+            return true;
+        }
+        return actuatorChanges[index]->take(active);
+    }
+
     const ConnectedDevice* device(size_t index) {
         return &devices[index];
     }
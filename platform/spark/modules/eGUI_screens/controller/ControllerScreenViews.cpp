@@ -88,15 +88,17 @@ ControllerTemperatureFormatPresenter tempFormatPresenter(tempFormatView);
 
 void ControllerScreen_Update()
 {
+    // read the state published by the control task once, so all views show the same update
+    ControlSnapshot snapshot = tempControl.snapshot();
     tempFormatPresenter.update();
-    states state = states(tempControl.getState());
+    states state = states(snapshot.state);
     statePresenter.setState(state);
-    modePresenter.update(tempControl.getMode());
-    timePresenter.update();
+    modePresenter.update(snapshot.mode);
+    timePresenter.update(state);
     
-    beerTempPresenter.update(tempControl.getBeerTemp(), tempControl.getBeerSetting());
-    fridgeTempPresenter.update(tempControl.getFridgeTemp(), tempControl.getFridgeSetting());
-    roomTempPresenter.update(tempControl.getRoomTemp(), temp_t::invalid(), false);
+    beerTempPresenter.update(snapshot.beerTemp, snapshot.beerSetting);
+    fridgeTempPresenter.update(snapshot.fridgeTemp, snapshot.fridgeSetting);
+    roomTempPresenter.update(snapshot.roomTemp, temp_t::invalid(), false);
     
 }
 
@@ -222,9 +222,9 @@ public:
     ControllerTimePresenter(ControllerTimeView& view)
         : view_(view) {}
             
-    void update() {
+    void update(states state) {
         char time_str[MAX_TIME_LEN];
-        int time = fetch_time(tempControl.getState());
+        int time = fetch_time(state);
         if (time<0)
             time_str[0] = 0;
         else
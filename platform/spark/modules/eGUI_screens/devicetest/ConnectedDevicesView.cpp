@@ -23,6 +23,7 @@
 #include "ConnectedDevicesView.h"
 #include "ConnectedDevicesManager.h"
 #include "device_test_screen.h"
+#include "ControlLock.h"
 
 using namespace std::placeholders;
 
@@ -64,17 +65,6 @@ ConnectedDevicesPresenter* connectedDevicesPresenter()
 
 const D4D_OBJECT* actuator_views[] = { &scrDeviceTest_actuator0, &scrDeviceTest_actuator1, &scrDeviceTest_actuator2, &scrDeviceTest_actuator3 };
 
-ActuatorDigital* actuatorForView(const D4D_OBJECT* pThis)
-{
-    ActuatorDigital* actuator = NULL;
-    for (unsigned i=0; i<arraySize(actuator_views); i++) {
-        if (actuator_views[i]==pThis) {
-            actuator = connectedDevicesManager()->actuator(i);
-        }
-    }
-    return actuator;
-}
-
 extern "C" void ActuatorClicked(D4D_OBJECT* pThis)
 {
     int idx = -1;
@@ -87,9 +77,10 @@ extern "C" void ActuatorClicked(D4D_OBJECT* pThis)
     if (pThis==&scrDeviceTest_actuator3)
         idx = 3;
 
-    if (idx>=0) {
-        ActuatorDigital* actuator = connectedDevicesManager()->actuator(idx);
+    ActuatorDigital* actuator = idx>=0 ? connectedDevicesManager()->actuator(idx) : NULL;
+    if (actuator) {
         bool active = !actuator->isActive();
+        ControlLock lock; // the actuator can be on the OneWire bus that the control thread uses
         actuator->setActive(active);
         SetActuatorButtonState(pThis, active, idx);
     }
@@ -99,19 +90,22 @@ void ScreenDeviceTest_OnMain()
 {
     connectedDevicesPresenter();
 
-    for (unsigned i=0; i<arraySize(actuator_views); i++) {
-        const D4D_OBJECT* obj = actuator_views[i];
-        ActuatorDigital* actuator = actuatorForView(obj);
-        SetActuatorButtonState(obj, actuator->isActive(), i);
-    }
-
     static uint32_t last = 0;
     static uint32_t updateTime = 0;
     uint32_t now = millis();
     // make sure updating is only taking 25% of CPU time
     if (now-last>=4*updateTime) {
         last = now;
+        ControlLock lock; // scans the OneWire bus
         connectedDevicesManager()->update();
+
+        // only redraw the buttons of actuators that changed state
+        for (unsigned i=0; i<arraySize(actuator_views); i++) {
+            bool active;
+            if (connectedDevicesManager()->actuatorChanged(i, active)) {
+                SetActuatorButtonState(actuator_views[i], active, i);
+            }
+        }
         updateTime = millis()-now;
     }
 }
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Brewpi.h"
+
+/*
+ * The host test board: a single OneWire bus, which is emulated, and no pins.
+ */
+
+#define oneWirePin 0x0
+
+#define BREWPI_INVERT_ACTUATORS 0
+
+#define USE_INTERNAL_PULL_UP_RESISTORS 0
+
+#define MAX_ACTUATOR_COUNT (0)
+
+inline uint8_t getShieldVersion() {
+    return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/**
+ * Configuration of the host test build. Only OneWire devices are supported, the test platform has no pins.
+ */
+
+#ifndef BREWPI_BOARD
+#define BREWPI_BOARD BREWPI_BOARD_UNKNOWN
+#endif
+
+// the hardware is emulated, like in Platform.h
+#ifndef BREWPI_EMULATE
+#define BREWPI_EMULATE 1
+#endif
+
+#ifndef BREWPI_DS2413
+#define BREWPI_DS2413 1
+#endif
+
+#ifndef BREWPI_DS2408
+#define BREWPI_DS2408 1
+#endif
+
+#ifndef BREWPI_BUZZER
+#define BREWPI_BUZZER 0
+#endif
+
+#ifndef BREWPI_SENSOR_PINS
+#define BREWPI_SENSOR_PINS 0
+#endif
+
+#ifndef BREWPI_ACTUATOR_PINS
+#define BREWPI_ACTUATOR_PINS 0
+#endif
+
+#ifndef DS2413_SUPPORT_SENSE
+#define DS2413_SUPPORT_SENSE 0
+#endif
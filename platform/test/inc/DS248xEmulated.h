@@ -0,0 +1,69 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "WireEmulated.h"
+#include "OneWireEmulated.h"
+
+/**
+ * DS2482-800 I2C to 1-Wire bridge on the emulated I2C bus.
+ *
+ * Channel n is connected to the emulated OneWire bus of pin firstPin + n. The 1-Wire commands are executed on the
+ * emulated bus when they are received. Afterwards the bridge reports busy for a configurable number of status reads,
+ * which stands in for the duration of the 1-Wire time slots.
+ */
+class DS248xEmulated : public I2cEmulatedDevice {
+public:
+    // address is 0-3, like the address pins of the DS248x
+    DS248xEmulated(uint8_t address, uint8_t firstPin);
+    ~DS248xEmulated() = default;
+
+    void receive(const uint8_t * data, uint8_t length) override final;
+    uint8_t transmit() override final;
+
+    // number of status reads that return busy after a 1-Wire command
+    void setBusyReads(uint32_t reads) {
+        busyReads = reads;
+    }
+
+    // 1-Wire commands received while the bridge was busy. The DS248x does not acknowledge them.
+    uint32_t getCommandsWhileBusy() const {
+        return commandsWhileBusy;
+    }
+
+    uint8_t getChannel() const {
+        return channel;
+    }
+
+private:
+    void deviceReset();
+    bool startCommand();
+    OneWireEmulatedBus & bus();
+
+    uint8_t firstPin;
+    uint8_t channel;
+    uint8_t readPtr;
+    uint8_t status;
+    uint8_t config;
+    uint8_t readData;
+    uint32_t busyReads;
+    uint32_t busyLeft;
+    uint32_t commandsWhileBusy;
+};
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "EepromTypes.h"
+
+/**
+ * EEPROM in RAM for the host tests. It starts erased, like a new chip, and counts the reads.
+ */
+class EepromAccessMock
+{
+public:
+    EepromAccessMock() {
+        erase();
+    }
+
+    void erase() {
+        memset(data, 0xFF, sizeof(data));
+        resetReads();
+    }
+
+    void resetReads() {
+        reads = 0;
+    }
+
+    uint8_t readByte(eptr_t offset) {
+        uint8_t value;
+        readBlock(&value, offset, 1);
+        return value;
+    }
+    void writeByte(eptr_t offset, uint8_t value) {
+        writeBlock(offset, &value, 1);
+    }
+
+    void readBlock(void* target, eptr_t offset, uint16_t size) {
+        memcpy(target, data + offset, size);
+        reads++;
+    }
+    void writeBlock(eptr_t target, const void* source, uint16_t size) {
+        memcpy(data + target, source, size);
+    }
+
+    size_t length() {
+        return sizeof(data);
+    }
+
+    void compact() {}
+
+    // number of reads since the last erase or resetReads()
+    uint32_t getReads() const {
+        return reads;
+    }
+
+private:
+    uint8_t data[1024]; // the size of the AVR eeprom
+    uint32_t reads;
+};
+
+typedef EepromAccessMock EepromAccess;
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// number of emulated buses. Drivers for pin n use bus n % ONEWIRE_EMULATED_MAX_BUSES.
+#ifndef ONEWIRE_EMULATED_MAX_BUSES
+#define ONEWIRE_EMULATED_MAX_BUSES (4)
+#endif
+
+// duration of a reset and presence detect cycle at standard speed, in microseconds
+#define ONEWIRE_RESET_TIME (960)
+// duration of a single read or write time slot at standard speed, including recovery time, in microseconds
+#define ONEWIRE_SLOT_TIME (70)
+
+class OneWireEmulatedBus;
+
+/**
+ * Model of a slave device on an emulated OneWire bus.
+ *
+ * The ROM function commands (Read ROM, Match ROM, Skip ROM, Search ROM) are handled here bit by bit, like the
+ * device would handle them. The device specific function commands are handled by the subclasses, which receive
+ * the first byte after the ROM command as command and the following bytes as data.
+ */
+class OneWireEmulatedDevice {
+public:
+    OneWireEmulatedDevice(uint8_t family, uint32_t serial);
+    virtual ~OneWireEmulatedDevice();
+
+    // 64 bit ROM code: family code, 48 bit serial number and crc
+    const uint8_t * getAddress() const {
+        return address;
+    }
+
+    // A device that is not present does not respond to resets or commands, like a device with a bad connection
+    void setPresent(bool present) {
+        this->present = present;
+    }
+
+    bool isPresent() const {
+        return present;
+    }
+
+    // called by the bus
+    void reset();
+    void writeBit(bool bit);
+    bool readBit();
+
+    // alarm search only finds devices with an alarm condition
+    virtual bool hasAlarm() const {
+        return false;
+    }
+
+protected:
+    // first byte after the ROM command
+    virtual void functionCommand(uint8_t command) = 0;
+
+    // bytes written after the command
+    virtual void functionData(uint8_t data) = 0;
+
+    // next byte that is read after a command. 0xFF, the bus idle state, when the device does not drive the bus.
+    virtual uint8_t functionRead() {
+        return 0xFF;
+    }
+
+    // next bit that is read after a command, for commands that respond with single time slots
+    virtual bool functionReadBit();
+
+    uint8_t command;
+
+private:
+    enum class State : uint8_t {
+        IDLE, // waiting for reset
+        ROM_COMMAND,
+        READ_ROM,
+        MATCH_ROM,
+        SEARCH_ROM,
+        FUNCTION
+    };
+
+    bool addressBit(uint8_t i) const {
+        return (address[i >> 3] >> (i & 7)) & 1;
+    }
+
+    uint8_t address[8];
+    bool present;
+    State state;
+    bool commandReceived;
+    uint8_t bitCount; // bits of the ROM code or of the current byte
+    uint8_t searchStep; // search sends the bit, its complement and receives the direction
+    uint8_t shiftIn;
+    uint8_t shiftOut;
+    uint8_t readCount; // bits left in shiftOut
+
+    OneWireEmulatedBus * bus;
+    OneWireEmulatedDevice * next;
+
+    friend class OneWireEmulatedBus;
+};
+
+/**
+ * Bus time used, counted at standard speed.
+ */
+struct OneWireBusStatistics {
+    uint32_t resets;
+    uint32_t bitsWritten;
+    uint32_t bitsRead;
+    uint32_t busTime; // microseconds
+};
+
+/**
+ * An emulated OneWire bus with a wired-AND of the attached devices.
+ * Faults can be injected to test how the code above the driver handles them.
+ */
+class OneWireEmulatedBus {
+public:
+    OneWireEmulatedBus() :
+        first(nullptr),
+        shorted(false),
+        resetFailureInterval(0),
+        readErrorInterval(0),
+        resetCount(0),
+        readCount(0) {
+        resetStatistics();
+    }
+    ~OneWireEmulatedBus() = default;
+
+    static OneWireEmulatedBus & forPin(uint8_t pin);
+
+    void attach(OneWireEmulatedDevice * device);
+    void detach(OneWireEmulatedDevice * device);
+
+    // detaches all devices and clears injected faults and statistics
+    void clear();
+
+    /**
+     * Performs a reset cycle.
+     * @return true when at least one device responded with a presence pulse
+     */
+    bool reset();
+    void writeBit(bool bit);
+    bool readBit();
+
+    // A shorted bus reads as 0 and has no presence pulse
+    void setShorted(bool shorted) {
+        this->shorted = shorted;
+    }
+
+    // Every n-th reset is missed by all devices. 0 disables the fault.
+    void setResetFailureInterval(uint32_t n) {
+        resetFailureInterval = n;
+        resetCount = 0;
+    }
+
+    // Every n-th bit that is read is inverted, like a disturbance on a long cable. 0 disables the fault.
+    void setReadErrorInterval(uint32_t n) {
+        readErrorInterval = n;
+        readCount = 0;
+    }
+
+    const OneWireBusStatistics & statistics() const {
+        return stats;
+    }
+
+    void resetStatistics() {
+        stats = OneWireBusStatistics();
+    }
+
+private:
+    OneWireEmulatedDevice * first;
+    bool shorted;
+    uint32_t resetFailureInterval;
+    uint32_t readErrorInterval;
+    uint32_t resetCount;
+    uint32_t readCount;
+    OneWireBusStatistics stats;
+
+    static OneWireEmulatedBus buses[ONEWIRE_EMULATED_MAX_BUSES];
+};
+
+/**
+ * OneWire driver for the emulated bus of a pin. Has the same interface as the other drivers.
+ */
+class OneWireEmulated {
+public:
+    OneWireEmulated(uint8_t pin) : pin(pin), bus(OneWireEmulatedBus::forPin(pin)) {}
+
+    bool init() {
+        return true;
+    }
+
+    uint8_t pinNr() {
+        return pin;
+    }
+
+    bool reset(void) {
+        return bus.reset();
+    }
+
+    void write(uint8_t v, uint8_t power = 0);
+
+    void write_bytes(const uint8_t *buf, uint16_t count, bool power = 0);
+
+    uint8_t read(void);
+
+    void read_bytes(uint8_t *buf, uint16_t count);
+
+    void write_bit(uint8_t v) {
+        bus.writeBit(v & 1);
+    }
+
+    uint8_t read_bit(void) {
+        return bus.readBit();
+    }
+
+    // same as the triplet command of the DS248x: reads a bit and its complement and writes the search direction
+    void search_triplet(uint8_t * search_direction, uint8_t * id_bit, uint8_t * cmp_id_bit);
+
+    OneWireEmulatedBus & getBus() {
+        return bus;
+    }
+
+private:
+    uint8_t pin;
+    OneWireEmulatedBus & bus;
+};
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWireEmulated.h"
+
+/**
+ * DS18B20 temperature sensor.
+ *
+ * The scratchpad, the EEPROM copy of the alarm and configuration registers and the conversion time for the
+ * configured resolution are emulated. Conversions complete after the conversion time has passed in ticks.
+ * The device is externally powered.
+ */
+class DS18B20Emulated : public OneWireEmulatedDevice {
+public:
+    DS18B20Emulated(uint32_t serial, double temperature = 20.0);
+    ~DS18B20Emulated() = default;
+
+    // temperature that is latched in the scratchpad by the next conversion
+    void setTemperature(double temperature);
+
+    // Restores the scratchpad to the power on state: 85 degrees and the registers from EEPROM
+    void powerOnReset();
+
+    // Overrides the conversion time of the datasheet, for example 0 for code that does not wait for conversions
+    void setConversionTime(int32_t ms) {
+        conversionTimeOverride = ms;
+    }
+
+    // conversion time in ms for the configured resolution
+    uint16_t conversionTime() const;
+
+    bool isConverting();
+
+    // The next scratchpad read sends a wrong crc
+    void injectCrcError() {
+        crcError = true;
+    }
+
+    const uint8_t * getScratchpad() const {
+        return scratchpad;
+    }
+
+    uint16_t getEepromWrites() const {
+        return eepromWrites;
+    }
+
+    uint16_t getConversions() const {
+        return conversions;
+    }
+
+protected:
+    void functionCommand(uint8_t command) override final;
+    void functionData(uint8_t data) override final;
+    uint8_t functionRead() override final;
+    bool functionReadBit() override final;
+
+private:
+    void updateConversion();
+    void updateCrc();
+
+    uint8_t scratchpad[9];
+    uint8_t eeprom[3]; // high alarm, low alarm, configuration
+    int16_t temperatureRaw; // 1/16 degree
+    int16_t convertedRaw; // temperature when the conversion was started
+    int32_t conversionTimeOverride;
+    uint32_t conversionStart;
+    bool converting;
+    bool crcError;
+    uint8_t index;
+    uint16_t eepromWrites;
+    uint16_t conversions;
+};
+
+/**
+ * DS2413 dual channel switch.
+ *
+ * Pins are open drain: a pin is low when its latch is active or when it is pulled low externally.
+ */
+class DS2413Emulated : public OneWireEmulatedDevice {
+public:
+    DS2413Emulated(uint32_t serial);
+    ~DS2413Emulated() = default;
+
+    // true when the output transistor of the pio is on
+    bool latch(uint8_t pio) const {
+        return !(latches & (1 << pio));
+    }
+
+    // pin level, true is high
+    bool pin(uint8_t pio) const {
+        return (latches & ~externalLow) & (1 << pio);
+    }
+
+    // emulates a switch connected to the pin
+    void setExternalLow(uint8_t pio, bool low);
+
+    uint16_t getLatchWrites() const {
+        return latchWrites;
+    }
+
+protected:
+    void functionCommand(uint8_t command) override final;
+    void functionData(uint8_t data) override final;
+    uint8_t functionRead() override final;
+
+private:
+    uint8_t status() const;
+
+    uint8_t latches; // bit 0 is PIOA, bit 1 is PIOB. 0 means the transistor is on.
+    uint8_t externalLow;
+    uint8_t written; // first data byte of a write, which is followed by its complement
+    uint8_t received; // data bytes received after the command
+    uint8_t index; // bytes read after the command
+    bool ack;
+    uint16_t latchWrites;
+};
+
+/**
+ * DS2408 8 channel switch.
+ *
+ * Supports channel access read and write, reading the PIO registers and resetting the activity latches.
+ */
+class DS2408Emulated : public OneWireEmulatedDevice {
+public:
+    DS2408Emulated(uint32_t serial);
+    ~DS2408Emulated() = default;
+
+    // output latch state, a 0 bit means the transistor is on
+    uint8_t latches() const {
+        return latch;
+    }
+
+    // pin levels
+    uint8_t pins() const {
+        return latch & ~externalLow;
+    }
+
+    uint8_t activity() const {
+        return activityLatch;
+    }
+
+    void setExternalLow(uint8_t mask);
+
+    uint16_t getLatchWrites() const {
+        return latchWrites;
+    }
+
+protected:
+    void functionCommand(uint8_t command) override final;
+    void functionData(uint8_t data) override final;
+    uint8_t functionRead() override final;
+
+private:
+    uint8_t registerValue(uint8_t address) const;
+    void setPins(uint8_t newLatch, uint8_t newExternalLow);
+
+    uint8_t latch;
+    uint8_t externalLow;
+    uint8_t activityLatch;
+    uint8_t conditionalSearch[3]; // selection mask, polarity and control registers
+    uint16_t targetAddress;
+    uint16_t crc;
+    uint8_t written;
+    uint8_t received;
+    uint8_t index;
+    bool ack;
+    uint16_t latchWrites;
+};
@@ -24,7 +24,7 @@
 
 #define PRINTF_PROGMEM "%s"             // devices with unified address space
 
-#define ONEWIRE_NULL
+#define ONEWIRE_EMULATED // see OneWireEmulated.h, a bus without devices behaves like OneWireNull
 
 #include <stdio.h> // for vsnprintf
 #include <stdint.h>
@@ -35,6 +35,10 @@ typedef uint32_t ticks_micros_t;
 typedef uint32_t ticks_seconds_t;
 typedef uint8_t ticks_seconds_tiny_t;
 
+// the test platform has no serial port, the stream classes are only declared for the interfaces that take them
+class Print;
+class Stream;
+
 #define BREWPI_EMULATE 1
 
 #endif	/* PLATFORM_H */
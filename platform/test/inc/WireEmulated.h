@@ -0,0 +1,96 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// size of the transmit and receive buffers, like the Wire library of the Particle firmware
+#define WIRE_EMULATED_BUFFER_LENGTH (32)
+
+/**
+ * Model of a slave device on the emulated I2C bus.
+ */
+class I2cEmulatedDevice {
+public:
+    I2cEmulatedDevice(uint8_t address) : address(address), next(nullptr) {}
+    virtual ~I2cEmulatedDevice();
+
+    uint8_t getAddress() const {
+        return address;
+    }
+
+    // bytes written by the master in a single transmission
+    virtual void receive(const uint8_t * data, uint8_t length) = 0;
+
+    // next byte read by the master
+    virtual uint8_t transmit() = 0;
+
+private:
+    uint8_t address;
+    I2cEmulatedDevice * next;
+
+    friend class TwoWire;
+};
+
+/**
+ * Emulated I2C master with the interface of the Wire library, so drivers for I2C devices can be tested on the host.
+ * Transmissions to an address without a device are not acknowledged.
+ */
+class TwoWire {
+public:
+    TwoWire() : first(nullptr), txAddress(0), txLength(0), rxLength(0), rxIndex(0), transfers(0) {}
+    ~TwoWire() = default;
+
+    void begin() {}
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    // returns 0 on success, 2 when the address was not acknowledged
+    uint8_t endTransmission();
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    int available();
+    int read();
+
+    void attach(I2cEmulatedDevice * device);
+    void detach(I2cEmulatedDevice * device);
+
+    // number of transmissions and requests since the last reset, to check how much a driver uses the bus
+    uint32_t getTransfers() const {
+        return transfers;
+    }
+
+    void resetTransfers() {
+        transfers = 0;
+    }
+
+private:
+    I2cEmulatedDevice * find(uint8_t address);
+
+    I2cEmulatedDevice * first;
+    uint8_t txAddress;
+    uint8_t txBuffer[WIRE_EMULATED_BUFFER_LENGTH];
+    uint8_t txLength;
+    uint8_t rxBuffer[WIRE_EMULATED_BUFFER_LENGTH];
+    uint8_t rxLength;
+    uint8_t rxIndex;
+    uint32_t transfers;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * The part of the Particle firmware API that the Spark drivers under test use.
+ * The I2C bus is emulated, time comes from the test ticks.
+ */
+
+#include <stdint.h>
+#include "Ticks.h"
+#include "WireEmulated.h"
+
+typedef uint8_t byte;
+
+inline uint32_t micros() {
+    return ticks.micros();
+}
+
+// the test ticks only move when the test advances them, so waiting is a no-op
+inline void delayMicroseconds(uint32_t us) {
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DS248xEmulated.h"
+
+// commands, from the DS2482-800 datasheet
+#define CMD_DRST 0xf0 // Device Reset
+#define CMD_WCFG 0xd2 // Write Configuration
+#define CMD_CHSL 0xc3 // Channel Select
+#define CMD_SRP 0xe1 // Set Read Pointer
+#define CMD_1WRS 0xb4 // 1-Wire Reset
+#define CMD_1WWB 0xa5 // 1-Wire Write Byte
+#define CMD_1WRB 0x96 // 1-Wire Read Byte
+#define CMD_1WSB 0x87 // 1-Wire Single Bit
+#define CMD_1WT 0x78 // 1-Wire Triplet
+
+// read pointer codes
+#define PTR_STATUS 0xf0
+#define PTR_DATA 0xe1
+#define PTR_CHANNEL 0xd2
+#define PTR_CONFIG 0xc3
+
+#define STATUS_BUSY (0x1<<0)
+#define STATUS_PPD (0x1<<1)
+#define STATUS_RST (0x1<<4)
+#define STATUS_SBR (0x1<<5)
+#define STATUS_TSB (0x1<<6)
+#define STATUS_DIR (0x1<<7)
+
+// channel select codes and the codes read back from the channel selection register
+static const uint8_t channelSelectCodes[8] = {0xf0, 0xe1, 0xd2, 0xc3, 0xb4, 0xa5, 0x96, 0x87};
+static const uint8_t channelReadCodes[8] = {0xb8, 0xb1, 0xaa, 0xa3, 0x9c, 0x95, 0x8e, 0x87};
+
+DS248xEmulated::DS248xEmulated(uint8_t address, uint8_t firstPin) :
+    I2cEmulatedDevice(0x18 | (address & 0b11)),
+    firstPin(firstPin),
+    busyReads(1),
+    commandsWhileBusy(0) {
+    deviceReset();
+}
+
+void DS248xEmulated::deviceReset(){
+    channel = 0;
+    readPtr = PTR_STATUS;
+    status = STATUS_RST;
+    config = 0;
+    readData = 0;
+    busyLeft = 0;
+}
+
+OneWireEmulatedBus & DS248xEmulated::bus(){
+    return OneWireEmulatedBus::forPin(firstPin + channel);
+}
+
+// 1-Wire commands are ignored while the bridge is busy
+bool DS248xEmulated::startCommand(){
+    readPtr = PTR_STATUS;
+    if(busyLeft > 0){
+        commandsWhileBusy++;
+        return false;
+    }
+    busyLeft = busyReads;
+    status &= ~STATUS_RST;
+    return true;
+}
+
+void DS248xEmulated::receive(const uint8_t * data, uint8_t length){
+    if(length == 0){
+        return;
+    }
+    uint8_t parameter = length > 1 ? data[1] : 0;
+    switch(data[0]){
+    case CMD_DRST:
+        deviceReset();
+        break;
+    case CMD_SRP:
+        readPtr = parameter;
+        break;
+    case CMD_WCFG:
+        // the upper nibble is the complement of the configuration
+        if((uint8_t(~parameter) >> 4) == (parameter & 0x0f)){
+            config = parameter & 0x0f;
+        }
+        readPtr = PTR_CONFIG;
+        break;
+    case CMD_CHSL:
+        for(uint8_t i = 0; i < 8; i++){
+            if(channelSelectCodes[i] == parameter){
+                channel = i;
+            }
+        }
+        readPtr = PTR_CHANNEL;
+        break;
+    case CMD_1WRS:
+        if(startCommand()){
+            if(bus().reset()){
+                status |= STATUS_PPD;
+            } else {
+                status &= ~STATUS_PPD;
+            }
+        }
+        break;
+    case CMD_1WWB:
+        if(startCommand()){
+            for(uint8_t i = 0; i < 8; i++){
+                bus().writeBit((parameter >> i) & 1);
+            }
+        }
+        break;
+    case CMD_1WRB:
+        if(startCommand()){
+            readData = 0;
+            for(uint8_t i = 0; i < 8; i++){
+                if(bus().readBit()){
+                    readData |= 1 << i;
+                }
+            }
+        }
+        break;
+    case CMD_1WSB:
+        if(startCommand()){
+            // writing a 1 is a read time slot
+            bool bit = (parameter & 0x80) ? bus().readBit() : false;
+            if(!(parameter & 0x80)){
+                bus().writeBit(false);
+            }
+            status = bit ? (status | STATUS_SBR) : (status & ~STATUS_SBR);
+        }
+        break;
+    case CMD_1WT:
+        if(startCommand()){
+            bool id = bus().readBit();
+            bool cmp = bus().readBit();
+            bool direction = (id != cmp) ? id : (id ? true : (parameter & 0x80));
+            bus().writeBit(direction);
+            status &= ~(STATUS_SBR | STATUS_TSB | STATUS_DIR);
+            status |= (id ? STATUS_SBR : 0) | (cmp ? STATUS_TSB : 0) | (direction ? STATUS_DIR : 0);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+uint8_t DS248xEmulated::transmit(){
+    switch(readPtr){
+    case PTR_STATUS:
+        if(busyLeft > 0){
+            busyLeft--;
+            return status | STATUS_BUSY;
+        }
+        return status;
+    case PTR_DATA:
+        return readData;
+    case PTR_CONFIG:
+        return config;
+    case PTR_CHANNEL:
+        return channelReadCodes[channel];
+    default:
+        return 0xff;
+    }
+}
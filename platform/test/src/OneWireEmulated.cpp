@@ -0,0 +1,316 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OneWireEmulated.h"
+#include "OneWire.h"
+
+#define READROM 0x33
+#define MATCHROM 0x55
+#define SKIPROM 0xCC
+#define SEARCHROM 0xF0
+#define ALARMSEARCH 0xEC
+
+OneWireEmulatedDevice::OneWireEmulatedDevice(uint8_t family, uint32_t serial) :
+    command(0),
+    present(true),
+    state(State::IDLE),
+    commandReceived(false),
+    bitCount(0),
+    searchStep(0),
+    shiftIn(0),
+    shiftOut(0),
+    readCount(0),
+    bus(nullptr),
+    next(nullptr) {
+    address[0] = family;
+    for(uint8_t i = 1; i < 7; i++){
+        address[i] = i < 5 ? uint8_t(serial >> ((i - 1) * 8)) : 0;
+    }
+    address[7] = OneWire::crc8(address, 7);
+}
+
+OneWireEmulatedDevice::~OneWireEmulatedDevice(){
+    if(bus){
+        bus->detach(this);
+    }
+}
+
+void OneWireEmulatedDevice::reset(){
+    state = State::ROM_COMMAND;
+    commandReceived = false;
+    bitCount = 0;
+    searchStep = 0;
+    shiftIn = 0;
+    readCount = 0;
+}
+
+void OneWireEmulatedDevice::writeBit(bool bit){
+    switch(state){
+    case State::ROM_COMMAND:
+        shiftIn = (shiftIn >> 1) | (bit ? 0x80 : 0);
+        if(++bitCount < 8){
+            break;
+        }
+        bitCount = 0;
+        switch(shiftIn){
+        case READROM:
+            state = State::READ_ROM;
+            break;
+        case MATCHROM:
+            state = State::MATCH_ROM;
+            break;
+        case SKIPROM:
+            state = State::FUNCTION;
+            break;
+        case SEARCHROM:
+            state = State::SEARCH_ROM;
+            break;
+        case ALARMSEARCH:
+            state = hasAlarm() ? State::SEARCH_ROM : State::IDLE;
+            break;
+        default:
+            state = State::IDLE;
+            break;
+        }
+        break;
+    case State::MATCH_ROM:
+        if(bit != addressBit(bitCount)){
+            state = State::IDLE; // not selected, wait for the next reset
+        }
+        else if(++bitCount == 64){
+            state = State::FUNCTION;
+            bitCount = 0;
+        }
+        break;
+    case State::SEARCH_ROM:
+        if(searchStep != 2){
+            state = State::IDLE; // master did not follow the search protocol
+        }
+        else if(bit != addressBit(bitCount)){
+            state = State::IDLE; // master continues with devices in the other branch
+        }
+        else if(++bitCount == 64){
+            state = State::FUNCTION;
+            bitCount = 0;
+        }
+        searchStep = 0;
+        break;
+    case State::FUNCTION:
+        shiftIn = (shiftIn >> 1) | (bit ? 0x80 : 0);
+        if(++bitCount < 8){
+            break;
+        }
+        bitCount = 0;
+        readCount = 0;
+        if(commandReceived){
+            functionData(shiftIn);
+        }
+        else {
+            commandReceived = true;
+            command = shiftIn;
+            functionCommand(command);
+        }
+        break;
+    case State::READ_ROM:
+    case State::IDLE:
+    default:
+        break;
+    }
+}
+
+bool OneWireEmulatedDevice::readBit(){
+    switch(state){
+    case State::READ_ROM:
+    {
+        bool bit = addressBit(bitCount);
+        if(++bitCount == 64){
+            state = State::FUNCTION;
+            bitCount = 0;
+        }
+        return bit;
+    }
+    case State::SEARCH_ROM:
+        if(searchStep == 0){
+            searchStep = 1;
+            return addressBit(bitCount);
+        }
+        if(searchStep == 1){
+            searchStep = 2;
+            return !addressBit(bitCount);
+        }
+        return true;
+    case State::FUNCTION:
+        if(!commandReceived){
+            return true;
+        }
+        return functionReadBit();
+    case State::ROM_COMMAND:
+    case State::MATCH_ROM:
+    case State::IDLE:
+    default:
+        return true;
+    }
+}
+
+bool OneWireEmulatedDevice::functionReadBit(){
+    if(readCount == 0){
+        shiftOut = functionRead();
+        readCount = 8;
+    }
+    bool bit = shiftOut & 1;
+    shiftOut >>= 1;
+    readCount--;
+    return bit;
+}
+
+OneWireEmulatedBus OneWireEmulatedBus::buses[ONEWIRE_EMULATED_MAX_BUSES];
+
+OneWireEmulatedBus & OneWireEmulatedBus::forPin(uint8_t pin){
+    return buses[pin % ONEWIRE_EMULATED_MAX_BUSES];
+}
+
+void OneWireEmulatedBus::attach(OneWireEmulatedDevice * device){
+    if(device->bus){
+        device->bus->detach(device);
+    }
+    device->bus = this;
+    device->next = first;
+    device->state = OneWireEmulatedDevice::State::IDLE;
+    first = device;
+}
+
+void OneWireEmulatedBus::detach(OneWireEmulatedDevice * device){
+    for(OneWireEmulatedDevice ** p = &first; *p != nullptr; p = &(*p)->next){
+        if(*p == device){
+            *p = device->next;
+            device->next = nullptr;
+            device->bus = nullptr;
+            break;
+        }
+    }
+}
+
+void OneWireEmulatedBus::clear(){
+    while(first != nullptr){
+        detach(first);
+    }
+    shorted = false;
+    setResetFailureInterval(0);
+    setReadErrorInterval(0);
+    resetStatistics();
+}
+
+bool OneWireEmulatedBus::reset(){
+    stats.resets++;
+    stats.busTime += ONEWIRE_RESET_TIME;
+    if(shorted){
+        return false;
+    }
+    resetCount++;
+    if(resetFailureInterval && (resetCount % resetFailureInterval) == 0){
+        for(OneWireEmulatedDevice * d = first; d != nullptr; d = d->next){
+            d->state = OneWireEmulatedDevice::State::IDLE;
+        }
+        return false;
+    }
+    bool presence = false;
+    for(OneWireEmulatedDevice * d = first; d != nullptr; d = d->next){
+        if(d->present){
+            d->reset();
+            presence = true;
+        }
+        else {
+            d->state = OneWireEmulatedDevice::State::IDLE;
+        }
+    }
+    return presence;
+}
+
+void OneWireEmulatedBus::writeBit(bool bit){
+    stats.bitsWritten++;
+    stats.busTime += ONEWIRE_SLOT_TIME;
+    if(shorted){
+        return;
+    }
+    for(OneWireEmulatedDevice * d = first; d != nullptr; d = d->next){
+        if(d->present){
+            d->writeBit(bit);
+        }
+    }
+}
+
+bool OneWireEmulatedBus::readBit(){
+    stats.bitsRead++;
+    stats.busTime += ONEWIRE_SLOT_TIME;
+    if(shorted){
+        return false;
+    }
+    // the bus is pulled up and any device can pull it low
+    bool bit = true;
+    for(OneWireEmulatedDevice * d = first; d != nullptr; d = d->next){
+        if(d->present){
+            bit &= d->readBit();
+        }
+    }
+    readCount++;
+    if(readErrorInterval && (readCount % readErrorInterval) == 0){
+        bit = !bit;
+    }
+    return bit;
+}
+
+void OneWireEmulated::write(uint8_t v, uint8_t power){
+    for(uint8_t i = 0; i < 8; i++){
+        bus.writeBit((v >> i) & 1);
+    }
+}
+
+void OneWireEmulated::write_bytes(const uint8_t *buf, uint16_t count, bool power){
+    for(uint16_t i = 0; i < count; i++){
+        write(buf[i], power);
+    }
+}
+
+uint8_t OneWireEmulated::read(void){
+    uint8_t v = 0;
+    for(uint8_t i = 0; i < 8; i++){
+        if(bus.readBit()){
+            v |= 1 << i;
+        }
+    }
+    return v;
+}
+
+void OneWireEmulated::read_bytes(uint8_t *buf, uint16_t count){
+    for(uint16_t i = 0; i < count; i++){
+        buf[i] = read();
+    }
+}
+
+void OneWireEmulated::search_triplet(uint8_t * search_direction, uint8_t * id_bit, uint8_t * cmp_id_bit){
+    *id_bit = bus.readBit();
+    *cmp_id_bit = bus.readBit();
+    if(*id_bit != *cmp_id_bit){
+        *search_direction = *id_bit; // all remaining devices have the same bit
+    }
+    else if(*id_bit){
+        *search_direction = 1; // no devices responded
+    }
+    bus.writeBit(*search_direction);
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OneWireEmulatedDevices.h"
+#include "OneWire.h"
+#include "Ticks.h"
+#include <math.h>
+#include <string.h>
+
+#define CONVERT_T 0x44
+#define COPY_SCRATCHPAD 0x48
+#define WRITE_SCRATCHPAD 0x4E
+#define READ_SCRATCHPAD 0xBE
+#define RECALL_EEPROM 0xB8
+#define READ_POWER_SUPPLY 0xB4
+
+#define PIO_ACCESS_READ 0xF5
+#define PIO_ACCESS_WRITE 0x5A
+#define READ_PIO_REGISTERS 0xF0
+#define WRITE_CONDITIONAL_SEARCH_REGISTER 0xCC
+#define RESET_ACTIVITY_LATCHES 0xC3
+
+#define ACK_SUCCESS 0xAA
+
+DS18B20Emulated::DS18B20Emulated(uint32_t serial, double temperature) :
+    OneWireEmulatedDevice(0x28, serial),
+    convertedRaw(0),
+    conversionTimeOverride(-1),
+    conversionStart(0),
+    converting(false),
+    crcError(false),
+    index(0),
+    eepromWrites(0),
+    conversions(0) {
+    // factory defaults of the alarm registers and 12 bit resolution
+    eeprom[0] = 0x4B;
+    eeprom[1] = 0x46;
+    eeprom[2] = 0x7F;
+    setTemperature(temperature);
+    powerOnReset();
+}
+
+void DS18B20Emulated::setTemperature(double temperature){
+    temperatureRaw = int16_t(lround(temperature * 16));
+}
+
+void DS18B20Emulated::powerOnReset(){
+    scratchpad[0] = 0x50; // 85 degrees
+    scratchpad[1] = 0x05;
+    memcpy(&scratchpad[2], eeprom, sizeof(eeprom));
+    scratchpad[5] = 0xFF;
+    scratchpad[6] = 0x0C;
+    scratchpad[7] = 0x10;
+    updateCrc();
+    converting = false;
+}
+
+uint16_t DS18B20Emulated::conversionTime() const {
+    if(conversionTimeOverride >= 0){
+        return conversionTimeOverride;
+    }
+    static const uint16_t times[4] = {94, 188, 375, 750};
+    return times[(scratchpad[4] >> 5) & 0x3];
+}
+
+bool DS18B20Emulated::isConverting(){
+    updateConversion();
+    return converting;
+}
+
+void DS18B20Emulated::updateConversion(){
+    if(!converting || ticks.timeSinceMillis(conversionStart) < conversionTime()){
+        return;
+    }
+    // undefined bits are 0 at lower resolutions
+    uint8_t unusedBits = 3 - ((scratchpad[4] >> 5) & 0x3);
+    int16_t raw = convertedRaw & ~((1 << unusedBits) - 1);
+    scratchpad[0] = uint8_t(raw);
+    scratchpad[1] = uint8_t(uint16_t(raw) >> 8);
+    updateCrc();
+    converting = false;
+}
+
+void DS18B20Emulated::updateCrc(){
+    scratchpad[8] = OneWire::crc8(scratchpad, 8);
+}
+
+void DS18B20Emulated::functionCommand(uint8_t command){
+    updateConversion();
+    index = 0;
+    switch(command){
+    case CONVERT_T:
+        converting = true;
+        conversionStart = ticks.millis();
+        convertedRaw = temperatureRaw;
+        conversions++;
+        updateConversion();
+        break;
+    case WRITE_SCRATCHPAD:
+        index = 2; // high alarm, low alarm and configuration are written
+        break;
+    case COPY_SCRATCHPAD:
+        memcpy(eeprom, &scratchpad[2], sizeof(eeprom));
+        eepromWrites++;
+        break;
+    case RECALL_EEPROM:
+        memcpy(&scratchpad[2], eeprom, sizeof(eeprom));
+        updateCrc();
+        break;
+    default:
+        break;
+    }
+}
+
+void DS18B20Emulated::functionData(uint8_t data){
+    if(command != WRITE_SCRATCHPAD || index > 4){
+        return;
+    }
+    if(index == 4){
+        data = (data & 0x60) | 0x1F; // only the resolution bits can be written
+    }
+    scratchpad[index++] = data;
+    updateCrc();
+}
+
+uint8_t DS18B20Emulated::functionRead(){
+    if(command != READ_SCRATCHPAD || index >= 9){
+        return 0xFF;
+    }
+    uint8_t data = scratchpad[index];
+    if(index == 8 && crcError){
+        data ^= 0x01;
+        crcError = false;
+    }
+    index++;
+    return data;
+}
+
+bool DS18B20Emulated::functionReadBit(){
+    if(command == CONVERT_T){
+        return !isConverting(); // read time slots are 0 while converting
+    }
+    if(command == READ_POWER_SUPPLY){
+        return true; // externally powered
+    }
+    return OneWireEmulatedDevice::functionReadBit();
+}
+
+DS2413Emulated::DS2413Emulated(uint32_t serial) :
+    OneWireEmulatedDevice(0x3A, serial),
+    latches(0x3),
+    externalLow(0),
+    written(0),
+    received(0),
+    index(0),
+    ack(false),
+    latchWrites(0) {
+}
+
+void DS2413Emulated::setExternalLow(uint8_t pio, bool low){
+    if(low){
+        externalLow |= (1 << pio);
+    }
+    else {
+        externalLow &= ~(1 << pio);
+    }
+}
+
+uint8_t DS2413Emulated::status() const {
+    uint8_t lower = (pin(0) ? 0x1 : 0) | ((latches & 0x1) << 1) | (pin(1) ? 0x4 : 0) | ((latches & 0x2) << 2);
+    return (~lower << 4) | lower;
+}
+
+void DS2413Emulated::functionCommand(uint8_t command){
+    received = 0;
+    index = 0;
+    ack = false;
+}
+
+void DS2413Emulated::functionData(uint8_t data){
+    if(command != PIO_ACCESS_WRITE){
+        return;
+    }
+    if(received == 0){
+        written = data;
+    }
+    else if(received == 1){
+        ack = data == uint8_t(~written);
+        if(ack){
+            latches = written & 0x3;
+            latchWrites++;
+        }
+    }
+    received++;
+}
+
+uint8_t DS2413Emulated::functionRead(){
+    if(command == PIO_ACCESS_READ){
+        return status();
+    }
+    if(command == PIO_ACCESS_WRITE && received >= 2 && ack){
+        return (index++ == 0) ? ACK_SUCCESS : status();
+    }
+    return 0xFF;
+}
+
+DS2408Emulated::DS2408Emulated(uint32_t serial) :
+    OneWireEmulatedDevice(0x29, serial),
+    latch(0xFF),
+    externalLow(0),
+    activityLatch(0),
+    targetAddress(0),
+    crc(0),
+    written(0),
+    received(0),
+    index(0),
+    ack(false),
+    latchWrites(0) {
+    conditionalSearch[0] = 0;
+    conditionalSearch[1] = 0;
+    conditionalSearch[2] = 0x88; // externally powered, power on reset latch set
+}
+
+void DS2408Emulated::setExternalLow(uint8_t mask){
+    setPins(latch, mask);
+}
+
+void DS2408Emulated::setPins(uint8_t newLatch, uint8_t newExternalLow){
+    uint8_t old = pins();
+    latch = newLatch;
+    externalLow = newExternalLow;
+    activityLatch |= old ^ pins();
+}
+
+uint8_t DS2408Emulated::registerValue(uint8_t address) const {
+    switch(address){
+    case 0x88:
+        return pins();
+    case 0x89:
+        return latch;
+    case 0x8A:
+        return activityLatch;
+    case 0x8B:
+    case 0x8C:
+    case 0x8D:
+        return conditionalSearch[address - 0x8B];
+    default:
+        return 0xFF;
+    }
+}
+
+void DS2408Emulated::functionCommand(uint8_t command){
+    crc = OneWire::crc16(&command, 1);
+    received = 0;
+    index = 0;
+    ack = false;
+    if(command == RESET_ACTIVITY_LATCHES){
+        activityLatch = 0;
+        ack = true;
+    }
+}
+
+void DS2408Emulated::functionData(uint8_t data){
+    switch(command){
+    case READ_PIO_REGISTERS:
+    case WRITE_CONDITIONAL_SEARCH_REGISTER:
+        if(received < 2){
+            crc = OneWire::crc16(&data, 1, crc);
+            if(received == 0){
+                targetAddress = data;
+            }
+            else {
+                targetAddress |= uint16_t(data) << 8;
+            }
+        }
+        else if(command == WRITE_CONDITIONAL_SEARCH_REGISTER && targetAddress >= 0x8B && targetAddress <= 0x8D){
+            uint8_t & reg = conditionalSearch[targetAddress - 0x8B];
+            reg = (targetAddress == 0x8D) ? ((reg & 0x80) | (data & 0x0F)) : data;
+            targetAddress++;
+        }
+        break;
+    case PIO_ACCESS_WRITE:
+        if(received == 0){
+            written = data;
+        }
+        else if(received == 1){
+            ack = data == uint8_t(~written);
+            if(ack){
+                setPins(written, externalLow);
+                latchWrites++;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    received++;
+}
+
+uint8_t DS2408Emulated::functionRead(){
+    uint8_t data = 0xFF;
+    switch(command){
+    case PIO_ACCESS_READ:
+        // 32 samples of the pins, followed by the inverted crc16
+        if(index < 32){
+            data = pins();
+            crc = OneWire::crc16(&data, 1, crc);
+        }
+        else {
+            data = uint8_t(~crc >> ((index - 32) * 8));
+        }
+        if(++index == 34){
+            index = 0;
+            crc = 0; // the next crc only covers the next 32 samples
+        }
+        return data;
+    case READ_PIO_REGISTERS:
+        if(received < 2){
+            return 0xFF;
+        }
+        if(targetAddress <= 0x8F){
+            data = registerValue(targetAddress++);
+            crc = OneWire::crc16(&data, 1, crc);
+            return data;
+        }
+        if(index < 2){
+            data = uint8_t(~crc >> (index * 8));
+            index++;
+        }
+        return data;
+    case PIO_ACCESS_WRITE:
+        if(received >= 2 && ack){
+            return (index++ == 0) ? ACK_SUCCESS : pins();
+        }
+        return 0xFF;
+    case RESET_ACTIVITY_LATCHES:
+        return ACK_SUCCESS;
+    default:
+        return 0xFF;
+    }
+}
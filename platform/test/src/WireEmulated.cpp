@@ -0,0 +1,102 @@
+/*
+ * Copyright 2016 BrewPi/Elco Jacobs.
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WireEmulated.h"
+
+TwoWire Wire;
+
+I2cEmulatedDevice::~I2cEmulatedDevice(){
+    Wire.detach(this);
+}
+
+void TwoWire::attach(I2cEmulatedDevice * device){
+    detach(device);
+    device->next = first;
+    first = device;
+}
+
+void TwoWire::detach(I2cEmulatedDevice * device){
+    for(I2cEmulatedDevice ** p = &first; *p != nullptr; p = &(*p)->next){
+        if(*p == device){
+            *p = device->next;
+            device->next = nullptr;
+            return;
+        }
+    }
+}
+
+I2cEmulatedDevice * TwoWire::find(uint8_t address){
+    for(I2cEmulatedDevice * d = first; d != nullptr; d = d->next){
+        if(d->address == address){
+            return d;
+        }
+    }
+    return nullptr;
+}
+
+void TwoWire::beginTransmission(uint8_t address){
+    txAddress = address;
+    txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data){
+    if(txLength >= WIRE_EMULATED_BUFFER_LENGTH){
+        return 0;
+    }
+    txBuffer[txLength++] = data;
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(){
+    transfers++;
+    I2cEmulatedDevice * device = find(txAddress);
+    if(device == nullptr){
+        return 2;
+    }
+    device->receive(txBuffer, txLength);
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity){
+    transfers++;
+    rxIndex = 0;
+    rxLength = 0;
+    I2cEmulatedDevice * device = find(address);
+    if(device == nullptr){
+        return 0;
+    }
+    if(quantity > WIRE_EMULATED_BUFFER_LENGTH){
+        quantity = WIRE_EMULATED_BUFFER_LENGTH;
+    }
+    while(rxLength < quantity){
+        rxBuffer[rxLength++] = device->transmit();
+    }
+    return rxLength;
+}
+
+int TwoWire::available(){
+    return rxLength - rxIndex;
+}
+
+int TwoWire::read(){
+    if(rxIndex >= rxLength){
+        return -1;
+    }
+    return rxBuffer[rxIndex++];
+}
@@ -21,6 +21,9 @@
 
 
 #include "ActuatorPin.h"
+#include "DevicePools.h"
+
+POOL_ALLOCATION(ActuatorPin, ACTUATOR_PIN_POOL_SIZE)
 
 ActuatorPin::ActuatorPin(uint8_t pin,
         bool                                   invert)
@@ -24,6 +24,7 @@
 
 #include "Platform.h"
 #include "ActuatorInterfaces.h"
+#include "BlockPool.h"
 
 class ActuatorPin final: public ActuatorDigital, public ActuatorPinMixin
 {
@@ -40,6 +41,7 @@ class ActuatorPin final: public ActuatorDigital, public ActuatorPinMixin
         void setActive(bool active) override final
         {
             digitalWrite(pin, (active ^ invert) ? HIGH : LOW);
+            publishChange();
         }
 
         bool isActive() const override final
@@ -47,8 +49,13 @@ class ActuatorPin final: public ActuatorDigital, public ActuatorPinMixin
             return ((digitalRead(pin) != LOW) ^ invert);
         }
 
-        void update() override final {} // do nothing on periodic update
+        // the pin can also be written by another ActuatorPin for the same pin, publish its state periodically
+        void update() override final {
+            publishChange();
+        }
         void fastUpdate() override final {} // do nothing on fast update
 
+        POOL_ALLOCATED
+
     friend class ActuatorPinMixin;
 };